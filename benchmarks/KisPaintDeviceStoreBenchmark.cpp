@@ -0,0 +1,146 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPaintDeviceStoreBenchmark.h"
+
+#include <QBuffer>
+#include <QRandomGenerator>
+#include <QThreadPool>
+
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "kis_paint_device_writer.h"
+#include "kis_sequential_iterator.h"
+
+const int NUM_LAYERS = 16;
+const int IMAGE_WIDTH = 3000;
+const int IMAGE_HEIGHT = 2000;
+
+namespace {
+
+class KisBufferPaintDeviceWriter : public KisPaintDeviceWriter
+{
+public:
+    KisBufferPaintDeviceWriter(QByteArray *buffer)
+        : m_buffer(buffer)
+    {
+    }
+
+    bool write(const QByteArray &data) override {
+        m_buffer->append(data);
+        return true;
+    }
+
+    bool write(const char* data, qint64 length) override {
+        m_buffer->append(data, length);
+        return true;
+    }
+
+private:
+    QByteArray *m_buffer;
+};
+
+void fillWithStrokes(KisPaintDeviceSP dev, int seed)
+{
+    /**
+     * Fully random data is not compressible at all, so fill the
+     * device with a smooth gradient and a bit of noise, which is
+     * closer to what painted layers look like
+     */
+
+    QRandomGenerator random(seed);
+
+    KisSequentialIterator it(dev, QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT));
+    while (it.nextPixel()) {
+        quint8 *pixel = it.rawData();
+        pixel[0] = (it.x() + seed) & 0xff;
+        pixel[1] = (it.y() + random.bounded(8)) & 0xff;
+        pixel[2] = ((it.x() + it.y()) / 8) & 0xff;
+        pixel[3] = 0xff - random.bounded(8);
+    }
+}
+
+}
+
+void KisPaintDeviceStoreBenchmark::initTestCase()
+{
+    m_defaultThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    for (int i = 0; i < NUM_LAYERS; i++) {
+        KisPaintDeviceSP dev = new KisPaintDevice(cs);
+        fillWithStrokes(dev, i);
+        m_layers << dev;
+
+        QByteArray buffer;
+        KisBufferPaintDeviceWriter writer(&buffer);
+        QVERIFY(dev->write(writer));
+        m_savedLayers << buffer;
+    }
+}
+
+void KisPaintDeviceStoreBenchmark::cleanupTestCase()
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(m_defaultThreadCount);
+}
+
+void KisPaintDeviceStoreBenchmark::benchmarkWriteImpl(int numThreads)
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(numThreads);
+
+    QBENCHMARK {
+        Q_FOREACH (KisPaintDeviceSP dev, m_layers) {
+            QByteArray buffer;
+            KisBufferPaintDeviceWriter writer(&buffer);
+            dev->write(writer);
+        }
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(m_defaultThreadCount);
+}
+
+void KisPaintDeviceStoreBenchmark::benchmarkReadImpl(int numThreads)
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(numThreads);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QBENCHMARK {
+        for (int i = 0; i < m_savedLayers.size(); i++) {
+            QBuffer buffer(&m_savedLayers[i]);
+            buffer.open(QIODevice::ReadOnly);
+
+            KisPaintDeviceSP dev = new KisPaintDevice(cs);
+            dev->read(&buffer);
+        }
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(m_defaultThreadCount);
+}
+
+void KisPaintDeviceStoreBenchmark::benchmarkWriteSingleThread()
+{
+    benchmarkWriteImpl(1);
+}
+
+void KisPaintDeviceStoreBenchmark::benchmarkWriteMultiThread()
+{
+    benchmarkWriteImpl(m_defaultThreadCount);
+}
+
+void KisPaintDeviceStoreBenchmark::benchmarkReadSingleThread()
+{
+    benchmarkReadImpl(1);
+}
+
+void KisPaintDeviceStoreBenchmark::benchmarkReadMultiThread()
+{
+    benchmarkReadImpl(m_defaultThreadCount);
+}
+
+SIMPLE_TEST_MAIN(KisPaintDeviceStoreBenchmark)
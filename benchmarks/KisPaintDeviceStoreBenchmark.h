@@ -0,0 +1,42 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPAINTDEVICESTOREBENCHMARK_H
+#define KISPAINTDEVICESTOREBENCHMARK_H
+
+#include <simpletest.h>
+#include "kis_types.h"
+
+/**
+ * Measures saving and loading of the pixel data of a multi-layer
+ * document, the way KisKraSaveVisitor and KisKraLoadVisitor do it:
+ * the layers are processed one by one, the tiles of every layer are
+ * (de)compressed by the worker threads.
+ */
+class KisPaintDeviceStoreBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    void benchmarkWriteImpl(int numThreads);
+    void benchmarkReadImpl(int numThreads);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkWriteSingleThread();
+    void benchmarkWriteMultiThread();
+    void benchmarkReadSingleThread();
+    void benchmarkReadMultiThread();
+
+private:
+    QVector<KisPaintDeviceSP> m_layers;
+    QVector<QByteArray> m_savedLayers;
+    int m_defaultThreadCount = 1;
+};
+
+#endif /* KISPAINTDEVICESTOREBENCHMARK_H */
@@ -25,6 +25,9 @@
 #include "kis_selection.h"
 #include <kis_iterator_ng.h>
 #include <KisGlobalResourcesInterface.h>
+#include <kis_convolution_painter.h>
+#include <kis_convolution_kernel.h>
+#include <kis_gaussian_kernel.h>
 
 void KisBlurBenchmark::initTestCase()
 {
@@ -76,6 +79,63 @@ void KisBlurBenchmark::benchmarkFilter()
     }
 }
 
+void KisBlurBenchmark::benchmarkSeparableKernel()
+{
+    KisConvolutionKernelSP kernel = KisGaussianKernel::createUniform2DKernel(5.0, 5.0);
+
+    KisPaintDeviceSP dst = new KisPaintDevice(m_colorSpace);
+    KisConvolutionPainter gc(dst, KisConvolutionPainter::SPATIAL);
 
+    QBENCHMARK{
+        gc.applyMatrix(kernel, m_device, QPoint(), QPoint(),
+                       QSize(GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT), BORDER_IGNORE);
+    }
+}
+
+void KisBlurBenchmark::benchmarkNonSeparableKernel()
+{
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> sharpen(3, 3);
+    sharpen << 0, -1, 0,
+              -1, 5, -1,
+               0, -1, 0;
+
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(sharpen, 0, 1);
+
+    KisPaintDeviceSP dst = new KisPaintDevice(m_colorSpace);
+    KisConvolutionPainter gc(dst, KisConvolutionPainter::SPATIAL);
+
+    QBENCHMARK{
+        gc.applyMatrix(kernel, m_device, QPoint(), QPoint(),
+                       QSize(GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT), BORDER_IGNORE);
+    }
+}
+
+void KisBlurBenchmark::benchmarkLensBlurCircle()
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("lens blur");
+    KisFilterConfigurationSP kfc = filter->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    kfc->setProperty("irisShape", "Circle");
+    kfc->setProperty("irisRadius", 30);
+    kfc->setProperty("halfWidth", 30);
+    kfc->setProperty("halfHeight", 30);
+
+    QBENCHMARK{
+        filter->process(m_device, QRect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT), kfc);
+    }
+}
+
+void KisBlurBenchmark::benchmarkLensBlurPolygon()
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("lens blur");
+    KisFilterConfigurationSP kfc = filter->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    kfc->setProperty("irisShape", "Hexagon (6)");
+    kfc->setProperty("irisRadius", 30);
+    kfc->setProperty("halfWidth", 30);
+    kfc->setProperty("halfHeight", 30);
+
+    QBENCHMARK{
+        filter->process(m_device, QRect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT), kfc);
+    }
+}
 
 SIMPLE_TEST_MAIN(KisBlurBenchmark)
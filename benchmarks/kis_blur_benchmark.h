@@ -27,6 +27,10 @@ private Q_SLOTS:
     void cleanupTestCase();
     
     void benchmarkFilter();
+    void benchmarkSeparableKernel();
+    void benchmarkNonSeparableKernel();
+    void benchmarkLensBlurCircle();
+    void benchmarkLensBlurPolygon();
     
 };
 
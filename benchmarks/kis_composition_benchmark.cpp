@@ -28,6 +28,8 @@
 #include <KoCompositeOpAlphaDarken.h>
 #include <KoCompositeOpOver.h>
 #include <KoCompositeOpCopy2.h>
+#include <KoCompositeOpGeneric.h>
+#include <KoColorSpaceBlendingPolicy.h>
 #include <KoOptimizedCompositeOpFactory.h>
 #include <KoAlphaDarkenParamsWrapper.h>
 
@@ -316,6 +318,30 @@ struct PixelEqualPremultiplied
     }
 };
 
+/**
+ * Some blend modes (e.g. color dodge) may produce values way outside
+ * the unit range for floating point channels, so the error should be
+ * measured relative to the value itself.
+ */
+template<typename channel_type>
+struct PixelEqualPremultipliedRelative
+{
+    bool operator() (channel_type c1, channel_type a1,
+                     channel_type c2, channel_type a2,
+                     channel_type prec) {
+
+        c1 = KoColorSpaceMaths<channel_type>::multiply(c1, a1);
+        c2 = KoColorSpaceMaths<channel_type>::multiply(c2, a2);
+
+        if constexpr (std::numeric_limits<channel_type>::is_integer) {
+            return fuzzyCompare(c1, c2, prec);
+        } else {
+            const channel_type scale = qMax(channel_type(1), qMax(qAbs(c1), qAbs(c2)));
+            return qAbs(c1 - c2) <= prec * scale;
+        }
+    }
+};
+
 template <typename channel_type, template<typename> class Compare = PixelEqualDirect>
 inline bool comparePixels(channel_type *p1, channel_type *p2, channel_type prec) {
     Compare<channel_type> comp;
@@ -407,6 +433,59 @@ bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp
     return compareResult;
 }
 
+typedef KoCompositeOp* (*GenericOpFactory)(const KoColorSpace *, const QString &, const QString &);
+
+template<class Traits,
+         typename Traits::channels_type compositeFunc(typename Traits::channels_type, typename Traits::channels_type),
+         template<typename> class Compare>
+bool compareGenericOp(const KoColorSpace *cs, const QString &id, GenericOpFactory factory)
+{
+    QScopedPointer<KoCompositeOp> opAct(factory(cs, id, QString()));
+    QScopedPointer<KoCompositeOp> opExp(
+        new KoCompositeOpGenericSC<Traits, compositeFunc, KoAdditiveBlendingPolicy<Traits>>(cs, id, QString()));
+
+    if (!opAct) {
+        qWarning() << "No optimized implementation for" << id;
+        return false;
+    }
+
+    const bool result =
+        compareTwoOps<Compare>(true, opAct.data(), opExp.data()) &&
+        compareTwoOps<Compare>(false, opAct.data(), opExp.data());
+
+    if (!result) {
+        qWarning() << "Optimized op differs from the generic one:" << id;
+    }
+
+    return result;
+}
+
+template<class Traits, template<typename> class Compare>
+bool compareAllGenericOps(const KoColorSpace *cs, GenericOpFactory factory)
+{
+    typedef typename Traits::channels_type Arg;
+
+    bool result = true;
+
+    result &= compareGenericOp<Traits, &cfMultiply<Arg>, Compare>(cs, COMPOSITE_MULT, factory);
+    result &= compareGenericOp<Traits, &cfScreen<Arg>, Compare>(cs, COMPOSITE_SCREEN, factory);
+    result &= compareGenericOp<Traits, &cfOverlay<Arg>, Compare>(cs, COMPOSITE_OVERLAY, factory);
+    result &= compareGenericOp<Traits, &cfHardLight<Arg>, Compare>(cs, COMPOSITE_HARD_LIGHT, factory);
+    result &= compareGenericOp<Traits, &cfSoftLight<Arg>, Compare>(cs, COMPOSITE_SOFT_LIGHT_PHOTOSHOP, factory);
+    result &= compareGenericOp<Traits, &cfColorDodge<Arg>, Compare>(cs, COMPOSITE_DODGE, factory);
+    result &= compareGenericOp<Traits, &cfColorBurn<Arg>, Compare>(cs, COMPOSITE_BURN, factory);
+    result &= compareGenericOp<Traits, &cfHardMix<Arg>, Compare>(cs, COMPOSITE_HARD_MIX, factory);
+    result &= compareGenericOp<Traits, &cfDarkenOnly<Arg>, Compare>(cs, COMPOSITE_DARKEN, factory);
+    result &= compareGenericOp<Traits, &cfLightenOnly<Arg>, Compare>(cs, COMPOSITE_LIGHTEN, factory);
+    result &= compareGenericOp<Traits, &cfAddition<Arg>, Compare>(cs, COMPOSITE_ADD, factory);
+    result &= compareGenericOp<Traits, &cfSubtract<Arg>, Compare>(cs, COMPOSITE_SUBTRACT, factory);
+    result &= compareGenericOp<Traits, &cfDifference<Arg>, Compare>(cs, COMPOSITE_DIFF, factory);
+    result &= compareGenericOp<Traits, &cfLinearBurn<Arg>, Compare>(cs, COMPOSITE_LINEAR_BURN, factory);
+    result &= compareGenericOp<Traits, &cfExclusion<Arg>, Compare>(cs, COMPOSITE_EXCLUSION, factory);
+
+    return result;
+}
+
 QString getTestName(bool haveMask,
                     const int srcAlignmentShift,
                     const int dstAlignmentShift,
@@ -885,6 +964,27 @@ void KisCompositionBenchmark::compareRgbF32CopyOps()
     delete opAct;
 }
 
+void KisCompositionBenchmark::compareRgbU8GenericOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    // The generic ops are implemented in integer arithmetic and divide
+    // by the resulting alpha, so compare them in premultiplied form
+    QVERIFY((compareAllGenericOps<KoBgrU8Traits, PixelEqualPremultiplied>(cs, &KoOptimizedCompositeOpFactory::createGenericOp32)));
+}
+
+void KisCompositionBenchmark::compareRgbU16GenericOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    QVERIFY((compareAllGenericOps<KoBgrU16Traits, PixelEqualPremultiplied>(cs, &KoOptimizedCompositeOpFactory::createGenericOpU64)));
+}
+
+void KisCompositionBenchmark::compareRgbF32GenericOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    QVERIFY((compareAllGenericOps<KoRgbF32Traits, PixelEqualPremultipliedRelative>(cs, &KoOptimizedCompositeOpFactory::createGenericOp128)));
+}
+
 void KisCompositionBenchmark::testRgb8CompositeAlphaDarkenLegacy()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -1043,6 +1143,108 @@ void KisCompositionBenchmark::testRgb8CompositeCopyOptimized()
     delete op;
 }
 
+void KisCompositionBenchmark::testRgb8CompositeMultiplyLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KoCompositeOp *op = new KoCompositeOpGenericSC<KoBgrU8Traits, &cfMultiply<quint8>, KoAdditiveBlendingPolicy<KoBgrU8Traits>>(cs, COMPOSITE_MULT, QString());
+    benchmarkCompositeOp(op, "Multiply Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb8CompositeMultiplyOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericOp32(cs, COMPOSITE_MULT, QString());
+    QVERIFY(op);
+    benchmarkCompositeOp(op, "Multiply Optimized");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb8CompositeOverlayLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KoCompositeOp *op = new KoCompositeOpGenericSC<KoBgrU8Traits, &cfOverlay<quint8>, KoAdditiveBlendingPolicy<KoBgrU8Traits>>(cs, COMPOSITE_OVERLAY, QString());
+    benchmarkCompositeOp(op, "Overlay Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb8CompositeOverlayOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericOp32(cs, COMPOSITE_OVERLAY, QString());
+    QVERIFY(op);
+    benchmarkCompositeOp(op, "Overlay Optimized");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb16CompositeMultiplyLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *op = new KoCompositeOpGenericSC<KoBgrU16Traits, &cfMultiply<quint16>, KoAdditiveBlendingPolicy<KoBgrU16Traits>>(cs, COMPOSITE_MULT, QString());
+    benchmarkCompositeOp(op, "Multiply Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb16CompositeMultiplyOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericOpU64(cs, COMPOSITE_MULT, QString());
+    QVERIFY(op);
+    benchmarkCompositeOp(op, "Multiply Optimized");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb16CompositeOverlayLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *op = new KoCompositeOpGenericSC<KoBgrU16Traits, &cfOverlay<quint16>, KoAdditiveBlendingPolicy<KoBgrU16Traits>>(cs, COMPOSITE_OVERLAY, QString());
+    benchmarkCompositeOp(op, "Overlay Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgb16CompositeOverlayOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericOpU64(cs, COMPOSITE_OVERLAY, QString());
+    QVERIFY(op);
+    benchmarkCompositeOp(op, "Overlay Optimized");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgbF32CompositeMultiplyLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    KoCompositeOp *op = new KoCompositeOpGenericSC<KoRgbF32Traits, &cfMultiply<float>, KoAdditiveBlendingPolicy<KoRgbF32Traits>>(cs, COMPOSITE_MULT, QString());
+    benchmarkCompositeOp(op, "RGBF32 Multiply Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgbF32CompositeMultiplyOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericOp128(cs, COMPOSITE_MULT, QString());
+    QVERIFY(op);
+    benchmarkCompositeOp(op, "RGBF32 Multiply Optimized");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgbF32CompositeOverlayLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    KoCompositeOp *op = new KoCompositeOpGenericSC<KoRgbF32Traits, &cfOverlay<float>, KoAdditiveBlendingPolicy<KoRgbF32Traits>>(cs, COMPOSITE_OVERLAY, QString());
+    benchmarkCompositeOp(op, "RGBF32 Overlay Legacy");
+    delete op;
+}
+
+void KisCompositionBenchmark::testRgbF32CompositeOverlayOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericOp128(cs, COMPOSITE_OVERLAY, QString());
+    QVERIFY(op);
+    benchmarkCompositeOp(op, "RGBF32 Overlay Optimized");
+    delete op;
+}
+
 void KisCompositionBenchmark::benchmarkMemcpy()
 {
     QVector<Tile> tiles =
@@ -47,6 +47,10 @@ private Q_SLOTS:
     void compareRgbU16CopyOps();
     void compareRgbF32CopyOps();
 
+    void compareRgbU8GenericOps();
+    void compareRgbU16GenericOps();
+    void compareRgbF32GenericOps();
+
     void testRgb8CompositeAlphaDarkenLegacy();
     void testRgb8CompositeAlphaDarkenOptimized();
 
@@ -77,6 +81,21 @@ private Q_SLOTS:
     void testRgb8CompositeCopyLegacy();
     void testRgb8CompositeCopyOptimized();
 
+    void testRgb8CompositeMultiplyLegacy();
+    void testRgb8CompositeMultiplyOptimized();
+    void testRgb8CompositeOverlayLegacy();
+    void testRgb8CompositeOverlayOptimized();
+
+    void testRgb16CompositeMultiplyLegacy();
+    void testRgb16CompositeMultiplyOptimized();
+    void testRgb16CompositeOverlayLegacy();
+    void testRgb16CompositeOverlayOptimized();
+
+    void testRgbF32CompositeMultiplyLegacy();
+    void testRgbF32CompositeMultiplyOptimized();
+    void testRgbF32CompositeOverlayLegacy();
+    void testRgbF32CompositeOverlayOptimized();
+
     void benchmarkMemcpy();
 
     void benchmarkUintFloat();
@@ -14,6 +14,7 @@
 #include <KoColor.h>
 
 #include <simpletest.h>
+#include <QtConcurrent>
 
 #include "kis_iterator_ng.h"
 
@@ -178,5 +179,28 @@ void KisHLineIteratorBenchmark::benchmarkTwoIteratorsNoMemCpy(){
 }
 
 
+void KisHLineIteratorBenchmark::benchmarkConcurrentConstNoMemCpy()
+{
+    const int numStripes = 4 * qMax(1, QThread::idealThreadCount());
+    const int stripeHeight = qMax(1, TEST_IMAGE_HEIGHT / numStripes);
+
+    QVector<QRect> stripes;
+    for (int y = 0; y < TEST_IMAGE_HEIGHT; y += stripeHeight) {
+        stripes << QRect(0, y, TEST_IMAGE_WIDTH, qMin(stripeHeight, TEST_IMAGE_HEIGHT - y));
+    }
+
+    QBENCHMARK{
+        QtConcurrent::blockingMap(stripes,
+            [this] (const QRect &rc) {
+                KisHLineConstIteratorSP cit = m_device->createHLineConstIteratorNG(rc.x(), rc.y(), rc.width());
+
+                for (int j = 0; j < rc.height(); j++) {
+                    do {} while (cit->nextPixel());
+                    cit->nextRow();
+                }
+            });
+    }
+}
+
 
 SIMPLE_TEST_MAIN(KisHLineIteratorBenchmark)
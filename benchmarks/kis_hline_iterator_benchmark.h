@@ -44,6 +44,8 @@ private Q_SLOTS:
     void benchmarkConstNoMemCpy();
     // copy from one device to another
     void benchmarkTwoIteratorsNoMemCpy();
+    // several threads sweeping stripes of the same device
+    void benchmarkConcurrentConstNoMemCpy();
     
 
     
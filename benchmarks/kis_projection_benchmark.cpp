@@ -8,6 +8,8 @@
 #include "kis_projection_benchmark.h"
 #include "kis_benchmark_values.h"
 
+#include <QThread>
+
 #include <KoColor.h>
 
 #include <kis_group_layer.h>
@@ -37,6 +39,37 @@ void KisProjectionBenchmark::benchmarkProjection()
     }
 }
 
+void KisProjectionBenchmark::benchmarkRefreshScaling_data()
+{
+    QTest::addColumn<int>("threads");
+
+    const int idealThreadCount = qMax(1, QThread::idealThreadCount());
+
+    for (int threads = 1; threads < idealThreadCount; threads *= 2) {
+        QTest::addRow("%d threads", threads) << threads;
+    }
+
+    QTest::addRow("%d threads", idealThreadCount) << idealThreadCount;
+}
+
+void KisProjectionBenchmark::benchmarkRefreshScaling()
+{
+    QFETCH(int, threads);
+
+    KisDocument *doc = KisPart::instance()->createDocument();
+    doc->loadNativeFormat(QString(FILES_DATA_DIR) + '/' + "load_test.kra");
+
+    KisImageSP image = doc->image();
+    image->setWorkingThreadsLimit(threads);
+
+    QBENCHMARK {
+        image->refreshGraphAsync();
+        image->waitForDone();
+    }
+
+    delete doc;
+}
+
 void KisProjectionBenchmark::benchmarkLoading()
 {
     QBENCHMARK{
@@ -19,6 +19,11 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void benchmarkProjection();
+
+    /// measures the full refresh of the image with different
+    /// number of threads, i.e. the scaling curve of the updater
+    void benchmarkRefreshScaling_data();
+    void benchmarkRefreshScaling();
     void benchmarkLoading();
 };
 
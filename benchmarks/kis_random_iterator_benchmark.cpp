@@ -14,6 +14,7 @@
 #include <KoColor.h>
 
 #include <simpletest.h>
+#include <QtConcurrent>
 #include <kis_random_accessor_ng.h>
 
 
@@ -222,5 +223,31 @@ void KisRandomIteratorBenchmark::benchmarkTwoIteratorsNoMemCpy()
     }
 }
 
+void KisRandomIteratorBenchmark::benchmarkConcurrentConstColumnWalk()
+{
+    const int numStripes = 4 * qMax(1, QThread::idealThreadCount());
+    const int stripeWidth = qMax(1, TEST_IMAGE_WIDTH / numStripes);
+
+    QVector<QRect> stripes;
+    for (int x = 0; x < TEST_IMAGE_WIDTH; x += stripeWidth) {
+        stripes << QRect(x, 0, qMin(stripeWidth, TEST_IMAGE_WIDTH - x), TEST_IMAGE_HEIGHT);
+    }
+
+    QBENCHMARK{
+        QtConcurrent::blockingMap(stripes,
+            [this] (const QRect &rc) {
+                KisRandomConstAccessorSP it = m_device->createRandomConstAccessorNG();
+
+                // walking the columns makes the accessor
+                // cross a tile border every 64 pixels
+                for (int i = rc.left(); i <= rc.right(); i++) {
+                    for (int j = rc.top(); j <= rc.bottom(); j++) {
+                        it->moveTo(i, j);
+                    }
+                }
+            });
+    }
+}
+
 
 SIMPLE_TEST_MAIN(KisRandomIteratorBenchmark)
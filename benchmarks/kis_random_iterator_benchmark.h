@@ -46,6 +46,8 @@ private Q_SLOTS:
     void benchmarkNoMemCpy();
     void benchmarkConstNoMemCpy();
     void benchmarkTwoIteratorsNoMemCpy();
+    // several threads walking stripes of the same device, crossing tiles often
+    void benchmarkConcurrentConstColumnWalk();
 };
 
 #endif
@@ -623,7 +623,7 @@ void KoShape::updateAbsolute(const QRectF &rect) const
 
     if (!d->shapeManagers.empty() && isVisible()) {
         Q_FOREACH (KoShapeManager *manager, d->shapeManagers) {
-            manager->update(rect);
+            manager->update(rect, this);
         }
     }
 }
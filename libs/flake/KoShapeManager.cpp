@@ -37,6 +37,7 @@
 #include <QPainterPath>
 #include <QTimer>
 #include <QThread>
+#include <QtMath>
 #include <FlakeDebug.h>
 
 #include "kis_painting_tweaks.h"
@@ -175,78 +176,197 @@ void buildRenderTree(QList<KoShape*> leafShapes,
     }
 }
 
-/**
- * Render the prebuilt rendering tree on \p painter
- */
 void renderShapes(typename KisForest<KoShape*>::child_iterator beginIt,
                   typename KisForest<KoShape*>::child_iterator endIt,
-                  QPainter &painter)
+                  QPainter &painter,
+                  const KoShapeManager::PaintJob::RasterCacheIds *rasterCacheIds = nullptr);
+
+/**
+ * Render the shape pointed by \p it and all its children on \p painter
+ */
+void renderShapeSubtree(typename KisForest<KoShape*>::child_iterator it,
+                        QPainter &painter)
 {
-    for (auto it = beginIt; it != endIt; ++it) {
-        KoShape *shape = *it;
+    KoShape *shape = *it;
+
+    KisQPainterStateSaver saver(&painter);
 
+    if (!isEnd(parent(it))) {
+        painter.setTransform(shape->transformation() * painter.transform());
+    } else {
+        painter.setTransform(shape->absoluteTransformation() * painter.transform());
+    }
+
+    KoClipPath::applyClipping(shape, painter);
+
+    qreal transparency = shape->transparency(true);
+    if (transparency > 0.0) {
+        painter.setOpacity(1.0-transparency);
+    }
+
+    if (shape->shadow()) {
         KisQPainterStateSaver saver(&painter);
+        shape->shadow()->paint(shape, painter);
+    }
 
-        if (!isEnd(parent(it))) {
-            painter.setTransform(shape->transformation() * painter.transform());
-        } else {
-            painter.setTransform(shape->absoluteTransformation() * painter.transform());
-        }
+    QScopedPointer<KoClipMaskPainter> clipMaskPainter;
+    QPainter *shapePainter = &painter;
 
-        KoClipPath::applyClipping(shape, painter);
+    KoClipMask *clipMask = shape->clipMask();
+    if (clipMask) {
+        const QRectF bounds = painter.transform().mapRect(shape->outlineRect());
 
-        qreal transparency = shape->transparency(true);
-        if (transparency > 0.0) {
-            painter.setOpacity(1.0-transparency);
-        }
+        clipMaskPainter.reset(new KoClipMaskPainter(&painter, bounds/*shape->boundingRect())*/));
+        shapePainter = clipMaskPainter->shapePainter();
+    }
+
+    /**
+     * We expect the shape to save/restore the painter's state itself. Such design was not
+     * not always here, so we need a period of sanity checks to ensure all the shapes are
+     * ported correctly.
+     */
+    const QTransform sanityCheckTransformSaved = shapePainter->transform();
 
-        if (shape->shadow()) {
-            KisQPainterStateSaver saver(&painter);
-            shape->shadow()->paint(shape, painter);
+    renderShapes(childBegin(it), childEnd(it), *shapePainter);
+
+    Q_FOREACH(const KoShape::PaintOrder p, shape->paintOrder()) {
+        if (p == KoShape::Fill) {
+            shape->paint(*shapePainter);
+        } else if (p == KoShape::Stroke) {
+            shape->paintStroke(*shapePainter);
+        } else if (p == KoShape::Markers)  {
+            shape->paintMarkers(*shapePainter);
         }
+    }
+
+    KIS_SAFE_ASSERT_RECOVER(shapePainter->transform() == sanityCheckTransformSaved) {
+        shapePainter->setTransform(sanityCheckTransformSaved);
+    }
 
-        QScopedPointer<KoClipMaskPainter> clipMaskPainter;
-        QPainter *shapePainter = &painter;
+    if (clipMask) {
+        clipMaskPainter->maskPainter()->save();
 
-        KoClipMask *clipMask = shape->clipMask();
-        if (clipMask) {
-            const QRectF bounds = painter.transform().mapRect(shape->outlineRect());
+        shape->clipMask()->drawMask(clipMaskPainter->maskPainter(), shape);
+        clipMaskPainter->renderOnGlobalPainter();
 
-            clipMaskPainter.reset(new KoClipMaskPainter(&painter, bounds/*shape->boundingRect())*/));
-            shapePainter = clipMaskPainter->shapePainter();
-        }
+        clipMaskPainter->maskPainter()->restore();
+    }
+}
+
+/**
+ * Render the top-level shape pointed by \p it and all its children on
+ * \p painter using the image stored in KoShapeRasterCache. If the cache
+ * has no valid image for the shape, the subtree is rendered into a new
+ * image, which is stored into the cache.
+ *
+ * The images are rendered with the painter's transform with the integer
+ * part of the translation removed, so that the patches of the same canvas
+ * could share the same image and just blit it with an integer offset.
+ *
+ * \return false if the shape cannot be cached and should be rendered directly
+ */
+bool renderCachedShapeSubtree(typename KisForest<KoShape*>::child_iterator it,
+                              QPainter &painter,
+                              const KoShapeManager::PaintJob::RasterCacheIds &rasterCacheIds)
+{
+    KoShape *shape = *it;
+
+    auto idIt = rasterCacheIds.constFind(shape);
+    if (idIt == rasterCacheIds.constEnd()) return false;
+
+    const QTransform painterTransform = painter.transform();
+    const QPoint integerOffset(qFloor(painterTransform.dx()), qFloor(painterTransform.dy()));
+    const QTransform normalizedTransform =
+        painterTransform * QTransform::fromTranslate(-integerOffset.x(), -integerOffset.y());
+
+    /**
+     * The absolute transformation of the top-level shape is baked into the
+     * key, because the shallow copies of the shapes may have the transformation
+     * of their (non-copied) parent applied
+     */
+    const QTransform cacheTransform = shape->absoluteTransformation() * normalizedTransform;
+    const QPainter::RenderHints hints = painter.renderHints();
+
+    KoShapeRasterCache *cache = KoShapeRasterCache::instance();
+
+    QImage image;
+    QPoint offset;
 
+    if (!cache->fetchOrBeginRender(*idIt, cacheTransform, hints, &image, &offset)) {
         /**
-         * We expect the shape to save/restore the painter's state itself. Such design was not
-         * not always here, so we need a period of sanity checks to ensure all the shapes are
-         * ported correctly.
+         * The rendering tree of the job contains only the children that
+         * intersect the job's rect, but the cached image is shared by all
+         * the jobs, so it should be rendered from the full subtree
          */
-        const QTransform sanityCheckTransformSaved = shapePainter->transform();
+        KisForest<KoShape*> fullTree;
+        auto fullIt = fullTree.insert(childEnd(fullTree), shape);
 
-        renderShapes(childBegin(it), childEnd(it), *shapePainter);
+        auto shouldIncludeShape =
+            [] (KoShape *child) {
+                return shapeIsVisible(child) &&
+                    (shapeUsedInRenderingTree(child) || shapeHasGroupEffects(child));
+            };
 
-        Q_FOREACH(const KoShape::PaintOrder p, shape->paintOrder()) {
-            if (p == KoShape::Fill) {
-                shape->paint(*shapePainter);
-            } else if (p == KoShape::Stroke) {
-                shape->paintStroke(*shapePainter);
-            } else if (p == KoShape::Markers)  {
-                shape->paintMarkers(*shapePainter);
-            }
+        populateRenderSubtree(shape, fullIt, fullTree, shouldIncludeShape, &shapeIsVisible);
+
+        QRectF bounds;
+        for (auto subtreeIt = subtreeBegin(fullIt); subtreeIt != subtreeEnd(fullIt); ++subtreeIt) {
+            bounds |= (*subtreeIt)->boundingRect();
         }
 
-        KIS_SAFE_ASSERT_RECOVER(shapePainter->transform() == sanityCheckTransformSaved) {
-            shapePainter->setTransform(sanityCheckTransformSaved);
+        const QRect imageRect =
+            normalizedTransform.mapRect(bounds).toAlignedRect().adjusted(-1, -1, 1, 1);
+
+        if (bounds.isEmpty() ||
+            qint64(imageRect.width()) * imageRect.height() > KoShapeRasterCache::maxImagePixels) {
+
+            cache->cancelRender(*idIt, cacheTransform, hints);
+            return false;
         }
 
-        if (clipMask) {
-            clipMaskPainter->maskPainter()->save();
+        image = QImage(imageRect.size(), QImage::Format_ARGB32_Premultiplied);
+        image.fill(0);
 
-            shape->clipMask()->drawMask(clipMaskPainter->maskPainter(), shape);
-            clipMaskPainter->renderOnGlobalPainter();
+        {
+            QPainter imagePainter(&image);
+            imagePainter.setRenderHints(hints);
+            imagePainter.setPen(Qt::NoPen);
+            imagePainter.setBrush(Qt::NoBrush);
+            imagePainter.setTransform(normalizedTransform *
+                                      QTransform::fromTranslate(-imageRect.x(), -imageRect.y()));
 
-            clipMaskPainter->maskPainter()->restore();
+            renderShapeSubtree(fullIt, imagePainter);
         }
+
+        offset = imageRect.topLeft();
+        cache->insert(*idIt, cacheTransform, hints, image, offset);
+    }
+
+    KisQPainterStateSaver saver(&painter);
+    painter.setTransform(QTransform::fromTranslate(offset.x() + integerOffset.x(),
+                                                   offset.y() + integerOffset.y()));
+    painter.drawImage(QPoint(), image);
+
+    return true;
+}
+
+/**
+ * Render the prebuilt rendering tree on \p painter. If \p rasterCacheIds
+ * is not null, the top-level shapes are rendered via KoShapeRasterCache.
+ */
+void renderShapes(typename KisForest<KoShape*>::child_iterator beginIt,
+                  typename KisForest<KoShape*>::child_iterator endIt,
+                  QPainter &painter,
+                  const KoShapeManager::PaintJob::RasterCacheIds *rasterCacheIds)
+{
+    for (auto it = beginIt; it != endIt; ++it) {
+        if (rasterCacheIds && isEnd(parent(it)) &&
+            renderCachedShapeSubtree(it, painter, *rasterCacheIds)) {
+
+            continue;
+        }
+
+        renderShapeSubtree(it, painter);
     }
 }
 
@@ -285,6 +405,29 @@ void KoShapeManager::Private::updateTree()
     }
 }
 
+void KoShapeManager::Private::invalidateRasterCache(const KoShape *shape)
+{
+    /**
+     * The cache stores only the top-level shapes of the rendering tree,
+     * which may be any of the parents of the changed shape
+     */
+    QMutexLocker l(&rasterCacheMutex);
+
+    while (shape) {
+        shapeVersions[shape] = KoShapeRasterCache::nextVersion();
+        KoShapeRasterCache::instance()->remove(shape);
+        shape = shape->parent();
+    }
+}
+
+void KoShapeManager::Private::forgetRasterCache(const KoShape *shape)
+{
+    QMutexLocker l(&rasterCacheMutex);
+
+    shapeVersions.remove(shape);
+    KoShapeRasterCache::instance()->remove(shape);
+}
+
 void KoShapeManager::Private::forwardCompressedUpdate()
 {
     bool shouldUpdateDecorations = false;
@@ -374,6 +517,11 @@ void KoShapeManager::setShapes(const QList<KoShape *> &shapes, Repaint repaint)
         d->aggregate4update.clear();
         d->shapeIndexesBeforeUpdate.clear();
         d->tree.clear();
+
+        Q_FOREACH (KoShape *shape, d->shapes) {
+            d->forgetRasterCache(shape);
+        }
+
         d->shapes.clear();
     }
 
@@ -434,6 +582,11 @@ void KoShapeManager::remove(KoShape *shape)
         d->shapes.removeAll(shape);
     }
 
+    if (d->rasterCacheEnabled) {
+        d->invalidateRasterCache(shape->parent());
+        d->forgetRasterCache(shape);
+    }
+
     if (!dirtyRect.isEmpty()) {
         d->canvas->updateCanvas(dirtyRect);
     }
@@ -468,6 +621,8 @@ void KoShapeManager::ShapeInterface::notifyShapeDestructed(KoShape *shape)
     }
 
     q->d->shapes.removeAll(shape);
+
+    q->d->forgetRasterCache(shape);
 }
 
 
@@ -533,12 +688,39 @@ void KoShapeManager::preparePaintJobs(PaintJobsOrder &jobsOrder,
         clonedFromOriginal[originalShapes[i]] = clonedShapes[i];
     }
 
+    PaintJob::SharedRasterCacheIds rasterCacheIds;
+
+    if (d->rasterCacheEnabled) {
+        /**
+         * The versions are recorded at the moment of cloning, so the
+         * rendering threads will never store an image of an outdated
+         * shape with the new version
+         */
+        QMutexLocker l(&d->rasterCacheMutex);
+
+        auto ids = std::make_shared<PaintJob::RasterCacheIds>();
+        ids->reserve(originalShapes.size());
+
+        for (int i = 0; i < originalShapes.size(); i++) {
+            KoShape *shape = originalShapes[i];
+
+            auto versionIt = d->shapeVersions.find(shape);
+            if (versionIt == d->shapeVersions.end()) {
+                versionIt = d->shapeVersions.insert(shape, KoShapeRasterCache::nextVersion());
+            }
+
+            ids->insert(clonedShapes[i], {shape, versionIt.value()});
+        }
+
+        rasterCacheIds = ids;
+    }
 
     for (auto it = std::begin(jobsOrder.jobs); it != std::end(jobsOrder.jobs); ++it) {
         QMutexLocker l(&d->treeMutex);
         QList<KoShape*> unsortedOriginalShapes = d->tree.intersects(it->docUpdateRect);
 
         it->allClonedShapes = shapesStorage;
+        it->rasterCacheIds = rasterCacheIds;
 
         Q_FOREACH (KoShape *shape, unsortedOriginalShapes) {
             KIS_SAFE_ASSERT_RECOVER(shapeUsedInRenderingTree(shape)) { continue; }
@@ -555,7 +737,17 @@ void KoShapeManager::paintJob(QPainter &painter, const KoShapeManager::PaintJob
     KisForest<KoShape*> renderTree;
     buildRenderTree(job.shapes, renderTree);
 
-    renderShapes(childBegin(renderTree), childEnd(renderTree), painter);
+    renderShapes(childBegin(renderTree), childEnd(renderTree), painter, job.rasterCacheIds.get());
+}
+
+void KoShapeManager::setRasterCacheEnabled(bool value)
+{
+    d->rasterCacheEnabled = value;
+}
+
+bool KoShapeManager::rasterCacheEnabled() const
+{
+    return d->rasterCacheEnabled;
 }
 
 void KoShapeManager::paint(QPainter &painter)
@@ -706,6 +898,27 @@ void KoShapeManager::update(const QRectF &rect, const KoShape *shape, bool selec
         }
     }
 
+    if (d->rasterCacheEnabled) {
+        if (shape) {
+            d->invalidateRasterCache(shape);
+        } else {
+            /**
+             * Some of the shapes update themselves without telling who
+             * they are, so we invalidate everything under the rect
+             */
+            QList<KoShape*> shapes;
+
+            {
+                QMutexLocker l(&d->treeMutex);
+                shapes = d->tree.intersects(rect);
+            }
+
+            Q_FOREACH (KoShape *updatedShape, shapes) {
+                d->invalidateRasterCache(updatedShape);
+            }
+        }
+    }
+
     emit(forwardUpdate());
 }
 
@@ -720,6 +933,14 @@ bool KoShapeManager::updatesBlocked() const
 }
 void KoShapeManager::notifyShapeChanged(KoShape *shape)
 {
+    /**
+     * The shape may change several times before the tree is updated,
+     * so the cache should be invalidated on every notification
+     */
+    if (d->rasterCacheEnabled) {
+        d->invalidateRasterCache(shape);
+    }
+
     {
         QMutexLocker l(&d->treeMutex);
 
@@ -12,6 +12,7 @@
 #include <QList>
 #include <QObject>
 #include <QSet>
+#include <QHash>
 #include <QRect>
 
 #include "KoFlake.h"
@@ -20,6 +21,8 @@
 #include <memory>
 #include <vector>
 
+#include "KoShapeRasterCache.h"
+
 class KoShape;
 class KoSelection;
 class KoViewConverter;
@@ -103,6 +106,10 @@ public:
         using ShapesStorage = std::vector<std::unique_ptr<KoShape>>;
         using SharedSafeStorage = std::shared_ptr<ShapesStorage>;
 
+        /// maps the cloned shapes into the ids of their originals in KoShapeRasterCache
+        using RasterCacheIds = QHash<const KoShape*, KoShapeRasterCache::ShapeId>;
+        using SharedRasterCacheIds = std::shared_ptr<const RasterCacheIds>;
+
         PaintJob() = default;
         PaintJob(QRectF _docUpdateRect, QRect _viewUpdateRect)
             : docUpdateRect(_docUpdateRect),
@@ -119,6 +126,7 @@ public:
 
         QList<KoShape*> shapes;
         SharedSafeStorage allClonedShapes;
+        SharedRasterCacheIds rasterCacheIds;
     };
 
     struct PaintJobsOrder
@@ -173,6 +181,22 @@ public:
      */
     void paintJob(QPainter &painter, const KoShapeManager::PaintJob &job);
 
+    /**
+     * Enables caching of the rendered shapes in paintJob(). When enabled,
+     * every top-level shape of the rendering tree is rendered into a
+     * separate image stored in KoShapeRasterCache, so that the following
+     * jobs could just blit the shapes that have not been changed since then.
+     *
+     * The cache is invalidated by notifyShapeChanged() and update() calls.
+     * Disabled by default.
+     */
+    void setRasterCacheEnabled(bool value);
+
+    /**
+     * \see setRasterCacheEnabled()
+     */
+    bool rasterCacheEnabled() const;
+
     /**
      * Paint all shapes and their selection handles etc.
      * @param painter the painter to paint to.
@@ -208,6 +232,8 @@ public:
      * will be merged into an appropriate repaint action.
      * @param rect the rectangle (in pt) to queue for repaint.
      * @param shape the shape that is going to be redrawn; only needed when selectionHandles=true
+     *   or when the raster cache is enabled (otherwise all the shapes under the rect will be
+     *   re-rendered, see setRasterCacheEnabled())
      * @param selectionHandles if true; find out if the shape is selected and repaint its
      *   selection handles at the same time.
      */
@@ -67,6 +67,21 @@ public:
     QSet<const KoShape*> compressedUpdatedShapes;
 
     bool updatesBlocked = false;
+
+    /**
+     * Invalidate the cached images of \p shape and its parents
+     */
+    void invalidateRasterCache(const KoShape *shape);
+
+    /**
+     * Drop the cached images of \p shape, that is going to be
+     * removed from the manager
+     */
+    void forgetRasterCache(const KoShape *shape);
+
+    bool rasterCacheEnabled = false;
+    QMutex rasterCacheMutex;
+    QHash<const KoShape*, quint64> shapeVersions;
 };
 
 #endif
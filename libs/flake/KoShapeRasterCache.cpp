@@ -0,0 +1,200 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoShapeRasterCache.h"
+
+#include <atomic>
+
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QGlobalStatic>
+
+Q_GLOBAL_STATIC(KoShapeRasterCache, s_instance)
+
+namespace {
+
+/**
+ * QCache counts the costs in ints, so we measure
+ * the images in kibibytes
+ */
+int imageCost(const QImage &image)
+{
+    return qMax(1, int(image.sizeInBytes() / 1024));
+}
+
+}
+
+const int KoShapeRasterCache::maxImagePixels = 2048 * 2048;
+
+struct KoShapeRasterCache::Private
+{
+    struct Entry {
+        quint64 version = 0;
+        QTransform transform;
+        QPainter::RenderHints hints;
+        QImage image;
+        QPoint offset;
+    };
+
+    struct RenderKey {
+        quint64 version = 0;
+        QTransform transform;
+        QPainter::RenderHints hints;
+
+        bool operator==(const RenderKey &rhs) const {
+            return version == rhs.version && transform == rhs.transform && hints == rhs.hints;
+        }
+    };
+
+    mutable QMutex mutex;
+    QCache<const KoShape*, Entry> cache {128 * 1024};
+
+    /// the images being rendered by some thread right now
+    QHash<const KoShape*, RenderKey> renderingImages;
+    QWaitCondition renderingFinished;
+
+    bool fetchImpl(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints,
+                   QImage *image, QPoint *offset) const;
+    void endRenderImpl(const ShapeId &id, const RenderKey &key);
+
+    static std::atomic<quint64> lastVersion;
+};
+
+std::atomic<quint64> KoShapeRasterCache::Private::lastVersion {0};
+
+KoShapeRasterCache::KoShapeRasterCache()
+    : m_d(new Private)
+{
+}
+
+KoShapeRasterCache::~KoShapeRasterCache()
+{
+}
+
+KoShapeRasterCache *KoShapeRasterCache::instance()
+{
+    return s_instance;
+}
+
+quint64 KoShapeRasterCache::nextVersion()
+{
+    return ++Private::lastVersion;
+}
+
+bool KoShapeRasterCache::Private::fetchImpl(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints,
+                                            QImage *image, QPoint *offset) const
+{
+    const Entry *entry = cache.object(id.shape);
+
+    if (!entry ||
+        entry->version != id.version ||
+        entry->transform != transform ||
+        entry->hints != hints) {
+
+        return false;
+    }
+
+    *image = entry->image;
+    *offset = entry->offset;
+
+    return true;
+}
+
+void KoShapeRasterCache::Private::endRenderImpl(const ShapeId &id, const RenderKey &key)
+{
+    auto it = renderingImages.find(id.shape);
+    if (it != renderingImages.end() && *it == key) {
+        renderingImages.erase(it);
+        renderingFinished.wakeAll();
+    }
+}
+
+bool KoShapeRasterCache::fetch(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints,
+                               QImage *image, QPoint *offset) const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->fetchImpl(id, transform, hints, image, offset);
+}
+
+bool KoShapeRasterCache::fetchOrBeginRender(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints,
+                                            QImage *image, QPoint *offset)
+{
+    const Private::RenderKey key {id.version, transform, hints};
+
+    QMutexLocker l(&m_d->mutex);
+
+    forever {
+        if (m_d->fetchImpl(id, transform, hints, image, offset)) {
+            return true;
+        }
+
+        auto it = m_d->renderingImages.constFind(id.shape);
+        if (it == m_d->renderingImages.constEnd()) {
+            m_d->renderingImages.insert(id.shape, key);
+            return false;
+        }
+
+        /**
+         * Another version or transform of the shape is being rendered,
+         * it won't be useful for us, so just render our own one
+         */
+        if (!(*it == key)) {
+            return false;
+        }
+
+        m_d->renderingFinished.wait(&m_d->mutex);
+    }
+}
+
+void KoShapeRasterCache::cancelRender(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->endRenderImpl(id, {id.version, transform, hints});
+}
+
+void KoShapeRasterCache::insert(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints,
+                                const QImage &image, const QPoint &offset)
+{
+    QScopedPointer<Private::Entry> entry(new Private::Entry());
+    entry->version = id.version;
+    entry->transform = transform;
+    entry->hints = hints;
+    entry->image = image;
+    entry->offset = offset;
+
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->endRenderImpl(id, {id.version, transform, hints});
+
+    /**
+     * Several threads might have rendered the same shape concurrently,
+     * don't let an older version override the newer one
+     */
+    const Private::Entry *existingEntry = m_d->cache.object(id.shape);
+    if (existingEntry && existingEntry->version > id.version) return;
+
+    m_d->cache.insert(id.shape, entry.take(), imageCost(image));
+}
+
+void KoShapeRasterCache::remove(const KoShape *shape)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->cache.remove(shape);
+}
+
+void KoShapeRasterCache::setMemoryLimit(qint64 bytes)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->cache.setMaxCost(int(qBound(qint64(0), bytes / 1024, qint64(std::numeric_limits<int>::max()))));
+}
+
+qint64 KoShapeRasterCache::memoryLimit() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return qint64(m_d->cache.maxCost()) * 1024;
+}
@@ -0,0 +1,111 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KOSHAPERASTERCACHE_H
+#define KOSHAPERASTERCACHE_H
+
+#include "kritaflake_export.h"
+
+#include <QScopedPointer>
+#include <QPainter>
+#include <QTransform>
+#include <QImage>
+
+class KoShape;
+
+/**
+ * A global, memory-bounded cache of rendered shapes. KoShapeManager uses
+ * it (when enabled with KoShapeManager::setRasterCacheEnabled()) to avoid
+ * re-rendering the shapes that didn't change since the last update.
+ *
+ * Every cached image is identified by the original shape and its version.
+ * The version is changed by the shape manager every time the shape
+ * notifies about a change, so the cache never returns a stale image,
+ * even when the rendering happens on shallow copies of the shapes in
+ * other threads.
+ *
+ * The images are also keyed by the transformation they have been rendered
+ * with (without the integer part of the translation, so that different
+ * patches of the same canvas can share them) and the render hints.
+ *
+ * All the methods are thread-safe.
+ */
+class KRITAFLAKE_EXPORT KoShapeRasterCache
+{
+public:
+    struct ShapeId {
+        const KoShape *shape = nullptr;
+        quint64 version = 0;
+    };
+
+public:
+    KoShapeRasterCache();
+    ~KoShapeRasterCache();
+
+    static KoShapeRasterCache* instance();
+
+    /**
+     * \return a new version for a shape, unique for the whole application
+     */
+    static quint64 nextVersion();
+
+    /**
+     * Fetches the image of the shape \p id rendered with \p transform and
+     * \p hints. The image should be painted at \p offset in the coordinate
+     * system of \p transform.
+     *
+     * \return true if the image has been found
+     */
+    bool fetch(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints,
+               QImage *image, QPoint *offset) const;
+
+    /**
+     * Same as fetch(), but if the image is not found, marks it as being
+     * rendered by the calling thread. Other threads asking for the same
+     * image will wait until it is inserted instead of rendering it once more.
+     *
+     * If false is returned, the caller must render the image and call
+     * either insert() or cancelRender().
+     */
+    bool fetchOrBeginRender(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints,
+                            QImage *image, QPoint *offset);
+
+    /**
+     * Releases the image marked by fetchOrBeginRender() without
+     * storing anything into the cache
+     */
+    void cancelRender(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints);
+
+    /**
+     * Stores the image of the shape \p id, replacing any older image of
+     * the same shape
+     */
+    void insert(const ShapeId &id, const QTransform &transform, QPainter::RenderHints hints,
+                const QImage &image, const QPoint &offset);
+
+    /**
+     * Drops all the images of \p shape
+     */
+    void remove(const KoShape *shape);
+
+    /**
+     * Sets the maximum amount of memory used by the cached images
+     */
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+
+    /**
+     * The images larger than this limit are never cached, it is cheaper
+     * to render the shape in parts when needed
+     */
+    static const int maxImagePixels;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KOSHAPERASTERCACHE_H
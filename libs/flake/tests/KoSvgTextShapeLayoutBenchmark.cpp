@@ -0,0 +1,108 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoSvgTextShapeLayoutBenchmark.h"
+
+#include <text/KoFontRegistry.h>
+#include <text/KoSvgText.h>
+#include <text/KoSvgTextProperties.h>
+#include <text/KoSvgTextShape.h>
+#include <text/KoSvgTextShapeMarkupConverter.h>
+
+#include <qimage_test_util.h>
+
+namespace {
+
+/// Enough text for about ten pages of a printed document
+const int numParagraphs = 80;
+
+const QString paragraphText =
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+    "incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud "
+    "exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure "
+    "dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur. "
+    "Excepteur sint occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+    "mollit anim id est laborum.";
+
+}
+
+void KoSvgTextShapeLayoutBenchmark::initTestCase()
+{
+    for (const char *const fontFile : {
+             "fonts/DejaVuSans.ttf",
+             "fonts/FreeSans.ttf",
+         }) {
+        QString fileName = TestUtil::fetchDataFileLazy(fontFile);
+        bool res = KoFontRegistry::instance()->addFontFilePathToRegistery(fileName);
+
+        QVERIFY2(res, QString("KoFontRegistry could not add the test font %1").arg(fontFile).toLatin1());
+    }
+}
+
+void KoSvgTextShapeLayoutBenchmark::loadDocument(KoSvgTextShape *shape)
+{
+    QStringList paragraphs;
+    for (int i = 0; i < numParagraphs; i++) {
+        paragraphs << QString("%1. %2").arg(i + 1).arg(paragraphText);
+    }
+
+    const QString svgText =
+        QString("<text x=\"0\" y=\"12\" style=\"font-family: DejaVu Sans; font-size: 12; "
+                "inline-size: 450; white-space: pre-wrap;\">%1</text>")
+            .arg(paragraphs.join("\n"));
+
+    KoSvgTextShapeMarkupConverter converter(shape);
+    QVERIFY(converter.convertFromSvg(svgText, "<defs/>", QRectF(0, 0, 450, 12000), 72.0));
+}
+
+void KoSvgTextShapeLayoutBenchmark::benchmarkLoad()
+{
+    QBENCHMARK {
+        KoSvgTextShape shape;
+        loadDocument(&shape);
+    }
+}
+
+void KoSvgTextShapeLayoutBenchmark::benchmarkRelayout()
+{
+    KoSvgTextShape shape;
+    loadDocument(&shape);
+
+    QBENCHMARK {
+        shape.relayout();
+    }
+}
+
+void KoSvgTextShapeLayoutBenchmark::benchmarkTypeCharacter()
+{
+    KoSvgTextShape shape;
+    loadDocument(&shape);
+
+    const int pos = shape.posForIndex(shape.plainText().size() / 2);
+
+    QBENCHMARK {
+        shape.insertText(pos, "a");
+    }
+}
+
+void KoSvgTextShapeLayoutBenchmark::benchmarkChangeInlineSize()
+{
+    KoSvgTextShape shape;
+    loadDocument(&shape);
+
+    KoSvgTextProperties props = shape.textProperties();
+    qreal inlineSize = 450;
+
+    QBENCHMARK {
+        inlineSize = inlineSize > 450 ? 440 : 460;
+        props.setProperty(KoSvgTextProperties::InlineSizeId, QVariant::fromValue(KoSvgText::AutoValue(inlineSize)));
+        shape.setPropertiesAtPos(-1, props);
+    }
+}
+
+#include "kistest.h"
+
+KISTEST_MAIN(KoSvgTextShapeLayoutBenchmark)
@@ -0,0 +1,35 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KOSVGTEXTSHAPELAYOUTBENCHMARK_H
+#define KOSVGTEXTSHAPELAYOUTBENCHMARK_H
+
+#include <simpletest.h>
+
+class KoSvgTextShape;
+
+/**
+ * Measures the layout of a multi-page text shape: a full relayout,
+ * typing a character into one of the paragraphs and changing a property
+ * that doesn't affect shaping.
+ */
+class KoSvgTextShapeLayoutBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    void loadDocument(KoSvgTextShape *shape);
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkLoad();
+    void benchmarkRelayout();
+    void benchmarkTypeCharacter();
+    void benchmarkChangeInlineSize();
+};
+
+#endif /* KOSVGTEXTSHAPELAYOUTBENCHMARK_H */
@@ -6,8 +6,16 @@
 #include "TestShapePainting.h"
 
 #include <QtGui>
+#include <thread>
+
 #include "KoShapeContainer.h"
 #include "KoShapeManager.h"
+#include "KoShapeGroup.h"
+#include "KoClipPath.h"
+#include <KoPathShape.h>
+#include <KoColorBackground.h>
+#include <kis_pointer_utils.h>
+#include <qimage_test_util.h>
 
 #include <MockShapes.h>
 #include <testflake.h>
@@ -298,4 +306,178 @@ void TestShapePainting::testGroupUngroup()
     }
 }
 
+namespace {
+QImage renderPaintJob(KoShapeManager &manager, const QRect &rc)
+{
+    KoShapeManager::PaintJobsOrder jobsOrder;
+    jobsOrder.jobs << KoShapeManager::PaintJob(rc, rc);
+    manager.preparePaintJobs(jobsOrder, 0);
+
+    QImage image(rc.size(), QImage::Format_ARGB32);
+    image.fill(0);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setClipRect(QRect(QPoint(), rc.size()));
+    painter.setTransform(QTransform::fromTranslate(-rc.x(), -rc.y()));
+    manager.paintJob(painter, jobsOrder.jobs.first());
+
+    return image;
+}
+}
+
+void TestShapePainting::testRasterCache()
+{
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas);
+
+    QPainterPath path1;
+    path1.addEllipse(QRectF(10.3, 10.7, 50, 40));
+    QScopedPointer<KoPathShape> shape1(KoPathShape::createShapeFromPainterPath(path1));
+    shape1->setBackground(toQShared(new KoColorBackground(Qt::red)));
+
+    QPainterPath path2;
+    path2.addRect(QRectF(40.5, 30.5, 50, 50));
+    QScopedPointer<KoPathShape> shape2(KoPathShape::createShapeFromPainterPath(path2));
+    shape2->setBackground(toQShared(new KoColorBackground(Qt::blue)));
+    shape2->setZIndex(1);
+
+    manager.addShape(shape1.data());
+    manager.addShape(shape2.data());
+
+    const QVector<QRect> tiles = {QRect(0, 0, 100, 100), QRect(7, 13, 40, 50), QRect(50, 50, 50, 50)};
+
+    auto checkCachedRendering = [&] () {
+        QVector<QImage> references;
+
+        manager.setRasterCacheEnabled(false);
+        Q_FOREACH (const QRect &rc, tiles) {
+            references << renderPaintJob(manager, rc);
+        }
+
+        manager.setRasterCacheEnabled(true);
+
+        // the second pass is rendered from the cache
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = 0; i < tiles.size(); i++) {
+                QPoint pt;
+                // the antialiased edges are composed via a premultiplied image
+                QVERIFY(TestUtil::compareQImages(pt, renderPaintJob(manager, tiles[i]), references[i], 1, 1));
+            }
+        }
+    };
+
+    checkCachedRendering();
+
+    shape1->setBackground(toQShared(new KoColorBackground(Qt::green)));
+    shape1->update();
+    QCOMPARE(renderPaintJob(manager, tiles[0]).pixelColor(20, 30), QColor(Qt::green));
+
+    checkCachedRendering();
+
+    shape2->setPosition(QPointF(30, 20));
+    shape2->update();
+
+    checkCachedRendering();
+
+    manager.setRasterCacheEnabled(false);
+}
+
+void TestShapePainting::testRasterCacheClippedGroup()
+{
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas);
+
+    QPainterPath path1;
+    path1.addRect(QRectF(10.5, 10.5, 60, 60));
+    KoPathShape *shape1 = KoPathShape::createShapeFromPainterPath(path1);
+    shape1->setBackground(toQShared(new KoColorBackground(Qt::red)));
+
+    QPainterPath path2;
+    path2.addEllipse(QRectF(120.3, 110.7, 60, 70));
+    KoPathShape *shape2 = KoPathShape::createShapeFromPainterPath(path2);
+    shape2->setBackground(toQShared(new KoColorBackground(Qt::blue)));
+
+    QScopedPointer<KoShapeGroup> group(new KoShapeGroup());
+    {
+        KoShapeGroupCommand cmd(group.data(), {shape1, shape2}, false);
+        cmd.redo();
+    }
+
+    // the clip path turns the group into a top-level node of the rendering tree
+    QPainterPath clipPath;
+    clipPath.moveTo(0, 40);
+    clipPath.lineTo(200, 0);
+    clipPath.lineTo(160, 200);
+    clipPath.closeSubpath();
+    KoClipPath *koClipPath = new KoClipPath({KoPathShape::createShapeFromPainterPath(clipPath)}, KoFlake::UserSpaceOnUse);
+    koClipPath->setClipRule(Qt::WindingFill);
+    group->setClipPath(koClipPath);
+
+    manager.addShape(group.data());
+
+    // each tile contains only a part of the group's children
+    const QVector<QRect> tiles = {QRect(0, 0, 100, 100), QRect(100, 0, 100, 100),
+                                  QRect(0, 100, 100, 100), QRect(100, 100, 100, 100)};
+
+    QVector<QImage> references;
+
+    manager.setRasterCacheEnabled(false);
+    Q_FOREACH (const QRect &rc, tiles) {
+        references << renderPaintJob(manager, rc);
+    }
+
+    manager.setRasterCacheEnabled(true);
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < tiles.size(); i++) {
+            QPoint pt;
+            QVERIFY(TestUtil::compareQImages(pt, renderPaintJob(manager, tiles[i]), references[i], 1, 1));
+        }
+    }
+
+    // the tiles rendered concurrently should share a single image of the group
+    {
+        KoShapeManager::PaintJobsOrder jobsOrder;
+        Q_FOREACH (const QRect &rc, tiles) {
+            jobsOrder.jobs << KoShapeManager::PaintJob(rc, rc);
+        }
+        group->update();
+        manager.preparePaintJobs(jobsOrder, 0);
+
+        QVector<QImage> images(tiles.size());
+
+        auto renderJob = [&] (int index) {
+            const KoShapeManager::PaintJob &job = jobsOrder.jobs[index];
+
+            QImage image(job.viewUpdateRect.size(), QImage::Format_ARGB32);
+            image.fill(0);
+
+            QPainter painter(&image);
+            painter.setRenderHint(QPainter::Antialiasing);
+            painter.setClipRect(QRect(QPoint(), job.viewUpdateRect.size()));
+            painter.setTransform(QTransform::fromTranslate(-job.viewUpdateRect.x(), -job.viewUpdateRect.y()));
+            manager.paintJob(painter, job);
+
+            images[index] = image;
+        };
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < tiles.size(); i++) {
+            threads.emplace_back(renderJob, i);
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        for (int i = 0; i < tiles.size(); i++) {
+            QPoint pt;
+            QVERIFY(TestUtil::compareQImages(pt, images[i], references[i], 1, 1));
+        }
+    }
+
+    manager.setRasterCacheEnabled(false);
+    manager.remove(group.data());
+}
+
 KISTEST_MAIN(TestShapePainting)
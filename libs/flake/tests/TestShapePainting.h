@@ -16,6 +16,8 @@ private Q_SLOTS:
     void testPaintHiddenShape();
     void testPaintOrder();
     void testGroupUngroup();
+    void testRasterCache();
+    void testRasterCacheClippedGroup();
 };
 
 #endif
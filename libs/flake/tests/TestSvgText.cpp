@@ -1856,6 +1856,68 @@ void TestSvgText::testFontSizeConfiguration()
     }
 }
 
+/**
+ * @brief TestSvgText::testFontRegistryCaches
+ *
+ * This tests whether the font matches and glyph outlines are cached by
+ * the font registry, and whether the caches respect their memory limits.
+ */
+void TestSvgText::testFontRegistryCaches()
+{
+    KoFontRegistry *registry = KoFontRegistry::instance();
+    const KoFontRegistry::CacheStatistics initialStats = registry->cacheStatistics();
+    registry->clearCaches();
+
+    const QString text = "Some text to match";
+    QVector<int> lengths;
+    QMap<QString, qreal> axisSettings;
+
+    const std::vector<FT_FaceSP> faces =
+        registry->facesForCSSValues({"DejaVu Sans"}, lengths, axisSettings, text, 72, 72, 12.0);
+    QVERIFY(!faces.empty());
+    const QVector<int> expectedLengths = lengths;
+
+    KoFontRegistry::CacheStatistics stats = registry->cacheStatistics();
+    QCOMPARE(stats.fontMatchCount, 1);
+    QVERIFY(stats.fontMatchMemory > 0);
+
+    const std::vector<FT_FaceSP> cachedFaces =
+        registry->facesForCSSValues({"DejaVu Sans"}, lengths, axisSettings, text, 72, 72, 12.0);
+    QCOMPARE(registry->cacheStatistics().fontMatchHits, stats.fontMatchHits + 1);
+    QCOMPARE(lengths, expectedLengths);
+    QCOMPARE(cachedFaces.front().data(), faces.front().data());
+
+    FT_Face face = faces.front().data();
+    const FT_UInt index = FT_Get_Char_Index(face, 'S');
+
+    KoFontRegistry::GlyphOutline glyph;
+    QVERIFY(!registry->fetchGlyphOutline(face, index, FT_LOAD_NO_HINTING, false, &glyph));
+
+    glyph.path.addRect(0, 0, 640, 640);
+    glyph.advance = QPoint(640, 0);
+    registry->storeGlyphOutline(face, index, FT_LOAD_NO_HINTING, false, glyph);
+
+    KoFontRegistry::GlyphOutline cachedGlyph;
+    QVERIFY(registry->fetchGlyphOutline(face, index, FT_LOAD_NO_HINTING, false, &cachedGlyph));
+    QCOMPARE(cachedGlyph.path, glyph.path);
+    QCOMPARE(cachedGlyph.advance, glyph.advance);
+
+    // synthetic bold and different load flags are cached separately
+    QVERIFY(!registry->fetchGlyphOutline(face, index, FT_LOAD_NO_HINTING, true, &cachedGlyph));
+    QVERIFY(!registry->fetchGlyphOutline(face, index, FT_LOAD_DEFAULT, false, &cachedGlyph));
+
+    stats = registry->cacheStatistics();
+    QCOMPARE(stats.glyphCount, 1);
+    QVERIFY(stats.glyphMemory > 0);
+
+    registry->setCacheMemoryLimits(0, 0);
+    stats = registry->cacheStatistics();
+    QCOMPARE(stats.fontMatchCount, 0);
+    QCOMPARE(stats.glyphCount, 0);
+
+    registry->setCacheMemoryLimits(initialStats.fontMatchMemoryLimit, initialStats.glyphMemoryLimit);
+}
+
 /**
  * @brief TestSvgText::testFontSizeRender
  *
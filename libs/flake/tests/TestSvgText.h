@@ -67,6 +67,7 @@ private Q_SLOTS:
     void testFontSelectionForText();
     void testFontStyleSelection();
     void testFontSizeConfiguration();
+    void testFontRegistryCaches();
 
     void testFontSizeRender();
     void testFontOpenTypeVariationsConfiguration();
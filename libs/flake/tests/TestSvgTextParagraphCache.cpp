@@ -0,0 +1,198 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "TestSvgTextParagraphCache.h"
+
+#include <QSet>
+
+#include <text/KoFontRegistry.h>
+#include <text/KoSvgTextShape.h>
+#include <text/KoSvgTextShape_p.h>
+#include <text/KoSvgTextShapeMarkupConverter.h>
+
+#include <qimage_test_util.h>
+
+namespace {
+
+const char *const testFontFile = "fonts/DejaVuSans.ttf";
+
+bool loadText(KoSvgTextShape *shape, const QString &text, const QString &direction)
+{
+    const QString svgText =
+        QString("<text x=\"0\" y=\"12\" style=\"font-family: DejaVu Sans; font-size: 12; "
+                "direction: %1; inline-size: 120; white-space: pre-wrap;\">%2</text>")
+            .arg(direction, text);
+
+    KoSvgTextShapeMarkupConverter converter(shape);
+    return converter.convertFromSvg(svgText, "<defs/>", QRectF(0, 0, 120, 400), 72.0);
+}
+
+QSet<const ShapedParagraph*> shapedParagraphs(const KoSvgTextShape::Private *d)
+{
+    QSet<const ShapedParagraph*> result;
+    Q_FOREACH (const ShapedParagraphSP &paragraph, d->shapedParagraphs) {
+        result.insert(paragraph.data());
+    }
+    return result;
+}
+
+bool fuzzyCompareLines(const QLineF &lhs, const QLineF &rhs)
+{
+    const qreal eps = 1e-3;
+    return qAbs(lhs.x1() - rhs.x1()) < eps && qAbs(lhs.y1() - rhs.y1()) < eps &&
+        qAbs(lhs.x2() - rhs.x2()) < eps && qAbs(lhs.y2() - rhs.y2()) < eps;
+}
+
+void compareLayouts(KoSvgTextShape *actual, KoSvgTextShape *expected)
+{
+    QCOMPARE(actual->plainText(), expected->plainText());
+
+    const int lastPos = expected->posForIndex(expected->plainText().size());
+    QCOMPARE(actual->posForIndex(actual->plainText().size()), lastPos);
+
+    for (int pos = 0; pos <= lastPos; pos++) {
+        QLineF actualCaret;
+        QLineF expectedCaret;
+        QColor color;
+
+        actual->cursorForPos(pos, actualCaret, color);
+        expected->cursorForPos(pos, expectedCaret, color);
+
+        QVERIFY2(fuzzyCompareLines(actualCaret, expectedCaret),
+                 QString("Caret differs at pos %1: (%2, %3) vs expected (%4, %5)")
+                     .arg(pos)
+                     .arg(actualCaret.x1()).arg(actualCaret.y1())
+                     .arg(expectedCaret.x1()).arg(expectedCaret.y1()).toLatin1());
+
+        // the visual navigation checks the bidi reordering of the lines
+        QCOMPARE(actual->posLeft(pos, true), expected->posLeft(pos, true));
+        QCOMPARE(actual->posRight(pos, true), expected->posRight(pos, true));
+    }
+
+    QVERIFY(actual->outline() == expected->outline());
+}
+
+}
+
+void TestSvgTextParagraphCache::initTestCase()
+{
+    QString fileName = TestUtil::fetchDataFileLazy(testFontFile);
+    bool res = KoFontRegistry::instance()->addFontFilePathToRegistery(fileName);
+
+    QVERIFY2(res, QString("KoFontRegistry could not add the test font %1").arg(testFontFile).toLatin1());
+}
+
+void TestSvgTextParagraphCache::testCachedRelayout_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("direction");
+    QTest::addColumn<int>("removeIndex");
+    QTest::addColumn<int>("removeLength");
+    QTest::addColumn<int>("insertIndex");
+    QTest::addColumn<QString>("insertText");
+
+    const QString ltrText("The first paragraph.\n"
+                          "The second paragraph is a bit longer than the first one.\n"
+                          "Third.");
+    const QString rtlText("פסקה ראשונה.\n"
+                          "פסקה שנייה ארוכה יותר מהראשונה.\n"
+                          "שלישית.");
+    const QString mixedText("Hello שלום world, 123.\n"
+                            "עולם abc 456 טוב\n"
+                            "end");
+
+    QTest::addRow("ltr-insert-inside-paragraph") << ltrText << QString("ltr") << 0 << 0 << 25 << QString("new ");
+    QTest::addRow("ltr-insert-hard-break") << ltrText << QString("ltr") << 0 << 0 << 32 << QString("\n");
+    QTest::addRow("ltr-remove-hard-break") << ltrText << QString("ltr") << 20 << 1 << 0 << QString("");
+    QTest::addRow("ltr-remove-across-hard-break") << ltrText << QString("ltr") << 15 << 10 << 0 << QString("");
+
+    QTest::addRow("rtl-insert-inside-paragraph") << rtlText << QString("rtl") << 0 << 0 << 18 << QString("חדש ");
+    QTest::addRow("rtl-insert-hard-break") << rtlText << QString("rtl") << 0 << 0 << 18 << QString("\n");
+    QTest::addRow("rtl-remove-across-hard-break") << rtlText << QString("rtl") << 8 << 10 << 0 << QString("");
+
+    QTest::addRow("mixed-ltr-insert-inside-paragraph") << mixedText << QString("ltr") << 0 << 0 << 28 << QString("xyz ");
+    QTest::addRow("mixed-ltr-remove-across-hard-break") << mixedText << QString("ltr") << 18 << 8 << 0 << QString("");
+    QTest::addRow("mixed-rtl-insert-inside-paragraph") << mixedText << QString("rtl") << 0 << 0 << 6 << QString("אבג ");
+    QTest::addRow("mixed-rtl-remove-hard-break") << mixedText << QString("rtl") << 22 << 1 << 0 << QString("");
+    QTest::addRow("mixed-rtl-remove-across-hard-break") << mixedText << QString("rtl") << 18 << 8 << 0 << QString("");
+}
+
+void TestSvgTextParagraphCache::testCachedRelayout()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, direction);
+    QFETCH(int, removeIndex);
+    QFETCH(int, removeLength);
+    QFETCH(int, insertIndex);
+    QFETCH(QString, insertText);
+
+    KoSvgTextShape edited;
+    QVERIFY(loadText(&edited, text, direction));
+
+    QString expectedText = text;
+
+    if (removeLength > 0) {
+        int index = removeIndex;
+        int length = removeLength;
+        QVERIFY(edited.removeText(index, length));
+        expectedText.remove(removeIndex, removeLength);
+    }
+
+    if (!insertText.isEmpty()) {
+        QVERIFY(edited.insertText(edited.posForIndex(insertIndex), insertText));
+        expectedText.insert(insertIndex, insertText);
+    }
+
+    QCOMPARE(edited.plainText(), expectedText);
+
+    KoSvgTextShape fresh;
+    QVERIFY(loadText(&fresh, expectedText, direction));
+
+    compareLayouts(&edited, &fresh);
+}
+
+void TestSvgTextParagraphCache::testCacheReusesParagraphs()
+{
+    KoSvgTextShape shape;
+    QVERIFY(loadText(&shape, "First paragraph.\nSecond paragraph.\nThird paragraph.", "ltr"));
+
+    // keep the old paragraphs alive, so that their addresses are not reused
+    const QMultiHash<QString, ShapedParagraphSP> oldParagraphs = shape.d->shapedParagraphs;
+    const QSet<const ShapedParagraph*> before = shapedParagraphs(shape.d.data());
+    QCOMPARE(before.size(), 3);
+
+    // type into the second paragraph
+    QVERIFY(shape.insertText(shape.posForIndex(20), "x"));
+
+    const QSet<const ShapedParagraph*> after = shapedParagraphs(shape.d.data());
+    QCOMPARE(after.size(), 3);
+    QCOMPARE(QSet<const ShapedParagraph*>(before).intersect(after).size(), 2);
+}
+
+void TestSvgTextParagraphCache::testFontRegistryInvalidatesCache()
+{
+    KoSvgTextShape shape;
+    QVERIFY(loadText(&shape, "First paragraph.\nSecond paragraph.", "ltr"));
+
+    const QMultiHash<QString, ShapedParagraphSP> oldParagraphs = shape.d->shapedParagraphs;
+    const QSet<const ShapedParagraph*> before = shapedParagraphs(shape.d.data());
+    QCOMPARE(before.size(), 2);
+
+    shape.relayout();
+    QCOMPARE(shapedParagraphs(shape.d.data()), before);
+
+    // a new font may change the fallback, so everything is reshaped
+    KoFontRegistry::instance()->addFontFilePathToRegistery(TestUtil::fetchDataFileLazy(testFontFile));
+    shape.relayout();
+
+    const QSet<const ShapedParagraph*> after = shapedParagraphs(shape.d.data());
+    QCOMPARE(after.size(), 2);
+    QVERIFY(!QSet<const ShapedParagraph*>(before).intersects(after));
+}
+
+#include "kistest.h"
+
+KISTEST_MAIN(TestSvgTextParagraphCache)
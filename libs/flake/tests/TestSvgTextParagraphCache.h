@@ -0,0 +1,30 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef TESTSVGTEXTPARAGRAPHCACHE_H
+#define TESTSVGTEXTPARAGRAPHCACHE_H
+
+#include <simpletest.h>
+
+/**
+ * Checks that the layout of a text shape relaid out with the cached
+ * shaped paragraphs is the same as a fresh full layout of the same text.
+ */
+class TestSvgTextParagraphCache : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testCachedRelayout_data();
+    void testCachedRelayout();
+
+    void testCacheReusesParagraphs();
+    void testFontRegistryInvalidatesCache();
+};
+
+#endif /* TESTSVGTEXTPARAGRAPHCACHE_H */
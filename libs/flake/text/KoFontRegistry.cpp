@@ -8,6 +8,7 @@
 #include "KoCssTextUtils.h"
 
 #include <QApplication>
+#include <QCache>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
@@ -44,6 +45,120 @@ static unsigned int firstCharUcs4(const QStringView qsv)
     return QChar::ReplacementCharacter;
 }
 
+namespace {
+
+struct FontEntry {
+    QString fileName;
+    int fontIndex;
+
+    static std::optional<FontEntry> get(const FcPattern *p) {
+
+        FcChar8 *fileValue{};
+        if (FcPatternGetString(p, FC_FILE, 0, &fileValue) != FcResultMatch) {
+            debugFlake << "Failed to get font file for" << p;
+            return {};
+        }
+        const QString fontFileName = QString::fromUtf8(reinterpret_cast<char *>(fileValue));
+
+        int indexValue{};
+        if (FcPatternGetInteger(p, FC_INDEX, 0, &indexValue) != FcResultMatch) {
+            debugFlake << "Failed to get font index for" << p << "(file:" << fontFileName << ")";
+            return {};
+        }
+
+        return {{fontFileName, indexValue}};
+    }
+};
+
+/**
+ * The CSS font query facesForCSSValues() resolves. The query is matched
+ * against the whole text, because the fallback fonts depend on it.
+ */
+struct FontMatchKey {
+    QStringList families;
+    QString text;
+    QString language;
+    int weight = 400;
+    int width = 100;
+    bool italic = false;
+    double pixelSize = 0.0;
+
+    bool operator==(const FontMatchKey &rhs) const {
+        return text == rhs.text
+            && families == rhs.families
+            && language == rhs.language
+            && weight == rhs.weight
+            && width == rhs.width
+            && italic == rhs.italic
+            && qFuzzyCompare(pixelSize, rhs.pixelSize);
+    }
+};
+
+uint qHash(const FontMatchKey &key, uint seed = 0)
+{
+    uint hash = qHash(key.text, seed) ^ qHash(key.language, seed) ^ qHash(key.weight, seed)
+        ^ qHash(key.width, seed) ^ qHash(key.italic, seed) ^ qHash(qRound(key.pixelSize * 64), seed);
+    Q_FOREACH (const QString &family, key.families) {
+        hash = hash * 31 + qHash(family, seed);
+    }
+    return hash;
+}
+
+struct FontMatch {
+    QVector<FontEntry> fonts;
+    QVector<int> lengths;
+};
+
+struct GlyphKey {
+    QString faceId;
+    FT_UInt index = 0;
+    FT_Int32 loadFlags = 0;
+    bool syntheticBold = false;
+
+    bool operator==(const GlyphKey &rhs) const {
+        return index == rhs.index
+            && loadFlags == rhs.loadFlags
+            && syntheticBold == rhs.syntheticBold
+            && faceId == rhs.faceId;
+    }
+};
+
+uint qHash(const GlyphKey &key, uint seed = 0)
+{
+    return qHash(key.faceId, seed) ^ qHash(key.index, seed) ^ qHash(key.loadFlags, seed) ^ qHash(key.syntheticBold, seed);
+}
+
+/**
+ * The costs of the cache entries are approximate sizes of the entries
+ * in bytes
+ */
+int fontMatchCost(const FontMatchKey &key, const FontMatch &match)
+{
+    int cost = int(sizeof(FontMatchKey) + sizeof(FontMatch)) + (key.text.size() + key.language.size()) * int(sizeof(QChar));
+    Q_FOREACH (const QString &family, key.families) {
+        cost += family.size() * int(sizeof(QChar));
+    }
+    Q_FOREACH (const FontEntry &font, match.fonts) {
+        cost += int(sizeof(FontEntry)) + font.fileName.size() * int(sizeof(QChar));
+    }
+    cost += match.lengths.size() * int(sizeof(int));
+    return cost;
+}
+
+int glyphCost(const GlyphKey &key, const KoFontRegistry::GlyphOutline &glyph)
+{
+    return int(sizeof(GlyphKey) + sizeof(KoFontRegistry::GlyphOutline))
+        + key.faceId.size() * int(sizeof(QChar))
+        + glyph.path.elementCount() * int(sizeof(QPainterPath::Element));
+}
+
+int costLimit(qint64 bytes)
+{
+    return int(qBound(qint64(0), bytes, qint64(std::numeric_limits<int>::max())));
+}
+
+}
+
 Q_GLOBAL_STATIC(KoFontRegistry, s_instance)
 
 class Q_DECL_HIDDEN KoFontRegistry::Private
@@ -56,6 +171,7 @@ private:
         QHash<FcChar32, FcPatternSP> m_patterns;
         QHash<FcChar32, FcFontSetSP> m_fontSets;
         QHash<QString, FT_FaceSP> m_faces;
+        QHash<FT_Face, QString> m_faceIds;
 
         ThreadData(FT_LibrarySP lib)
             : m_library(std::move(lib))
@@ -65,6 +181,18 @@ private:
 
     QThreadStorage<QSharedPointer<ThreadData>> m_data;
 
+    QMutex m_fontMatchMutex;
+    QCache<FontMatchKey, FontMatch> m_fontMatches {4 * 1024 * 1024};
+    quint64 m_fontMatchHits = 0;
+    quint64 m_fontMatchMisses = 0;
+
+    QMutex m_glyphMutex;
+    QCache<GlyphKey, KoFontRegistry::GlyphOutline> m_glyphs {32 * 1024 * 1024};
+    quint64 m_glyphHits = 0;
+    quint64 m_glyphMisses = 0;
+
+    QAtomicInt m_fontSetVersion;
+
     void initialize()
     {
         if (!m_data.hasLocalData()) {
@@ -129,10 +257,139 @@ public:
         return m_data.localData()->m_faces;
     }
 
+    /**
+     * The identifiers of the faces of the current thread, they are
+     * the same for the faces of the same font in all the threads
+     */
+    QHash<FT_Face, QString> &faceIds()
+    {
+        if (!m_data.hasLocalData())
+            initialize();
+        return m_data.localData()->m_faceIds;
+    }
+
     FcConfigSP config() const
     {
         return m_config;
     }
+
+    bool fetchFontMatch(const FontMatchKey &key, QVector<FontEntry> *fonts, QVector<int> *lengths)
+    {
+        QMutexLocker l(&m_fontMatchMutex);
+
+        const FontMatch *match = m_fontMatches.object(key);
+        if (!match) {
+            m_fontMatchMisses++;
+            return false;
+        }
+
+        m_fontMatchHits++;
+        *fonts = match->fonts;
+        *lengths = match->lengths;
+        return true;
+    }
+
+    void storeFontMatch(const FontMatchKey &key, const QVector<FontEntry> &fonts, const QVector<int> &lengths)
+    {
+        QScopedPointer<FontMatch> match(new FontMatch {fonts, lengths});
+        const int cost = fontMatchCost(key, *match);
+
+        QMutexLocker l(&m_fontMatchMutex);
+        m_fontMatches.insert(key, match.take(), cost);
+    }
+
+    bool glyphKey(FT_Face face, FT_UInt index, FT_Int32 loadFlags, bool syntheticBold, GlyphKey *key)
+    {
+        auto it = faceIds().constFind(face);
+        if (it == faceIds().constEnd()) {
+            return false;
+        }
+
+        *key = GlyphKey {it.value(), index, loadFlags, syntheticBold};
+        return true;
+    }
+
+    bool fetchGlyph(const GlyphKey &key, KoFontRegistry::GlyphOutline *glyph)
+    {
+        QMutexLocker l(&m_glyphMutex);
+
+        const KoFontRegistry::GlyphOutline *cached = m_glyphs.object(key);
+        if (!cached) {
+            m_glyphMisses++;
+            return false;
+        }
+
+        m_glyphHits++;
+        *glyph = *cached;
+        return true;
+    }
+
+    void storeGlyph(const GlyphKey &key, const KoFontRegistry::GlyphOutline &glyph)
+    {
+        QScopedPointer<KoFontRegistry::GlyphOutline> cached(new KoFontRegistry::GlyphOutline(glyph));
+        const int cost = glyphCost(key, glyph);
+
+        QMutexLocker l(&m_glyphMutex);
+        m_glyphs.insert(key, cached.take(), cost);
+    }
+
+    void setCacheMemoryLimits(qint64 fontMatchBytes, qint64 glyphBytes)
+    {
+        {
+            QMutexLocker l(&m_fontMatchMutex);
+            m_fontMatches.setMaxCost(costLimit(fontMatchBytes));
+        }
+        {
+            QMutexLocker l(&m_glyphMutex);
+            m_glyphs.setMaxCost(costLimit(glyphBytes));
+        }
+    }
+
+    void clearFontMatches()
+    {
+        QMutexLocker l(&m_fontMatchMutex);
+        m_fontMatches.clear();
+    }
+
+    int fontSetVersion() const
+    {
+        return m_fontSetVersion.loadAcquire();
+    }
+
+    void fontSetChanged()
+    {
+        // the new font may be a better match for the cached queries
+        clearFontMatches();
+        m_fontSetVersion.ref();
+    }
+
+    void clearGlyphs()
+    {
+        QMutexLocker l(&m_glyphMutex);
+        m_glyphs.clear();
+    }
+
+    KoFontRegistry::CacheStatistics statistics()
+    {
+        KoFontRegistry::CacheStatistics stats;
+        {
+            QMutexLocker l(&m_fontMatchMutex);
+            stats.fontMatchCount = m_fontMatches.count();
+            stats.fontMatchMemory = m_fontMatches.totalCost();
+            stats.fontMatchMemoryLimit = m_fontMatches.maxCost();
+            stats.fontMatchHits = m_fontMatchHits;
+            stats.fontMatchMisses = m_fontMatchMisses;
+        }
+        {
+            QMutexLocker l(&m_glyphMutex);
+            stats.glyphCount = m_glyphs.count();
+            stats.glyphMemory = m_glyphs.totalCost();
+            stats.glyphMemoryLimit = m_glyphs.maxCost();
+            stats.glyphHits = m_glyphHits;
+            stats.glyphMisses = m_glyphMisses;
+        }
+        return stats;
+    }
 };
 
 KoFontRegistry::KoFontRegistry()
@@ -161,216 +418,200 @@ std::vector<FT_FaceSP> KoFontRegistry::facesForCSSValues(const QStringList &fami
                                                          int slant,
                                                          const QString &language)
 {
-    // FcObjectSet *objectSet = FcObjectSetBuild(FC_FAMILY, FC_FILE, FC_WIDTH,
-    // FC_WEIGHT, FC_SLANT, nullptr);
-    FcPatternSP p(FcPatternCreate());
-    Q_FOREACH (const QString &family, families) {
-        QByteArray utfData = family.toUtf8();
-        const FcChar8 *vals = reinterpret_cast<FcChar8 *>(utfData.data());
-        FcPatternAddString(p.data(), FC_FAMILY, vals);
-    }
-
-    {
-        QByteArray fallbackBuf = QString("sans-serif").toUtf8();
-        FcValue fallback;
-        fallback.type = FcTypeString;
-        fallback.u.s = reinterpret_cast<FcChar8 *>(fallbackBuf.data());
-        FcPatternAddWeak(p.data(), FC_FAMILY, fallback, true);
-    }
+    const double pixelSize = size*(qMin(xRes, yRes)/72.0);
 
-    if (italic || slant != 0) {
-        FcPatternAddInteger(p.data(), FC_SLANT, FC_SLANT_ITALIC);
-    } else {
-        FcPatternAddInteger(p.data(), FC_SLANT, FC_SLANT_ROMAN);
-    }
-    FcPatternAddInteger(p.data(), FC_WEIGHT, FcWeightFromOpenType(weight));
-    FcPatternAddInteger(p.data(), FC_WIDTH, width);
-
-    double pixelSize = size*(qMin(xRes, yRes)/72.0);
-    FcPatternAddDouble(p.data(), FC_PIXEL_SIZE, pixelSize);
+    QVector<FontEntry> fonts;
+    lengths.clear();
 
-    FcConfigSubstitute(nullptr, p.data(), FcMatchPattern);
-    FcDefaultSubstitute(p.data());
+    const FontMatchKey matchKey {families, text, language, weight, width, italic || slant != 0, pixelSize};
 
-    p = [&]() {
-        const FcChar32 hash = FcPatternHash(p.data());
-        const auto oldPattern = d->patterns().find(hash);
-        if (oldPattern != d->patterns().end()) {
-            return oldPattern.value();
-        } else {
-            d->patterns().insert(hash, p);
-            return p;
+    if (!d->fetchFontMatch(matchKey, &fonts, &lengths)) {
+        // FcObjectSet *objectSet = FcObjectSetBuild(FC_FAMILY, FC_FILE, FC_WIDTH,
+        // FC_WEIGHT, FC_SLANT, nullptr);
+        FcPatternSP p(FcPatternCreate());
+        Q_FOREACH (const QString &family, families) {
+            QByteArray utfData = family.toUtf8();
+            const FcChar8 *vals = reinterpret_cast<FcChar8 *>(utfData.data());
+            FcPatternAddString(p.data(), FC_FAMILY, vals);
         }
-    }();
 
-    FcResult result = FcResultNoMatch;
-    FcCharSetSP charSet;
-    FcFontSetSP fontSet = [&]() -> FcFontSetSP {
-        const FcChar32 hash = FcPatternHash(p.data());
-        const auto set = d->sets().find(hash);
+        {
+            QByteArray fallbackBuf = QString("sans-serif").toUtf8();
+            FcValue fallback;
+            fallback.type = FcTypeString;
+            fallback.u.s = reinterpret_cast<FcChar8 *>(fallbackBuf.data());
+            FcPatternAddWeak(p.data(), FC_FAMILY, fallback, true);
+        }
 
-        if (set != d->sets().end()) {
-            return set.value();
+        if (italic || slant != 0) {
+            FcPatternAddInteger(p.data(), FC_SLANT, FC_SLANT_ITALIC);
         } else {
-            FcCharSet *cs = nullptr;
-            FcFontSetSP avalue(FcFontSort(FcConfigGetCurrent(), p.data(), FcTrue, &cs, &result));
-            charSet.reset(cs);
-            d->sets().insert(hash, avalue);
-            return avalue;
+            FcPatternAddInteger(p.data(), FC_SLANT, FC_SLANT_ROMAN);
         }
-    }();
-
-    struct FontEntry {
-        QString fileName;
-        int fontIndex;
+        FcPatternAddInteger(p.data(), FC_WEIGHT, FcWeightFromOpenType(weight));
+        FcPatternAddInteger(p.data(), FC_WIDTH, width);
 
+        FcPatternAddDouble(p.data(), FC_PIXEL_SIZE, pixelSize);
 
-        static std::optional<FontEntry> get(const FcPattern *p) {
+        FcConfigSubstitute(nullptr, p.data(), FcMatchPattern);
+        FcDefaultSubstitute(p.data());
 
-            FcChar8 *fileValue{};
-            if (FcPatternGetString(p, FC_FILE, 0, &fileValue) != FcResultMatch) {
-                debugFlake << "Failed to get font file for" << p;
-                return {};
+        p = [&]() {
+            const FcChar32 hash = FcPatternHash(p.data());
+            const auto oldPattern = d->patterns().find(hash);
+            if (oldPattern != d->patterns().end()) {
+                return oldPattern.value();
+            } else {
+                d->patterns().insert(hash, p);
+                return p;
             }
-            const QString fontFileName = QString::fromUtf8(reinterpret_cast<char *>(fileValue));
+        }();
 
-            int indexValue{};
-            if (FcPatternGetInteger(p, FC_INDEX, 0, &indexValue) != FcResultMatch) {
-                debugFlake << "Failed to get font index for" << p << "(file:" << fontFileName << ")";
-                return {};
-            }
+        FcResult result = FcResultNoMatch;
+        FcCharSetSP charSet;
+        FcFontSetSP fontSet = [&]() -> FcFontSetSP {
+            const FcChar32 hash = FcPatternHash(p.data());
+            const auto set = d->sets().find(hash);
 
-            return {{fontFileName, indexValue}};
-        }
-    };
+            if (set != d->sets().end()) {
+                return set.value();
+            } else {
+                FcCharSet *cs = nullptr;
+                FcFontSetSP avalue(FcFontSort(FcConfigGetCurrent(), p.data(), FcTrue, &cs, &result));
+                charSet.reset(cs);
+                d->sets().insert(hash, avalue);
+                return avalue;
+            }
+        }();
 
-    QVector<FontEntry> fonts;
-    lengths.clear();
 
-    if (text.isEmpty()) {
-        for (int j = 0; j < fontSet->nfont; j++) {
-            if (std::optional<FontEntry> font = FontEntry::get(fontSet->fonts[j])) {
-                fonts.append(std::move(*font));
-                lengths.append(0);
-                break;
-            }
-        }
-    } else {
-        FcCharSet *set = nullptr;
-        QVector<int> familyValues(text.size());
-        QVector<int> fallbackMatchValues(text.size());
-        familyValues.fill(-1);
-        fallbackMatchValues.fill(-1);
-
-        // First, we're going to split up the text into graphemes. This is both
-        // because the css spec requires it, but also because of why the css
-        // spec requires it: graphemes' parts should not end up in seperate
-        // runs, which they will if they get assigned different fonts,
-        // potentially breaking ligatures and emoji sequences.
-        QStringList graphemes = KoCssTextUtils::textToUnicodeGraphemeClusters(text, language);
-
-        // Parse over the fonts and graphemes and try to see if we can get the
-        // best match for a given grapheme.
-        for (int i = 0; i < fontSet->nfont; i++) {
-
-            double fontsize = 0.0;
-            FcBool isScalable = false;
-            FcPatternGetBool(fontSet->fonts[i], FC_SCALABLE, 0, &isScalable);
-            FcPatternGetDouble(fontSet->fonts[i], FC_PIXEL_SIZE, 0, &fontsize);
-            if (!isScalable && pixelSize != fontsize) {
-                // For some reason, FC will sometimes consider a smaller font pixel-size
-                // to be more relevant to the requested pattern than a bigger one. This
-                // skips those fonts, but it does mean that such pixel fonts would not
-                // be used for fallback.
-                continue;
+        if (text.isEmpty()) {
+            for (int j = 0; j < fontSet->nfont; j++) {
+                if (std::optional<FontEntry> font = FontEntry::get(fontSet->fonts[j])) {
+                    fonts.append(std::move(*font));
+                    lengths.append(0);
+                    break;
+                }
             }
-            if (FcPatternGetCharSet(fontSet->fonts[i], FC_CHARSET, 0, &set) == FcResultMatch) {
-                int index = 0;
-                Q_FOREACH (const QString &grapheme, graphemes) {
-
-                    // Don't worry about matching controls directly,
-                    // as they are not important to font-selection (and many
-                    // fonts have no glyph entry for these)
-                    if (const uint first = firstCharUcs4(grapheme); QChar::category(first) == QChar::Other_Control
-                        || QChar::category(first) == QChar::Other_Format) {
-                        index += grapheme.size();
-                        continue;
-                    }
-                    int familyIndex = -1;
-                    if (familyValues.at(index) == -1) {
-                        int fallbackMatch = fallbackMatchValues.at(index);
-                        Q_FOREACH (uint unicode, grapheme.toUcs4()) {
-                            if (FcCharSetHasChar(set, unicode)) {
-                                familyIndex = i;
-                                if (fallbackMatch < 0) {
-                                    fallbackMatch = i;
+        } else {
+            FcCharSet *set = nullptr;
+            QVector<int> familyValues(text.size());
+            QVector<int> fallbackMatchValues(text.size());
+            familyValues.fill(-1);
+            fallbackMatchValues.fill(-1);
+
+            // First, we're going to split up the text into graphemes. This is both
+            // because the css spec requires it, but also because of why the css
+            // spec requires it: graphemes' parts should not end up in seperate
+            // runs, which they will if they get assigned different fonts,
+            // potentially breaking ligatures and emoji sequences.
+            QStringList graphemes = KoCssTextUtils::textToUnicodeGraphemeClusters(text, language);
+
+            // Parse over the fonts and graphemes and try to see if we can get the
+            // best match for a given grapheme.
+            for (int i = 0; i < fontSet->nfont; i++) {
+
+                double fontsize = 0.0;
+                FcBool isScalable = false;
+                FcPatternGetBool(fontSet->fonts[i], FC_SCALABLE, 0, &isScalable);
+                FcPatternGetDouble(fontSet->fonts[i], FC_PIXEL_SIZE, 0, &fontsize);
+                if (!isScalable && pixelSize != fontsize) {
+                    // For some reason, FC will sometimes consider a smaller font pixel-size
+                    // to be more relevant to the requested pattern than a bigger one. This
+                    // skips those fonts, but it does mean that such pixel fonts would not
+                    // be used for fallback.
+                    continue;
+                }
+                if (FcPatternGetCharSet(fontSet->fonts[i], FC_CHARSET, 0, &set) == FcResultMatch) {
+                    int index = 0;
+                    Q_FOREACH (const QString &grapheme, graphemes) {
+
+                        // Don't worry about matching controls directly,
+                        // as they are not important to font-selection (and many
+                        // fonts have no glyph entry for these)
+                        if (const uint first = firstCharUcs4(grapheme); QChar::category(first) == QChar::Other_Control
+                            || QChar::category(first) == QChar::Other_Format) {
+                            index += grapheme.size();
+                            continue;
+                        }
+                        int familyIndex = -1;
+                        if (familyValues.at(index) == -1) {
+                            int fallbackMatch = fallbackMatchValues.at(index);
+                            Q_FOREACH (uint unicode, grapheme.toUcs4()) {
+                                if (FcCharSetHasChar(set, unicode)) {
+                                    familyIndex = i;
+                                    if (fallbackMatch < 0) {
+                                        fallbackMatch = i;
+                                    }
+                                } else {
+                                    familyIndex = -1;
+                                    break;
                                 }
-                            } else {
-                                familyIndex = -1;
-                                break;
+                            }
+                            for (int k = 0; k < grapheme.size(); k++) {
+                                familyValues[index + k] = familyIndex;
+                                fallbackMatchValues[index + k] = fallbackMatch;
                             }
                         }
-                        for (int k = 0; k < grapheme.size(); k++) {
-                            familyValues[index + k] = familyIndex;
-                            fallbackMatchValues[index + k] = fallbackMatch;
-                        }
+                        index += grapheme.size();
+                    }
+                    if (!familyValues.contains(-1)) {
+                        break;
                     }
-                    index += grapheme.size();
-                }
-                if (!familyValues.contains(-1)) {
-                    break;
                 }
             }
-        }
 
-        // Remove the -1 entries.
-        if (familyValues.contains(-1)) {
-            int value = -1;
-            Q_FOREACH (const int currentValue, familyValues) {
-                if (currentValue != value) {
-                    value = currentValue;
-                    break;
+            // Remove the -1 entries.
+            if (familyValues.contains(-1)) {
+                int value = -1;
+                Q_FOREACH (const int currentValue, familyValues) {
+                    if (currentValue != value) {
+                        value = currentValue;
+                        break;
+                    }
                 }
-            }
-            value = qMax(0, value);
-            for (int i = 0; i < familyValues.size(); i++) {
-                if (familyValues.at(i) < 0) {
-                    if (fallbackMatchValues.at(i) < 0) {
-                        familyValues[i] = value;
+                value = qMax(0, value);
+                for (int i = 0; i < familyValues.size(); i++) {
+                    if (familyValues.at(i) < 0) {
+                        if (fallbackMatchValues.at(i) < 0) {
+                            familyValues[i] = value;
+                        } else {
+                            familyValues[i] = fallbackMatchValues.at(i);
+                        }
                     } else {
-                        familyValues[i] = fallbackMatchValues.at(i);
+                        value = familyValues.at(i);
                     }
-                } else {
-                    value = familyValues.at(i);
                 }
             }
-        }
 
-        // Get the filenames and lengths for the entries.
-        int length = 0;
-        int startIndex = 0;
-        int lastIndex = familyValues.at(0);
-        FontEntry font{};
-        if (std::optional<FontEntry> f = FontEntry::get(fontSet->fonts[lastIndex])) {
-            font = std::move(*f);
-        }
-        for (int i = 0; i < familyValues.size(); i++) {
-            if (lastIndex != familyValues.at(i)) {
+            // Get the filenames and lengths for the entries.
+            int length = 0;
+            int startIndex = 0;
+            int lastIndex = familyValues.at(0);
+            FontEntry font{};
+            if (std::optional<FontEntry> f = FontEntry::get(fontSet->fonts[lastIndex])) {
+                font = std::move(*f);
+            }
+            for (int i = 0; i < familyValues.size(); i++) {
+                if (lastIndex != familyValues.at(i)) {
+                    lengths.append(text.mid(startIndex, length).size());
+                    fonts.append(font);
+                    startIndex = i;
+                    length = 0;
+                    lastIndex = familyValues.at(i);
+                    if (std::optional<FontEntry> f = FontEntry::get(fontSet->fonts[lastIndex])) {
+                        font = std::move(*f);
+                    }
+                }
+                length += 1;
+            }
+            if (length > 0) {
                 lengths.append(text.mid(startIndex, length).size());
                 fonts.append(font);
-                startIndex = i;
-                length = 0;
-                lastIndex = familyValues.at(i);
-                if (std::optional<FontEntry> f = FontEntry::get(fontSet->fonts[lastIndex])) {
-                    font = std::move(*f);
-                }
             }
-            length += 1;
-        }
-        if (length > 0) {
-            lengths.append(text.mid(startIndex, length).size());
-            fonts.append(font);
         }
+
+        d->storeFontMatch(matchKey, fonts, lengths);
     }
 
     std::vector<FT_FaceSP> faces;
@@ -403,6 +644,7 @@ std::vector<FT_FaceSP> KoFontRegistry::facesForCSSValues(const QStringList &fami
                 configureFaces({face}, size, fontSizeAdjust, xRes, yRes, axisSettings);
                 faces.emplace_back(face);
                 d->typeFaces().insert(fontCacheEntry, face);
+                d->faceIds().insert(face.data(), fontCacheEntry);
             }
         }
     }
@@ -531,16 +773,62 @@ bool KoFontRegistry::configureFaces(const std::vector<FT_FaceSP> &faces,
     return (errorCode == 0);
 }
 
+bool KoFontRegistry::fetchGlyphOutline(FT_Face face, FT_UInt index, FT_Int32 loadFlags, bool syntheticBold, GlyphOutline *glyph) const
+{
+    GlyphKey key;
+    if (!d->glyphKey(face, index, loadFlags, syntheticBold, &key)) {
+        return false;
+    }
+    return d->fetchGlyph(key, glyph);
+}
+
+void KoFontRegistry::storeGlyphOutline(FT_Face face, FT_UInt index, FT_Int32 loadFlags, bool syntheticBold, const GlyphOutline &glyph)
+{
+    GlyphKey key;
+    if (d->glyphKey(face, index, loadFlags, syntheticBold, &key)) {
+        d->storeGlyph(key, glyph);
+    }
+}
+
+void KoFontRegistry::setCacheMemoryLimits(qint64 fontMatchBytes, qint64 glyphBytes)
+{
+    d->setCacheMemoryLimits(fontMatchBytes, glyphBytes);
+}
+
+KoFontRegistry::CacheStatistics KoFontRegistry::cacheStatistics() const
+{
+    return d->statistics();
+}
+
+void KoFontRegistry::clearCaches()
+{
+    d->clearFontMatches();
+    d->clearGlyphs();
+}
+
 bool KoFontRegistry::addFontFilePathToRegistery(const QString &path)
 {
     const QByteArray utfData = path.toUtf8();
     const FcChar8 *vals = reinterpret_cast<const FcChar8 *>(utfData.data());
-    return FcConfigAppFontAddFile(d->config().data(), vals);
+
+    const bool result = FcConfigAppFontAddFile(d->config().data(), vals);
+    d->fontSetChanged();
+
+    return result;
 }
 
 bool KoFontRegistry::addFontFileDirectoryToRegistery(const QString &path)
 {
     const QByteArray utfData = path.toUtf8();
     const FcChar8 *vals = reinterpret_cast<const FcChar8 *>(utfData.data());
-    return FcConfigAppFontAddDir(d->config().data(), vals);
+
+    const bool result = FcConfigAppFontAddDir(d->config().data(), vals);
+    d->fontSetChanged();
+
+    return result;
+}
+
+int KoFontRegistry::fontSetVersion() const
+{
+    return d->fontSetVersion();
 }
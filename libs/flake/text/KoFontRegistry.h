@@ -6,6 +6,8 @@
 #ifndef KOFONTREGISTRY_H
 #define KOFONTREGISTRY_H
 
+#include <QPainterPath>
+#include <QPoint>
 #include <QScopedPointer>
 #include <QVector>
 
@@ -23,9 +25,40 @@
  *
  * It also provides a configuration function to handle all the
  * size and variation axis values.
+ *
+ * The FT_Faces are created per thread, because FreeType doesn't allow
+ * using a face from several threads at once. The results of the font
+ * matching and the glyph outlines, on the other hand, are kept in
+ * process-wide caches shared by all the threads. Both caches are bounded
+ * in memory, see cacheStatistics().
  */
 class KRITAFLAKE_EXPORT KoFontRegistry
 {
+public:
+    /**
+     * An outline glyph as loaded by FreeType, before any transformation
+     * is applied to it.
+     */
+    struct GlyphOutline {
+        QPainterPath path; ///< the outline in 26.6 font units
+        QPoint advance; ///< the advance of the glyph slot, before emboldening
+        FT_Pos emboldenStrength = 0; ///< the strength of synthetic bold applied to the outline
+    };
+
+    struct CacheStatistics {
+        int fontMatchCount = 0;
+        qint64 fontMatchMemory = 0;
+        qint64 fontMatchMemoryLimit = 0;
+        quint64 fontMatchHits = 0;
+        quint64 fontMatchMisses = 0;
+
+        int glyphCount = 0;
+        qint64 glyphMemory = 0;
+        qint64 glyphMemoryLimit = 0;
+        quint64 glyphHits = 0;
+        quint64 glyphMisses = 0;
+    };
+
 public:
     KoFontRegistry();
     ~KoFontRegistry();
@@ -73,11 +106,61 @@ public:
                         quint32 yRes,
                         const QMap<QString, qreal> &axisSettings);
 
+    /**
+     * @brief fetchGlyphOutline
+     * Fetches the outline of glyph \p index of \p face loaded with
+     * \p loadFlags from the glyph cache. \p syntheticBold tells whether
+     * the outline has been emboldened.
+     *
+     * Only the faces returned by facesForCSSValues() can be cached, the
+     * key of the cache includes the font file, the size and the variation
+     * settings of the face, so the glyphs are shared between the threads.
+     *
+     * @returns whether the glyph has been found.
+     */
+    bool fetchGlyphOutline(FT_Face face, FT_UInt index, FT_Int32 loadFlags, bool syntheticBold, GlyphOutline *glyph) const;
+
+    /**
+     * @brief storeGlyphOutline
+     * Adds the outline of a glyph to the glyph cache, see fetchGlyphOutline().
+     */
+    void storeGlyphOutline(FT_Face face, FT_UInt index, FT_Int32 loadFlags, bool syntheticBold, const GlyphOutline &glyph);
+
+    /**
+     * @brief setCacheMemoryLimits
+     * Sets the maximum amount of memory used by the cached font matches
+     * and glyph outlines.
+     */
+    void setCacheMemoryLimits(qint64 fontMatchBytes, qint64 glyphBytes);
+
+    /**
+     * @brief cacheStatistics
+     * @returns the current size and efficiency of the font match and
+     * glyph caches.
+     */
+    CacheStatistics cacheStatistics() const;
+
+    /**
+     * @brief clearCaches
+     * Drops all the cached font matches and glyph outlines.
+     */
+    void clearCaches();
+
+    /**
+     * @brief fontSetVersion
+     * @returns a number that changes every time a font is added to the
+     * registry. The text shapes compare it with the version they shaped
+     * their text with to find out whether the cached glyphs are stale.
+     */
+    int fontSetVersion() const;
+
 private:
     class Private;
 
     friend class TestSvgText;
     friend class SvgTextCursorTest;
+    friend class KoSvgTextShapeLayoutBenchmark;
+    friend class TestSvgTextParagraphCache;
 
     /**
      * @brief addFontFilePathToRegistery
@@ -429,6 +429,7 @@ protected:
 
 private:
     friend class TestSvgText;
+    friend class TestSvgTextParagraphCache;
     friend class KoSvgTextLoader;
     /**
      * @brief nextPos
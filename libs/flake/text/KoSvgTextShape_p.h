@@ -23,6 +23,8 @@
 #include <QPointF>
 #include <QRectF>
 #include <QVector>
+#include <QMultiHash>
+#include <QSharedPointer>
 
 #include <variant>
 
@@ -294,6 +296,86 @@ struct SubChunk {
     QSharedPointer<KoShapeBackground> bg;
 };
 
+/**
+ * The properties of a run of text that affect the way it is shaped.
+ * Indices are local to the paragraph.
+ */
+struct ShapingRun {
+    int start = 0;
+    int length = 0;
+    QStringList fontFamilies;
+    QMap<QString, qreal> fontAxisSettings;
+    qreal fontSize = 0.0;
+    qreal fontSizeAdjust = 1.0;
+    int fontWeight = 400;
+    int fontStretch = 100;
+    QFont::Style fontStyle = QFont::StyleNormal;
+    QString language;
+    QStringList fontFeatures;
+    KoSvgText::AutoLengthPercentage letterSpacing;
+    KoSvgText::AutoLengthPercentage wordSpacing;
+    KoSvgText::LineHeightInfo lineHeight;
+
+    bool operator==(const ShapingRun &rhs) const {
+        return start == rhs.start
+            && length == rhs.length
+            && fontFamilies == rhs.fontFamilies
+            && fontAxisSettings == rhs.fontAxisSettings
+            && qFuzzyCompare(fontSize, rhs.fontSize)
+            && qFuzzyCompare(fontSizeAdjust, rhs.fontSizeAdjust)
+            && fontWeight == rhs.fontWeight
+            && fontStretch == rhs.fontStretch
+            && fontStyle == rhs.fontStyle
+            && language == rhs.language
+            && fontFeatures == rhs.fontFeatures
+            && letterSpacing == rhs.letterSpacing
+            && wordSpacing == rhs.wordSpacing
+            && lineHeight == rhs.lineHeight;
+    }
+};
+
+/**
+ * Everything the shaping of a single paragraph depends on. Two paragraphs
+ * with equal keys produce exactly the same glyphs.
+ */
+struct ParagraphShapingKey {
+    QString text;
+    QVector<bool> addressable;
+    QVector<int> runBreaks; ///< arbitrary run breaks caused by absolutely positioned chunks
+    QVector<ShapingRun> runs;
+    QMap<int, KoSvgText::TabSizeInfo> tabSizeInfo;
+    KoSvgText::WritingMode writingMode = KoSvgText::HorizontalTB;
+    KoSvgText::Direction direction = KoSvgText::DirectionLeftToRight;
+    KoSvgTextShape::TextRendering textRendering = KoSvgTextShape::Auto;
+    qreal resolution = 72.0;
+
+    bool operator==(const ParagraphShapingKey &rhs) const {
+        return text == rhs.text
+            && addressable == rhs.addressable
+            && runBreaks == rhs.runBreaks
+            && runs == rhs.runs
+            && tabSizeInfo == rhs.tabSizeInfo
+            && writingMode == rhs.writingMode
+            && direction == rhs.direction
+            && textRendering == rhs.textRendering
+            && qFuzzyCompare(resolution, rhs.resolution);
+    }
+};
+
+/**
+ * The glyphs of a shaped paragraph, i.e. a piece of text ending with a
+ * hard line break. The paragraphs are shaped separately, so that the
+ * ones untouched by an edit can be reused by the next relayout.
+ */
+struct ShapedParagraph {
+    ParagraphShapingKey key;
+    QVector<CharacterResult> result; ///< visualIndex and cssPosition are local to the paragraph
+    int glyphCount = 0;
+    QPointF totalAdvanceFTFontCoordinates;
+};
+
+using ShapedParagraphSP = QSharedPointer<const ShapedParagraph>;
+
 class KRITAFLAKE_EXPORT KoSvgTextShape::Private
 {
 public:
@@ -322,6 +404,8 @@ public:
         xRes = rhs.xRes;
         result = rhs.result;
         lineBoxes = rhs.lineBoxes;
+        shapedParagraphs = rhs.shapedParagraphs;
+        shapedParagraphsFontSetVersion = rhs.shapedParagraphsFontSetVersion;
     };
 
     TextRendering textRendering = Auto;
@@ -344,8 +428,15 @@ public:
     bool isBidi = false;
     QPointF initialTextPosition = QPointF();
 
+    /// The paragraphs shaped during the last relayout, hashed by their text
+    QMultiHash<QString, ShapedParagraphSP> shapedParagraphs;
+    /// KoFontRegistry::fontSetVersion() the paragraphs were shaped with
+    int shapedParagraphsFontSetVersion = -1;
+
     void relayout();
 
+    ShapedParagraphSP shapeParagraph(const ParagraphShapingKey &key) const;
+
     bool loadGlyph(const QTransform &ftTF,
                    const QMap<int, KoSvgText::TabSizeInfo> &tabSizeInfo,
                    FT_Int32 faceLoadFlags,
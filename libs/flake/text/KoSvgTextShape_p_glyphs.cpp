@@ -10,6 +10,7 @@
 
 #include "KisTofuGlyph.h"
 #include "KoFontLibraryResourceUtils.h"
+#include "KoFontRegistry.h"
 
 #include <FlakeDebug.h>
 #include <KoPathShape.h>
@@ -38,6 +39,8 @@
 static QPainterPath convertFromFreeTypeOutline(FT_GlyphSlotRec *glyphSlot);
 static QImage convertFromFreeTypeBitmap(FT_GlyphSlotRec *glyphSlot);
 
+static constexpr int WEIGHT_SEMIBOLD = 600;
+
 static QString glyphFormatToStr(const FT_Glyph_Format _v)
 {
     const unsigned int v = _v;
@@ -54,30 +57,30 @@ static QString glyphFormatToStr(const FT_Glyph_Format _v)
  * bold.
  *
  * @param ftface
- * @param charResult
+ * @param fontWeight
  * @param x_advance Pointer to the X advance to be adjusted if needed.
  * @param y_advance Pointer to the Y advance to be adjusted if needed.
+ * @return the strength the glyph has been emboldened with, zero if it wasn't.
  */
-static void
-emboldenGlyphIfNeeded(const FT_Face ftface, const CharacterResult &charResult, int *x_advance, int *y_advance)
+static FT_Pos
+emboldenGlyphIfNeeded(const FT_Face ftface, const int fontWeight, int *x_advance, int *y_advance)
 {
-    constexpr int WEIGHT_SEMIBOLD = 600;
-    if (charResult.fontWeight >= WEIGHT_SEMIBOLD) {
+    if (fontWeight >= WEIGHT_SEMIBOLD) {
         // Simplest check: Bold fonts don't need to be embolden.
         if (ftface->style_flags & FT_STYLE_FLAG_BOLD) {
-            return;
+            return 0;
         }
 
         // Variable fnots also don't need to be embolden.
         if (FT_HAS_MULTIPLE_MASTERS(ftface)) {
-            return;
+            return 0;
         }
 
         // Some heavy weight classes don't cause FT_STYLE_FLAG_BOLD to be set,
         // so we have to check the OS/2 table for its weight class to be sure.
         if (const TT_OS2 *const os2Table = reinterpret_cast<TT_OS2 *>(FT_Get_Sfnt_Table(ftface, FT_SFNT_OS2));
             os2Table && os2Table->usWeightClass >= WEIGHT_SEMIBOLD) {
-            return;
+            return 0;
         }
 
         // This code is somewhat inspired by Firefox.
@@ -119,7 +122,55 @@ emboldenGlyphIfNeeded(const FT_Face ftface, const CharacterResult &charResult, i
                 *y_advance -= strength;
             }
         }
+        return strength;
+    }
+    return 0;
+}
+
+/**
+ * @brief Load an outline glyph, using the glyph cache of KoFontRegistry.
+ *
+ * When the glyph is not an outline glyph, it is left loaded (and not
+ * emboldened) in the glyph slot of the face, so the caller can handle the
+ * other formats.
+ *
+ * @param ftface
+ * @param index glyph index
+ * @param faceLoadFlags
+ * @param fontWeight the weight used to decide on synthetic bold
+ * @param glyph the loaded outline
+ * @param error the FreeType error, if any
+ * @return whether an outline glyph has been loaded.
+ */
+static bool loadOutlineGlyph(const FT_Face ftface,
+                             const FT_UInt index,
+                             const FT_Int32 faceLoadFlags,
+                             const int fontWeight,
+                             KoFontRegistry::GlyphOutline *glyph,
+                             FT_Error *error)
+{
+    const bool syntheticBold = fontWeight >= WEIGHT_SEMIBOLD;
+    *error = 0;
+
+    if (KoFontRegistry::instance()->fetchGlyphOutline(ftface, index, faceLoadFlags, syntheticBold, glyph)) {
+        return true;
+    }
+
+    if ((*error = FT_Load_Glyph(ftface, index, faceLoadFlags))) {
+        return false;
+    }
+
+    if (ftface->glyph->format != FT_GLYPH_FORMAT_OUTLINE) {
+        return false;
     }
+
+    glyph->advance = QPoint(ftface->glyph->advance.x, ftface->glyph->advance.y);
+    glyph->emboldenStrength = emboldenGlyphIfNeeded(ftface, fontWeight, nullptr, nullptr);
+    glyph->path = convertFromFreeTypeOutline(ftface->glyph);
+
+    KoFontRegistry::instance()->storeGlyphOutline(ftface, index, faceLoadFlags, syntheticBold, *glyph);
+
+    return true;
 }
 
 /**
@@ -221,7 +272,7 @@ public:
         }
         if (m_face->glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
             // Check whether we need to synthesize bold by emboldening the glyph:
-            emboldenGlyphIfNeeded(m_face, charResult, x_advance, y_advance);
+            emboldenGlyphIfNeeded(m_face, charResult.fontWeight, x_advance, y_advance);
 
             const QPainterPath p = convertFromFreeTypeOutline(m_face->glyph);
             return {p, layerColor, isForeGroundColor};
@@ -328,15 +379,24 @@ std::pair<QTransform, qreal> KoSvgTextShape::Private::loadGlyphOnly(const QTrans
         currentGlyph.x_advance = new_x_advance;
         currentGlyph.y_advance = new_y_advance;
     } else {
-        if (const FT_Error err = FT_Load_Glyph(currentGlyph.ftface, currentGlyph.index, faceLoadFlags)) {
+        KoFontRegistry::GlyphOutline outline;
+        FT_Error err = 0;
+        const bool isOutline =
+            loadOutlineGlyph(currentGlyph.ftface, currentGlyph.index, faceLoadFlags, charResult.fontWeight, &outline, &err);
+        if (err) {
             warnFlake << "Failed to load glyph, freetype error" << err;
             return {glyphObliqueTf, bitmapScale};
         }
 
-        // Check whether we need to synthesize bold by emboldening the glyph:
-        emboldenGlyphIfNeeded(currentGlyph.ftface, charResult, &currentGlyph.x_advance, &currentGlyph.y_advance);
+        if (isOutline) {
+            // Account for the synthesized bold the same way emboldenGlyphIfNeeded does
+            if (currentGlyph.x_advance != 0) {
+                currentGlyph.x_advance += outline.emboldenStrength;
+            }
+            if (currentGlyph.y_advance != 0) {
+                currentGlyph.y_advance -= outline.emboldenStrength;
+            }
 
-        if (currentGlyph.ftface->glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
             Glyph::Outline _discard; ///< Storage for discarded outline, must outlive outlineGlyph
             Glyph::Outline *outlineGlyph = std::get_if<Glyph::Outline>(&charResult.glyph);
             if (!outlineGlyph) {
@@ -359,8 +419,7 @@ std::pair<QTransform, qreal> KoSvgTextShape::Private::loadGlyphOnly(const QTrans
             std::tie(outlineGlyphTf, glyphObliqueTf) =
                 calcOutlineGlyphTransform(ftTF, currentGlyph, charResult, isHorizontal);
 
-            QPainterPath glyph = convertFromFreeTypeOutline(currentGlyph.ftface->glyph);
-            glyph = outlineGlyphTf.map(glyph);
+            QPainterPath glyph = outlineGlyphTf.map(outline.path);
 
             if (charResult.visualIndex > -1) {
                 // this is for glyph clusters, unicode combining marks are always
@@ -372,6 +431,9 @@ std::pair<QTransform, qreal> KoSvgTextShape::Private::loadGlyphOnly(const QTrans
                 outlineGlyph->path = glyph;
             }
         } else {
+            // Check whether we need to synthesize bold by emboldening the glyph:
+            emboldenGlyphIfNeeded(currentGlyph.ftface, charResult.fontWeight, &currentGlyph.x_advance, &currentGlyph.y_advance);
+
             QTransform bitmapTf;
 
             if (currentGlyph.ftface->glyph->format == FT_GLYPH_FORMAT_BITMAP) {
@@ -479,8 +541,13 @@ bool KoSvgTextShape::Private::loadGlyph(const QTransform &ftTF,
 
     QPointF spaceAdvance;
     if (tabSizeInfo.contains(cluster)) {
-        FT_Load_Glyph(currentGlyph.ftface, FT_Get_Char_Index(currentGlyph.ftface, ' '), faceLoadFlags);
-        spaceAdvance = QPointF(currentGlyph.ftface->glyph->advance.x, currentGlyph.ftface->glyph->advance.y);
+        KoFontRegistry::GlyphOutline space;
+        FT_Error err = 0;
+        if (loadOutlineGlyph(currentGlyph.ftface, FT_Get_Char_Index(currentGlyph.ftface, ' '), faceLoadFlags, 400, &space, &err)) {
+            spaceAdvance = space.advance;
+        } else {
+            spaceAdvance = QPointF(currentGlyph.ftface->glyph->advance.x, currentGlyph.ftface->glyph->advance.y);
+        }
     }
 
     /// The matrix for Italic (oblique) synthesis of outline glyphs, or for
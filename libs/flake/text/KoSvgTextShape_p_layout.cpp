@@ -92,6 +92,39 @@ static QMap<int, int> logicalToVisualCursorPositions(const QVector<CursorPos> &c
 }
 
 
+/**
+ * @brief shapingRunForProperties
+ * Collect the properties that affect shaping of a run of text, \p start is
+ * local to the paragraph the run belongs to.
+ */
+static ShapingRun shapingRunForProperties(const KoSvgTextProperties &properties, int start, int length)
+{
+    ShapingRun run;
+    run.start = start;
+    run.length = length;
+    run.fontFamilies = properties.property(KoSvgTextProperties::FontFamiliesId).toStringList();
+    run.fontAxisSettings = properties.fontAxisSettings();
+    run.fontSize = properties.fontSize().value;
+
+    KoSvgText::AutoValue fontSizeAdjust = properties.propertyOrDefault(KoSvgTextProperties::FontSizeAdjustId).value<KoSvgText::AutoValue>();
+    if (properties.hasProperty(KoSvgTextProperties::KraTextVersionId)) {
+        fontSizeAdjust.isAuto = (properties.property(KoSvgTextProperties::KraTextVersionId).toInt() < 3);
+    }
+    run.fontSizeAdjust = fontSizeAdjust.isAuto ? 1.0 : fontSizeAdjust.customValue;
+
+    run.fontWeight = properties.propertyOrDefault(KoSvgTextProperties::FontWeightId).toInt();
+    run.fontStretch = properties.propertyOrDefault(KoSvgTextProperties::FontStretchId).toInt();
+    run.fontStyle = QFont::Style(properties.propertyOrDefault(KoSvgTextProperties::FontStyleId).toInt());
+    if (properties.hasProperty(KoSvgTextProperties::TextLanguage)) {
+        run.language = properties.property(KoSvgTextProperties::TextLanguage).toString();
+    }
+    run.fontFeatures = properties.fontFeaturesForText(start, length);
+    run.letterSpacing = properties.propertyOrDefault(KoSvgTextProperties::LetterSpacingId).value<KoSvgText::AutoLengthPercentage>();
+    run.wordSpacing = properties.propertyOrDefault(KoSvgTextProperties::WordSpacingId).value<KoSvgText::AutoLengthPercentage>();
+    run.lineHeight = properties.propertyOrDefault(KoSvgTextProperties::LineHeightId).value<KoSvgText::LineHeightInfo>();
+    return run;
+}
+
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
 void KoSvgTextShape::Private::relayout()
 {
@@ -114,48 +147,12 @@ void KoSvgTextShape::Private::relayout()
 
     const bool isHorizontal = writingMode == KoSvgText::HorizontalTB;
 
-    FT_Int32 loadFlags = 0;
-    if (this->textRendering == GeometricPrecision || this->textRendering == Auto) {
-        // without load_no_hinting, the advance and offset will be rounded
-        // to nearest pixel, which we don't want as we're using the vector
-        // outline.
-        loadFlags |= FT_LOAD_NO_HINTING;
-
-        // Disable embedded bitmaps because they _do not_ follow geometric
-        // precision, but is focused on legibility.
-        // This does not affect bitmap-only fonts.
-        loadFlags |= FT_LOAD_NO_BITMAP;
-    } else {
-        // When using hinting, sometimes the bounding box does not encompass the
-        // drawn glyphs properly.
-        // The default hinting works best for vertical, while the 'light'
-        // hinting mode works best for horizontal.
-        if (isHorizontal) {
-            loadFlags |= FT_LOAD_TARGET_LIGHT;
-        }
-    }
-    const auto loadFlagsForFace = [loadFlags, isHorizontal](FT_Face face) -> FT_Int32 {
-        FT_Int32 faceLoadFlags = loadFlags;
-        if (FT_HAS_COLOR(face)) {
-            faceLoadFlags |= FT_LOAD_COLOR;
-        }
-        if (!isHorizontal && FT_HAS_VERTICAL(face)) {
-            faceLoadFlags |= FT_LOAD_VERTICAL_LAYOUT;
-        }
-        if (!FT_IS_SCALABLE(face)) {
-            // This is needed for the CBDT version of Noto Color Emoji
-            faceLoadFlags &= ~FT_LOAD_NO_BITMAP;
-        }
-        return faceLoadFlags;
-    };
-
     // Whenever the freetype docs talk about a 26.6 floating point unit, they
     // mean a 1/64 value.
     const qreal ftFontUnit = 64.0;
     const qreal ftFontUnitFactor = 1 / ftFontUnit;
     const qreal finalRes = qMin(this->xRes, this->yRes);
     const qreal scaleToPT = 72. / finalRes;
-    const qreal scaleToPixel = finalRes / 72.;
     const QTransform dpiScale = QTransform::fromScale(scaleToPT, scaleToPT);
     const QTransform ftTF = QTransform::fromScale(ftFontUnitFactor, -ftFontUnitFactor) * dpiScale;
 
@@ -256,387 +253,268 @@ void KoSvgTextShape::Private::relayout()
 
     QMap<int, KoSvgText::TabSizeInfo> tabSizeInfo;
 
-    // pass everything to a css-compatible text-layout algortihm.
-    raqm_t_sp layout(raqm_create());
-
-    if (raqm_set_text_utf16(layout.data(), text.utf16(), static_cast<size_t>(text.size()))) {
-        if (writingMode == KoSvgText::VerticalRL || writingMode == KoSvgText::VerticalLR) {
-            raqm_set_par_direction(layout.data(), raqm_direction_t::RAQM_DIRECTION_TTB);
-        } else if (direction == KoSvgText::DirectionRightToLeft) {
-            raqm_set_par_direction(layout.data(), raqm_direction_t::RAQM_DIRECTION_RTL);
-        } else {
-            raqm_set_par_direction(layout.data(), raqm_direction_t::RAQM_DIRECTION_LTR);
+    int start = 0;
+    Q_FOREACH (const SubChunk &chunk, textChunks) {
+        const int length = chunk.text.size();
+        const KoSvgTextProperties &properties = chunk.inheritedProps;
+
+        // In this section we retrieve the resolved transforms and
+        // direction/anchoring that we can get from the subchunks.
+        KoSvgText::TextAnchor anchor = KoSvgText::TextAnchor(properties.propertyOrDefault(KoSvgTextProperties::TextAnchorId).toInt());
+        KoSvgText::Direction direction = KoSvgText::Direction(properties.propertyOrDefault(KoSvgTextProperties::DirectionId).toInt());
+        KoSvgText::WordBreak wordBreakStrictness = KoSvgText::WordBreak(properties.propertyOrDefault(KoSvgTextProperties::WordBreakId).toInt());
+        KoSvgText::HangingPunctuations hang =
+            properties.propertyOrDefault(KoSvgTextProperties::HangingPunctuationId).value<KoSvgText::HangingPunctuations>();
+        KoSvgText::TabSizeInfo tabInfo = properties.propertyOrDefault(KoSvgTextProperties::TabSizeId).value<KoSvgText::TabSizeInfo>();
+        KoSvgText::AutoLengthPercentage letterSpacing = properties.propertyOrDefault(KoSvgTextProperties::LetterSpacingId).value<KoSvgText::AutoLengthPercentage>();
+        KoSvgText::AutoLengthPercentage wordSpacing = properties.propertyOrDefault(KoSvgTextProperties::WordSpacingId).value<KoSvgText::AutoLengthPercentage>();
+        bool overflowWrap = KoSvgText::OverflowWrap(properties.propertyOrDefault(KoSvgTextProperties::OverflowWrapId).toInt()) != KoSvgText::OverflowWrapNormal;
+
+        KoColorBackground *b = dynamic_cast<KoColorBackground *>(chunk.bg.data());
+        QColor fillColor;
+        if (b)
+        {
+            fillColor = b->color();
+        }
+        if (!letterSpacing.isAuto) {
+            tabInfo.extraSpacing += letterSpacing.length.value;
+        }
+        if (!wordSpacing.isAuto) {
+            tabInfo.extraSpacing += wordSpacing.length.value;
         }
 
-        int start = 0;
-        Q_FOREACH (const SubChunk &chunk, textChunks) {
-            int length = chunk.text.size();
-            KoSvgTextProperties properties = chunk.inheritedProps;
-
-            // In this section we retrieve the resolved transforms and
-            // direction/anchoring that we can get from the subchunks.
-            KoSvgText::TextAnchor anchor = KoSvgText::TextAnchor(properties.propertyOrDefault(KoSvgTextProperties::TextAnchorId).toInt());
-            KoSvgText::Direction direction = KoSvgText::Direction(properties.propertyOrDefault(KoSvgTextProperties::DirectionId).toInt());
-            KoSvgText::WordBreak wordBreakStrictness = KoSvgText::WordBreak(properties.propertyOrDefault(KoSvgTextProperties::WordBreakId).toInt());
-            KoSvgText::HangingPunctuations hang =
-                properties.propertyOrDefault(KoSvgTextProperties::HangingPunctuationId).value<KoSvgText::HangingPunctuations>();
-            KoSvgText::TabSizeInfo tabInfo = properties.propertyOrDefault(KoSvgTextProperties::TabSizeId).value<KoSvgText::TabSizeInfo>();
-            KoSvgText::AutoLengthPercentage letterSpacing = properties.propertyOrDefault(KoSvgTextProperties::LetterSpacingId).value<KoSvgText::AutoLengthPercentage>();
-            KoSvgText::AutoLengthPercentage wordSpacing = properties.propertyOrDefault(KoSvgTextProperties::WordSpacingId).value<KoSvgText::AutoLengthPercentage>();
-            KoSvgText::LineHeightInfo lineHeight = properties.propertyOrDefault(KoSvgTextProperties::LineHeightId).value<KoSvgText::LineHeightInfo>();
-            bool overflowWrap = KoSvgText::OverflowWrap(properties.propertyOrDefault(KoSvgTextProperties::OverflowWrapId).toInt()) != KoSvgText::OverflowWrapNormal;
-
-            KoColorBackground *b = dynamic_cast<KoColorBackground *>(chunk.bg.data());
-            QColor fillColor;
-            if (b)
-            {
-                fillColor = b->color();
-            }
-            if (!letterSpacing.isAuto) {
-                tabInfo.extraSpacing += letterSpacing.length.value;
-            }
-            if (!wordSpacing.isAuto) {
-                tabInfo.extraSpacing += wordSpacing.length.value;
-            }
-
-            for (int i = 0; i < length; i++) {
-                CharacterResult cr = result[start + i];
-                cr.anchor = anchor;
-                cr.direction = direction;
-                QPair<bool, bool> canJustify = justify.value(start + i, QPair<bool, bool>(false, false));
-                cr.justifyBefore = canJustify.first;
-                cr.justifyAfter = canJustify.second;
-                cr.overflowWrap = overflowWrap;
-                if (lineBreaks[start + i] == LINEBREAK_MUSTBREAK) {
-                    cr.breakType = BreakType::HardBreak;
+        for (int i = 0; i < length; i++) {
+            CharacterResult cr = result[start + i];
+            cr.anchor = anchor;
+            cr.direction = direction;
+            QPair<bool, bool> canJustify = justify.value(start + i, QPair<bool, bool>(false, false));
+            cr.justifyBefore = canJustify.first;
+            cr.justifyAfter = canJustify.second;
+            cr.overflowWrap = overflowWrap;
+            if (lineBreaks[start + i] == LINEBREAK_MUSTBREAK) {
+                cr.breakType = BreakType::HardBreak;
+                cr.lineEnd = LineEdgeBehaviour::Collapse;
+                cr.lineStart = LineEdgeBehaviour::Collapse;
+            } else if (lineBreaks[start + i] == LINEBREAK_ALLOWBREAK && wrap != KoSvgText::NoWrap) {
+                cr.breakType = BreakType::SoftBreak;
+
+                if (KoCssTextUtils::collapseLastSpace(text.at(start + i), collapse)) {
                     cr.lineEnd = LineEdgeBehaviour::Collapse;
                     cr.lineStart = LineEdgeBehaviour::Collapse;
-                } else if (lineBreaks[start + i] == LINEBREAK_ALLOWBREAK && wrap != KoSvgText::NoWrap) {
-                    cr.breakType = BreakType::SoftBreak;
-
-                    if (KoCssTextUtils::collapseLastSpace(text.at(start + i), collapse)) {
-                        cr.lineEnd = LineEdgeBehaviour::Collapse;
-                        cr.lineStart = LineEdgeBehaviour::Collapse;
-                    }
                 }
-                if (cr.lineEnd != LineEdgeBehaviour::Collapse) {
-                    const auto isFollowedByForcedLineBreak = [&]() {
-                        if (result.size() <= start + i + 1) {
-                            // End of the text block, consider it a forced line break
-                            return true;
-                        }
-                        if (lineBreaks[start + i+ 1] == LINEBREAK_MUSTBREAK) {
-                            // Next character is a forced line break
-                            return true;
-                        }
-                        if (resolvedTransforms.at(start + i + 1).startsNewChunk()) {
-                            // Next character is another chunk, consider it a forced line break
-                            return true;
-                        }
-                        return false;
-                    };
-                    bool forceHang = false;
-                    if (KoCssTextUtils::hangLastSpace(text.at(start + i), collapse, wrap, forceHang, isFollowedByForcedLineBreak())) {
-                        cr.lineEnd = forceHang? LineEdgeBehaviour::ForceHang: LineEdgeBehaviour::ConditionallyHang;
-
+            }
+            if (cr.lineEnd != LineEdgeBehaviour::Collapse) {
+                const auto isFollowedByForcedLineBreak = [&]() {
+                    if (result.size() <= start + i + 1) {
+                        // End of the text block, consider it a forced line break
+                        return true;
                     }
-                }
-
-                if ((wordBreakStrictness == KoSvgText::WordBreakBreakAll ||
-                     linebreakStrictness == KoSvgText::LineBreakAnywhere)
-                        && wrap != KoSvgText::NoWrap) {
-                    if (graphemeBreaks[start + i] == GRAPHEMEBREAK_BREAK && cr.breakType == BreakType::NoBreak) {
-                        cr.breakType = BreakType::SoftBreak;
+                    if (lineBreaks[start + i+ 1] == LINEBREAK_MUSTBREAK) {
+                        // Next character is a forced line break
+                        return true;
                     }
-                }
-                if (cr.lineStart != LineEdgeBehaviour::Collapse && hang.testFlag(KoSvgText::HangFirst)) {
-                    cr.lineStart = KoCssTextUtils::characterCanHang(text.at(start + i), KoSvgText::HangFirst)
-                        ? LineEdgeBehaviour::ForceHang
-                        : cr.lineEnd;
-                }
-                if (cr.lineEnd != LineEdgeBehaviour::Collapse) {
-                    if (hang.testFlag(KoSvgText::HangLast)) {
-                        cr.lineEnd = KoCssTextUtils::characterCanHang(text.at(start + i), KoSvgText::HangLast)
-                            ? LineEdgeBehaviour::ForceHang
-                            : cr.lineEnd;
-                    }
-                    if (hang.testFlag(KoSvgText::HangEnd)) {
-                        LineEdgeBehaviour edge = hang.testFlag(KoSvgText::HangForce)
-                            ? LineEdgeBehaviour::ForceHang
-                            : LineEdgeBehaviour::ConditionallyHang;
-                        cr.lineEnd = KoCssTextUtils::characterCanHang(text.at(start + i), KoSvgText::HangEnd) ? edge : cr.lineEnd;
+                    if (resolvedTransforms.at(start + i + 1).startsNewChunk()) {
+                        // Next character is another chunk, consider it a forced line break
+                        return true;
                     }
-                }
-
-                cr.cursorInfo.isWordBoundary = (wordBreaks[start + i] == WORDBREAK_BREAK);
-                cr.cursorInfo.color = fillColor;
-
-                if (text.at(start + i) == QChar::Tabulation) {
-                    tabSizeInfo.insert(start + i, tabInfo);
-                }
+                    return false;
+                };
+                bool forceHang = false;
+                if (KoCssTextUtils::hangLastSpace(text.at(start + i), collapse, wrap, forceHang, isFollowedByForcedLineBreak())) {
+                    cr.lineEnd = forceHang? LineEdgeBehaviour::ForceHang: LineEdgeBehaviour::ConditionallyHang;
 
-                if (resolvedTransforms.at(start + i).startsNewChunk()) {
-                    raqm_set_arbitrary_run_break(layout.data(), static_cast<size_t>(start + i), true);
                 }
-
-                if (chunk.firstTextInPath && i == 0) {
-                    cr.anchored_chunk = true;
-                }
-                result[start + i] = cr;
-            }
-
-            QVector<int> lengths;
-            QStringList fontFeatures = properties.fontFeaturesForText(start, length);
-
-            qreal fontSize = properties.fontSize().value;
-            const QFont::Style style = QFont::Style(properties.propertyOrDefault(KoSvgTextProperties::FontStyleId).toInt());
-            KoSvgText::AutoValue fontSizeAdjust = properties.propertyOrDefault(KoSvgTextProperties::FontSizeAdjustId).value<KoSvgText::AutoValue>();
-            if (properties.hasProperty(KoSvgTextProperties::KraTextVersionId)) {
-                fontSizeAdjust.isAuto = (properties.property(KoSvgTextProperties::KraTextVersionId).toInt() < 3);
-            }
-            const std::vector<FT_FaceSP> faces = KoFontRegistry::instance()->facesForCSSValues(
-                properties.property(KoSvgTextProperties::FontFamiliesId).toStringList(),
-                lengths,
-                properties.fontAxisSettings(),
-                chunk.text,
-                static_cast<quint32>(finalRes),
-                static_cast<quint32>(finalRes),
-                fontSize,
-                fontSizeAdjust.isAuto ? 1.0 : fontSizeAdjust.customValue,
-                properties.propertyOrDefault(KoSvgTextProperties::FontWeightId).toInt(),
-                properties.propertyOrDefault(KoSvgTextProperties::FontStretchId).toInt(),
-                style != QFont::StyleNormal);
-            if (properties.hasProperty(KoSvgTextProperties::TextLanguage)) {
-                raqm_set_language(layout.data(),
-                                  properties.property(KoSvgTextProperties::TextLanguage).toString().toUtf8(),
-                                  static_cast<size_t>(start),
-                                  static_cast<size_t>(length));
-            }
-            Q_FOREACH (const QString &feature, fontFeatures) {
-                debugFlake << "adding feature" << feature;
-                raqm_add_font_feature(layout.data(), feature.toUtf8(), feature.toUtf8().size());
             }
 
-            if (!letterSpacing.isAuto) {
-                raqm_set_letter_spacing_range(layout.data(),
-                                              static_cast<int>(letterSpacing.length.value * ftFontUnit * scaleToPixel),
-                                              static_cast<size_t>(start),
-                                              static_cast<size_t>(length));
+            if ((wordBreakStrictness == KoSvgText::WordBreakBreakAll ||
+                 linebreakStrictness == KoSvgText::LineBreakAnywhere)
+                    && wrap != KoSvgText::NoWrap) {
+                if (graphemeBreaks[start + i] == GRAPHEMEBREAK_BREAK && cr.breakType == BreakType::NoBreak) {
+                    cr.breakType = BreakType::SoftBreak;
+                }
             }
-
-            if (!wordSpacing.isAuto) {
-                raqm_set_word_spacing_range(layout.data(),
-                                            static_cast<int>(wordSpacing.length.value * ftFontUnit * scaleToPixel),
-                                            static_cast<size_t>(start),
-                                            static_cast<size_t>(length));
+            if (cr.lineStart != LineEdgeBehaviour::Collapse && hang.testFlag(KoSvgText::HangFirst)) {
+                cr.lineStart = KoCssTextUtils::characterCanHang(text.at(start + i), KoSvgText::HangFirst)
+                    ? LineEdgeBehaviour::ForceHang
+                    : cr.lineEnd;
             }
-
-            for (int i = 0; i < lengths.size(); i++) {
-                length = lengths.at(i);
-                const FT_FaceSP &face = faces.at(static_cast<size_t>(i));
-                const FT_Int32 faceLoadFlags = loadFlagsForFace(face.data());
-                if (start == 0) {
-                    raqm_set_freetype_face(layout.data(), face.data());
-                    raqm_set_freetype_load_flags(layout.data(), faceLoadFlags);
+            if (cr.lineEnd != LineEdgeBehaviour::Collapse) {
+                if (hang.testFlag(KoSvgText::HangLast)) {
+                    cr.lineEnd = KoCssTextUtils::characterCanHang(text.at(start + i), KoSvgText::HangLast)
+                        ? LineEdgeBehaviour::ForceHang
+                        : cr.lineEnd;
                 }
-                if (length > 0) {
-                    raqm_set_freetype_face_range(layout.data(),
-                                                 face.data(),
-                                                 static_cast<size_t>(start),
-                                                 static_cast<size_t>(length));
-                    raqm_set_freetype_load_flags_range(layout.data(),
-                                                       faceLoadFlags,
-                                                       static_cast<size_t>(start),
-                                                       static_cast<size_t>(length));
+                if (hang.testFlag(KoSvgText::HangEnd)) {
+                    LineEdgeBehaviour edge = hang.testFlag(KoSvgText::HangForce)
+                        ? LineEdgeBehaviour::ForceHang
+                        : LineEdgeBehaviour::ConditionallyHang;
+                    cr.lineEnd = KoCssTextUtils::characterCanHang(text.at(start + i), KoSvgText::HangEnd) ? edge : cr.lineEnd;
                 }
+            }
 
-                hb_font_t_sp font(hb_ft_font_create_referenced(face.data()));
-                hb_position_t ascender = 0;
-                hb_position_t descender = 0;
-                hb_position_t lineGap = 0;
-
-                if (isHorizontal) {
-                    /**
-                     * There's 3 different definitions of the so-called vertical metrics, that is,
-                     * the ascender and descender for horizontally laid out script. WinAsc & Desc,
-                     * HHAE asc&desc, and OS/2... we need the last one, but harfbuzz doesn't return
-                     * it unless there's a flag set in the font, which is missing in a lot of fonts
-                     * that were from the transitional period, like Deja Vu Sans. Hence we need to get
-                     * the OS/2 table and calculate the values manually (and fall back in various ways).
-                     *
-                     * https://www.w3.org/TR/css-inline-3/#ascent-descent
-                     * https://www.w3.org/TR/CSS2/visudet.html#sTypoAscender
-                     * https://wiki.inkscape.org/wiki/Text_Rendering_Notes#Ascent_and_Descent
-                     *
-                     * Related HB issue: https://github.com/harfbuzz/harfbuzz/issues/1920
-                     */
-                    TT_OS2 *os2Table = nullptr;
-                    os2Table = (TT_OS2*)FT_Get_Sfnt_Table(face.data(), FT_SFNT_OS2);
-                    if (os2Table) {
-                        int yscale = face.data()->size->metrics.y_scale;
-
-                        ascender = FT_MulFix(os2Table->sTypoAscender, yscale);
-                        descender = FT_MulFix(os2Table->sTypoDescender, yscale);
-                        lineGap = FT_MulFix(os2Table->sTypoLineGap, yscale);
-                    }
-
-                    constexpr unsigned USE_TYPO_METRICS = 1u << 7;
-                    if (!os2Table || os2Table->version == 0xFFFFU || !(os2Table->fsSelection & USE_TYPO_METRICS)) {
-                        hb_position_t altAscender = 0;
-                        hb_position_t altDescender = 0;
-                        hb_position_t altLineGap = 0;
-                        if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER, &altAscender)) {
-                            altAscender = face.data()->ascender;
-                        }
-                        if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_DESCENDER, &altDescender)) {
-                            altDescender = face.data()->descender;
-                        }
-                        if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP, &altLineGap)) {
-                            altLineGap = face.data()->height - (altAscender-altDescender);
-                        }
+            cr.cursorInfo.isWordBoundary = (wordBreaks[start + i] == WORDBREAK_BREAK);
+            cr.cursorInfo.color = fillColor;
 
-                        // Some fonts have sTypo metrics that are too small compared
-                        // to the HHEA values which make the default line height too
-                        // tight (e.g. Microsoft JhengHei, Source Han Sans), so we
-                        // compare them and take the ones that are larger.
-                        if (!os2Table || (altAscender - altDescender + altLineGap) > (ascender - descender + lineGap)) {
-                            ascender = altAscender;
-                            descender = altDescender;
-                            lineGap = altLineGap;
-                        }
-                    }
-                } else {
-                    hb_font_extents_t fontExtends;
-                    hb_font_get_extents_for_direction (font.data(), HB_DIRECTION_TTB, &fontExtends);
-                    if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_ASCENDER, &ascender)) {
-                        ascender = fontExtends.ascender;
-                    }
-                    if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_DESCENDER, &descender)) {
-                        descender = fontExtends.descender;
-                    }
-                    if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_LINE_GAP, &lineGap)) {
-                        lineGap = 0;
-                    }
-                    // Default microsoft CJK fonts have the vertical ascent and descent be the same as the horizontal
-                    // ascent and descent, so we 'normalize' the ascender and descender to be half the total height.
-                    qreal height = ascender - fontExtends.descender;
-                    ascender = height*0.5;
-                    descender = -ascender;
-                }
-                if (ascender == 0 && descender == 0) {
-                    ascender = face->size->metrics.ascender;
-                    descender = face->size->metrics.descender;
-                    qreal height = ascender - descender;
-                    lineGap = face->size->metrics.height - height;
-                    if (!isHorizontal) {
-                        ascender = height * 0.5;
-                        descender = -ascender;
-                    }
-                }
+            if (text.at(start + i) == QChar::Tabulation) {
+                tabSizeInfo.insert(start + i, tabInfo);
+            }
 
-                for (int j=start; j<start+length; j++) {
-                    result[j].fontAscent = ascender;
-                    result[j].fontDescent = descender;
-                    qreal leading = lineGap;
 
-                    if (!lineHeight.isNormal) {
-                        if (lineHeight.isNumber) {
-                            leading = (fontSize*scaleToPixel*ftFontUnit)*lineHeight.value;
-                            leading -= (ascender-descender);
-                        } else {
-                            QPointF val = ftTF.inverted().map(QPointF(lineHeight.length.value, lineHeight.length.value));
-                            leading = isHorizontal? val.x(): val.y();
-                            leading -= (ascender-descender);
-                        }
-                    }
-                    result[j].fontHalfLeading = leading * 0.5;
-                    result[j].fontStyle = style;
-                    result[j].fontWeight = properties.propertyOrDefault(KoSvgTextProperties::FontWeightId).toInt();
-                }
-
-                start += length;
+            if (chunk.firstTextInPath && i == 0) {
+                cr.anchored_chunk = true;
             }
+            result[start + i] = cr;
         }
-        debugFlake << "text-length:" << text.size();
+        start += length;
     }
+    debugFlake << "text-length:" << text.size();
+
     // set very first character as anchored chunk.
     if (!result.empty()) {
         result[0].anchored_chunk = true;
     }
 
-    if (raqm_layout(layout.data())) {
-        debugFlake << "layout succeeded";
+    if (text.isEmpty()) {
+        this->shapedParagraphs.clear();
+        return;
     }
 
-    // 2. Set flags and assign initial positions
-    // We also retreive a glyph path here.
-    size_t count = 0;
-    const raqm_glyph_t *glyphs = raqm_get_glyphs(layout.data(), &count);
-    if (!glyphs) {
-        return;
+    // 2. Shape the text, set flags and assign initial positions.
+    // Every paragraph (the text up to and including a hard break) is shaped
+    // separately, and the paragraphs whose text and font properties didn't
+    // change since the previous relayout are reused as they are. This way
+    // typing in a long text only reshapes the paragraph being edited.
+    //
+    // Every paragraph is a separate bidi paragraph now, like UAX #9 wants
+    // it for the preserved line feeds (class B). The neutral and weak
+    // characters at the edges of a paragraph are resolved against the base
+    // direction instead of the strong characters of the neighbouring
+    // paragraph, so in mixed bidi text their order may differ from the one
+    // we got when the whole text was a single raqm paragraph.
+    //
+    // The positions of the paragraphs are accumulated in logical order,
+    // while the single raqm paragraph accumulated them in visual order.
+    // That only matters until breakLines(), which puts every line (a line
+    // never crosses a hard break) at its own position in visual order.
+    const int fontSetVersion = KoFontRegistry::instance()->fontSetVersion();
+    if (this->shapedParagraphsFontSetVersion != fontSetVersion) {
+        this->shapedParagraphs.clear();
+        this->shapedParagraphsFontSetVersion = fontSetVersion;
     }
 
+    QMultiHash<QString, ShapedParagraphSP> shapedParagraphs;
     QPointF totalAdvanceFTFontCoordinates;
     QMap<int, int> logicalToVisual;
+    int visualIndexOffset = 0;
     this->isBidi = false;
 
+    int chunkIndex = 0;
+    int chunkStart = 0;
+    int paragraphStart = 0;
 
-    KIS_ASSERT(count <= INT32_MAX);
-
-    for (int i = 0; i < static_cast<int>(count); i++) {
-        raqm_glyph_t currentGlyph = glyphs[i];
-        KIS_ASSERT(currentGlyph.cluster <= INT32_MAX);
-        const int cluster = static_cast<int>(currentGlyph.cluster);
-        if (!result[cluster].addressable) {
-            continue;
+    while (paragraphStart < text.size()) {
+        int paragraphEnd = paragraphStart;
+        while (paragraphEnd < text.size() - 1 && lineBreaks[paragraphEnd] != LINEBREAK_MUSTBREAK) {
+            paragraphEnd++;
         }
-        CharacterResult charResult = result[cluster];
-
-        const FT_Int32 faceLoadFlags = loadFlagsForFace(currentGlyph.ftface);
-
-        const auto getUcs4At = [](const QString &s, int i) -> char32_t {
-            const QChar high = s.at(i);
-            if (!high.isSurrogate()) {
-                return high.unicode();
+        paragraphEnd++;
+
+        ParagraphShapingKey key;
+        key.text = text.mid(paragraphStart, paragraphEnd - paragraphStart);
+        key.writingMode = writingMode;
+        key.direction = direction;
+        key.textRendering = this->textRendering;
+        key.resolution = finalRes;
+        key.addressable.resize(key.text.size());
+
+        for (int i = paragraphStart; i < paragraphEnd; i++) {
+            key.addressable[i - paragraphStart] = result.at(i).addressable;
+            if (resolvedTransforms.at(i).startsNewChunk()) {
+                key.runBreaks.append(i - paragraphStart);
             }
-            if (high.isHighSurrogate() && s.length() > i + 1) {
-                const QChar low = s[i + 1];
-                if (low.isLowSurrogate()) {
-                    return QChar::surrogateToUcs4(high, low);
-                }
+            if (tabSizeInfo.contains(i)) {
+                key.tabSizeInfo.insert(i - paragraphStart, tabSizeInfo.value(i));
             }
-            // Don't return U+FFFD replacement character but return the
-            // unpaired surrogate itself, so that if we want to we can draw
-            // a tofu block for it.
-            return high.unicode();
-        };
-        const char32_t codepoint = getUcs4At(text, cluster);
-        debugFlake << "glyph" << i << "cluster" << cluster << currentGlyph.index << codepoint;
+        }
 
-        charResult.cursorInfo.rtl = raqm_get_direction_at_index(layout.data(), cluster) == RAQM_DIRECTION_RTL;
-        if (charResult.cursorInfo.rtl != (charResult.direction == KoSvgText::DirectionRightToLeft)) {
-            this->isBidi = true;
+        while (chunkIndex < textChunks.size() &&
+               chunkStart + textChunks.at(chunkIndex).text.size() <= paragraphStart) {
+
+            chunkStart += textChunks.at(chunkIndex).text.size();
+            chunkIndex++;
         }
 
-        if (!this->loadGlyph(ftTF,
-                             tabSizeInfo,
-                             faceLoadFlags,
-                             isHorizontal,
-                             codepoint,
-                             currentGlyph,
-                             charResult,
-                             totalAdvanceFTFontCoordinates)) {
-            continue;
+        for (int i = chunkIndex, runChunkStart = chunkStart;
+             i < textChunks.size() && runChunkStart < paragraphEnd; i++) {
+
+            const SubChunk &chunk = textChunks.at(i);
+            const int runStart = qMax(runChunkStart, paragraphStart);
+            const int runEnd = qMin(runChunkStart + chunk.text.size(), paragraphEnd);
+
+            if (runStart < runEnd) {
+                key.runs.append(shapingRunForProperties(chunk.inheritedProps,
+                                                        runStart - paragraphStart,
+                                                        runEnd - runStart));
+            }
+            runChunkStart += chunk.text.size();
         }
 
-        charResult.visualIndex = i;
-        logicalToVisual.insert(cluster, i);
+        ShapedParagraphSP paragraph;
+        for (auto it = this->shapedParagraphs.constFind(key.text);
+             it != this->shapedParagraphs.constEnd() && it.key() == key.text; ++it) {
 
-        charResult.middle = false;
+            if (it.value()->key == key) {
+                paragraph = it.value();
+                break;
+            }
+        }
 
-        result[cluster] = charResult;
+        if (!paragraph) {
+            paragraph = shapeParagraph(key);
+        }
+        shapedParagraphs.insert(key.text, paragraph);
+
+        const QPointF paragraphOffset = ftTF.map(totalAdvanceFTFontCoordinates);
+
+        for (int i = paragraphStart; i < paragraphEnd; i++) {
+            const CharacterResult &shaped = paragraph->result.at(i - paragraphStart);
+            CharacterResult &cr = result[i];
+
+            cr.glyph = shaped.glyph;
+            cr.advance = shaped.advance;
+            cr.boundingBox = shaped.boundingBox;
+            cr.fontAscent = shaped.fontAscent;
+            cr.fontDescent = shaped.fontDescent;
+            cr.fontHalfLeading = shaped.fontHalfLeading;
+            cr.fontStyle = shaped.fontStyle;
+            cr.fontWeight = shaped.fontWeight;
+            cr.scaledAscent = shaped.scaledAscent;
+            cr.scaledDescent = shaped.scaledDescent;
+            cr.scaledHalfLeading = shaped.scaledHalfLeading;
+            cr.lineHeightBox = shaped.lineHeightBox;
+            cr.cursorInfo.caret = shaped.cursorInfo.caret;
+            cr.cursorInfo.offsets = shaped.cursorInfo.offsets;
+            cr.cursorInfo.rtl = shaped.cursorInfo.rtl;
+
+            if (shaped.visualIndex > -1) {
+                cr.visualIndex = shaped.visualIndex + visualIndexOffset;
+                cr.cssPosition = shaped.cssPosition + paragraphOffset;
+                cr.middle = false;
+                logicalToVisual.insert(i, cr.visualIndex);
+
+                if (cr.cursorInfo.rtl != (cr.direction == KoSvgText::DirectionRightToLeft)) {
+                    this->isBidi = true;
+                }
+            }
+        }
+
+        visualIndexOffset += paragraph->glyphCount;
+        totalAdvanceFTFontCoordinates += paragraph->totalAdvanceFTFontCoordinates;
+        paragraphStart = paragraphEnd;
     }
 
+    this->shapedParagraphs = shapedParagraphs;
+
     // fix it so that characters that are in the 'middle' due to either being
     // surrogates or part of a ligature, are marked as such. Also set the css
     // position so that anchoring will work correctly later.
@@ -918,6 +796,322 @@ void KoSvgTextShape::Private::relayout()
     this->logicalToVisualCursorPos = logicalToVisualCursorPositions(cursorPos, result, this->lineBoxes, direction == KoSvgText::DirectionLeftToRight);
 }
 
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+ShapedParagraphSP KoSvgTextShape::Private::shapeParagraph(const ParagraphShapingKey &key) const
+{
+    QSharedPointer<ShapedParagraph> paragraph(new ShapedParagraph());
+    paragraph->key = key;
+
+    const QString &text = key.text;
+    const bool isHorizontal = key.writingMode == KoSvgText::HorizontalTB;
+
+    QVector<CharacterResult> result(text.size());
+    for (int i = 0; i < text.size(); i++) {
+        result[i].addressable = key.addressable.at(i);
+    }
+
+    FT_Int32 loadFlags = 0;
+    if (key.textRendering == GeometricPrecision || key.textRendering == Auto) {
+        // without load_no_hinting, the advance and offset will be rounded
+        // to nearest pixel, which we don't want as we're using the vector
+        // outline.
+        loadFlags |= FT_LOAD_NO_HINTING;
+
+        // Disable embedded bitmaps because they _do not_ follow geometric
+        // precision, but is focused on legibility.
+        // This does not affect bitmap-only fonts.
+        loadFlags |= FT_LOAD_NO_BITMAP;
+    } else {
+        // When using hinting, sometimes the bounding box does not encompass the
+        // drawn glyphs properly.
+        // The default hinting works best for vertical, while the 'light'
+        // hinting mode works best for horizontal.
+        if (isHorizontal) {
+            loadFlags |= FT_LOAD_TARGET_LIGHT;
+        }
+    }
+    const auto loadFlagsForFace = [loadFlags, isHorizontal](FT_Face face) -> FT_Int32 {
+        FT_Int32 faceLoadFlags = loadFlags;
+        if (FT_HAS_COLOR(face)) {
+            faceLoadFlags |= FT_LOAD_COLOR;
+        }
+        if (!isHorizontal && FT_HAS_VERTICAL(face)) {
+            faceLoadFlags |= FT_LOAD_VERTICAL_LAYOUT;
+        }
+        if (!FT_IS_SCALABLE(face)) {
+            // This is needed for the CBDT version of Noto Color Emoji
+            faceLoadFlags &= ~FT_LOAD_NO_BITMAP;
+        }
+        return faceLoadFlags;
+    };
+
+    const qreal ftFontUnit = 64.0;
+    const qreal ftFontUnitFactor = 1 / ftFontUnit;
+    const qreal scaleToPT = 72. / key.resolution;
+    const qreal scaleToPixel = key.resolution / 72.;
+    const QTransform dpiScale = QTransform::fromScale(scaleToPT, scaleToPT);
+    const QTransform ftTF = QTransform::fromScale(ftFontUnitFactor, -ftFontUnitFactor) * dpiScale;
+
+    // pass everything to a css-compatible text-layout algortihm.
+    raqm_t_sp layout(raqm_create());
+
+    if (raqm_set_text_utf16(layout.data(), text.utf16(), static_cast<size_t>(text.size()))) {
+        if (key.writingMode == KoSvgText::VerticalRL || key.writingMode == KoSvgText::VerticalLR) {
+            raqm_set_par_direction(layout.data(), raqm_direction_t::RAQM_DIRECTION_TTB);
+        } else if (key.direction == KoSvgText::DirectionRightToLeft) {
+            raqm_set_par_direction(layout.data(), raqm_direction_t::RAQM_DIRECTION_RTL);
+        } else {
+            raqm_set_par_direction(layout.data(), raqm_direction_t::RAQM_DIRECTION_LTR);
+        }
+
+        Q_FOREACH (const int runBreak, key.runBreaks) {
+            raqm_set_arbitrary_run_break(layout.data(), static_cast<size_t>(runBreak), true);
+        }
+
+        Q_FOREACH (const ShapingRun &run, key.runs) {
+            int start = run.start;
+            int length = run.length;
+            const qreal fontSize = run.fontSize;
+            const QFont::Style style = run.fontStyle;
+            const KoSvgText::LineHeightInfo &lineHeight = run.lineHeight;
+
+            QVector<int> lengths;
+            const std::vector<FT_FaceSP> faces = KoFontRegistry::instance()->facesForCSSValues(
+                run.fontFamilies,
+                lengths,
+                run.fontAxisSettings,
+                text.mid(start, length),
+                static_cast<quint32>(key.resolution),
+                static_cast<quint32>(key.resolution),
+                fontSize,
+                run.fontSizeAdjust,
+                run.fontWeight,
+                run.fontStretch,
+                style != QFont::StyleNormal);
+            if (!run.language.isEmpty()) {
+                raqm_set_language(layout.data(),
+                                  run.language.toUtf8(),
+                                  static_cast<size_t>(start),
+                                  static_cast<size_t>(length));
+            }
+            Q_FOREACH (const QString &feature, run.fontFeatures) {
+                debugFlake << "adding feature" << feature;
+                raqm_add_font_feature(layout.data(), feature.toUtf8(), feature.toUtf8().size());
+            }
+
+            if (!run.letterSpacing.isAuto) {
+                raqm_set_letter_spacing_range(layout.data(),
+                                              static_cast<int>(run.letterSpacing.length.value * ftFontUnit * scaleToPixel),
+                                              static_cast<size_t>(start),
+                                              static_cast<size_t>(length));
+            }
+
+            if (!run.wordSpacing.isAuto) {
+                raqm_set_word_spacing_range(layout.data(),
+                                            static_cast<int>(run.wordSpacing.length.value * ftFontUnit * scaleToPixel),
+                                            static_cast<size_t>(start),
+                                            static_cast<size_t>(length));
+            }
+
+
+        for (int i = 0; i < lengths.size(); i++) {
+            length = lengths.at(i);
+            const FT_FaceSP &face = faces.at(static_cast<size_t>(i));
+            const FT_Int32 faceLoadFlags = loadFlagsForFace(face.data());
+            if (start == 0) {
+                raqm_set_freetype_face(layout.data(), face.data());
+                raqm_set_freetype_load_flags(layout.data(), faceLoadFlags);
+            }
+            if (length > 0) {
+                raqm_set_freetype_face_range(layout.data(),
+                                             face.data(),
+                                             static_cast<size_t>(start),
+                                             static_cast<size_t>(length));
+                raqm_set_freetype_load_flags_range(layout.data(),
+                                                   faceLoadFlags,
+                                                   static_cast<size_t>(start),
+                                                   static_cast<size_t>(length));
+            }
+
+            hb_font_t_sp font(hb_ft_font_create_referenced(face.data()));
+            hb_position_t ascender = 0;
+            hb_position_t descender = 0;
+            hb_position_t lineGap = 0;
+
+            if (isHorizontal) {
+                /**
+                 * There's 3 different definitions of the so-called vertical metrics, that is,
+                 * the ascender and descender for horizontally laid out script. WinAsc & Desc,
+                 * HHAE asc&desc, and OS/2... we need the last one, but harfbuzz doesn't return
+                 * it unless there's a flag set in the font, which is missing in a lot of fonts
+                 * that were from the transitional period, like Deja Vu Sans. Hence we need to get
+                 * the OS/2 table and calculate the values manually (and fall back in various ways).
+                 *
+                 * https://www.w3.org/TR/css-inline-3/#ascent-descent
+                 * https://www.w3.org/TR/CSS2/visudet.html#sTypoAscender
+                 * https://wiki.inkscape.org/wiki/Text_Rendering_Notes#Ascent_and_Descent
+                 *
+                 * Related HB issue: https://github.com/harfbuzz/harfbuzz/issues/1920
+                 */
+                TT_OS2 *os2Table = nullptr;
+                os2Table = (TT_OS2*)FT_Get_Sfnt_Table(face.data(), FT_SFNT_OS2);
+                if (os2Table) {
+                    int yscale = face.data()->size->metrics.y_scale;
+
+                    ascender = FT_MulFix(os2Table->sTypoAscender, yscale);
+                    descender = FT_MulFix(os2Table->sTypoDescender, yscale);
+                    lineGap = FT_MulFix(os2Table->sTypoLineGap, yscale);
+                }
+
+                constexpr unsigned USE_TYPO_METRICS = 1u << 7;
+                if (!os2Table || os2Table->version == 0xFFFFU || !(os2Table->fsSelection & USE_TYPO_METRICS)) {
+                    hb_position_t altAscender = 0;
+                    hb_position_t altDescender = 0;
+                    hb_position_t altLineGap = 0;
+                    if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_ASCENDER, &altAscender)) {
+                        altAscender = face.data()->ascender;
+                    }
+                    if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_DESCENDER, &altDescender)) {
+                        altDescender = face.data()->descender;
+                    }
+                    if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_HORIZONTAL_LINE_GAP, &altLineGap)) {
+                        altLineGap = face.data()->height - (altAscender-altDescender);
+                    }
+
+                    // Some fonts have sTypo metrics that are too small compared
+                    // to the HHEA values which make the default line height too
+                    // tight (e.g. Microsoft JhengHei, Source Han Sans), so we
+                    // compare them and take the ones that are larger.
+                    if (!os2Table || (altAscender - altDescender + altLineGap) > (ascender - descender + lineGap)) {
+                        ascender = altAscender;
+                        descender = altDescender;
+                        lineGap = altLineGap;
+                    }
+                }
+            } else {
+                hb_font_extents_t fontExtends;
+                hb_font_get_extents_for_direction (font.data(), HB_DIRECTION_TTB, &fontExtends);
+                if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_ASCENDER, &ascender)) {
+                    ascender = fontExtends.ascender;
+                }
+                if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_DESCENDER, &descender)) {
+                    descender = fontExtends.descender;
+                }
+                if (!hb_ot_metrics_get_position(font.data(), HB_OT_METRICS_TAG_VERTICAL_LINE_GAP, &lineGap)) {
+                    lineGap = 0;
+                }
+                // Default microsoft CJK fonts have the vertical ascent and descent be the same as the horizontal
+                // ascent and descent, so we 'normalize' the ascender and descender to be half the total height.
+                qreal height = ascender - fontExtends.descender;
+                ascender = height*0.5;
+                descender = -ascender;
+            }
+            if (ascender == 0 && descender == 0) {
+                ascender = face->size->metrics.ascender;
+                descender = face->size->metrics.descender;
+                qreal height = ascender - descender;
+                lineGap = face->size->metrics.height - height;
+                if (!isHorizontal) {
+                    ascender = height * 0.5;
+                    descender = -ascender;
+                }
+            }
+
+            for (int j=start; j<start+length; j++) {
+                result[j].fontAscent = ascender;
+                result[j].fontDescent = descender;
+                qreal leading = lineGap;
+
+                if (!lineHeight.isNormal) {
+                    if (lineHeight.isNumber) {
+                        leading = (fontSize*scaleToPixel*ftFontUnit)*lineHeight.value;
+                        leading -= (ascender-descender);
+                    } else {
+                        QPointF val = ftTF.inverted().map(QPointF(lineHeight.length.value, lineHeight.length.value));
+                        leading = isHorizontal? val.x(): val.y();
+                        leading -= (ascender-descender);
+                    }
+                }
+                result[j].fontHalfLeading = leading * 0.5;
+                result[j].fontStyle = style;
+                result[j].fontWeight = run.fontWeight;
+            }
+
+            start += length;
+        }
+    }
+
+    if (raqm_layout(layout.data())) {
+        debugFlake << "layout succeeded";
+    }
+
+    size_t count = 0;
+    const raqm_glyph_t *glyphs = raqm_get_glyphs(layout.data(), &count);
+    if (!glyphs) {
+        count = 0;
+    }
+
+    QPointF totalAdvanceFTFontCoordinates;
+
+    KIS_ASSERT(count <= INT32_MAX);
+
+    for (int i = 0; i < static_cast<int>(count); i++) {
+        raqm_glyph_t currentGlyph = glyphs[i];
+        KIS_ASSERT(currentGlyph.cluster <= INT32_MAX);
+        const int cluster = static_cast<int>(currentGlyph.cluster);
+        if (!result[cluster].addressable) {
+            continue;
+        }
+        CharacterResult charResult = result[cluster];
+
+        const FT_Int32 faceLoadFlags = loadFlagsForFace(currentGlyph.ftface);
+
+        const auto getUcs4At = [](const QString &s, int i) -> char32_t {
+            const QChar high = s.at(i);
+            if (!high.isSurrogate()) {
+                return high.unicode();
+            }
+            if (high.isHighSurrogate() && s.length() > i + 1) {
+                const QChar low = s[i + 1];
+                if (low.isLowSurrogate()) {
+                    return QChar::surrogateToUcs4(high, low);
+                }
+            }
+            // Don't return U+FFFD replacement character but return the
+            // unpaired surrogate itself, so that if we want to we can draw
+            // a tofu block for it.
+            return high.unicode();
+        };
+        const char32_t codepoint = getUcs4At(text, cluster);
+        debugFlake << "glyph" << i << "cluster" << cluster << currentGlyph.index << codepoint;
+
+        charResult.cursorInfo.rtl = raqm_get_direction_at_index(layout.data(), cluster) == RAQM_DIRECTION_RTL;
+
+        if (!this->loadGlyph(ftTF,
+                             key.tabSizeInfo,
+                             faceLoadFlags,
+                             isHorizontal,
+                             codepoint,
+                             currentGlyph,
+                             charResult,
+                             totalAdvanceFTFontCoordinates)) {
+            continue;
+        }
+
+        charResult.visualIndex = i;
+
+        charResult.middle = false;
+
+        result[cluster] = charResult;
+    }
+
+    paragraph->result = result;
+    paragraph->glyphCount = static_cast<int>(count);
+    paragraph->totalAdvanceFTFontCoordinates = totalAdvanceFTFontCoordinates;
+
+    return paragraph;
+}
+
 void KoSvgTextShape::Private::clearAssociatedOutlines()
 {
     for (auto it = textData.depthFirstTailBegin(); it != textData.depthFirstTailEnd(); it++) {
@@ -54,6 +54,11 @@ QRect KisRectsGrid::alignRect(const QRect &rc) const
     return KisLodTransformBase::alignedRect(rc, m_logGridSize);
 }
 
+QRect KisRectsGrid::shrinkRect(const QRect &rc) const
+{
+    return shrinkRectToAlignedGrid(rc, m_logGridSize);
+}
+
 QVector<QRect> KisRectsGrid::addRect(const QRect &rc)
 {
     return addAlignedRect(alignRect(rc));
@@ -122,7 +127,8 @@ QVector<QRect> KisRectsGrid::removeRect(const QRect &rc)
 
 QVector<QRect> KisRectsGrid::removeAlignedRect(const QRect &rc)
 {
-    const QRect mappedRect = KisLodTransformBase::scaledRect(rc, m_logGridSize);
+    // the cells outside the mapped area have never been added
+    const QRect mappedRect = KisLodTransformBase::scaledRect(rc, m_logGridSize) & m_mappedAreaSize;
 
     // NOTE: we never shrink the size of the grid, just keep it as big as
     //       it ever was
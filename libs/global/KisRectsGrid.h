@@ -42,6 +42,13 @@ public:
      */
     QRect alignRect(const QRect &rc) const;
 
+    /**
+     * Shrink rectangle \p rc until it becomes aligned to the
+     * grid cell borders, i.e. return the area of the cells
+     * that are fully covered by \p rc.
+     */
+    QRect shrinkRect(const QRect &rc) const;
+
     /**
      * Add an arbitrary (non-aligned) rect to the grid
      *
@@ -54,4 +54,22 @@ void KisRectsGridTest::test()
     QVERIFY(!grid.contains(QRect(128,10,1,1)));
 }
 
+void KisRectsGridTest::testShrinkAndRemove()
+{
+    KisRectsGrid grid;
+
+    QCOMPARE(grid.shrinkRect(QRect(0,0,100,100)), QRect(0,0,64,64));
+    QCOMPARE(grid.shrinkRect(QRect(-5,-5,200,100)), QRect(0,0,192,64));
+    QVERIFY(grid.shrinkRect(QRect(5,5,100,100)).isEmpty());
+
+    // removing from the area that has never been mapped
+    QVERIFY(grid.removeRect(QRect(0,0,256,256)).isEmpty());
+
+    grid.addRect(QRect(0,0,64,64));
+
+    QVERIFY(grid.removeRect(QRect(1024,1024,256,256)).isEmpty());
+    QCOMPARE(grid.removeRect(QRect(-256,-256,512,512)), QVector<QRect>({QRect(0,0,64,64)}));
+    QVERIFY(!grid.contains(QRect(10,10,1,1)));
+}
+
 QTEST_MAIN(KisRectsGridTest)
@@ -16,6 +16,7 @@ class KisRectsGridTest : public QObject
     Q_OBJECT
 private Q_SLOTS:
     void test();
+    void testShrinkAndRemove();
 };
 
 #endif // KISRECTSGRIDTEST_H
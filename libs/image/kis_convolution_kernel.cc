@@ -10,11 +10,13 @@
 
 #include <QImage>
 #include <kis_mask_generator.h>
+#include <kis_assert.h>
 
 struct Q_DECL_HIDDEN KisConvolutionKernel::Private {
     qreal offset;
     qreal factor;
     Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> data;
+    QVector<SeparableTerm> separableTerms;
 };
 
 KisConvolutionKernel::KisConvolutionKernel(quint32 _width, quint32 _height, qreal _offset, qreal _factor) : d(new Private)
@@ -42,6 +44,7 @@ quint32 KisConvolutionKernel::height() const
 void KisConvolutionKernel::setSize(quint32 width, quint32 height)
 {
     d->data.resize(height, width);
+    d->separableTerms.clear();
 }
 
 
@@ -62,6 +65,8 @@ void KisConvolutionKernel::setFactor(qreal factor)
 
 Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>& KisConvolutionKernel::data()
 {
+    // the matrix may be changed by the caller, so the terms are not valid anymore
+    d->separableTerms.clear();
     return d->data;
 }
 
@@ -70,6 +75,11 @@ const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>* KisConvolutionKernel
     return &(d->data);
 }
 
+QVector<KisConvolutionKernel::SeparableTerm> KisConvolutionKernel::separableTerms() const
+{
+    return d->separableTerms;
+}
+
 KisConvolutionKernelSP KisConvolutionKernel::fromQImage(const QImage& image)
 {
     KisConvolutionKernelSP kernel = new KisConvolutionKernel(image.width(), image.height(), 0, 0);
@@ -133,6 +143,33 @@ KisConvolutionKernelSP KisConvolutionKernel::fromMatrix(Eigen::Matrix<qreal, Eig
     return kernel;
 }
 
+KisConvolutionKernelSP KisConvolutionKernel::fromSeparableTerms(const QVector<SeparableTerm> &terms, qreal offset, qreal factor)
+{
+    KIS_ASSERT_RECOVER_RETURN_VALUE(!terms.isEmpty(), KisConvolutionKernelSP());
+
+    const int height = terms.first().column.size();
+    const int width = terms.first().row.size();
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix =
+        Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>::Zero(height, width);
+
+    Q_FOREACH (const SeparableTerm &term, terms) {
+        KIS_ASSERT_RECOVER_RETURN_VALUE(term.column.size() == height && term.row.size() == width,
+                                        KisConvolutionKernelSP());
+
+        for (int r = 0; r < height; r++) {
+            for (int c = 0; c < width; c++) {
+                matrix(r, c) += term.column[r] * term.row[c];
+            }
+        }
+    }
+
+    KisConvolutionKernelSP kernel = fromMatrix(matrix, offset, factor);
+    kernel->d->separableTerms = terms;
+
+    return kernel;
+}
+
 
 
 
@@ -9,6 +9,7 @@
 
 #include <cstddef>
 #include <Eigen/Core>
+#include <QVector>
 #include "kis_shared.h"
 #include "kritaimage_export.h"
 #include "kis_types.h"
@@ -19,6 +20,16 @@ class QImage;
 class KRITAIMAGE_EXPORT KisConvolutionKernel : public KisShared
 {
 
+public:
+    /**
+     * A single term of a kernel given as a sum of outer products,
+     * kernel(r, c) = sum(term.column[r] * term.row[c])
+     */
+    struct SeparableTerm {
+        QVector<qreal> column;
+        QVector<qreal> row;
+    };
+
 public:
     KisConvolutionKernel(quint32 width, quint32 height, qreal offset, qreal factor);
     virtual ~KisConvolutionKernel();
@@ -35,9 +46,25 @@ public:
     Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>& data();
     const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> * data() const;
 
+    /**
+     * The separable terms the kernel has been created from (see
+     * fromSeparableTerms()). The list is empty when the terms are not
+     * known, including the case when the kernel was modified after
+     * creation.
+     */
+    QVector<SeparableTerm> separableTerms() const;
+
     static KisConvolutionKernelSP fromQImage(const QImage& image);
     static KisConvolutionKernelSP fromMaskGenerator(KisMaskGenerator *, qreal angle = 0.0);
     static KisConvolutionKernelSP fromMatrix(Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix, qreal offset, qreal factor);
+
+    /**
+     * Creates a kernel which is a sum of separable \p terms. All the
+     * columns must have the same size, as well as all the rows. The
+     * convolution workers may apply every term as a pair of 1D passes
+     * instead of the full 2D kernel.
+     */
+    static KisConvolutionKernelSP fromSeparableTerms(const QVector<SeparableTerm> &terms, qreal offset, qreal factor);
 private:
     struct Private;
     Private* const d;
@@ -0,0 +1,56 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_CONVOLUTION_LINE_ACCUMULATOR_H
+#define __KIS_CONVOLUTION_LINE_ACCUMULATOR_H
+
+#include <QtGlobal>
+
+#include <KoMultiArchBuildSupport.h>
+
+/**
+ * Accumulates weighted lines of channel values. That is the only
+ * arithmetic KisConvolutionWorkerSeparable does, so the implementation
+ * is chosen for the current CPU via createOptimizedClass().
+ */
+class KisConvolutionLineAccumulatorBase
+{
+public:
+    virtual ~KisConvolutionLineAccumulatorBase() = default;
+
+    /**
+     * dst[x] += sum(weights[i] * lines[i][x]) for every x in [0, width),
+     * lines with zero weight are skipped
+     */
+    virtual void accumulate(const qreal *const *lines, const qreal *weights, int numLines,
+                            qreal *dst, int width) const = 0;
+};
+
+class KisConvolutionLineAccumulatorScalar : public KisConvolutionLineAccumulatorBase
+{
+public:
+    void accumulate(const qreal *const *lines, const qreal *weights, int numLines,
+                    qreal *dst, int width) const override
+    {
+        for (int i = 0; i < numLines; i++) {
+            const qreal weight = weights[i];
+            if (weight == 0.0) continue;
+
+            const qreal *line = lines[i];
+
+            for (int x = 0; x < width; x++) {
+                dst[x] += weight * line[x];
+            }
+        }
+    }
+};
+
+struct KisConvolutionLineAccumulatorFactory {
+    template<typename _impl>
+    static KisConvolutionLineAccumulatorBase *create();
+};
+
+#endif /* __KIS_CONVOLUTION_LINE_ACCUMULATOR_H */
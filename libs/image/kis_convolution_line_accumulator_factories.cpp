@@ -0,0 +1,65 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_convolution_line_accumulator.h"
+
+#if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE) && XSIMD_UNIVERSAL_BUILD_PASS
+
+template<typename _impl>
+class KisConvolutionLineAccumulatorVector : public KisConvolutionLineAccumulatorBase
+{
+public:
+    void accumulate(const qreal *const *lines, const qreal *weights, int numLines,
+                    qreal *dst, int width) const override
+    {
+        using double_v = xsimd::batch<double, _impl>;
+
+        /**
+         * Process the destination in blocks, so that it stays in L1 cache
+         * while we add all the lines to it
+         */
+        const int blockSize = 512;
+
+        for (int blockStart = 0; blockStart < width; blockStart += blockSize) {
+            const int blockEnd = qMin(blockStart + blockSize, width);
+            const int vectorEnd = blockStart + (blockEnd - blockStart) / int(double_v::size) * int(double_v::size);
+
+            for (int i = 0; i < numLines; i++) {
+                const qreal weight = weights[i];
+                if (weight == 0.0) continue;
+
+                const double_v weight_v(weight);
+                const qreal *line = lines[i];
+
+                int x = blockStart;
+
+                for (; x < vectorEnd; x += double_v::size) {
+                    const double_v value = double_v::load_unaligned(line + x);
+                    const double_v sum = double_v::load_unaligned(dst + x);
+                    (sum + weight_v * value).store_unaligned(dst + x);
+                }
+
+                for (; x < blockEnd; x++) {
+                    dst[x] += weight * line[x];
+                }
+            }
+        }
+    }
+};
+
+template<>
+KisConvolutionLineAccumulatorBase *
+KisConvolutionLineAccumulatorFactory::create<xsimd::current_arch>()
+{
+#if XSIMD_WITH_NEON && !XSIMD_WITH_NEON64
+    // 32-bit NEON has no double precision lanes
+    return new KisConvolutionLineAccumulatorScalar();
+#else
+    return new KisConvolutionLineAccumulatorVector<xsimd::current_arch>();
+#endif
+}
+
+#endif
@@ -0,0 +1,14 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_convolution_line_accumulator.h"
+
+template<>
+KisConvolutionLineAccumulatorBase *
+KisConvolutionLineAccumulatorFactory::create<xsimd::generic>()
+{
+    return new KisConvolutionLineAccumulatorScalar();
+}
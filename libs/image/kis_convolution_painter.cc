@@ -38,7 +38,7 @@
 #include "kis_selection.h"
 
 #include "kis_convolution_worker.h"
-#include "kis_convolution_worker_spatial.h"
+#include "kis_convolution_worker_separable.h"
 
 #include "config_convolution.h"
 
@@ -77,11 +77,11 @@ KisConvolutionWorker<factory>* KisConvolutionPainter::createWorker(const KisConv
     if (useFFTImplementation(kernel)) {
         worker = new KisConvolutionWorkerFFT<factory>(painter, progress);
     } else {
-        worker = new KisConvolutionWorkerSpatial<factory>(painter, progress);
+        worker = new KisConvolutionWorkerSeparable<factory>(painter, progress);
     }
 #else
     Q_UNUSED(kernel);
-    worker = new KisConvolutionWorkerSpatial<factory>(painter, progress);
+    worker = new KisConvolutionWorkerSeparable<factory>(painter, progress);
 #endif
 
     return worker;
@@ -97,6 +97,31 @@ bool KisConvolutionPainter::supportsFFTW()
 #endif
 }
 
+void KisConvolutionPainter::releaseCachedKernels()
+{
+#ifdef HAVE_FFTW3
+    KisConvolutionWorkerFFTKernelCache::clear();
+#endif
+}
+
+qint64 KisConvolutionPainter::cachedKernelsBytes()
+{
+#ifdef HAVE_FFTW3
+    return KisConvolutionWorkerFFTKernelCache::bytes();
+#else
+    return 0;
+#endif
+}
+
+void KisConvolutionPainter::setCachedKernelsLimit(qint64 bytes)
+{
+#ifdef HAVE_FFTW3
+    KisConvolutionWorkerFFTKernelCache::setLimit(bytes);
+#else
+    Q_UNUSED(bytes);
+#endif
+}
+
 
 KisConvolutionPainter::KisConvolutionPainter()
     : KisPainter(),
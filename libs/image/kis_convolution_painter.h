@@ -80,9 +80,22 @@ public:
 
     static bool supportsFFTW();
 
+    /**
+     * Frees the kernel spectra cached by the FFT engine. Call it when
+     * a filter run is over, the cache is only useful while the patches
+     * of the same run are processed.
+     */
+    static void releaseCachedKernels();
+
 protected:
     friend class KisConvolutionPainterTest;
 
+    /// The size of the kernel spectra retained by the FFT engine, for testing purposes
+    static qint64 cachedKernelsBytes();
+
+    /// Changes the limit of the retained kernel spectra, for testing purposes
+    static void setCachedKernelsLimit(qint64 bytes);
+
 
 
 private:
@@ -13,9 +13,12 @@
 #include <KoChannelInfo.h>
 
 #include "kis_convolution_worker.h"
+#include "kis_convolution_kernel.h"
 #include "kis_math_toolbox.h"
 
 #include <QMutex>
+#include <QMutexLocker>
+#include <QList>
 #include <QVector>
 #include <QTextStream>
 #include <QFile>
@@ -33,6 +36,118 @@ private:
 
 QMutex KisConvolutionWorkerFFTLock::fftwMutex;
 
+/**
+ * Keeps the spectra of the recently used kernels. When a filter is
+ * applied in patches, all the patches use the same kernel and most of
+ * them have the same FFT size, so the forward transform of the kernel
+ * is done only once.
+ *
+ * A spectrum is as big as the patch, so the cache is limited by the
+ * size of the retained data rather than by the number of entries. The
+ * filter strokes release it with clear() when they end.
+ */
+class KisConvolutionWorkerFFTKernelCache
+{
+public:
+    static QVector<double> fetch(const KisConvolutionKernelSP kernel, quint32 fftWidth, quint32 fftHeight)
+    {
+        QMutexLocker l(&mutex);
+
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->fftWidth == fftWidth &&
+                it->fftHeight == fftHeight &&
+                it->kernel.rows() == kernel->data()->rows() &&
+                it->kernel.cols() == kernel->data()->cols() &&
+                it->kernel == *kernel->data()) {
+
+                // move the entry to the front to keep the list ordered by the last usage
+                Entry entry = *it;
+                entries.erase(it);
+                entries.prepend(entry);
+
+                return entry.spectrum;
+            }
+        }
+
+        return QVector<double>();
+    }
+
+    static void store(const KisConvolutionKernelSP kernel, quint32 fftWidth, quint32 fftHeight,
+                      const QVector<double> &spectrum)
+    {
+        Entry entry;
+        entry.kernel = *kernel->data();
+        entry.fftWidth = fftWidth;
+        entry.fftHeight = fftHeight;
+        entry.spectrum = spectrum;
+
+        const qint64 bytes = entryBytes(entry);
+
+        QMutexLocker l(&mutex);
+
+        if (bytes > maxRetainedBytes) return;
+
+        entries.prepend(entry);
+        retainedBytes += bytes;
+
+        evictOverLimit();
+    }
+
+    static void clear()
+    {
+        QMutexLocker l(&mutex);
+
+        entries.clear();
+        retainedBytes = 0;
+    }
+
+    static qint64 bytes()
+    {
+        QMutexLocker l(&mutex);
+        return retainedBytes;
+    }
+
+    static void setLimit(qint64 bytes)
+    {
+        QMutexLocker l(&mutex);
+
+        maxRetainedBytes = bytes;
+        evictOverLimit();
+    }
+
+    static const qint64 defaultMaxRetainedBytes = 32 * 1024 * 1024;
+
+private:
+    struct Entry {
+        Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> kernel;
+        quint32 fftWidth {0};
+        quint32 fftHeight {0};
+        QVector<double> spectrum;
+    };
+
+    static qint64 entryBytes(const Entry &entry) {
+        return qint64(entry.spectrum.size()) * sizeof(double) +
+            qint64(entry.kernel.size()) * sizeof(qreal);
+    }
+
+    static void evictOverLimit() {
+        while (retainedBytes > maxRetainedBytes) {
+            retainedBytes -= entryBytes(entries.last());
+            entries.removeLast();
+        }
+    }
+
+    static QMutex mutex;
+    static QList<Entry> entries;
+    static qint64 retainedBytes;
+    static qint64 maxRetainedBytes;
+};
+
+QMutex KisConvolutionWorkerFFTKernelCache::mutex;
+QList<KisConvolutionWorkerFFTKernelCache::Entry> KisConvolutionWorkerFFTKernelCache::entries;
+qint64 KisConvolutionWorkerFFTKernelCache::retainedBytes = 0;
+qint64 KisConvolutionWorkerFFTKernelCache::maxRetainedBytes = KisConvolutionWorkerFFTKernelCache::defaultMaxRetainedBytes;
+
 
 template<class _IteratorFactory_>
 class KisConvolutionWorkerFFT : public KisConvolutionWorker<_IteratorFactory_>
@@ -85,10 +200,19 @@ public:
         m_fftLength = m_fftHeight * (m_fftWidth / 2 + 1);
         m_extraMem = (m_fftWidth % 2) ? 1 : 2;
 
-        // create and fill kernel
+        // create and fill kernel, its spectrum may be already known
         m_kernelFFT = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
-        memset(m_kernelFFT, 0, sizeof(fftw_complex) * m_fftLength);
-        fftFillKernelMatrix(kernel, m_kernelFFT);
+
+        const QVector<double> cachedKernelSpectrum =
+            KisConvolutionWorkerFFTKernelCache::fetch(kernel, m_fftWidth, m_fftHeight);
+        const bool kernelSpectrumIsCached = !cachedKernelSpectrum.isEmpty();
+
+        if (kernelSpectrumIsCached) {
+            memcpy(m_kernelFFT, cachedKernelSpectrum.constData(), sizeof(fftw_complex) * m_fftLength);
+        } else {
+            memset(m_kernelFFT, 0, sizeof(fftw_complex) * m_fftLength);
+            fftFillKernelMatrix(kernel, m_kernelFFT);
+        }
 
         // find out which channels need convolving
         QList<KoChannelInfo*> convChannelList = this->convolvableChannelList(src);
@@ -126,7 +250,13 @@ public:
         fftwPlanBackward = fftw_plan_dft_c2r_2d(m_fftHeight, m_fftWidth, m_kernelFFT, (double*)m_kernelFFT, FFTW_ESTIMATE);
         KisConvolutionWorkerFFTLock::fftwMutex.unlock();
 
-        fftw_execute(fftwPlanForward);
+        if (!kernelSpectrumIsCached) {
+            fftw_execute(fftwPlanForward);
+
+            QVector<double> kernelSpectrum(2 * m_fftLength);
+            memcpy(kernelSpectrum.data(), m_kernelFFT, sizeof(fftw_complex) * m_fftLength);
+            KisConvolutionWorkerFFTKernelCache::store(kernel, m_fftWidth, m_fftHeight, kernelSpectrum);
+        }
         addToProgress(progressPerFFT);
         if (isInterrupted()) return;
 
@@ -0,0 +1,357 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_CONVOLUTION_WORKER_SEPARABLE_H
+#define KIS_CONVOLUTION_WORKER_SEPARABLE_H
+
+#include <QScopedPointer>
+#include <QVector>
+
+#include <algorithm>
+
+#include <KoChannelInfo.h>
+
+#include "kis_convolution_worker.h"
+#include "kis_convolution_kernel.h"
+#include "kis_convolution_line_accumulator.h"
+#include "kis_math_toolbox.h"
+
+/**
+ * A spatial convolution worker that unpacks the source into channel-planar
+ * lines and does all the arithmetic as accumulation of whole weighted lines
+ * (see KisConvolutionLineAccumulatorBase), which is vectorized for the
+ * current CPU.
+ *
+ * If the kernel is separable (has rank 1, or is given as a sum of a few
+ * separable terms), the worker runs a horizontal pass over every source
+ * line and a vertical pass over kernel-height filtered lines for every
+ * term, so the cost is (width + height) per pixel and term. Any other
+ * kernel is treated as a sum of its rows, each applied as a horizontal
+ * pass. The lines are kept in a ring buffer, so every source pixel is
+ * unpacked only once.
+ *
+ * The values are kept in double precision, but the products are summed
+ * in a different order than in the straightforward per-pixel convolution,
+ * so the results are equal only up to rounding.
+ */
+template <class _IteratorFactory_>
+class KisConvolutionWorkerSeparable : public KisConvolutionWorker<_IteratorFactory_>
+{
+public:
+    KisConvolutionWorkerSeparable(KisPainter *painter, KoUpdater *progress)
+        : KisConvolutionWorker<_IteratorFactory_>(painter, progress)
+        , m_accumulator(createOptimizedClass<KisConvolutionLineAccumulatorFactory>())
+    {
+    }
+
+    /**
+     * Splits \p kernel into a sum of separable terms if that is cheaper
+     * than the direct convolution. The terms either come from the kernel
+     * itself (see KisConvolutionKernel::separableTerms()) or, for a kernel
+     * of rank 1, are calculated here. The weights are returned in reversed
+     * order, because convolution applies the kernel flipped.
+     */
+    static bool splitKernel(const KisConvolutionKernelSP kernel,
+                            QVector<KisConvolutionKernel::SeparableTerm> *terms)
+    {
+        const int kw = kernel->width();
+        const int kh = kernel->height();
+
+        const QVector<KisConvolutionKernel::SeparableTerm> kernelTerms = kernel->separableTerms();
+
+        if (!kernelTerms.isEmpty()) {
+            if (kernelTerms.size() * (kw + kh) >= kw * kh) return false;
+
+            *terms = kernelTerms;
+            for (auto it = terms->begin(); it != terms->end(); ++it) {
+                std::reverse(it->column.begin(), it->column.end());
+                std::reverse(it->row.begin(), it->row.end());
+            }
+            return true;
+        }
+
+        const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> &m = *kernel->data();
+
+        int pivotRow = 0;
+        int pivotColumn = 0;
+        const qreal maxValue = m.cwiseAbs().maxCoeff(&pivotRow, &pivotColumn);
+        if (maxValue == 0.0) return false;
+
+        const qreal pivot = m(pivotRow, pivotColumn);
+        const qreal tolerance = 1e-9 * maxValue;
+
+        KisConvolutionKernel::SeparableTerm term;
+        term.column.resize(kh);
+        term.row.resize(kw);
+
+        for (int r = 0; r < kh; r++) {
+            term.column[kh - 1 - r] = m(r, pivotColumn);
+        }
+
+        for (int c = 0; c < kw; c++) {
+            term.row[kw - 1 - c] = m(pivotRow, c) / pivot;
+        }
+
+        for (int r = 0; r < kh; r++) {
+            for (int c = 0; c < kw; c++) {
+                const qreal value = term.column[kh - 1 - r] * term.row[kw - 1 - c];
+                if (qAbs(m(r, c) - value) > tolerance) {
+                    return false;
+                }
+            }
+        }
+
+        terms->clear();
+        terms->append(term);
+
+        return true;
+    }
+
+    void execute(const KisConvolutionKernelSP kernel, const KisPaintDeviceSP src, QPoint srcPos, QPoint dstPos, QSize areaSize, const QRect& dataRect) override
+    {
+        const int kw = kernel->width();
+        const int kh = kernel->height();
+        const int halfWidth = (kw - 1) / 2;
+        const int halfHeight = (kh - 1) / 2;
+
+        // Make the area we cover as small as possible
+        if (this->m_painter->selection()) {
+            QRect r = this->m_painter->selection()->selectedRect().intersected(QRect(srcPos, areaSize));
+            dstPos += r.topLeft() - srcPos;
+            srcPos = r.topLeft();
+            areaSize = r.size();
+        }
+
+        if (areaSize.width() <= 0 || areaSize.height() <= 0 || kw <= 0 || kh <= 0)
+            return;
+
+        m_convChannelList = this->convolvableChannelList(src);
+        m_numChannels = m_convChannelList.size();
+        m_pixelSize = src->colorSpace()->pixelSize();
+        m_alphaIndex = -1;
+
+        for (int i = 0; i < m_numChannels; i++) {
+            if (m_convChannelList[i]->channelType() == KoChannelInfo::ALPHA) {
+                m_alphaIndex = i;
+            }
+        }
+
+        KisMathToolbox mathToolbox;
+        m_toDoubleFuncPtr = QVector<PtrToDouble>(m_numChannels);
+        if (!mathToolbox.getToDoubleChannelPtr(m_convChannelList, m_toDoubleFuncPtr))
+            return;
+
+        m_fromDoubleFuncPtr = QVector<PtrFromDouble>(m_numChannels);
+        if (!mathToolbox.getFromDoubleChannelPtr(m_convChannelList, m_fromDoubleFuncPtr))
+            return;
+
+        m_kernelFactor = kernel->factor() ? 1.0 / kernel->factor() : 1;
+        m_minClamp.resize(m_numChannels);
+        m_maxClamp.resize(m_numChannels);
+        m_absoluteOffset.resize(m_numChannels);
+        for (int i = 0; i < m_numChannels; ++i) {
+            m_minClamp[i] = mathToolbox.minChannelValue(m_convChannelList[i]);
+            m_maxClamp[i] = mathToolbox.maxChannelValue(m_convChannelList[i]);
+            m_absoluteOffset[i] = (m_maxClamp[i] - m_minClamp[i]) * kernel->offset();
+        }
+
+        QVector<KisConvolutionKernel::SeparableTerm> terms;
+        const bool isSeparable = splitKernel(kernel, &terms);
+        const int numTerms = isSeparable ? terms.size() : 1;
+
+        // weights of the kernel rows, flipped in both directions
+        QVector<qreal> kernelRows;
+        if (!isSeparable) {
+            kernelRows.resize(kw * kh);
+            for (int r = 0; r < kh; r++) {
+                for (int c = 0; c < kw; c++) {
+                    kernelRows[r * kw + c] = (*kernel->data())(kh - 1 - r, kw - 1 - c);
+                }
+            }
+        }
+
+        const int width = areaSize.width();
+        const int srcWidth = width + kw - 1;
+
+        /**
+         * For separable kernels the ring keeps horizontally filtered lines,
+         * one per separable term, otherwise it keeps the unpacked source lines
+         */
+        const int ringLineWidth = isSeparable ? width : srcWidth;
+        const int ringLineStride = ringLineWidth * m_numChannels;
+        const int ringSlotStride = numTerms * ringLineStride;
+
+        QVector<qreal> ring(kh * ringSlotStride);
+        QVector<qreal> sourceLine(isSeparable ? srcWidth * m_numChannels : 0);
+        QVector<qreal> result(width * m_numChannels);
+        QVector<const qreal*> linePtrs(qMax(kw, kh));
+
+        typename _IteratorFactory_::HLineConstIterator srcIt =
+            _IteratorFactory_::createHLineConstIterator(src, srcPos.x() - halfWidth, srcPos.y() - halfHeight, srcWidth, dataRect);
+
+        auto loadLine = [&] (int ringIndex) {
+            qreal *ringSlot = ring.data() + ringIndex * ringSlotStride;
+            qreal *planes = isSeparable ? sourceLine.data() : ringSlot;
+
+            for (int x = 0; x < srcWidth; x++) {
+                loadPixel(srcIt->oldRawData(), planes + x, srcWidth);
+                srcIt->nextPixel();
+            }
+            srcIt->nextRow();
+
+            if (isSeparable) {
+                std::fill(ringSlot, ringSlot + ringSlotStride, 0.0);
+
+                for (int k = 0; k < m_numChannels; k++) {
+                    const qreal *plane = planes + k * srcWidth;
+                    for (int c = 0; c < kw; c++) {
+                        linePtrs[c] = plane + c;
+                    }
+
+                    for (int t = 0; t < numTerms; t++) {
+                        qreal *ringLine = ringSlot + t * ringLineStride;
+                        m_accumulator->accumulate(linePtrs.constData(), terms[t].row.constData(), kw,
+                                                  ringLine + k * ringLineWidth, width);
+                    }
+                }
+            }
+        };
+
+        bool hasProgressUpdater = this->m_progress;
+        if (hasProgressUpdater) {
+            this->m_progress->setProgress(0);
+            this->m_progress->setRange(0, areaSize.height());
+        }
+
+        for (int r = 0; r < kh - 1; r++) {
+            loadLine(r);
+        }
+
+        typename _IteratorFactory_::HLineIterator hitDst = _IteratorFactory_::createHLineIterator(this->m_painter->device(), dstPos.x(), dstPos.y(), width, dataRect);
+        typename _IteratorFactory_::HLineConstIterator hitSrc = _IteratorFactory_::createHLineConstIterator(src, srcPos.x(), srcPos.y(), width, dataRect);
+
+        for (int row = 0; row < areaSize.height(); row++) {
+            loadLine((row + kh - 1) % kh);
+
+            std::fill(result.begin(), result.end(), 0.0);
+
+            for (int k = 0; k < m_numChannels; k++) {
+                qreal *resultPlane = result.data() + k * width;
+
+                if (isSeparable) {
+                    for (int t = 0; t < numTerms; t++) {
+                        for (int r = 0; r < kh; r++) {
+                            linePtrs[r] = ring.constData() + ((row + r) % kh) * ringSlotStride +
+                                t * ringLineStride + k * ringLineWidth;
+                        }
+                        m_accumulator->accumulate(linePtrs.constData(), terms[t].column.constData(), kh,
+                                                  resultPlane, width);
+                    }
+                } else {
+                    for (int r = 0; r < kh; r++) {
+                        const qreal *plane = ring.constData() + ((row + r) % kh) * ringSlotStride + k * ringLineWidth;
+                        for (int c = 0; c < kw; c++) {
+                            linePtrs[c] = plane + c;
+                        }
+                        m_accumulator->accumulate(linePtrs.constData(), kernelRows.constData() + r * kw, kw,
+                                                  resultPlane, width);
+                    }
+                }
+            }
+
+            for (int x = 0; x < width; x++) {
+                // write original channel values
+                memcpy(hitDst->rawData(), hitSrc->oldRawData(), m_pixelSize);
+                writePixel(hitDst->rawData(), result.constData() + x, width);
+
+                hitDst->nextPixel();
+                hitSrc->nextPixel();
+            }
+
+            hitDst->nextRow();
+            hitSrc->nextRow();
+
+            if (hasProgressUpdater) {
+                this->m_progress->setValue(row);
+
+                if (this->m_progress->interrupted()) {
+                    return;
+                }
+            }
+        }
+    }
+
+private:
+    inline void loadPixel(const quint8 *data, qreal *planes, int planeStride) {
+        // no alpha is rare case, so just multiply by 1.0 in that case
+        const qreal alphaValue = m_alphaIndex >= 0 ?
+            m_toDoubleFuncPtr[m_alphaIndex](data, m_convChannelList[m_alphaIndex]->pos()) : 1.0;
+
+        for (int k = 0; k < m_numChannels; ++k) {
+            planes[k * planeStride] = k != m_alphaIndex ?
+                m_toDoubleFuncPtr[k](data, m_convChannelList[k]->pos()) * alphaValue :
+                alphaValue;
+        }
+    }
+
+    inline void limitValue(qreal *value, qreal lowBound, qreal highBound) {
+        if (*value > highBound) {
+            *value = highBound;
+        } else if (!(*value >= lowBound)) {  // value < lowBound or value == NaN
+            // IEEE compliant comparisons with NaN are always false
+            *value = lowBound;
+        }
+    }
+
+    inline qreal writeChannel(quint8 *dstPtr, int channel, qreal value, qreal additionalMultiplier) {
+        qreal channelPixelValue = value * m_kernelFactor * additionalMultiplier + m_absoluteOffset[channel];
+        limitValue(&channelPixelValue, m_minClamp[channel], m_maxClamp[channel]);
+        m_fromDoubleFuncPtr[channel](dstPtr, m_convChannelList[channel]->pos(), channelPixelValue);
+        return channelPixelValue;
+    }
+
+    inline void writePixel(quint8 *dstPtr, const qreal *planes, int planeStride) {
+        if (m_alphaIndex >= 0) {
+            const qreal alphaValue = writeChannel(dstPtr, m_alphaIndex, planes[m_alphaIndex * planeStride], 1.0);
+
+            if (alphaValue != 0.0) {
+                const qreal alphaValueInv = 1.0 / alphaValue;
+
+                for (int k = 0; k < m_numChannels; ++k) {
+                    if (k == m_alphaIndex) continue;
+                    writeChannel(dstPtr, k, planes[k * planeStride], alphaValueInv);
+                }
+            } else {
+                for (int k = 0; k < m_numChannels; ++k) {
+                    if (k == m_alphaIndex) continue;
+                    m_fromDoubleFuncPtr[k](dstPtr, m_convChannelList[k]->pos(), 0.0);
+                }
+            }
+        } else {
+            for (int k = 0; k < m_numChannels; ++k) {
+                writeChannel(dstPtr, k, planes[k * planeStride], 1.0);
+            }
+        }
+    }
+
+private:
+    QScopedPointer<KisConvolutionLineAccumulatorBase> m_accumulator;
+
+    int m_numChannels {0};
+    int m_pixelSize {0};
+    int m_alphaIndex {-1};
+
+    qreal m_kernelFactor {1.0};
+    QVector<qreal> m_minClamp;
+    QVector<qreal> m_maxClamp;
+    QVector<qreal> m_absoluteOffset;
+
+    QList<KoChannelInfo *> m_convChannelList;
+    QVector<PtrToDouble> m_toDoubleFuncPtr;
+    QVector<PtrFromDouble> m_fromDoubleFuncPtr;
+};
+
+#endif
@@ -16,15 +16,223 @@
 #include "kis_selection.h"
 #include "kis_processing_information.h"
 #include "kis_node.h"
+#include "kis_default_bounds_base.h"
 #include "kis_node_visitor.h"
 #include "kis_processing_visitor.h"
 #include "kis_busy_progress_indicator.h"
 #include "kis_transaction.h"
 #include "kis_painter.h"
+#include "kis_memory_statistics_server.h"
+#include "KisRegion.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+
+namespace {
+
+inline quint64 tileKey(const QRect &tileRect) {
+    return (quint64(quint32(tileRect.x())) << 32) | quint32(tileRect.y());
+}
+
+inline quint64 rotl64(quint64 x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/**
+ * A simple 64-bit hash in the spirit of MurmurHash3, it is only used for
+ * detecting changes of the input pixels, so it doesn't need to be
+ * cryptographically strong
+ */
+quint64 hashPixelData(const quint8 *data, int size)
+{
+    const quint64 c1 = 0x87c37b91114253d5ULL;
+    const quint64 c2 = 0x4cf5ad432745937fULL;
+
+    quint64 h = size;
+
+    const int numWords = size / int(sizeof(quint64));
+    for (int i = 0; i < numWords; i++) {
+        quint64 k;
+        memcpy(&k, data + i * sizeof(quint64), sizeof(quint64));
+
+        k *= c1;
+        k = rotl64(k, 31);
+        k *= c2;
+
+        h ^= k;
+        h = rotl64(h, 27) * 5 + 0x52dce729;
+    }
+
+    for (int i = numWords * int(sizeof(quint64)); i < size; i++) {
+        h ^= quint64(data[i]) * c1;
+        h = rotl64(h, 27) * 5 + 0x52dce729;
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+}
+
+/**
+ * The cache of the filtered tiles. The mask doesn't know which parts of
+ * its parent have changed, so every tile of the output is keyed by
+ * the hash of the input pixels in the filter's need rect of this tile.
+ * The cached pixels live in a normal paint device, so the swapper can
+ * evict them as any other tile data.
+ *
+ * Every level of detail has a cache of its own, so that switching
+ * between the preview and the full-size image doesn't drop them.
+ */
+struct KisFilterMask::Private
+{
+    static const int tileSize = 64;
+
+    struct LodCache
+    {
+        KisPaintDeviceSP device;
+
+        /**
+         * The filters may read the bounds of the image, e.g. to handle
+         * the borders, so the output depends on them as well
+         */
+        QRect imageBounds;
+
+        QHash<quint64, quint64> tileHashes;
+    };
+
+    QMutex mutex;
+    KisFilterConfigurationSP cachedConfig;
+    const KoColorSpace *cachedColorSpace = nullptr;
+    QHash<int, LodCache> lodCaches;
+
+    KisPaintDeviceSP resetIfNeeded(KisFilterConfigurationSP config, const KoColorSpace *cs,
+                                   int lod, const QRect &imageBounds) {
+        if (cachedConfig != config ||
+            !cachedColorSpace ||
+            !(*cachedColorSpace == *cs)) {
+
+            lodCaches.clear();
+            cachedConfig = config;
+            cachedColorSpace = cs;
+        }
+
+        LodCache &cache = lodCaches[lod];
+
+        if (!cache.device || cache.imageBounds != imageBounds) {
+            cache.device = new KisPaintDevice(cs);
+            cache.imageBounds = imageBounds;
+            cache.tileHashes.clear();
+        }
+
+        return cache.device;
+    }
+
+    /**
+     * \return the cache of \p lod if it is still backed by \p device,
+     * that is, if it hasn't been reset since \p device was fetched
+     */
+    LodCache* currentCache(int lod, KisPaintDeviceSP device) {
+        auto it = lodCaches.find(lod);
+        return it != lodCaches.end() && it->device == device ? &(*it) : nullptr;
+    }
+
+    void processCached(KisFilterSP filter,
+                       KisFilterConfigurationSP config,
+                       KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                       const QRect &rc, int lod);
+};
+
+void KisFilterMask::Private::processCached(KisFilterSP filter,
+                                           KisFilterConfigurationSP config,
+                                           KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                                           const QRect &rc, int lod)
+{
+    KisPaintDeviceSP cache;
+
+    {
+        QMutexLocker l(&mutex);
+        cache = resetIfNeeded(config, src->colorSpace(), lod, src->defaultBounds()->bounds());
+    }
+
+    const int pixelSize = src->pixelSize();
+
+    QVector<QRect> hitRects;
+    QVector<QRect> missedRects;
+    QVector<QPair<QRect, quint64>> newTiles;
+    QVector<quint8> buffer;
+
+    const int firstColumn = rc.left() >= 0 ? rc.left() / tileSize : (rc.left() + 1) / tileSize - 1;
+    const int firstRow = rc.top() >= 0 ? rc.top() / tileSize : (rc.top() + 1) / tileSize - 1;
+
+    for (int y = firstRow * tileSize; y <= rc.bottom(); y += tileSize) {
+        for (int x = firstColumn * tileSize; x <= rc.right(); x += tileSize) {
+            const QRect tileRect(x, y, tileSize, tileSize);
+
+            // partial tiles are never cached
+            if (!rc.contains(tileRect)) {
+                missedRects.append(tileRect & rc);
+                continue;
+            }
+
+            const QRect inputRect = filter->neededRect(tileRect, config.data(), lod);
+            buffer.resize(inputRect.width() * inputRect.height() * pixelSize);
+            src->readBytes(buffer.data(), inputRect);
+            const quint64 hash = hashPixelData(buffer.constData(), buffer.size());
+
+            bool isHit = false;
+            {
+                QMutexLocker l(&mutex);
+                LodCache *lodCache = currentCache(lod, cache);
+                if (lodCache) {
+                    auto it = lodCache->tileHashes.constFind(tileKey(tileRect));
+                    isHit = it != lodCache->tileHashes.constEnd() && *it == hash;
+                }
+            }
+
+            if (isHit) {
+                hitRects.append(tileRect);
+            } else {
+                missedRects.append(tileRect);
+                newTiles.append(qMakePair(tileRect, hash));
+            }
+        }
+    }
+
+    KisMemoryStatisticsServer::instance()->notifyFilterMaskCacheAccess(hitRects.size(), newTiles.size());
+
+    Q_FOREACH (const QRect &rect, hitRects) {
+        KisPainter::copyAreaOptimized(rect.topLeft(), cache, dst, rect);
+    }
+
+    auto endIt = KisRegion::mergeSparseRects(missedRects.begin(), missedRects.end());
+    for (auto it = missedRects.begin(); it != endIt; ++it) {
+        filter->process(src, dst, 0, *it, config.data(), 0);
+    }
+
+    for (auto it = newTiles.begin(); it != newTiles.end(); ++it) {
+        KisPainter::copyAreaOptimized(it->first.topLeft(), dst, cache, it->first);
+    }
+
+    QMutexLocker l(&mutex);
+
+    // the cache could have been reset while we were filtering
+    LodCache *lodCache = currentCache(lod, cache);
+    if (lodCache) {
+        for (auto it = newTiles.begin(); it != newTiles.end(); ++it) {
+            lodCache->tileHashes.insert(tileKey(it->first), it->second);
+        }
+    }
+}
 
 KisFilterMask::KisFilterMask(KisImageWSP image, const QString &name)
     : KisEffectMask(image, name),
-      KisNodeFilterInterface(0)
+      KisNodeFilterInterface(0),
+      m_d(new Private)
 {
     setCompositeOpId(COMPOSITE_COPY);
 }
@@ -36,6 +244,7 @@ KisFilterMask::~KisFilterMask()
 KisFilterMask::KisFilterMask(const KisFilterMask& rhs)
         : KisEffectMask(rhs)
         , KisNodeFilterInterface(rhs)
+        , m_d(new Private)
 {
 }
 
@@ -81,9 +290,22 @@ QRect KisFilterMask::decorateRect(KisPaintDeviceSP &src,
     KIS_ASSERT_RECOVER_NOOP(this->busyProgressIndicator());
     this->busyProgressIndicator()->update();
 
-    filter->process(src, dst, 0, rc, filterConfig.data(), 0);
+    const int lod = dst->defaultBounds()->currentLevelOfDetail();
+
+    /**
+     * Only the filters that read pixels around the processed area are
+     * worth caching, the per-pixel filters are cheaper than hashing
+     * their input.
+     */
+    const QRect probeRect(0, 0, Private::tileSize, Private::tileSize);
+
+    if (filter->neededRect(probeRect, filterConfig.data(), lod) != probeRect) {
+        m_d->processCached(filter, filterConfig, src, dst, rc, lod);
+    } else {
+        filter->process(src, dst, 0, rc, filterConfig.data(), 0);
+    }
 
-    QRect r = filter->changedRect(rc, filterConfig.data(), dst->defaultBounds()->currentLevelOfDetail());
+    QRect r = filter->changedRect(rc, filterConfig.data(), lod);
     return r;
 }
 
@@ -10,8 +10,16 @@
 #include "kis_convolution_kernel.h"
 #include <kis_convolution_painter.h>
 #include <kis_transaction.h>
+#include <kis_paint_device.h>
+#include <kis_default_bounds.h>
+#include <kis_math_toolbox.h>
+#include <KoChannelInfo.h>
+#include <KoColorSpace.h>
+#include <KoUpdater.h>
 #include <QRect>
 
+#include <limits>
+
 
 qreal KisGaussianKernel::sigmaFromRadius(qreal radius)
 {
@@ -99,14 +107,33 @@ KisGaussianKernel::createUniform2DKernel(qreal xRadius, qreal yRadius)
 }
 
 
+bool KisGaussianKernel::usesRecursiveGaussian(BlurAlgorithm algorithm, qreal xRadius, qreal yRadius)
+{
+    /**
+     * Below this radius the explicit kernels are still fast enough and
+     * they are a bit more precise than the recursive approximation
+     */
+    const qreal minRecursiveRadius = 100.0;
+
+    return algorithm == Recursive ||
+        (algorithm == Auto && qMax(xRadius, yRadius) > minRecursiveRadius);
+}
+
 void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
                                       const QRect& rect,
                                       qreal xRadius, qreal yRadius,
                                       const QBitArray &channelFlags,
                                       KoUpdater *progressUpdater,
                                       bool createTransaction,
-                                      KisConvolutionBorderOp borderOp)
+                                      KisConvolutionBorderOp borderOp,
+                                      BlurAlgorithm algorithm)
 {
+    if (usesRecursiveGaussian(algorithm, xRadius, yRadius)) {
+        applyRecursiveGaussian(device, rect, xRadius, yRadius,
+                               channelFlags, progressUpdater, createTransaction, borderOp);
+        return;
+    }
+
     QPoint srcTopLeft = rect.topLeft();
 
 
@@ -177,6 +204,343 @@ void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
     }
 }
 
+namespace {
+
+struct RecursiveGaussianCoefficients
+{
+    RecursiveGaussianCoefficients(qreal sigma)
+    {
+        // the approximation of q is valid only for sigma >= 0.5
+        sigma = qMax(sigma, 0.5);
+
+        const qreal q = sigma >= 2.5 ?
+            0.98711 * sigma - 0.96330 :
+            3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+
+        const qreal q2 = pow2(q);
+        const qreal q3 = q2 * q;
+
+        const qreal b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+
+        b1 = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+        b2 = -(1.4281 * q2 + 1.26661 * q3) / b0;
+        b3 = 0.422205 * q3 / b0;
+        B = 1.0 - (b1 + b2 + b3);
+    }
+
+    qreal B {1.0};
+    qreal b1 {0.0};
+    qreal b2 {0.0};
+    qreal b3 {0.0};
+};
+
+void recursiveGaussianLine(qreal *data, int size, const RecursiveGaussianCoefficients &c)
+{
+    /**
+     * The lines are padded with the real data around the applied
+     * rect, so it is enough to start both passes from a steady state
+     * of the outermost pixel.
+     */
+
+    qreal w1 = data[0];
+    qreal w2 = w1;
+    qreal w3 = w1;
+
+    for (int i = 0; i < size; i++) {
+        const qreal w = c.B * data[i] + c.b1 * w1 + c.b2 * w2 + c.b3 * w3;
+        data[i] = w;
+        w3 = w2;
+        w2 = w1;
+        w1 = w;
+    }
+
+    w1 = data[size - 1];
+    w2 = w1;
+    w3 = w1;
+
+    for (int i = size - 1; i >= 0; i--) {
+        const qreal w = c.B * data[i] + c.b1 * w1 + c.b2 * w2 + c.b3 * w3;
+        data[i] = w;
+        w3 = w2;
+        w2 = w1;
+        w1 = w;
+    }
+}
+
+/**
+ * Converts pixels into planar alpha-premultiplied channel values and
+ * back, only the channels enabled in the channel flags are touched.
+ */
+struct RecursiveGaussianPixelCodec
+{
+    RecursiveGaussianPixelCodec(const KoColorSpace *cs, const QBitArray &channelFlags)
+        : pixelSize(cs->pixelSize())
+    {
+        const QList<KoChannelInfo*> allChannels = cs->channels();
+
+        for (int i = 0; i < allChannels.size(); i++) {
+            if (channelFlags.isEmpty() || channelFlags.testBit(i)) {
+                channels.append(allChannels[i]);
+            }
+        }
+
+        KisMathToolbox mathToolbox;
+
+        for (int i = 0; i < channels.size(); i++) {
+            minValue.append(mathToolbox.minChannelValue(channels[i]));
+            maxValue.append(mathToolbox.maxChannelValue(channels[i]));
+
+            if (channels[i]->channelType() == KoChannelInfo::ALPHA) {
+                alphaIndex = i;
+            }
+        }
+
+        bool result = mathToolbox.getToDoubleChannelPtr(channels, toDouble);
+        result &= mathToolbox.getFromDoubleChannelPtr(channels, fromDouble);
+        KIS_ASSERT(result);
+    }
+
+    int numChannels() const {
+        return channels.size();
+    }
+
+    void unpack(const quint8 *src, int numPixels, qreal *dst, int pixelStep, int planeStride) const
+    {
+        for (int i = 0; i < numPixels; i++, src += pixelSize, dst += pixelStep) {
+            const qreal alpha = alphaIndex >= 0 ?
+                toDouble[alphaIndex](src, channels[alphaIndex]->pos()) : 1.0;
+
+            for (int k = 0; k < channels.size(); k++) {
+                dst[k * planeStride] = k == alphaIndex ?
+                    alpha : toDouble[k](src, channels[k]->pos()) * alpha;
+            }
+        }
+    }
+
+    void pack(const qreal *src, int numPixels, int pixelStep, int planeStride, quint8 *dst) const
+    {
+        for (int i = 0; i < numPixels; i++, src += pixelStep, dst += pixelSize) {
+            qreal alphaInv = 1.0;
+
+            if (alphaIndex >= 0) {
+                const qreal alpha = qBound(minValue[alphaIndex],
+                                           src[alphaIndex * planeStride],
+                                           maxValue[alphaIndex]);
+                fromDouble[alphaIndex](dst, channels[alphaIndex]->pos(), alpha);
+
+                alphaInv = alpha > std::numeric_limits<qreal>::epsilon() ? 1.0 / alpha : 0.0;
+            }
+
+            for (int k = 0; k < channels.size(); k++) {
+                if (k == alphaIndex) continue;
+
+                const qreal value = qBound(minValue[k],
+                                           src[k * planeStride] * alphaInv,
+                                           maxValue[k]);
+                fromDouble[k](dst, channels[k]->pos(), value);
+            }
+        }
+    }
+
+    const int pixelSize;
+    QList<KoChannelInfo*> channels;
+    QVector<qreal> minValue;
+    QVector<qreal> maxValue;
+    QVector<PtrToDouble> toDouble;
+    QVector<PtrFromDouble> fromDouble;
+    int alphaIndex {-1};
+};
+
+/**
+ * Reads \p rc from \p dev the same way BORDER_REPEAT convolution does:
+ * the pixels outside \p clampRect are replaced with the nearest pixel
+ * inside it. Empty \p clampRect means no clamping.
+ */
+void readBytesClamped(KisPaintDeviceSP dev, quint8 *data, const QRect &rc,
+                      const QRect &clampRect, int pixelSize)
+{
+    if (clampRect.isEmpty() || clampRect.contains(rc)) {
+        dev->readBytes(data, rc);
+        return;
+    }
+
+    const QRect readRect(QPoint(qBound(clampRect.left(), rc.left(), clampRect.right()),
+                                qBound(clampRect.top(), rc.top(), clampRect.bottom())),
+                         QPoint(qBound(clampRect.left(), rc.right(), clampRect.right()),
+                                qBound(clampRect.top(), rc.bottom(), clampRect.bottom())));
+
+    QVector<quint8> buffer(readRect.width() * readRect.height() * pixelSize);
+    dev->readBytes(buffer.data(), readRect);
+
+    const int leftFill = readRect.left() - rc.left();
+    const int rightFill = rc.right() - readRect.right();
+    const int readRowSize = readRect.width() * pixelSize;
+
+    for (int row = 0; row < rc.height(); row++) {
+        const int srcRow = qBound(readRect.top(), rc.top() + row, readRect.bottom()) - readRect.top();
+        const quint8 *src = buffer.constData() + srcRow * readRowSize;
+        quint8 *dst = data + row * rc.width() * pixelSize;
+
+        for (int i = 0; i < leftFill; i++, dst += pixelSize) {
+            memcpy(dst, src, pixelSize);
+        }
+
+        memcpy(dst, src, readRowSize);
+        dst += readRowSize;
+
+        const quint8 *lastPixel = src + readRowSize - pixelSize;
+        for (int i = 0; i < rightFill; i++, dst += pixelSize) {
+            memcpy(dst, lastPixel, pixelSize);
+        }
+    }
+}
+
+}
+
+void KisGaussianKernel::applyRecursiveGaussian(KisPaintDeviceSP device,
+                                               const QRect& rect,
+                                               qreal xRadius, qreal yRadius,
+                                               const QBitArray &channelFlags,
+                                               KoUpdater *progressUpdater,
+                                               bool createTransaction,
+                                               KisConvolutionBorderOp borderOp)
+{
+    const int xMargin = xRadius > 0.0 ? kernelSizeFromRadius(xRadius) / 2 : 0;
+    const int yMargin = yRadius > 0.0 ? kernelSizeFromRadius(yRadius) / 2 : 0;
+
+    if (rect.isEmpty() || (!xMargin && !yMargin)) return;
+
+    const KoColorSpace *cs = device->colorSpace();
+    const int pixelSize = cs->pixelSize();
+    const RecursiveGaussianPixelCodec codec(cs, channelFlags);
+    const int numChannels = codec.numChannels();
+
+    QScopedPointer<KisTransaction> transaction;
+    if (createTransaction) {
+        transaction.reset(new KisTransaction(device));
+    }
+
+    /**
+     * The horizontal pass goes row by row through the rect grown by the
+     * vertical margin, the vertical pass goes through narrow column strips
+     * of the result. Therefore we never keep more than a strip of unpacked
+     * data in memory, even for huge images.
+     */
+    /**
+     * Repeat the border pixels of the image (or of the requested rect,
+     * if it is bigger) exactly like KisConvolutionPainter does for
+     * BORDER_REPEAT. In wraparound mode the device reads the wrapped
+     * pixels itself.
+     */
+    QRect clampRect;
+    if (borderOp == BORDER_REPEAT && !device->defaultBounds()->wrapAroundMode()) {
+        const QRect boundsRect = device->defaultBounds()->bounds();
+        clampRect = boundsRect != KisDefaultBounds().bounds() ?
+            rect | boundsRect : rect | device->exactBounds();
+    }
+
+    KisPaintDeviceSP interm = device;
+    if (xMargin && yMargin) {
+        interm = new KisPaintDevice(cs);
+        interm->prepareClone(device);
+    }
+
+    const int stripWidth = 64;
+    const int numRows = xMargin ? rect.height() + 2 * yMargin : 0;
+    const int numStrips = yMargin ? (rect.width() + stripWidth - 1) / stripWidth : 0;
+    const int totalSteps = numRows + numStrips * stripWidth;
+    int currentStep = 0;
+
+    if (xMargin) {
+        const RecursiveGaussianCoefficients coeffs(sigmaFromRadius(xRadius));
+        QRect srcRect = rect.adjusted(-xMargin, -yMargin, xMargin, yMargin);
+        const int lineSize = srcRect.width();
+
+        /**
+         * The rows outside the clamp rect are never read by the vertical
+         * pass, it repeats the border rows instead
+         */
+        if (!clampRect.isEmpty()) {
+            srcRect.setTop(qMax(srcRect.top(), clampRect.top()));
+            srcRect.setBottom(qMin(srcRect.bottom(), clampRect.bottom()));
+        }
+
+        QVector<quint8> line(lineSize * pixelSize);
+        QVector<qreal> planes(lineSize * numChannels);
+
+        for (int y = srcRect.top(); y <= srcRect.bottom(); y++) {
+            readBytesClamped(device, line.data(), QRect(srcRect.x(), y, lineSize, 1),
+                             clampRect, pixelSize);
+            codec.unpack(line.data(), lineSize, planes.data(), 1, lineSize);
+
+            for (int k = 0; k < numChannels; k++) {
+                recursiveGaussianLine(planes.data() + k * lineSize, lineSize, coeffs);
+            }
+
+            quint8 *dstPtr = line.data() + xMargin * pixelSize;
+            codec.pack(planes.data() + xMargin, rect.width(), 1, lineSize, dstPtr);
+            interm->writeBytes(dstPtr, rect.x(), y, rect.width(), 1);
+
+            if (progressUpdater && !(++currentStep % 64)) {
+                progressUpdater->setProgress(100 * currentStep / totalSteps);
+                if (progressUpdater->interrupted()) return;
+            }
+        }
+    }
+
+    if (yMargin) {
+        const RecursiveGaussianCoefficients coeffs(sigmaFromRadius(yRadius));
+        const int lineSize = rect.height() + 2 * yMargin;
+
+        QVector<quint8> strip(stripWidth * lineSize * pixelSize);
+        QVector<qreal> planes(stripWidth * lineSize * numChannels);
+
+        for (int x = rect.x(); x <= rect.right(); x += stripWidth) {
+            const int width = qMin(stripWidth, rect.right() - x + 1);
+            const int planeStride = width * lineSize;
+
+            readBytesClamped(interm, strip.data(), QRect(x, rect.y() - yMargin, width, lineSize),
+                             clampRect, pixelSize);
+
+            for (int row = 0; row < lineSize; row++) {
+                codec.unpack(strip.data() + row * width * pixelSize, width,
+                             planes.data() + row, lineSize, planeStride);
+            }
+
+            for (int k = 0; k < numChannels; k++) {
+                for (int column = 0; column < width; column++) {
+                    recursiveGaussianLine(planes.data() + k * planeStride + column * lineSize,
+                                          lineSize, coeffs);
+                }
+            }
+
+            quint8 *dstPtr = strip.data() + yMargin * width * pixelSize;
+
+            // the channels that are not blurred should come from the device itself
+            if (interm != device) {
+                device->readBytes(dstPtr, x, rect.y(), width, rect.height());
+            }
+
+            for (int row = yMargin; row < yMargin + rect.height(); row++) {
+                codec.pack(planes.data() + row, width, lineSize, planeStride,
+                           strip.data() + row * width * pixelSize);
+            }
+
+            device->writeBytes(dstPtr, x, rect.y(), width, rect.height());
+
+            if (progressUpdater) {
+                currentStep += stripWidth;
+                progressUpdater->setProgress(100 * currentStep / totalSteps);
+                if (progressUpdater->interrupted()) return;
+            }
+        }
+    }
+
+    if (progressUpdater) {
+        progressUpdater->setProgress(100);
+    }
+}
+
 Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>
 KisGaussianKernel::createLoGMatrix(qreal radius, qreal coeff, bool zeroCentered, bool includeWrappedArea)
 {
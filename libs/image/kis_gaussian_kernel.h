@@ -18,6 +18,12 @@ class QRect;
 class KRITAIMAGE_EXPORT KisGaussianKernel
 {
 public:
+    enum BlurAlgorithm {
+        Auto = 0, ///< recursive filter for large radii, convolution otherwise
+        Convolution, ///< explicit kernel, spatial or FFTW
+        Recursive ///< Young-van Vliet IIR filter, constant cost per pixel
+    };
+
     static Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>
         createHorizontalMatrix(qreal radius);
 
@@ -36,13 +42,36 @@ public:
     static qreal sigmaFromRadius(qreal radius);
     static int kernelSizeFromRadius(qreal radius);
 
+    /**
+     * \return true if applyGaussian() with \p algorithm and the given
+     * radii will use the recursive filter. The recursive filter reads
+     * only kernelSizeFromRadius() / 2 pixels around the applied rect.
+     */
+    static bool usesRecursiveGaussian(BlurAlgorithm algorithm, qreal xRadius, qreal yRadius);
+
     static void applyGaussian(KisPaintDeviceSP device,
                               const QRect& rect,
                               qreal xRadius, qreal yRadius,
                               const QBitArray &channelFlags,
                               KoUpdater *updater,
                               bool createTransaction = false,
-                              KisConvolutionBorderOp borderOp = BORDER_REPEAT);
+                              KisConvolutionBorderOp borderOp = BORDER_REPEAT,
+                              BlurAlgorithm algorithm = Auto);
+
+    /**
+     * Approximates the Gaussian blur with a recursive (IIR) filter
+     * described in I. T. Young, L. J. van Vliet, "Recursive implementation
+     * of the Gaussian filter", 1995. The cost per pixel does not depend on
+     * the radius, so it is used for the large radii, where the explicit
+     * kernels become too slow.
+     */
+    static void applyRecursiveGaussian(KisPaintDeviceSP device,
+                                       const QRect& rect,
+                                       qreal xRadius, qreal yRadius,
+                                       const QBitArray &channelFlags,
+                                       KoUpdater *updater,
+                                       bool createTransaction = false,
+                                       KisConvolutionBorderOp borderOp = BORDER_REPEAT);
 
     static Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> createLoGMatrix(qreal radius, qreal coeff, bool zeroCentered, bool includeWrappedArea);
 
@@ -109,6 +109,25 @@ void KisImageConfig::setUpdatePatchWidth(int value)
     m_config.writeEntry("updatePatchWidth", value);
 }
 
+int KisImageConfig::updateSubtaskSize(bool requestDefault) const
+{
+    const int defaultSubtaskSize = 128;
+
+    int subtaskSize = !requestDefault ?
+        m_config.readEntry("updateSubtaskSize", defaultSubtaskSize) :
+        defaultSubtaskSize;
+
+    if (subtaskSize < 0) return defaultSubtaskSize;
+
+    // subtasks should never share a tile between each other
+    return (subtaskSize + 63) & ~63;
+}
+
+void KisImageConfig::setUpdateSubtaskSize(int value)
+{
+    m_config.writeEntry("updateSubtaskSize", value);
+}
+
 qreal KisImageConfig::maxCollectAlpha() const
 {
     return m_config.readEntry("maxCollectAlpha", 2.5);
@@ -168,6 +187,65 @@ void KisImageConfig::setSwapWindowSize(int value)
     m_config.writeEntry("swapWindowSize", value);
 }
 
+int KisImageConfig::swapMappedWindows() const
+{
+    return m_config.readEntry("swapMappedWindows", 8);
+}
+
+void KisImageConfig::setSwapMappedWindows(int value)
+{
+    m_config.writeEntry("swapMappedWindows", value);
+}
+
+QString KisImageConfig::swapCompression(bool requestDefault) const
+{
+    // the swap file is read much more often than written, so prefer
+    // the algorithm with the fastest decompression
+    const QString defaultValue = "LZ4";
+    return !requestDefault ? m_config.readEntry("swapCompression", defaultValue) : defaultValue;
+}
+
+void KisImageConfig::setSwapCompression(const QString &value)
+{
+    m_config.writeEntry("swapCompression", value);
+}
+
+QString KisImageConfig::documentTileCompression(bool requestDefault) const
+{
+    // LZF is the only algorithm older versions of Krita can load
+    const QString defaultValue = "LZF";
+    return !requestDefault ? m_config.readEntry("documentTileCompression", defaultValue) : defaultValue;
+}
+
+void KisImageConfig::setDocumentTileCompression(const QString &value)
+{
+    m_config.writeEntry("documentTileCompression", value);
+}
+
+int KisImageConfig::swapTilePredictor(bool requestDefault) const
+{
+    // horizontal predictor, cheap enough to be used on every swap-out
+    const int defaultValue = 1;
+    return !requestDefault ? m_config.readEntry("swapTilePredictor", defaultValue) : defaultValue;
+}
+
+void KisImageConfig::setSwapTilePredictor(int value)
+{
+    m_config.writeEntry("swapTilePredictor", value);
+}
+
+int KisImageConfig::documentTilePredictor(bool requestDefault) const
+{
+    // no predictor, older versions of Krita cannot read such tiles
+    const int defaultValue = 0;
+    return !requestDefault ? m_config.readEntry("documentTilePredictor", defaultValue) : defaultValue;
+}
+
+void KisImageConfig::setDocumentTilePredictor(int value)
+{
+    m_config.writeEntry("documentTilePredictor", value);
+}
+
 int KisImageConfig::tilesHardLimit() const
 {
     qreal hp = qreal(memoryHardLimitPercent()) / 100.0;
@@ -224,6 +302,17 @@ void KisImageConfig::setMemoryPoolLimitPercent(qreal value)
     m_config.writeEntry("memoryPoolLimitPercent", value);
 }
 
+int KisImageConfig::shapeRasterCacheLimit(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("shapeRasterCacheLimit", 128) : 128;
+}
+
+void KisImageConfig::setShapeRasterCacheLimit(int value)
+{
+    m_config.writeEntry("shapeRasterCacheLimit", value);
+}
+
 QString KisImageConfig::safelyGetWritableTempLocation(const QString &suffix, const QString &configKey, bool requestDefault) const
 {
 #ifdef Q_OS_MACOS
@@ -31,6 +31,13 @@ public:
     int updatePatchWidth() const;
     void setUpdatePatchWidth(int value);
 
+    /**
+     * Size of the tile-aligned subtasks a merge job is split into,
+     * so that idle threads could steal them. Zero disables splitting.
+     */
+    int updateSubtaskSize(bool requestDefault = false) const;
+    void setUpdateSubtaskSize(int value);
+
     qreal maxCollectAlpha() const;
     qreal maxMergeAlpha() const;
     qreal maxMergeCollectAlpha() const;
@@ -46,6 +53,31 @@ public:
     int swapWindowSize() const;
     void setSwapWindowSize(int value);
 
+    int swapMappedWindows() const;
+    void setSwapMappedWindows(int value);
+
+    /**
+     * Names of the tile compression algorithms (see
+     * KisCompressionRegistry) used for the swap file and for the
+     * pixel data saved into documents
+     */
+    QString swapCompression(bool requestDefault = false) const;
+    void setSwapCompression(const QString &value);
+
+    QString documentTileCompression(bool requestDefault = false) const;
+    void setDocumentTileCompression(const QString &value);
+
+    /**
+     * Prediction filters (KisTileCompressor2::Predictor) applied to
+     * the tiles before compressing them into the swap file and into
+     * documents
+     */
+    int swapTilePredictor(bool requestDefault = false) const;
+    void setSwapTilePredictor(int value);
+
+    int documentTilePredictor(bool requestDefault = false) const;
+    void setDocumentTilePredictor(int value);
+
     int tilesHardLimit() const; // MiB
     int tilesSoftLimit() const; // MiB
     int poolLimit() const; // MiB
@@ -57,6 +89,9 @@ public:
     void setMemorySoftLimitPercent(qreal value);
     void setMemoryPoolLimitPercent(qreal value);
 
+    int shapeRasterCacheLimit(bool requestDefault = false) const; // MiB, 0 disables the cache of rendered vector shapes
+    void setShapeRasterCacheLimit(int value);
+
     static int totalRAM(); // MiB
 
     /**
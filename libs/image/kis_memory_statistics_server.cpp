@@ -8,6 +8,7 @@
 
 #include <QGlobalStatic>
 #include <QApplication>
+#include <QAtomicInteger>
 
 #include "kis_image.h"
 #include "kis_image_config.h"
@@ -25,6 +26,9 @@ struct Q_DECL_HIDDEN KisMemoryStatisticsServer::Private
     }
 
     KisSignalCompressor updateCompressor;
+
+    QAtomicInteger<qint64> filterMaskCacheHits;
+    QAtomicInteger<qint64> filterMaskCacheMisses;
 };
 
 
@@ -152,9 +156,18 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     stats.tilesPoolLimit = cfg.poolLimit() * MiB;
     stats.totalMemoryLimit = stats.tilesHardLimit + stats.tilesPoolLimit;
 
+    stats.filterMaskCacheHits = m_d->filterMaskCacheHits.loadAcquire();
+    stats.filterMaskCacheMisses = m_d->filterMaskCacheMisses.loadAcquire();
+
     return stats;
 }
 
+void KisMemoryStatisticsServer::notifyFilterMaskCacheAccess(int hits, int misses)
+{
+    m_d->filterMaskCacheHits.fetchAndAddRelaxed(hits);
+    m_d->filterMaskCacheMisses.fetchAndAddRelaxed(misses);
+}
+
 void KisMemoryStatisticsServer::tryForceUpdateMemoryStatisticsWhileIdle()
 {
     KisTileDataStore::instance()->tryForceUpdateMemoryStatisticsWhileIdle();
@@ -37,7 +37,10 @@ public:
               totalMemoryLimit(0),
               tilesHardLimit(0),
               tilesSoftLimit(0),
-              tilesPoolLimit(0)
+              tilesPoolLimit(0),
+
+              filterMaskCacheHits(0),
+              filterMaskCacheMisses(0)
         {
         }
 
@@ -57,6 +60,9 @@ public:
         qint64 tilesHardLimit;
         qint64 tilesSoftLimit;
         qint64 tilesPoolLimit;
+
+        qint64 filterMaskCacheHits;
+        qint64 filterMaskCacheMisses;
     };
 
 
@@ -68,6 +74,12 @@ public:
 
     Statistics fetchMemoryStatistics(KisImageSP image) const;
 
+    /**
+     * Called by filter masks when they look up their cached output tiles,
+     * may be called from any thread
+     */
+    void notifyFilterMaskCacheAccess(int hits, int misses);
+
 public Q_SLOTS:
     void notifyImageChanged();
     void tryForceUpdateMemoryStatisticsWhileIdle();
@@ -9,9 +9,12 @@
 #include <QMutexLocker>
 #include <QVector>
 
+#include <algorithm>
+
 #include "kis_image_config.h"
 #include "kis_full_refresh_walker.h"
 #include "kis_spontaneous_job.h"
+#include "kis_update_time_monitor.h"
 
 
 //#define ENABLE_DEBUG_JOIN
@@ -111,6 +114,11 @@ bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
 
             updaterContext.addMergeJob(item);
             iter.remove();
+
+            releaseDirtyTiles(item);
+            KisUpdateTimeMonitor::instance()->reportUpdateRecomputed(
+                qint64(item->requestedRect().width()) * item->requestedRect().height());
+
             jobAdded = true;
             break;
         }
@@ -191,27 +199,22 @@ void KisSimpleUpdateQueue::addJob(KisNodeSP node, const QVector<QRect> &rects,
     Q_FOREACH (const QRect &rc, rects) {
         if (rc.isEmpty()) continue;
 
-        KisBaseRectsWalkerSP walker;
-
         if(trySplitJob(node, rc, cropRect, levelOfDetail, type)) continue;
-        if(tryMergeJob(node, rc, cropRect, levelOfDetail, type)) continue;
 
-        if (type == KisBaseRectsWalker::UPDATE) {
-            walker = new KisMergeWalker(cropRect, KisMergeWalker::DEFAULT);
-        }
-        else if (type == KisBaseRectsWalker::FULL_REFRESH)  {
-            walker = new KisFullRefreshWalker(cropRect);
-        }
-        else if (type == KisBaseRectsWalker::UPDATE_NO_FILTHY) {
-            walker = new KisMergeWalker(cropRect, KisMergeWalker::NO_FILTHY);
-        }
-        else if (type == KisBaseRectsWalker::FULL_REFRESH_NO_FILTHY)  {
-            walker = new KisFullRefreshWalker(cropRect, KisFullRefreshWalker::NoFilthyMode);
-        }
-        /* else if(type == KisBaseRectsWalker::UNSUPPORTED) fatalKrita; */
+        KisUpdateTimeMonitor::instance()->reportUpdateRequested(qint64(rc.width()) * rc.height());
 
-        walker->collectRects(node, rc);
-        walkers.append(walker);
+        const QVector<QRect> pieces =
+            coalesceDirtyTiles(node, rc, cropRect, levelOfDetail, type);
+
+        for (const QRect &piece : pieces) {
+            if(tryMergeJob(node, piece, cropRect, levelOfDetail, type)) continue;
+
+            KisBaseRectsWalkerSP walker = createWalker(type, cropRect);
+            KIS_SAFE_ASSERT_RECOVER(walker) { continue; }
+
+            walker->collectRects(node, piece);
+            walkers.append(walker);
+        }
     }
 
     if (!walkers.isEmpty()) {
@@ -221,6 +224,28 @@ void KisSimpleUpdateQueue::addJob(KisNodeSP node, const QVector<QRect> &rects,
     }
 }
 
+KisBaseRectsWalkerSP KisSimpleUpdateQueue::createWalker(KisBaseRectsWalker::UpdateType type,
+                                                        const QRect &cropRect)
+{
+    KisBaseRectsWalkerSP walker;
+
+    if (type == KisBaseRectsWalker::UPDATE) {
+        walker = new KisMergeWalker(cropRect, KisMergeWalker::DEFAULT);
+    }
+    else if (type == KisBaseRectsWalker::FULL_REFRESH)  {
+        walker = new KisFullRefreshWalker(cropRect);
+    }
+    else if (type == KisBaseRectsWalker::UPDATE_NO_FILTHY) {
+        walker = new KisMergeWalker(cropRect, KisMergeWalker::NO_FILTHY);
+    }
+    else if (type == KisBaseRectsWalker::FULL_REFRESH_NO_FILTHY)  {
+        walker = new KisFullRefreshWalker(cropRect, KisFullRefreshWalker::NoFilthyMode);
+    }
+    /* else if(type == KisBaseRectsWalker::UNSUPPORTED) fatalKrita; */
+
+    return walker;
+}
+
 void KisSimpleUpdateQueue::addSpontaneousJob(KisSpontaneousJob *spontaneousJob)
 {
     QMutexLocker locker(&m_lock);
@@ -327,6 +352,122 @@ bool KisSimpleUpdateQueue::tryMergeJob(KisNodeSP node, const QRect& rc,
     return (bool)goodCandidate;
 }
 
+/**
+ * Deduplicates the incoming update \p rc at the tile granularity. The
+ * tiles of \p rc that are fully covered by some walker waiting in the
+ * queue are dropped, the rest of the tiles are grouped into rectangular
+ * runs of connected tiles, which are returned to the caller. Every
+ * returned rect is cropped by \p rc, so the walkers never recompute
+ * more pixels than requested. The tiles fully covered by \p rc are
+ * marked as dirty until the walker leaves the queue.
+ */
+QVector<QRect> KisSimpleUpdateQueue::coalesceDirtyTiles(KisNodeSP node, const QRect& rc,
+                                                        const QRect& cropRect,
+                                                        int levelOfDetail,
+                                                        KisBaseRectsWalker::UpdateType type)
+{
+    QMutexLocker locker(&m_lock);
+
+    auto tilesIt =
+        std::find_if(m_dirtyTiles.begin(), m_dirtyTiles.end(),
+                     [&] (const DirtyTiles &tiles) {
+                         return tiles.node == node &&
+                             tiles.type == type &&
+                             tiles.cropRect == cropRect &&
+                             tiles.levelOfDetail == levelOfDetail;
+                     });
+
+    if (tilesIt == m_dirtyTiles.end()) {
+        m_dirtyTiles.append({node, type, cropRect, levelOfDetail, KisRectsGrid(TileSize)});
+        m_dirtyTiles.last().grid.addAlignedRect(m_dirtyTiles.last().grid.shrinkRect(rc));
+        return {rc};
+    }
+
+    KisRectsGrid &grid = tilesIt->grid;
+    const QRect alignedRect = grid.alignRect(rc);
+
+    QVector<QRect> pieces;
+    QVector<QRect> openPieces;
+
+    for (int y = alignedRect.top(); y <= alignedRect.bottom(); y += TileSize) {
+        QVector<QRect> rowRuns;
+        QRect run;
+
+        for (int x = alignedRect.left(); x <= alignedRect.right(); x += TileSize) {
+            const QRect tileRect(x, y, TileSize, TileSize);
+
+            if (!grid.contains(tileRect)) {
+                run |= tileRect;
+            } else if (!run.isEmpty()) {
+                rowRuns.append(run);
+                run = QRect();
+            }
+        }
+
+        if (!run.isEmpty()) {
+            rowRuns.append(run);
+        }
+
+        /**
+         * The runs having exactly the same span as the pieces of
+         * the previous row continue these pieces downwards, all
+         * other pieces are finished
+         */
+        QVector<QRect> nextOpenPieces;
+
+        for (QRect run : rowRuns) {
+            auto it = std::find_if(openPieces.begin(), openPieces.end(),
+                                   [&run] (const QRect &piece) {
+                                       return piece.left() == run.left() &&
+                                           piece.right() == run.right();
+                                   });
+
+            if (it != openPieces.end()) {
+                run |= *it;
+                openPieces.erase(it);
+            }
+
+            nextOpenPieces.append(run);
+        }
+
+        pieces += openPieces;
+        openPieces = nextOpenPieces;
+    }
+
+    pieces += openPieces;
+
+    for (QRect &piece : pieces) {
+        piece &= rc;
+    }
+
+    grid.addAlignedRect(grid.shrinkRect(rc));
+
+    return pieces;
+}
+
+void KisSimpleUpdateQueue::releaseDirtyTiles(KisBaseRectsWalkerSP walker)
+{
+    /**
+     * When the queue is empty, no tiles can be dirty anymore. Dropping
+     * the grids also releases the references to the nodes.
+     */
+    if (m_updatesList.isEmpty()) {
+        m_dirtyTiles.clear();
+        return;
+    }
+
+    for (DirtyTiles &tiles : m_dirtyTiles) {
+        if (tiles.node == walker->startNode() &&
+            tiles.type == walker->type() &&
+            tiles.cropRect == walker->cropRect() &&
+            tiles.levelOfDetail == walker->levelOfDetail()) {
+
+            tiles.grid.removeRect(walker->requestedRect());
+            break;
+        }
+    }
+}
+
 void KisSimpleUpdateQueue::optimize()
 {
     QMutexLocker locker(&m_lock);
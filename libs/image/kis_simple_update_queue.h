@@ -9,6 +9,7 @@
 
 #include <QMutex>
 #include "kis_updater_context.h"
+#include "KisRectsGrid.h"
 
 typedef QList<KisBaseRectsWalkerSP> KisWalkersList;
 typedef QListIterator<KisBaseRectsWalkerSP> KisWalkersListIterator;
@@ -46,6 +47,14 @@ public:
 
     int overrideLevelOfDetail() const;
 
+    /**
+     * Creates an empty walker of the specified \p type. The walker
+     * should be initialized with collectRects() before use. Returns
+     * null for KisBaseRectsWalker::UNSUPPORTED.
+     */
+    static KisBaseRectsWalkerSP createWalker(KisBaseRectsWalker::UpdateType type,
+                                             const QRect &cropRect);
+
 protected:
     void addJob(KisNodeSP node, const QVector<QRect> &rects, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
 
@@ -54,6 +63,9 @@ protected:
     bool trySplitJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
     bool tryMergeJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
 
+    QVector<QRect> coalesceDirtyTiles(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type);
+    void releaseDirtyTiles(KisBaseRectsWalkerSP walker);
+
     void collectJobs(KisBaseRectsWalkerSP &baseWalker, QRect baseRect,
                      const qreal maxAlpha);
     bool joinRects(QRect& baseRect, const QRect& newRect, qreal maxAlpha);
@@ -94,6 +106,25 @@ protected:
     qreal m_maxMergeCollectAlpha;
 
     int m_overrideLevelOfDetail;
+
+    /**
+     * The tiles that are fully covered by the walkers waiting in the
+     * queue. The grids are kept per start node, update type, crop
+     * rect and level of detail, that is, per a set of walkers that
+     * can replace each other. The new requests are deduplicated
+     * against these tiles in coalesceDirtyTiles().
+     */
+    static const int TileSize = 64;
+
+    struct DirtyTiles {
+        KisNodeSP node;
+        KisBaseRectsWalker::UpdateType type;
+        QRect cropRect;
+        int levelOfDetail;
+        KisRectsGrid grid;
+    };
+
+    QVector<DirtyTiles> m_dirtyTiles;
 };
 
 class KRITAIMAGE_EXPORT KisTestableSimpleUpdateQueue : public KisSimpleUpdateQueue
@@ -7,6 +7,9 @@
 #ifndef __KIS_SPONTANEOUS_JOB_H
 #define __KIS_SPONTANEOUS_JOB_H
 
+#include <functional>
+#include <QVector>
+
 #include "kis_runnable_with_debug_name.h"
 
 /**
@@ -17,6 +20,19 @@
  */
 class KRITAIMAGE_EXPORT KisSpontaneousJob : public KisRunnableWithDebugName
 {
+public:
+    /**
+     * An object that executes the subtasks of a running job,
+     * normally, the update job item the job is run by.
+     */
+    class SubtasksExecutor
+    {
+    public:
+        virtual ~SubtasksExecutor() = default;
+        virtual void runSubtasks(const QVector<std::function<void()>> &subtasks) = 0;
+        virtual int subtasksConcurrency() const = 0;
+    };
+
 public:
     virtual bool overrides(const KisSpontaneousJob *otherJob) = 0;
     virtual int levelOfDetail() const = 0;
@@ -24,6 +40,35 @@ public:
         return m_isExclusive;
     }
 
+    /**
+     * Runs \p subtasks and returns when all of them are completed.
+     * When the job is executed by the update scheduler, the idle
+     * threads of the scheduler may steal the subtasks and run them
+     * concurrently. Should be called from run() only.
+     */
+    void runSubtasks(const QVector<std::function<void()>> &subtasks) {
+        if (m_subtasksExecutor) {
+            m_subtasksExecutor->runSubtasks(subtasks);
+        } else {
+            for (const std::function<void()> &subtask : subtasks) {
+                subtask();
+            }
+        }
+    }
+
+    /**
+     * The number of threads that may run the subtasks passed to
+     * runSubtasks() concurrently, including the calling one. Use it
+     * to decide how finely the work should be split.
+     */
+    int subtasksConcurrency() const {
+        return m_subtasksExecutor ? m_subtasksExecutor->subtasksConcurrency() : 1;
+    }
+
+    void setSubtasksExecutor(SubtasksExecutor *executor) {
+        m_subtasksExecutor = executor;
+    }
+
 protected:
     void setExclusive(bool value) {
         m_isExclusive = value;
@@ -31,6 +76,7 @@ protected:
 
 private:
     bool m_isExclusive = false;
+    SubtasksExecutor *m_subtasksExecutor = nullptr;
 };
 
 #endif /* __KIS_SPONTANEOUS_JOB_H */
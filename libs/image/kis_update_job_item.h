@@ -8,9 +8,12 @@
 #define __KIS_UPDATE_JOB_ITEM_H
 
 #include <atomic>
+#include <deque>
 
+#include <QMutex>
 #include <QRunnable>
 #include <QReadWriteLock>
+#include <QWaitCondition>
 
 #include "kis_stroke_job.h"
 #include "kis_spontaneous_job.h"
@@ -21,7 +24,8 @@
 
 //#define DEBUG_JOBS_SEQUENCE
 
-class KRITAIMAGE_EXPORT KisUpdateJobItem : public QObject, public QRunnable
+class KRITAIMAGE_EXPORT KisUpdateJobItem : public QObject, public QRunnable,
+                                            public KisSpontaneousJob::SubtasksExecutor
 {
     Q_OBJECT
 public:
@@ -74,10 +78,20 @@ private:
         while (1) {
             KIS_SAFE_ASSERT_RECOVER_RETURN(isRunning());
 
-            if(m_exclusive) {
-                m_updaterContext->m_exclusiveJobLock.lockForWrite();
-            } else {
-                m_updaterContext->m_exclusiveJobLock.lockForRead();
+            /**
+             * A stolen spontaneous subtask runs under the read lock of
+             * its owner, which waits for it. Taking the lock again could
+             * deadlock: a waiting exclusive job blocks the new readers,
+             * while the owner waits for us.
+             */
+            const bool usesExclusiveLock = !m_spontaneousIsSubtask;
+
+            if (usesExclusiveLock) {
+                if(m_exclusive) {
+                    m_updaterContext->m_exclusiveJobLock.lockForWrite();
+                } else {
+                    m_updaterContext->m_exclusiveJobLock.lockForRead();
+                }
             }
 
             if(m_atomicType == Type::MERGE) {
@@ -108,7 +122,9 @@ private:
             // may flip the current state from Waiting -> Running again
             m_updaterContext->jobFinished();
 
-            m_updaterContext->m_exclusiveJobLock.unlock();
+            if (usesExclusiveLock) {
+                m_updaterContext->m_exclusiveJobLock.unlock();
+            }
 
             // try to exit the loop. Please note, that no one can flip the state from
             // WAITING to EMPTY except ourselves!
@@ -132,19 +148,159 @@ public:
 
 #endif
 
-        m_merger.startMerge(*m_walker);
+        const QVector<KisBaseRectsWalkerSP> subtasks =
+            !m_walkerIsSubtask ?
+            m_updaterContext->splitMergeJob(m_walker) :
+            QVector<KisBaseRectsWalkerSP>();
+
+        if (subtasks.isEmpty()) {
+            m_merger.startMerge(*m_walker);
+
+            QRect changeRect = m_walker->changeRect();
+            m_updaterContext->continueUpdate(changeRect);
+            return;
+        }
+
+        /**
+         * The subtasks are published in our own queue. We process them
+         * from the front, while idle threads of the context steal them
+         * from the back (see KisUpdaterContext::stealMergeJob()). The
+         * access rect of the item is still equal to the one of the
+         * parent walker, so no other job may enter this area until all
+         * the subtasks are done.
+         */
+        {
+            QMutexLocker l(&m_subtasksLock);
+            m_subtasks.assign(subtasks.begin(), subtasks.end());
+        }
+
+        m_updaterContext->subtasksAppeared();
+
+        KisBaseRectsWalkerSP subtask;
+        while ((subtask = takeSubtask(false))) {
+            m_merger.startMerge(*subtask);
+            m_updaterContext->continueUpdate(subtask->changeRect());
+        }
+    }
+
+    /**
+     * Takes one of the queued merge subtasks. The owner of the queue
+     * takes them from the front, thieves from the back.
+     */
+    inline KisBaseRectsWalkerSP takeSubtask(bool fromBack) {
+        QMutexLocker l(&m_subtasksLock);
+
+        KisBaseRectsWalkerSP subtask;
+        if (m_subtasks.empty()) return subtask;
+
+        if (fromBack) {
+            subtask = m_subtasks.back();
+            m_subtasks.pop_back();
+        } else {
+            subtask = m_subtasks.front();
+            m_subtasks.pop_front();
+        }
+
+        return subtask;
+    }
+
+    inline int numSubtasks() {
+        QMutexLocker l(&m_subtasksLock);
+        return int(m_subtasks.size());
+    }
+
+    /**
+     * Runs the subtasks of the current spontaneous job. They are
+     * published the same way as the merge subtasks, but the owner
+     * waits until the stolen ones are finished, because the job is
+     * complete only when all its subtasks are done.
+     */
+    void runSubtasks(const QVector<std::function<void()>> &subtasks) override {
+        KIS_SAFE_ASSERT_RECOVER_NOOP(m_atomicType == Type::SPONTANEOUS);
+
+        /**
+         * Nothing may run concurrently with an exclusive job, so
+         * its subtasks are never published for the thieves
+         */
+        if (m_exclusive) {
+            for (const std::function<void()> &subtask : subtasks) {
+                subtask();
+            }
+            return;
+        }
+
+        {
+            QMutexLocker l(&m_subtasksLock);
+            m_spontaneousSubtasks.assign(subtasks.begin(), subtasks.end());
+            m_numUnfinishedSpontaneousSubtasks = subtasks.size();
+        }
+
+        m_updaterContext->subtasksAppeared();
+
+        std::function<void()> subtask;
+        while ((subtask = takeSpontaneousSubtask(false))) {
+            subtask();
+            spontaneousSubtaskFinished();
+        }
+
+        QMutexLocker l(&m_subtasksLock);
+        while (m_numUnfinishedSpontaneousSubtasks > 0) {
+            m_subtasksFinished.wait(&m_subtasksLock);
+        }
+    }
+
+    int subtasksConcurrency() const override {
+        return m_exclusive || m_updaterContext->m_testingMode ?
+            1 : m_updaterContext->threadsLimit();
+    }
+
+    /**
+     * Takes one of the queued spontaneous subtasks. The owner of the
+     * queue takes them from the front, thieves from the back.
+     */
+    inline std::function<void()> takeSpontaneousSubtask(bool fromBack) {
+        QMutexLocker l(&m_subtasksLock);
+
+        std::function<void()> subtask;
+        if (m_spontaneousSubtasks.empty()) return subtask;
+
+        if (fromBack) {
+            subtask = m_spontaneousSubtasks.back();
+            m_spontaneousSubtasks.pop_back();
+        } else {
+            subtask = m_spontaneousSubtasks.front();
+            m_spontaneousSubtasks.pop_front();
+        }
 
-        QRect changeRect = m_walker->changeRect();
-        m_updaterContext->continueUpdate(changeRect);
+        return subtask;
+    }
+
+    inline void spontaneousSubtaskFinished() {
+        QMutexLocker l(&m_subtasksLock);
+
+        if (--m_numUnfinishedSpontaneousSubtasks == 0) {
+            m_subtasksFinished.wakeAll();
+        }
+    }
+
+    inline int numSpontaneousSubtasks() {
+        QMutexLocker l(&m_subtasksLock);
+        return int(m_spontaneousSubtasks.size());
+    }
+
+    inline int spontaneousLevelOfDetail() const {
+        return m_spontaneousLevelOfDetail;
     }
 
     // return true if the thread should actually be started
-    inline bool setWalker(KisBaseRectsWalkerSP walker) {
+    inline bool setWalker(KisBaseRectsWalkerSP walker, bool isSubtask = false) {
         KIS_ASSERT(m_atomicType <= Type::WAITING);
 
         m_accessRect = walker->accessRect();
         m_changeRect = walker->changeRect();
         m_walker = walker;
+        m_walkerIsSubtask = isSubtask;
+        m_spontaneousIsSubtask = false;
 
         m_exclusive = false;
         m_runnableJob = 0;
@@ -161,6 +317,7 @@ public:
         m_strokeJobSequentiality = strokeJob->sequentiality();
 
         m_exclusive = strokeJob->isExclusive();
+        m_spontaneousIsSubtask = false;
         m_walker = 0;
         m_accessRect = m_changeRect = QRect();
 
@@ -169,10 +326,13 @@ public:
     }
 
     // return true if the thread should actually be started
-    inline bool setSpontaneousJob(KisSpontaneousJob *spontaneousJob) {
+    inline bool setSpontaneousJob(KisSpontaneousJob *spontaneousJob, bool isSubtask = false) {
         KIS_ASSERT(m_atomicType <= Type::WAITING);
 
         m_runnableJob = spontaneousJob;
+        spontaneousJob->setSubtasksExecutor(this);
+        m_spontaneousLevelOfDetail = spontaneousJob->levelOfDetail();
+        m_spontaneousIsSubtask = isSubtask;
 
         m_exclusive = spontaneousJob->isExclusive();
         m_walker = 0;
@@ -251,6 +411,8 @@ private:
      * Merge jobs part
      */
     KisBaseRectsWalkerSP m_walker;
+    bool m_walkerIsSubtask {false};
+    bool m_spontaneousIsSubtask {false};
     KisAsyncMerger m_merger;
 
     /**
@@ -259,6 +421,22 @@ private:
      */
     QRect m_accessRect;
     QRect m_changeRect;
+
+    /**
+     * Merge subtasks of the current walker that
+     * are available for stealing by idle threads
+     */
+    QMutex m_subtasksLock;
+    std::deque<KisBaseRectsWalkerSP> m_subtasks;
+
+    /**
+     * Subtasks of the current spontaneous job, guarded by
+     * the same lock as the merge subtasks
+     */
+    std::deque<std::function<void()>> m_spontaneousSubtasks;
+    int m_numUnfinishedSpontaneousSubtasks {0};
+    int m_spontaneousLevelOfDetail {0};
+    QWaitCondition m_subtasksFinished;
 };
 
 
@@ -323,6 +323,7 @@ void KisUpdateScheduler::updateSettings()
     m_d->updatesQueue.updateSettings();
     KisImageConfig config(true);
     m_d->defaultBalancingRatio = config.schedulerBalancingRatio();
+    m_d->updaterContext.setMergeSubtaskSize(config.updateSubtaskSize());
     setThreadsLimit(config.maxNumberOfThreads());
 }
 
@@ -422,6 +423,12 @@ void KisUpdateScheduler::processQueues()
 
     }
 
+    /**
+     * The subtasks of the running merge and spontaneous jobs get
+     * the threads only after all the queued jobs had their chance
+     */
+    tryStealSubtasks();
+
     progressUpdate();
 }
 
@@ -458,6 +465,15 @@ void KisUpdateScheduler::tryProcessUpdatesQueue()
     m_d->updatesQueue.processQueue(m_d->updaterContext);
 }
 
+void KisUpdateScheduler::tryStealSubtasks()
+{
+    std::lock_guard<KisUpdaterContext> l(m_d->updaterContext);
+
+    while (m_d->updaterContext.hasSpareThread() &&
+           (m_d->updaterContext.stealMergeJob() ||
+            m_d->updaterContext.stealSpontaneousSubtask()));
+}
+
 bool KisUpdateScheduler::haveUpdatesRunning()
 {
     QWriteLocker locker(&m_d->updatesStartLock);
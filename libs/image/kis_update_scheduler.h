@@ -233,6 +233,7 @@ private:
     friend class UpdatesBlockTester;
     bool haveUpdatesRunning();
     void tryProcessUpdatesQueue();
+    void tryStealSubtasks();
     void wakeUpWaitingThreads();
 
     void progressUpdate();
@@ -72,6 +72,8 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
           responseTime(0),
           numTickets(0),
           numUpdates(0),
+          requestedPixels(0),
+          recomputedPixels(0),
           mousePath(0.0),
           loggingEnabled(false)
     {
@@ -85,7 +87,9 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
     qint64 responseTime;
     qint32 numTickets;
     qint32 numUpdates;
-    QMutex mutex;
+    qint64 requestedPixels;
+    qint64 recomputedPixels;
+    mutable QMutex mutex;
 
     qreal mousePath;
     QPointF lastMousePos;
@@ -127,6 +131,8 @@ void KisUpdateTimeMonitor::startStrokeMeasure()
     m_d->responseTime = 0;
     m_d->numTickets = 0;
     m_d->numUpdates = 0;
+    m_d->requestedPixels = 0;
+    m_d->recomputedPixels = 0;
     m_d->mousePath = 0;
 
     m_d->lastMousePos = QPointF();
@@ -192,6 +198,8 @@ void KisUpdateTimeMonitor::printValues()
            << i18n("Mouse Speed:") << QString::number( mouseSpeed, 'f', 3 ) << "\t"
            << i18n("Jobs/Update:") << QString::number( jobsPerUpdate, 'f', 3 ) << "\t"
            << i18n("Non Update Time:") << QString::number( nonUpdateTime, 'f', 3 ) << "\t"
+           << i18n("Requested Pixels:") << m_d->requestedPixels << "\t"
+           << i18n("Recomputed Pixels:") << m_d->recomputedPixels << "\t"
            << i18n("Response Time:") << responseTime << endl; // 'endl' will use the correct OS line ending
     logFile.close();
 }
@@ -245,3 +253,31 @@ void KisUpdateTimeMonitor::reportUpdateFinished(const QRect &rect)
     }
     m_d->numUpdates++;
 }
+
+void KisUpdateTimeMonitor::reportUpdateRequested(qint64 pixels)
+{
+    if (!m_d->loggingEnabled) return;
+
+    QMutexLocker locker(&m_d->mutex);
+    m_d->requestedPixels += pixels;
+}
+
+void KisUpdateTimeMonitor::reportUpdateRecomputed(qint64 pixels)
+{
+    if (!m_d->loggingEnabled) return;
+
+    QMutexLocker locker(&m_d->mutex);
+    m_d->recomputedPixels += pixels;
+}
+
+qint64 KisUpdateTimeMonitor::requestedPixels() const
+{
+    QMutexLocker locker(&m_d->mutex);
+    return m_d->requestedPixels;
+}
+
+qint64 KisUpdateTimeMonitor::recomputedPixels() const
+{
+    QMutexLocker locker(&m_d->mutex);
+    return m_d->recomputedPixels;
+}
@@ -34,6 +34,16 @@ public:
     void reportJobFinished(void *key, const QVector<QRect> &rects);
     void reportUpdateFinished(const QRect &rect);
 
+    /**
+     * Pixels requested by the incoming updates vs. pixels actually
+     * recomputed by the merge jobs after the update queue has
+     * coalesced them
+     */
+    void reportUpdateRequested(qint64 pixels);
+    void reportUpdateRecomputed(qint64 pixels);
+    qint64 requestedPixels() const;
+    qint64 recomputedPixels() const;
+
 
 private:
     struct Private;
@@ -11,9 +11,54 @@
 
 #include "kis_update_job_item.h"
 #include "kis_stroke_job.h"
+#include "kis_simple_update_queue.h"
+#include "kis_algebra_2d.h"
 
 const int KisUpdaterContext::useIdealThreadCountTag = -1;
 
+namespace {
+
+/**
+ * A subtask of a spontaneous job executed by
+ * a thread other than the one of the job itself
+ */
+class KisStolenSpontaneousSubtask : public KisSpontaneousJob
+{
+public:
+    KisStolenSpontaneousSubtask(KisUpdateJobItem *owner,
+                                const std::function<void()> &subtask)
+        : m_owner(owner),
+          m_subtask(subtask),
+          m_levelOfDetail(owner->spontaneousLevelOfDetail())
+    {
+    }
+
+    bool overrides(const KisSpontaneousJob *otherJob) override {
+        Q_UNUSED(otherJob);
+        return false;
+    }
+
+    int levelOfDetail() const override {
+        return m_levelOfDetail;
+    }
+
+    void run() override {
+        m_subtask();
+        m_owner->spontaneousSubtaskFinished();
+    }
+
+    QString debugName() const override {
+        return "KisStolenSpontaneousSubtask";
+    }
+
+private:
+    KisUpdateJobItem *m_owner;
+    std::function<void()> m_subtask;
+    int m_levelOfDetail;
+};
+
+}
+
 KisUpdaterContext::KisUpdaterContext(qint32 threadCount, KisUpdateScheduler *parent)
     : m_scheduler(parent)
 {
@@ -205,6 +250,151 @@ void KisUpdaterContext::addSpontaneousJob(KisSpontaneousJob *spontaneousJob)
     }
 }
 
+bool KisUpdaterContext::stealMergeJob()
+{
+    KisUpdateJobItem *victim = 0;
+    int victimSubtasks = 0;
+
+    for (KisUpdateJobItem *item : std::as_const(m_jobs)) {
+        if (item->type() != KisUpdateJobItem::Type::MERGE) continue;
+
+        const int numSubtasks = item->numSubtasks();
+        if (numSubtasks > victimSubtasks) {
+            victim = item;
+            victimSubtasks = numSubtasks;
+        }
+    }
+
+    if (!victim) return false;
+
+    // the owner might have already taken the last subtask
+    KisBaseRectsWalkerSP subtask = victim->takeSubtask(true);
+    if (!subtask) return false;
+
+    m_lodCounter.addLod(subtask->levelOfDetail());
+    qint32 jobIndex = findSpareThread();
+    Q_ASSERT(jobIndex >= 0);
+
+    // stolen subtasks are never split any further
+    const bool shouldStartThread = m_jobs[jobIndex]->setWalker(subtask, true);
+
+    if (shouldStartThread && !m_testingMode) {
+        startThread(jobIndex);
+    }
+
+    return true;
+}
+
+bool KisUpdaterContext::stealSpontaneousSubtask()
+{
+    if (m_testingMode) return false;
+
+    KisUpdateJobItem *victim = 0;
+
+    for (KisUpdateJobItem *item : std::as_const(m_jobs)) {
+        if (item->type() == KisUpdateJobItem::Type::SPONTANEOUS &&
+            item->numSpontaneousSubtasks() > 0) {
+
+            victim = item;
+            break;
+        }
+    }
+
+    if (!victim) return false;
+
+    // the owner might have already taken the last subtask
+    std::function<void()> subtask = victim->takeSpontaneousSubtask(true);
+    if (!subtask) return false;
+
+    KisSpontaneousJob *job = new KisStolenSpontaneousSubtask(victim, subtask);
+
+    m_lodCounter.addLod(job->levelOfDetail());
+    qint32 jobIndex = findSpareThread();
+    Q_ASSERT(jobIndex >= 0);
+
+    const bool shouldStartThread = m_jobs[jobIndex]->setSpontaneousJob(job, true);
+
+    if (shouldStartThread) {
+        startThread(jobIndex);
+    }
+
+    return true;
+}
+
+QVector<KisBaseRectsWalkerSP> KisUpdaterContext::splitMergeJob(KisBaseRectsWalkerSP walker) const
+{
+    QVector<KisBaseRectsWalkerSP> subtasks;
+
+    int subtaskSize = m_mergeSubtaskSize;
+    if (m_testingMode || subtaskSize <= 0 || m_jobs.size() < 2) return subtasks;
+
+    const QRect rc = walker->requestedRect();
+    if (qint64(rc.width()) * rc.height() < 2 * qint64(subtaskSize) * subtaskSize) return subtasks;
+
+    /**
+     * Too many subtasks would only add the overhead of walking the
+     * graph for every one of them, so we grow the subtasks until
+     * every thread gets just a few of them
+     */
+    const int maxSubtasks = 4 * m_jobs.size();
+
+    int firstCol, lastCol, firstRow, lastRow;
+
+    while (true) {
+        firstCol = KisAlgebra2D::divideFloor(rc.left(), subtaskSize);
+        lastCol = KisAlgebra2D::divideFloor(rc.right(), subtaskSize);
+        firstRow = KisAlgebra2D::divideFloor(rc.top(), subtaskSize);
+        lastRow = KisAlgebra2D::divideFloor(rc.bottom(), subtaskSize);
+
+        if ((lastCol - firstCol + 1) * (lastRow - firstRow + 1) <= maxSubtasks) break;
+        subtaskSize *= 2;
+    }
+
+    if (firstCol == lastCol && firstRow == lastRow) return subtasks;
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int col = firstCol; col <= lastCol; col++) {
+            const QRect subtaskRect =
+                rc & QRect(col * subtaskSize, row * subtaskSize,
+                           subtaskSize, subtaskSize);
+
+            KisBaseRectsWalkerSP subtask =
+                KisSimpleUpdateQueue::createWalker(walker->type(), walker->cropRect());
+            if (!subtask) return {};
+
+            subtask->collectRects(walker->startNode(), subtaskRect);
+
+            /**
+             * The subtasks may be executed concurrently only when they
+             * don't touch the same pixels, that is, there are no filters
+             * or transformations in the stack that would widen their
+             * need rects.
+             */
+            if (subtask->levelOfDetail() != walker->levelOfDetail() ||
+                (!subtask->accessRect().isEmpty() &&
+                 !walker->accessRect().contains(subtask->accessRect()))) {
+
+                return {};
+            }
+
+            for (const KisBaseRectsWalkerSP &other : std::as_const(subtasks)) {
+                if (other->accessRect().intersects(subtask->accessRect())) {
+                    return {};
+                }
+            }
+
+            subtasks.append(subtask);
+        }
+    }
+
+    return subtasks;
+}
+
+void KisUpdaterContext::setMergeSubtaskSize(int value)
+{
+    m_mergeSubtaskSize = value;
+}
+
 void KisUpdaterContext::waitForDone()
 {
     QMutexLocker l(&m_runningThreadsMutex);
@@ -276,6 +466,11 @@ void KisUpdaterContext::continueUpdate(const QRect& rc)
     if (m_scheduler) m_scheduler->continueUpdate(rc);
 }
 
+void KisUpdaterContext::subtasksAppeared()
+{
+    if (m_scheduler) m_scheduler->spareThreadAppeared();
+}
+
 void KisUpdaterContext::doSomeUsefulWork()
 {
     if (m_scheduler) m_scheduler->doSomeUsefulWork();
@@ -7,6 +7,8 @@
 #ifndef __KIS_UPDATER_CONTEXT_H
 #define __KIS_UPDATER_CONTEXT_H
 
+#include <atomic>
+
 #include <QMutex>
 #include <QReadWriteLock>
 #include <QThreadPool>
@@ -93,6 +95,47 @@ public:
      */
     void addSpontaneousJob(KisSpontaneousJob *spontaneousJob);
 
+    /**
+     * Moves one of the merge subtasks published by a running merge
+     * job into a spare thread. The subtasks belong to the area already
+     * reserved by the owner job, so they are not checked with
+     * isJobAllowed(). The caller must lock the context and ensure
+     * there is a spare thread with hasSpareThread().
+     *
+     * \return true if a subtask has been stolen
+     *
+     * \see lock()
+     * \see hasSpareThread()
+     */
+    bool stealMergeJob();
+
+    /**
+     * Moves one of the subtasks published by a running spontaneous
+     * job into a spare thread. The owner job waits for the stolen
+     * subtasks, so they need no extra checks. The caller must lock
+     * the context and ensure there is a spare thread with
+     * hasSpareThread().
+     *
+     * \return true if a subtask has been stolen
+     *
+     * \see KisSpontaneousJob::runSubtasks()
+     */
+    bool stealSpontaneousSubtask();
+
+    /**
+     * Splits a big merge job into a set of tile-aligned walkers
+     * with non-intersecting access rects, which can be executed
+     * concurrently. Returns an empty vector if the job should be
+     * executed as a whole.
+     */
+    QVector<KisBaseRectsWalkerSP> splitMergeJob(KisBaseRectsWalkerSP walker) const;
+
+    /**
+     * Set the size of the subtasks used by splitMergeJob(). Zero
+     * disables splitting of the merge jobs.
+     */
+    void setMergeSubtaskSize(int value);
+
     /**
      * Block execution of the caller until all the jobs are finished
      */
@@ -128,6 +171,7 @@ public:
     int threadsLimit() const;
 
     void continueUpdate(const QRect& rc);
+    void subtasksAppeared();
     void doSomeUsefulWork();
     void jobFinished();
     void jobThreadExited();
@@ -157,6 +201,7 @@ protected:
     KisLockFreeLodCounter m_lodCounter;
     KisUpdateScheduler *m_scheduler;
     bool m_testingMode = false;
+    std::atomic<int> m_mergeSubtaskSize {0};
 
 private:
 
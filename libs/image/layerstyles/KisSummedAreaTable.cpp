@@ -0,0 +1,196 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSummedAreaTable.h"
+
+#include <KoColorSpace.h>
+
+#include "kis_paint_device.h"
+#include "kis_pixel_selection.h"
+#include "kis_default_bounds_base.h"
+#include "kis_sequential_iterator.h"
+#include "kis_pointer_utils.h"
+
+
+KisSummedAreaTable::KisSummedAreaTable(KisPaintDeviceSP device, const QRect &rect)
+    : m_rect(rect.isEmpty() ? QRect() : rect),
+      m_stride(m_rect.width() + 1),
+      m_table(m_stride * (m_rect.height() + 1), 0)
+{
+    if (m_rect.isEmpty()) return;
+
+    const KoColorSpace *cs = device->colorSpace();
+    const int width = m_rect.width();
+
+    /**
+     * The first row and the first column of the table are kept zero,
+     * so that the lookups never need any bounds checks
+     */
+    quint32 *prevRow = m_table.data();
+    quint32 *row = prevRow + m_stride;
+    quint32 rowSum = 0;
+    int col = 0;
+
+    KisSequentialConstIterator it(device, m_rect);
+    while (it.nextPixel()) {
+        rowSum += cs->opacityU8(it.rawDataConst());
+        row[col + 1] = prevRow[col + 1] + rowSum;
+
+        if (++col == width) {
+            col = 0;
+            rowSum = 0;
+            prevRow = row;
+            row += m_stride;
+        }
+    }
+}
+
+QRect KisSummedAreaTable::rect() const
+{
+    return m_rect;
+}
+
+quint32 KisSummedAreaTable::sum(const QRect &rc) const
+{
+    const QRect r = rc & m_rect;
+    if (r.isEmpty()) return 0;
+
+    const int x0 = r.left() - m_rect.left();
+    const int x1 = r.right() + 1 - m_rect.left();
+    const int y0 = r.top() - m_rect.top();
+    const int y1 = r.bottom() + 1 - m_rect.top();
+
+    return sumAt(x1, y1) - sumAt(x0, y1) - sumAt(x1, y0) + sumAt(x0, y0);
+}
+
+void KisSummedAreaTable::boxBlur(KisPixelSelectionSP dst, const QRect &applyRect, int radius, bool inverted) const
+{
+    if (applyRect.isEmpty()) return;
+
+    const int width = applyRect.width();
+    const quint64 area = quint64(2 * radius + 1) * (2 * radius + 1);
+    const quint64 halfArea = area / 2;
+
+    QVector<int> colStart(width);
+    QVector<int> colEnd(width);
+
+    for (int i = 0; i < width; i++) {
+        const int x = applyRect.x() + i;
+        colStart[i] = qBound(0, x - radius - m_rect.left(), m_rect.width());
+        colEnd[i] = qBound(0, x + radius + 1 - m_rect.left(), m_rect.width());
+    }
+
+    QVector<quint8> line(width);
+
+    for (int y = applyRect.top(); y <= applyRect.bottom(); y++) {
+        const int rowStart = qBound(0, y - radius - m_rect.top(), m_rect.height());
+        const int rowEnd = qBound(0, y + radius + 1 - m_rect.top(), m_rect.height());
+
+        for (int i = 0; i < width; i++) {
+            const int x0 = colStart[i];
+            const int x1 = colEnd[i];
+
+            quint64 value =
+                quint32(sumAt(x1, rowEnd) - sumAt(x0, rowEnd) -
+                        sumAt(x1, rowStart) + sumAt(x0, rowStart));
+
+            if (inverted) {
+                value = 255 * area - value;
+            }
+
+            line[i] = quint8((value + halfArea) / area);
+        }
+
+        dst->writeBytes(line.constData(), QRect(applyRect.x(), y, width, 1));
+    }
+}
+
+KisSummedAreaTableCache::KisSummedAreaTableCache(qint64 maxRetainedBytes)
+    : m_maxRetainedBytes(maxRetainedBytes)
+{
+}
+
+qint64 KisSummedAreaTableCache::tableBytes(const QRect &rect)
+{
+    return qint64(rect.width() + 1) * (rect.height() + 1) * sizeof(quint32);
+}
+
+KisSummedAreaTableSP KisSummedAreaTableCache::fetch(KisPaintDeviceSP device, const QRect &rect)
+{
+    DataKey key;
+    key.device = device.data();
+    key.sequenceNumber = device->sequenceNumber();
+    key.levelOfDetail = device->defaultBounds()->currentLevelOfDetail();
+    key.offset = device->offset();
+
+    int generation = 0;
+
+    {
+        QMutexLocker l(&m_mutex);
+        generation = m_generation;
+
+        if (m_device.isValid() && m_key == key) {
+            for (auto it = m_tables.begin(); it != m_tables.end(); ++it) {
+                if ((*it)->rect().contains(rect)) {
+                    KisSummedAreaTableSP table = *it;
+                    m_tables.erase(it);
+                    m_tables.prepend(table);
+                    return table;
+                }
+            }
+        }
+    }
+
+    /**
+     * Building the table is the expensive part, so it is done without
+     * holding the lock. Two threads may occasionally build the same
+     * table, which is cheaper than serializing all of them.
+     */
+    KisSummedAreaTableSP table = toQShared(new KisSummedAreaTable(device, rect));
+    const qint64 newTableBytes = tableBytes(table->rect());
+
+    QMutexLocker l(&m_mutex);
+
+    if (!m_device.isValid() || !(m_key == key)) {
+        // the tables of the previous state of the device are useless now
+        m_tables.clear();
+        m_retainedBytes = 0;
+        m_device = device;
+        m_key = key;
+    }
+
+    /**
+     * If the cache has been invalidated while we were building the table,
+     * the table might contain the pixels of the old state of the device
+     */
+    if (generation == m_generation && newTableBytes <= m_maxRetainedBytes) {
+        m_tables.prepend(table);
+        m_retainedBytes += newTableBytes;
+
+        while (m_retainedBytes > m_maxRetainedBytes) {
+            m_retainedBytes -= tableBytes(m_tables.last()->rect());
+            m_tables.removeLast();
+        }
+    }
+
+    return table;
+}
+
+void KisSummedAreaTableCache::invalidate(const QRect &rect)
+{
+    QMutexLocker l(&m_mutex);
+
+    m_generation++;
+
+    for (auto it = m_tables.begin(); it != m_tables.end();) {
+        if ((*it)->rect().intersects(rect)) {
+            m_retainedBytes -= tableBytes((*it)->rect());
+            it = m_tables.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
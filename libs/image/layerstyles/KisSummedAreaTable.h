@@ -0,0 +1,125 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSUMMEDAREATABLE_H
+#define KISSUMMEDAREATABLE_H
+
+#include <QRect>
+#include <QVector>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+/**
+ * A summed-area table (integral image) of the alpha channel of a device.
+ * It lets the layer styles compute the sum of any rectangular area of the
+ * alpha channel in constant time, which turns box blurs of any radius into
+ * four lookups per pixel.
+ *
+ * The sums are stored in 32-bit unsigned integers and are allowed to
+ * overflow: the differences are computed modulo 2^32, so the sum of every
+ * box smaller than 2^32 / 255 pixels is still exact.
+ *
+ * The table is immutable after creation, so it can be shared between
+ * threads without locking.
+ */
+class KRITAIMAGE_EXPORT KisSummedAreaTable
+{
+public:
+    /**
+     * Builds the table from the alpha channel of \p device in \p rect
+     */
+    KisSummedAreaTable(KisPaintDeviceSP device, const QRect &rect);
+
+    QRect rect() const;
+
+    /**
+     * \return the sum of alpha values in \p rc. The pixels outside
+     * rect() are considered transparent.
+     */
+    quint32 sum(const QRect &rc) const;
+
+    /**
+     * Writes the average alpha of the (2 * radius + 1)-sized box around
+     * each pixel of \p applyRect into \p dst. The source pixels outside
+     * rect() are considered transparent. If \p inverted is true, the
+     * average is calculated for the inverted alpha channel.
+     */
+    void boxBlur(KisPixelSelectionSP dst, const QRect &applyRect, int radius, bool inverted = false) const;
+
+private:
+    inline quint32 sumAt(int col, int row) const {
+        return m_table[row * m_stride + col];
+    }
+
+private:
+    QRect m_rect;
+    int m_stride = 0;
+    QVector<quint32> m_table;
+};
+
+typedef QSharedPointer<const KisSummedAreaTable> KisSummedAreaTableSP;
+
+/**
+ * Keeps the summed-area tables of the alpha channel of a single device
+ * until the device is changed, so all the layer styles of a layer can
+ * share them. Every table covers exactly the requested rect (usually the
+ * update patch plus the margin of the style) and is built outside the
+ * lock. The most recently used tables are retained until their total
+ * size exceeds the limit passed to the constructor.
+ *
+ * Most of the writes into a projection (bitBlt, composition of the
+ * masks and child layers) do not change the sequence number of the
+ * device, so the owner must call invalidate() for every rect it
+ * recalculates before fetching the tables again.
+ */
+class KRITAIMAGE_EXPORT KisSummedAreaTableCache
+{
+public:
+    KisSummedAreaTableCache(qint64 maxRetainedBytes = 64 * 1024 * 1024);
+
+    KisSummedAreaTableSP fetch(KisPaintDeviceSP device, const QRect &rect);
+
+    /**
+     * Drops all the tables that intersect \p rect. The tables that are
+     * being built while the call happens are not retained either.
+     */
+    void invalidate(const QRect &rect);
+
+private:
+    struct DataKey {
+        const KisPaintDevice *device = nullptr;
+        int sequenceNumber = -1;
+        int levelOfDetail = 0;
+        QPoint offset;
+
+        bool operator==(const DataKey &rhs) const {
+            return device == rhs.device &&
+                sequenceNumber == rhs.sequenceNumber &&
+                levelOfDetail == rhs.levelOfDetail &&
+                offset == rhs.offset;
+        }
+    };
+
+    static qint64 tableBytes(const QRect &rect);
+
+private:
+    const qint64 m_maxRetainedBytes;
+
+    QMutex m_mutex;
+    KisPaintDeviceWSP m_device;
+    DataKey m_key;
+    QList<KisSummedAreaTableSP> m_tables;
+    qint64 m_retainedBytes = 0;
+    int m_generation = 0;
+};
+
+typedef QSharedPointer<KisSummedAreaTableCache> KisSummedAreaTableCacheSP;
+
+#endif // KISSUMMEDAREATABLE_H
@@ -32,6 +32,7 @@ struct Q_DECL_HIDDEN KisLayerStyleFilterEnvironment::Private
     KisCachedSelection globalCachedSelection;
     KisCachedPaintDevice globalCachedPaintDevice;
     KisLocalStrokeResources cachedFlattenedPattern;
+    KisSummedAreaTableCacheSP alphaTableCache {new KisSummedAreaTableCache()};
 
     static KisPixelSelectionSP generateRandomSelection(const QRect &rc);
 };
@@ -141,6 +142,16 @@ KoPatternSP KisLayerStyleFilterEnvironment::cachedFlattenedPattern(KoPatternSP p
     return flattenedPattern;
 }
 
+KisSummedAreaTableSP KisLayerStyleFilterEnvironment::cachedAlphaTable(KisPaintDeviceSP device, const QRect &requestedRect) const
+{
+    return m_d->alphaTableCache->fetch(device, requestedRect);
+}
+
+void KisLayerStyleFilterEnvironment::setAlphaTableCache(KisSummedAreaTableCacheSP cache)
+{
+    m_d->alphaTableCache = cache;
+}
+
 KisCachedSelection *KisLayerStyleFilterEnvironment::cachedSelection()
 {
     return &m_d->globalCachedSelection;
@@ -13,6 +13,7 @@
 #include <kritaimage_export.h>
 #include "kis_types.h"
 #include <KoPattern.h>
+#include "KisSummedAreaTable.h"
 
 class KisPainter;
 class KisLayer;
@@ -40,6 +41,19 @@ public:
 
     KoPatternSP cachedFlattenedPattern(KoPatternSP pattern) const;
 
+    /**
+     * \return a summed-area table of the alpha channel of \p device
+     * covering at least \p requestedRect. The table is reused until
+     * the device changes.
+     */
+    KisSummedAreaTableSP cachedAlphaTable(KisPaintDeviceSP device, const QRect &requestedRect) const;
+
+    /**
+     * Makes the environment share the alpha table cache with the
+     * environments of the other styles of the same layer
+     */
+    void setAlphaTableCache(KisSummedAreaTableCacheSP cache);
+
     KisCachedSelection* cachedSelection();
     KisCachedPaintDevice* cachedPaintDevice();
 
@@ -71,6 +71,11 @@ void KisLayerStyleFilterProjectionPlane::setStyle(KisLayerStyleFilter *filter, K
     m_d->style = style;
 }
 
+void KisLayerStyleFilterProjectionPlane::setAlphaTableCache(KisSummedAreaTableCacheSP cache)
+{
+    m_d->environment->setAlphaTableCache(cache);
+}
+
 QRect KisLayerStyleFilterProjectionPlane::recalculate(const QRect& rect, KisNodeSP filthyNode)
 {
     Q_UNUSED(filthyNode);
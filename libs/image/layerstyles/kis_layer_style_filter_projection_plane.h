@@ -12,6 +12,7 @@
 #include <QScopedPointer>
 
 #include "kis_types.h"
+#include "KisSummedAreaTable.h"
 
 class KisLayerStyleKnockoutBlower;
 
@@ -25,6 +26,12 @@ public:
 
     void setStyle(KisLayerStyleFilter *filter, KisPSDLayerStyleSP style);
 
+    /**
+     * Share the cache of the layer's alpha summed-area table with
+     * the other style planes of the same layer
+     */
+    void setAlphaTableCache(KisSummedAreaTableCacheSP cache);
+
     QRect recalculate(const QRect& rect, KisNodeSP filthyNode) override;
     void apply(KisPainter *painter, const QRect &rect) override;
 
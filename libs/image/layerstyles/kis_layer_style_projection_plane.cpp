@@ -35,6 +35,7 @@ struct Q_DECL_HIDDEN KisLayerStyleProjectionPlane::Private
 
     KisCachedPaintDevice cachedPaintDevice;
     KisCachedSelection cachedSelection;
+    KisSummedAreaTableCacheSP alphaTableCache {new KisSummedAreaTableCache()};
     KisLayer *sourceLayer = 0;
 
 
@@ -59,6 +60,12 @@ struct Q_DECL_HIDDEN KisLayerStyleProjectionPlane::Private
         return result;
     }
 
+    void shareAlphaTableCache() {
+        Q_FOREACH (KisLayerStyleFilterProjectionPlaneSP plane, allStyles()) {
+            plane->setAlphaTableCache(alphaTableCache);
+        }
+    }
+
     bool hasOverlayStyles() const {
         Q_FOREACH (KisLayerStyleFilterProjectionPlaneSP plane, stylesOverlay) {
             if (!plane->isEmpty()) return true;
@@ -122,6 +129,8 @@ KisLayerStyleProjectionPlane::KisLayerStyleProjectionPlane(const KisLayerStylePr
     }
 
     m_d->strokeStyle.reset(new KisStrokeLayerStyleFilterProjectionPlane(*rhs.m_d->strokeStyle, sourceLayer, m_d->style));
+
+    m_d->shareAlphaTableCache();
 }
 
 // for testing purposes only!
@@ -206,6 +215,8 @@ void KisLayerStyleProjectionPlane::init(KisLayer *sourceLayer, KisPSDLayerStyleS
         innerShadow->setStyle(new KisLsDropShadowFilter(KisLsDropShadowFilter::InnerShadow), style);
         m_d->stylesOverlay << toQShared(innerShadow);
     }
+
+    m_d->shareAlphaTableCache();
 }
 
 KisLayerStyleProjectionPlane::~KisLayerStyleProjectionPlane()
@@ -224,7 +235,14 @@ QRect KisLayerStyleProjectionPlane::recalculate(const QRect& rect, KisNodeSP fil
     QRect result = rect;
 
     if (m_d->style->isEnabled()) {
-        result = sourcePlane->recalculate(stylesNeedRect(rect), filthyNode);
+        const QRect sourceRect = stylesNeedRect(rect);
+        result = sourcePlane->recalculate(sourceRect, filthyNode);
+
+        /**
+         * The source plane rewrites the projection without changing its
+         * sequence number, so the alpha tables of this area are stale now
+         */
+        m_d->alphaTableCache->invalidate(sourceRect | result);
 
         Q_FOREACH (const KisAbstractProjectionPlaneSP plane, m_d->allStyles()) {
             plane->recalculate(rect, filthyNode);
@@ -146,11 +146,28 @@ void KisLsDropShadowFilter::applyDropShadow(KisPaintDeviceSP srcDevice,
         KisLsUtils::findEdge(selection, d.blurNeedRect, true);
     }
 
+    /**
+     * Unless the technique is precise, the selection is still the
+     * (possibly inverted) alpha channel of the layer here, so the first
+     * large blur can reuse the summed-area table shared by all the
+     * styles of the layer
+     */
+    KisSummedAreaTableSP alphaTable;
+    const int firstBlurSize = d.spread_size ? d.spread_size : d.blur_size;
+
+    if (shadow->technique() != psd_technique_precise &&
+        firstBlurSize >= KisLsUtils::boxBlurMinRadius) {
+
+        alphaTable = env->cachedAlphaTable(srcDevice, d.spreadNeedRect);
+    }
+
     /**
      * Spread and blur the selection
      */
     if (d.spread_size) {
-        KisLsUtils::applyGaussianWithTransaction(selection, d.blurNeedRect, d.spread_size);
+        KisLsUtils::applyGaussianWithTransaction(selection, d.blurNeedRect, d.spread_size,
+                                                 alphaTable, shadow->invertsSelection());
+        alphaTable.clear();
 
         // TODO: find out why in libpsd we pass false here. If we do so,
         //       the result is fully black, which is not expected
@@ -160,7 +177,8 @@ void KisLsDropShadowFilter::applyDropShadow(KisPaintDeviceSP srcDevice,
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("1_selection_spread.png");
 
     if (d.blur_size) {
-        KisLsUtils::applyGaussianWithTransaction(selection, d.noiseNeedRect, d.blur_size);
+        KisLsUtils::applyGaussianWithTransaction(selection, d.noiseNeedRect, d.blur_size,
+                                                 alphaTable, shadow->invertsSelection());
     }
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("2_selection_blur.png");
 
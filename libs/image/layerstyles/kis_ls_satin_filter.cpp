@@ -144,7 +144,12 @@ void KisLsSatinFilter::applySatin(KisPaintDeviceSP srcDevice,
 
     //KIS_DUMP_DEVICE_2(tempSelection, QRect(0,0,64,64), "00_selection", "dd");
 
-    KisLsUtils::applyGaussianWithTransaction(tempSelection, d.satinNeedRect, d.blur_size);
+    KisSummedAreaTableSP alphaTable;
+    if (d.blur_size >= KisLsUtils::boxBlurMinRadius) {
+        alphaTable = env->cachedAlphaTable(srcDevice, d.blurNeedRect);
+    }
+
+    KisLsUtils::applyGaussianWithTransaction(tempSelection, d.satinNeedRect, d.blur_size, alphaTable);
 
     //KIS_DUMP_DEVICE_2(tempSelection, QRect(0,0,64,64), "01_gauss", "dd");
 
@@ -7,6 +7,10 @@
 
 #include "kis_ls_utils.h"
 
+#include <cmath>
+#include <numeric>
+#include <QtMath>
+
 #include <resources/KoAbstractGradient.h>
 #include <KoColorSpace.h>
 #include <resources/KoPattern.h>
@@ -14,6 +18,7 @@
 
 #include "psd.h"
 
+#include "kis_global.h"
 #include "kis_default_bounds.h"
 #include "kis_pixel_selection.h"
 #include "kis_random_accessor_ng.h"
@@ -99,14 +104,75 @@ namespace KisLsUtils
         return rc.adjusted(-halfSize, -halfSize, halfSize, halfSize);
     }
 
+    const int boxBlurMinRadius = 20;
+
+    namespace Private {
+        /**
+         * Radii of three box blurs whose composition has the same
+         * standard deviation as the Gaussian of \p radius, see
+         * "Fast Almost-Gaussian Filtering" by Peter Kovesi
+         */
+        QVector<int> boxRadiiForGaussian(qreal radius)
+        {
+            const int numBoxes = 3;
+            const qreal sigma = KisGaussianKernel::sigmaFromRadius(radius);
+            const qreal variance12 = 12.0 * pow2(sigma);
+
+            int lowerSize = qFloor(std::sqrt(variance12 / numBoxes + 1.0));
+            if (lowerSize % 2 == 0) lowerSize--;
+            const int upperSize = lowerSize + 2;
+
+            const int numLowerBoxes =
+                qRound((variance12
+                        - numBoxes * pow2(lowerSize)
+                        - 4 * numBoxes * lowerSize
+                        - 3 * numBoxes) / (-4.0 * lowerSize - 4.0));
+
+            QVector<int> radii;
+            for (int i = 0; i < numBoxes; i++) {
+                const int size = i < numLowerBoxes ? lowerSize : upperSize;
+                radii << (size - 1) / 2;
+            }
+
+            return radii;
+        }
+    }
+
     void applyGaussianWithTransaction(KisPixelSelectionSP selection,
                                       const QRect &applyRect,
-                                      qreal radius)
+                                      qreal radius,
+                                      KisSummedAreaTableSP alphaTable,
+                                      bool alphaInverted)
     {
-        KisGaussianKernel::applyGaussian(selection, applyRect,
-                                         radius, radius,
-                                         QBitArray(), 0, true,
-                                         BORDER_IGNORE);
+        if (radius < boxBlurMinRadius) {
+            KisGaussianKernel::applyGaussian(selection, applyRect,
+                                             radius, radius,
+                                             QBitArray(), 0, true,
+                                             BORDER_IGNORE);
+            return;
+        }
+
+        /**
+         * Every pass reads the area grown by the radii of all the
+         * remaining passes, so the last one reads exactly what it
+         * needs to produce \p applyRect. The needed area is never
+         * larger than the one of the Gaussian kernel.
+         */
+        const QVector<int> radii = Private::boxRadiiForGaussian(radius);
+        int remainingRadius = std::accumulate(radii.begin(), radii.end(), 0);
+
+        for (int i = 0; i < radii.size(); i++) {
+            const QRect srcRect = kisGrowRect(applyRect, remainingRadius);
+            remainingRadius -= radii[i];
+            const QRect dstRect = kisGrowRect(applyRect, remainingRadius);
+
+            if (i == 0 && alphaTable && alphaTable->rect().contains(srcRect)) {
+                alphaTable->boxBlur(selection, dstRect, radii[i], alphaInverted);
+            } else {
+                KisSummedAreaTable table(selection, srcRect);
+                table.boxBlur(selection, dstRect, radii[i]);
+            }
+        }
     }
 
     namespace Private {
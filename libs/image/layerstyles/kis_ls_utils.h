@@ -12,6 +12,7 @@
 
 #include "kis_lod_transform.h"
 #include <KoPattern.h>
+#include "KisSummedAreaTable.h"
 
 struct psd_layer_effects_context;
 class psd_layer_effects_shadow_base;
@@ -33,9 +34,26 @@ namespace KisLsUtils
 
     void findEdge(KisPixelSelectionSP selection, const QRect &applyRect, const bool edgeHidden);
     QRect growRectFromRadius(const QRect &rc, int radius);
+
+    /**
+     * Blurs with radius not less than this value are approximated with
+     * three box blurs calculated from summed-area tables
+     */
+    extern const int boxBlurMinRadius;
+
+    /**
+     * Applies a Gaussian blur of \p radius to \p selection in \p applyRect.
+     *
+     * If \p alphaTable is not null, it must contain the current content of
+     * \p selection (or its inversion, if \p alphaInverted is true). It is
+     * then used for the first pass of the box approximation instead of
+     * building a new table.
+     */
     void applyGaussianWithTransaction(KisPixelSelectionSP selection,
                                       const QRect &applyRect,
-                                      qreal radius);
+                                      qreal radius,
+                                      KisSummedAreaTableSP alphaTable = KisSummedAreaTableSP(),
+                                      bool alphaInverted = false);
 
     static const int FULL_PERCENT_RANGE = 100;
     void adjustRange(KisPixelSelectionSP selection, const QRect &applyRect, const int range);
@@ -10,11 +10,13 @@
 
 #include <QBitArray>
 #include <QElapsedTimer>
+#include <cmath>
 
 #include <KoColor.h>
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoColorSpaceTraits.h>
+#include <KoColorModelStandardIds.h>
 
 #include "kis_paint_device.h"
 #include "kis_convolution_painter.h"
@@ -450,6 +452,277 @@ void KisConvolutionPainterTest::testGaussianDetailsFFTW()
     testGaussianDetails(true);
 }
 
+void KisConvolutionPainterTest::testGaussianRecursive()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect imageRect(0,0,256,256);
+    dev->fill(QRect(50,50,100,60), KoColor(Qt::red, cs));
+    dev->fill(QRect(120,90,60,100), KoColor(Qt::blue, cs));
+
+    // the shapes touching the image borders check the BORDER_REPEAT mode
+    dev->fill(QRect(0,0,40,256), KoColor(Qt::green, cs));
+    dev->fill(QRect(200,220,56,36), KoColor(Qt::yellow, cs));
+
+    KisDefaultBoundsBaseSP bounds = new TestUtil::TestingTimedDefaultBounds(imageRect);
+    dev->setDefaultBounds(bounds);
+
+    KisPaintDeviceSP recursiveDev = new KisPaintDevice(*dev);
+
+    KisGaussianKernel::applyGaussian(dev, imageRect, 20, 12, QBitArray(), 0,
+                                     false, BORDER_REPEAT, KisGaussianKernel::Convolution);
+    KisGaussianKernel::applyGaussian(recursiveDev, imageRect, 20, 12, QBitArray(), 0,
+                                     false, BORDER_REPEAT, KisGaussianKernel::Recursive);
+
+    const QImage convolutionImage = dev->convertToQImage(0, imageRect);
+    const QImage recursiveImage = recursiveDev->convertToQImage(0, imageRect);
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::compareQImagesPremultiplied(errorPoint,
+                                                  convolutionImage,
+                                                  recursiveImage,
+                                                  3, 3));
+
+    auto checkEdgePixel = [&] (int x, int y) {
+        const QRgb expected = convolutionImage.pixel(x, y);
+        const QRgb actual = recursiveImage.pixel(x, y);
+
+        if (qAbs(qRed(expected) - qRed(actual)) > 3 ||
+            qAbs(qGreen(expected) - qGreen(actual)) > 3 ||
+            qAbs(qBlue(expected) - qBlue(actual)) > 3 ||
+            qAbs(qAlpha(expected) - qAlpha(actual)) > 3) {
+
+            qWarning() << "Edge pixel differs at" << QPoint(x, y)
+                       << "expected" << QColor::fromRgba(expected)
+                       << "actual" << QColor::fromRgba(actual);
+            return false;
+        }
+        return true;
+    };
+
+    for (int i = 0; i < imageRect.width(); i++) {
+        QVERIFY(checkEdgePixel(i, imageRect.top()));
+        QVERIFY(checkEdgePixel(i, imageRect.bottom()));
+        QVERIFY(checkEdgePixel(imageRect.left(), i));
+        QVERIFY(checkEdgePixel(imageRect.right(), i));
+    }
+
+    // the green band is repeated beyond the left border, so it stays opaque
+    QCOMPARE(qAlpha(recursiveImage.pixel(0, 128)), 255);
+}
+
+void KisConvolutionPainterTest::testSeparableTerms()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect imageRect(0,0,256,256);
+    dev->fill(QRect(50,50,100,60), KoColor(Qt::red, cs));
+    dev->fill(QRect(120,90,60,100), KoColor(Qt::blue, cs));
+
+    KisDefaultBoundsBaseSP bounds = new TestUtil::TestingTimedDefaultBounds(imageRect);
+    dev->setDefaultBounds(bounds);
+
+    const int radius = 10;
+    const int size = 2 * radius + 1;
+
+    KisConvolutionKernel::SeparableTerm term1;
+    KisConvolutionKernel::SeparableTerm term2;
+
+    for (int i = 0; i < size; i++) {
+        const qreal x = qreal(i - radius) / radius;
+        term1.column << std::exp(-x * x);
+        term1.row << std::exp(-2 * x * x);
+        term2.column << 0.5 * std::cos(3 * x * x);
+        term2.row << std::sin(2 * x * x);
+    }
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix(size, size);
+    for (int r = 0; r < size; r++) {
+        for (int c = 0; c < size; c++) {
+            matrix(r, c) = term1.column[r] * term1.row[c] + term2.column[r] * term2.row[c];
+        }
+    }
+
+    KisConvolutionKernelSP separableKernel =
+        KisConvolutionKernel::fromSeparableTerms({term1, term2}, 0, matrix.sum());
+    QCOMPARE(separableKernel->separableTerms().size(), 2);
+
+    KisConvolutionKernelSP matrixKernel =
+        KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
+    QVERIFY(matrixKernel->separableTerms().isEmpty());
+
+    KisPaintDeviceSP separableDev = new KisPaintDevice(*dev);
+    KisPaintDeviceSP matrixDev = new KisPaintDevice(*dev);
+
+    KisConvolutionPainter separablePainter(separableDev, KisConvolutionPainter::SPATIAL);
+    separablePainter.applyMatrix(separableKernel, dev, imageRect.topLeft(), imageRect.topLeft(),
+                                 imageRect.size(), BORDER_REPEAT);
+
+    KisConvolutionPainter matrixPainter(matrixDev, KisConvolutionPainter::SPATIAL);
+    matrixPainter.applyMatrix(matrixKernel, dev, imageRect.topLeft(), imageRect.topLeft(),
+                              imageRect.size(), BORDER_REPEAT);
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::compareQImages(errorPoint,
+                                     separableDev->convertToQImage(0, imageRect),
+                                     matrixDev->convertToQImage(0, imageRect),
+                                     1, 1));
+}
+
+void KisConvolutionPainterTest::testSpatialMatchesDirectConvolution_data()
+{
+    QTest::addColumn<bool>("separable");
+
+    QTest::addRow("separable") << true;
+    QTest::addRow("non-separable") << false;
+}
+
+void KisConvolutionPainterTest::testSpatialMatchesDirectConvolution()
+{
+    QFETCH(bool, separable);
+
+    /**
+     * The spatial worker sums the products in a different order than the
+     * straightforward convolution does, so compare it with a scalar
+     * per-pixel reference in float precision with some tolerance
+     */
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(GrayAColorModelID.id(), Float32BitsColorDepthID.id(), 0);
+    QVERIFY(cs);
+
+    const int kw = 7;
+    const int kh = 5;
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix(kh, kw);
+    for (int r = 0; r < kh; r++) {
+        for (int c = 0; c < kw; c++) {
+            matrix(r, c) = separable ?
+                std::exp(-0.3 * (r - 1) * (r - 1)) * std::exp(-0.1 * (c - 2) * (c - 2)) :
+                1.0 + ((r * 7 + c * 3) % 11) / 3.0;
+        }
+    }
+
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
+
+    const QRect srcRect(-20, -10, 120, 90);
+    const QRect applyRect = srcRect.adjusted(kw, kh, -kw, -kh);
+
+    QVector<float> srcPixels(srcRect.width() * srcRect.height() * 2);
+    for (int i = 0; i < srcRect.width() * srcRect.height(); i++) {
+        srcPixels[2 * i] = ((i * 2654435761u) % 1000) / 999.0f;
+        srcPixels[2 * i + 1] = 1.0f;
+    }
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    src->writeBytes(reinterpret_cast<const quint8*>(srcPixels.constData()), srcRect);
+
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+    KisConvolutionPainter painter(dst, KisConvolutionPainter::SPATIAL);
+    painter.applyMatrix(kernel, src, applyRect.topLeft(), applyRect.topLeft(),
+                        applyRect.size(), BORDER_REPEAT);
+
+    QVector<float> dstPixels(applyRect.width() * applyRect.height() * 2);
+    dst->readBytes(reinterpret_cast<quint8*>(dstPixels.data()), applyRect);
+
+    const int halfWidth = (kw - 1) / 2;
+    const int halfHeight = (kh - 1) / 2;
+
+    for (int y = applyRect.top(); y <= applyRect.bottom(); y++) {
+        for (int x = applyRect.left(); x <= applyRect.right(); x++) {
+            qreal expected = 0.0;
+
+            // convolution applies the kernel flipped in both directions
+            for (int r = 0; r < kh; r++) {
+                for (int c = 0; c < kw; c++) {
+                    const int sx = x - halfWidth + c - srcRect.x();
+                    const int sy = y - halfHeight + r - srcRect.y();
+                    expected += matrix(kh - 1 - r, kw - 1 - c) * srcPixels[2 * (sy * srcRect.width() + sx)];
+                }
+            }
+            expected /= matrix.sum();
+
+            const int dstIndex = 2 * ((y - applyRect.y()) * applyRect.width() + x - applyRect.x());
+
+            if (qAbs(dstPixels[dstIndex] - expected) > 1e-5 ||
+                qAbs(dstPixels[dstIndex + 1] - 1.0) > 1e-5) {
+
+                qDebug() << ppVar(x) << ppVar(y) << ppVar(dstPixels[dstIndex]) << ppVar(expected);
+                QFAIL("the spatial convolution differs from the direct one");
+            }
+        }
+    }
+}
+
+void KisConvolutionPainterTest::testFFTKernelCache()
+{
+    if (!KisConvolutionPainter::supportsFFTW()) {
+        QSKIP("FFTW is not available");
+    }
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect applyRect(0, 0, 64, 64);
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    src->fill(QRect(10, 10, 30, 20), KoColor(Qt::red, cs));
+
+    auto applyKernel = [&] (int seed) {
+        Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix(9, 9);
+        for (int r = 0; r < 9; r++) {
+            for (int c = 0; c < 9; c++) {
+                matrix(r, c) = 1.0 + (r * 3 + c * 5 + seed) % 7;
+            }
+        }
+
+        KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
+
+        KisPaintDeviceSP dst = new KisPaintDevice(cs);
+        KisConvolutionPainter painter(dst, KisConvolutionPainter::FFTW);
+        painter.applyMatrix(kernel, src, applyRect.topLeft(), applyRect.topLeft(),
+                            applyRect.size(), BORDER_REPEAT);
+    };
+
+    KisConvolutionPainter::releaseCachedKernels();
+    QCOMPARE(KisConvolutionPainter::cachedKernelsBytes(), qint64(0));
+
+    applyKernel(0);
+    const qint64 entryBytes = KisConvolutionPainter::cachedKernelsBytes();
+    QVERIFY(entryBytes > 0);
+
+    // the same kernel is fetched from the cache, not stored again
+    applyKernel(0);
+    QCOMPARE(KisConvolutionPainter::cachedKernelsBytes(), entryBytes);
+
+    // only two spectra fit into the limit, the oldest one is evicted
+    KisConvolutionPainter::setCachedKernelsLimit(2 * entryBytes + entryBytes / 2);
+
+    applyKernel(1);
+    QCOMPARE(KisConvolutionPainter::cachedKernelsBytes(), 2 * entryBytes);
+
+    applyKernel(2);
+    QCOMPARE(KisConvolutionPainter::cachedKernelsBytes(), 2 * entryBytes);
+
+    // lowering the limit evicts the spectra immediately
+    KisConvolutionPainter::setCachedKernelsLimit(entryBytes);
+    QCOMPARE(KisConvolutionPainter::cachedKernelsBytes(), entryBytes);
+
+    // the spectra bigger than the limit are not retained at all
+    KisConvolutionPainter::releaseCachedKernels();
+    KisConvolutionPainter::setCachedKernelsLimit(entryBytes - 1);
+
+    applyKernel(3);
+    QCOMPARE(KisConvolutionPainter::cachedKernelsBytes(), qint64(0));
+
+    KisConvolutionPainter::setCachedKernelsLimit(32 * 1024 * 1024);
+
+    applyKernel(4);
+    QVERIFY(KisConvolutionPainter::cachedKernelsBytes() > 0);
+
+    KisConvolutionPainter::releaseCachedKernels();
+    QCOMPARE(KisConvolutionPainter::cachedKernelsBytes(), qint64(0));
+}
+
 #include "kis_transaction.h"
 
 void KisConvolutionPainterTest::testDilate()
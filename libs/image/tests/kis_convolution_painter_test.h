@@ -47,6 +47,12 @@ private Q_SLOTS:
     void testGaussianDetailsSpatial();
     void testGaussianDetailsFFTW();
 
+    void testGaussianRecursive();
+    void testSeparableTerms();
+    void testSpatialMatchesDirectConvolution_data();
+    void testSpatialMatchesDirectConvolution();
+    void testFFTKernelCache();
+
     void testDilate();
     void testErode();
 
@@ -20,9 +20,11 @@
 #include "kis_types.h"
 #include "kis_image.h"
 #include <KisGlobalResourcesInterface.h>
+#include "kis_memory_statistics_server.h"
 
 
 #include <testutil.h>
+#include <testing_timed_default_bounds.h>
 
 #define IMAGE_WIDTH 1000
 #define IMAGE_HEIGHT 1000
@@ -98,4 +100,130 @@ void KisFilterMaskTest::testProjectionSelected()
 
 }
 
+void KisFilterMaskTest::testOutputCache()
+{
+    TestUtil::MaskParent p(QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT));
+    KisImageSP image = p.image;
+    KisPaintLayerSP layer = p.layer;
+
+    QImage qimage(QString(FILES_DATA_DIR) + '/' + "hakonepa.png");
+    layer->paintDevice()->convertFromQImage(qimage, 0, 0, 0);
+
+    KisFilterSP f = KisFilterRegistry::instance()->value("gaussian blur");
+    Q_ASSERT(f);
+    KisFilterConfigurationSP kfc = f->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    Q_ASSERT(kfc);
+
+    KisFilterMaskSP mask = new KisFilterMask(image, "mask");
+    image->addNode(mask, layer);
+
+    mask->setFilter(kfc->cloneWithResourcesSnapshot());
+    mask->createNodeProgressProxy();
+    mask->initSelection(layer);
+
+    const QRect applyRect(0, 0, 256, 256);
+    const QRect needRect = mask->needRect(applyRect);
+
+    KisMemoryStatisticsServer *server = KisMemoryStatisticsServer::instance();
+    const KisMemoryStatisticsServer::Statistics initialStats = server->fetchMemoryStatistics(image);
+
+    KisPaintDeviceSP firstPass = new KisPaintDevice(*layer->paintDevice());
+    mask->apply(firstPass, applyRect, needRect, KisNode::N_FILTHY);
+
+    KisPaintDeviceSP secondPass = new KisPaintDevice(*layer->paintDevice());
+    mask->apply(secondPass, applyRect, needRect, KisNode::N_FILTHY);
+
+    const KisMemoryStatisticsServer::Statistics cachedStats = server->fetchMemoryStatistics(image);
+    QCOMPARE(cachedStats.filterMaskCacheMisses - initialStats.filterMaskCacheMisses, qint64(16));
+    QCOMPARE(cachedStats.filterMaskCacheHits - initialStats.filterMaskCacheHits, qint64(16));
+
+    QPoint errpoint;
+    QVERIFY(TestUtil::compareQImages(errpoint,
+                                     firstPass->convertToQImage(0, applyRect),
+                                     secondPass->convertToQImage(0, applyRect)));
+
+    // a change in the input must invalidate only the tiles that depend on it
+    layer->paintDevice()->fill(QRect(10, 10, 4, 4), KoColor(Qt::red, layer->paintDevice()->colorSpace()));
+
+    KisPaintDeviceSP changedPass = new KisPaintDevice(*layer->paintDevice());
+    mask->apply(changedPass, applyRect, needRect, KisNode::N_FILTHY);
+
+    const KisMemoryStatisticsServer::Statistics changedStats = server->fetchMemoryStatistics(image);
+    QCOMPARE(changedStats.filterMaskCacheMisses - cachedStats.filterMaskCacheMisses, qint64(1));
+    QCOMPARE(changedStats.filterMaskCacheHits - cachedStats.filterMaskCacheHits, qint64(15));
+
+    KisFilterMaskSP freshMask = new KisFilterMask(image, "fresh mask");
+    image->addNode(freshMask, layer);
+    freshMask->setFilter(kfc->cloneWithResourcesSnapshot());
+    freshMask->createNodeProgressProxy();
+    freshMask->initSelection(layer);
+
+    KisPaintDeviceSP referencePass = new KisPaintDevice(*layer->paintDevice());
+    freshMask->apply(referencePass, applyRect, needRect, KisNode::N_FILTHY);
+
+    // FFTW-based blur may round differently for a smaller processed area
+    QVERIFY(TestUtil::compareQImages(errpoint,
+                                     referencePass->convertToQImage(0, applyRect),
+                                     changedPass->convertToQImage(0, applyRect), 1, 1));
+}
+
+void KisFilterMaskTest::testOutputCacheKey()
+{
+    TestUtil::MaskParent p(QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT));
+    KisImageSP image = p.image;
+    KisPaintLayerSP layer = p.layer;
+
+    QImage qimage(QString(FILES_DATA_DIR) + '/' + "hakonepa.png");
+    layer->paintDevice()->convertFromQImage(qimage, 0, 0, 0);
+
+    KisFilterSP f = KisFilterRegistry::instance()->value("gaussian blur");
+    Q_ASSERT(f);
+    KisFilterConfigurationSP kfc = f->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    Q_ASSERT(kfc);
+
+    KisFilterMaskSP mask = new KisFilterMask(image, "mask");
+    image->addNode(mask, layer);
+
+    mask->setFilter(kfc->cloneWithResourcesSnapshot());
+    mask->createNodeProgressProxy();
+    mask->initSelection(layer);
+
+    const QRect applyRect(0, 0, 256, 256);
+    const QRect needRect = mask->needRect(applyRect);
+
+    KisDefaultBoundsBaseSP lod0Bounds = new TestUtil::TestingTimedDefaultBounds(image->bounds());
+
+    TestUtil::TestingTimedDefaultBounds *lodBounds = new TestUtil::TestingTimedDefaultBounds(image->bounds());
+    lodBounds->testingSetLod(1);
+    KisDefaultBoundsBaseSP lod1Bounds = lodBounds;
+
+    KisDefaultBoundsBaseSP resizedBounds =
+        new TestUtil::TestingTimedDefaultBounds(image->bounds().adjusted(0, 0, 64, 64));
+
+    KisMemoryStatisticsServer *server = KisMemoryStatisticsServer::instance();
+
+    auto checkApply = [&] (KisDefaultBoundsBaseSP bounds, qint64 expectedMisses, qint64 expectedHits) {
+        const KisMemoryStatisticsServer::Statistics before = server->fetchMemoryStatistics(image);
+
+        KisPaintDeviceSP device = new KisPaintDevice(*layer->paintDevice());
+        device->setDefaultBounds(bounds);
+        mask->apply(device, applyRect, needRect, KisNode::N_FILTHY);
+
+        const KisMemoryStatisticsServer::Statistics after = server->fetchMemoryStatistics(image);
+        QCOMPARE(after.filterMaskCacheMisses - before.filterMaskCacheMisses, expectedMisses);
+        QCOMPARE(after.filterMaskCacheHits - before.filterMaskCacheHits, expectedHits);
+    };
+
+    checkApply(lod0Bounds, 16, 0);
+    checkApply(lod1Bounds, 16, 0);
+
+    // switching the level of detail must not drop the other cache
+    checkApply(lod0Bounds, 0, 16);
+    checkApply(lod1Bounds, 0, 16);
+
+    // the filter may depend on the image bounds, so the output is refiltered
+    checkApply(resizedBounds, 16, 0);
+    checkApply(resizedBounds, 0, 16);
+}
+
 SIMPLE_TEST_MAIN(KisFilterMaskTest)
@@ -19,6 +19,8 @@ private Q_SLOTS:
 
     void testProjectionNotSelected();
     void testProjectionSelected();
+    void testOutputCache();
+    void testOutputCacheKey();
 
 };
 
@@ -8,6 +8,9 @@
 
 #include "layerstyles/kis_layer_style_filter_environment.h"
 #include "kis_pixel_selection.h"
+#include "kis_sequential_iterator.h"
+#include "kis_painter.h"
+#include <KoColor.h>
 #include <testutil.h>
 
 
@@ -46,4 +49,144 @@ void KisLayerStyleFilterEnvironmentTest::benchmarkRandomSelectionGeneration()
     }
 }
 
+void KisLayerStyleFilterEnvironmentTest::testAlphaTableCaching()
+{
+    TestUtil::MaskParent p;
+    KisLayerStyleFilterEnvironment env(p.layer.data());
+
+    KisPaintDeviceSP device = p.layer->paintDevice();
+    device->fill(QRect(10, 10, 20, 20), KoColor(Qt::red, device->colorSpace()));
+
+    const QRect r1 = QRect(0,0,40,40);
+    const QRect r2 = QRect(20,20,40,40);
+
+    KisSummedAreaTableSP table1 = env.cachedAlphaTable(device, r1);
+    QCOMPARE(table1->rect(), r1);
+    QCOMPARE(table1->sum(r1), quint32(20 * 20 * 255));
+    QCOMPARE(table1->sum(QRect(5, 5, 10, 10)), quint32(5 * 5 * 255));
+
+    KisSummedAreaTableSP table2 = env.cachedAlphaTable(device, r1.adjusted(5, 5, -5, -5));
+    QVERIFY(table1 == table2);
+
+    KisSummedAreaTableSP table3 = env.cachedAlphaTable(device, r2);
+    QVERIFY(table1 != table3);
+    QCOMPARE(table3->rect(), r2);
+
+    // both tables are retained
+    QVERIFY(env.cachedAlphaTable(device, r1) == table1);
+    QVERIFY(env.cachedAlphaTable(device, r2) == table3);
+
+    device->fill(QRect(40, 40, 10, 10), KoColor(Qt::red, device->colorSpace()));
+
+    KisSummedAreaTableSP table4 = env.cachedAlphaTable(device, r2);
+    QVERIFY(table3 != table4);
+    QCOMPARE(table4->rect(), r2);
+    QCOMPARE(table4->sum(r2), quint32((10 * 10 + 10 * 10) * 255));
+}
+
+void KisLayerStyleFilterEnvironmentTest::testAlphaTableCacheLimit()
+{
+    KisPaintDeviceSP device = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    device->fill(QRect(10, 10, 20, 20), KoColor(Qt::red, device->colorSpace()));
+
+    // every 40x40 table takes 41 * 41 * 4 bytes
+    KisSummedAreaTableCache cache(2 * 41 * 41 * 4);
+
+    const QRect r1 = QRect(0,0,40,40);
+    const QRect r2 = QRect(20,20,40,40);
+    const QRect r3 = QRect(40,40,40,40);
+
+    KisSummedAreaTableSP table1 = cache.fetch(device, r1);
+    KisSummedAreaTableSP table2 = cache.fetch(device, r2);
+    QVERIFY(cache.fetch(device, r1) == table1);
+
+    // r2 is the least recently used one, so it gets evicted
+    KisSummedAreaTableSP table3 = cache.fetch(device, r3);
+    QVERIFY(cache.fetch(device, r1) == table1);
+    QVERIFY(cache.fetch(device, r3) == table3);
+    QVERIFY(cache.fetch(device, r2) != table2);
+
+    // the tables bigger than the limit are never retained
+    const QRect bigRect = QRect(0,0,100,100);
+    KisSummedAreaTableSP bigTable = cache.fetch(device, bigRect);
+    QCOMPARE(bigTable->sum(bigRect), quint32(20 * 20 * 255));
+    QVERIFY(cache.fetch(device, bigRect) != bigTable);
+}
+
+void KisLayerStyleFilterEnvironmentTest::testAlphaTableCacheInvalidation()
+{
+    KisPaintDeviceSP device = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    device->fill(QRect(10, 10, 20, 20), KoColor(Qt::red, device->colorSpace()));
+
+    KisSummedAreaTableCache cache;
+
+    const QRect r1 = QRect(0,0,40,40);
+    const QRect r2 = QRect(100,100,40,40);
+
+    KisSummedAreaTableSP table1 = cache.fetch(device, r1);
+    KisSummedAreaTableSP table2 = cache.fetch(device, r2);
+    QCOMPARE(table1->sum(r1), quint32(20 * 20 * 255));
+
+    /**
+     * Write into the device the way the projection is updated, that is,
+     * with bitBlt and without touching the device in any other way
+     */
+    const QRect dirtyRect = QRect(30, 30, 5, 5);
+
+    {
+        KisPaintDeviceSP src = new KisPaintDevice(device->colorSpace());
+        src->fill(dirtyRect, KoColor(Qt::red, device->colorSpace()));
+
+        KisPainter gc(device);
+        gc.bitBlt(dirtyRect.topLeft(), src, dirtyRect);
+    }
+
+    cache.invalidate(dirtyRect);
+
+    KisSummedAreaTableSP table3 = cache.fetch(device, r1);
+    QVERIFY(table3 != table1);
+    QCOMPARE(table3->sum(r1), quint32((20 * 20 + 5 * 5) * 255));
+
+    // the tables outside the dirty rect are still valid
+    QVERIFY(cache.fetch(device, r2) == table2);
+}
+
+void KisLayerStyleFilterEnvironmentTest::testSummedAreaTableBoxBlur()
+{
+    const QRect srcRect(-7, 3, 61, 45);
+    const int radius = 4;
+
+    KisPixelSelectionSP src = new KisPixelSelection();
+
+    {
+        KisSequentialIterator it(src, srcRect);
+        while (it.nextPixel()) {
+            *it.rawData() = quint8((it.x() * 37 + it.y() * 101) ^ (it.x() * it.y()));
+        }
+    }
+
+    KisSummedAreaTable table(src, srcRect);
+    const QRect dstRect = srcRect.adjusted(radius, radius, -radius, -radius);
+
+    for (int inverted = 0; inverted < 2; inverted++) {
+        KisPixelSelectionSP dst = new KisPixelSelection();
+        table.boxBlur(dst, dstRect, radius, inverted);
+
+        KisSequentialConstIterator it(dst, dstRect);
+        while (it.nextPixel()) {
+            int sum = 0;
+
+            for (int y = it.y() - radius; y <= it.y() + radius; y++) {
+                for (int x = it.x() - radius; x <= it.x() + radius; x++) {
+                    const int value = src->pixel(QPoint(x, y)).data()[0];
+                    sum += inverted ? 255 - value : value;
+                }
+            }
+
+            const int area = (2 * radius + 1) * (2 * radius + 1);
+            QCOMPARE(int(*it.rawDataConst()), (sum + area / 2) / area);
+        }
+    }
+}
+
 SIMPLE_TEST_MAIN(KisLayerStyleFilterEnvironmentTest)
@@ -15,6 +15,10 @@ class KisLayerStyleFilterEnvironmentTest : public QObject
 private Q_SLOTS:
     void testRandomSelectionCaching();
     void benchmarkRandomSelectionGeneration();
+    void testAlphaTableCaching();
+    void testAlphaTableCacheLimit();
+    void testAlphaTableCacheInvalidation();
+    void testSummedAreaTableBoxBlur();
 };
 
 #endif /* __KIS_LAYER_STYLE_FILTER_ENVIRONMENT_TEST_H */
@@ -542,6 +542,78 @@ void KisLayerStyleProjectionPlaneTest::testBevel()
     test(style, "bevel_pillow_up_soft");
 }
 
+void KisLayerStyleProjectionPlaneTest::testShadowAfterBitBlt()
+{
+    const QRect imageRect(0, 0, 200, 200);
+    const QRect fillRect(30, 30, 100, 100);
+    const QRect holeRect(60, 60, 30, 30);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "styles test");
+
+    KisPaintLayerSP layer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+    image->addNode(layer);
+
+    /**
+     * The blur is big enough to use the summed-area tables of the
+     * alpha channel, which are cached by the projection plane
+     */
+    KisPSDLayerStyleSP style(new KisPSDLayerStyle());
+    style->innerShadow()->setSize(40);
+    style->innerShadow()->setDistance(0);
+    style->innerShadow()->setOpacity(100);
+    style->innerShadow()->setNoise(0);
+    style->innerShadow()->setEffectEnabled(true);
+
+    KisLayerStyleProjectionPlane plane(layer.data(), style);
+
+    layer->paintDevice()->fill(fillRect, KoColor(Qt::red, cs));
+
+    {
+        KisPaintDeviceSP projection = new KisPaintDevice(cs);
+        plane.recalculate(imageRect, layer);
+
+        KisPainter painter(projection);
+        plane.apply(&painter, imageRect);
+    }
+
+    /**
+     * Punch a hole with bitBlt, which doesn't change the sequence number
+     * of the device, so the tables must be dropped by the plane itself
+     */
+    {
+        KisPaintDeviceSP transparent = new KisPaintDevice(cs);
+
+        KisPainter gc(layer->paintDevice());
+        gc.setCompositeOpId(COMPOSITE_COPY);
+        gc.bitBlt(holeRect.topLeft(), transparent, holeRect);
+    }
+
+    const QRect changeRect = plane.changeRect(holeRect, KisLayer::N_FILTHY);
+
+    KisPaintDeviceSP updated = new KisPaintDevice(cs);
+
+    {
+        plane.recalculate(changeRect, layer);
+
+        KisPainter painter(updated);
+        plane.apply(&painter, changeRect);
+    }
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+
+    {
+        KisLayerStyleProjectionPlane freshPlane(layer.data(), style);
+        freshPlane.recalculate(changeRect, layer);
+
+        KisPainter painter(reference);
+        freshPlane.apply(&painter, changeRect);
+    }
+
+    QPoint pt;
+    QVERIFY(TestUtil::comparePaintDevices(pt, updated, reference));
+}
+
 #include "kis_ls_utils.h"
 
 void KisLayerStyleProjectionPlaneTest::testBlending()
@@ -34,6 +34,8 @@ private Q_SLOTS:
 
     void testBevel();
 
+    void testShadowAfterBitBlt();
+
     void testBlending();
 
 private:
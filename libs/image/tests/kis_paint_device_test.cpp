@@ -124,6 +124,52 @@ void KisPaintDeviceTest::testStore()
 
 }
 
+void KisPaintDeviceTest::testStoreManyTiles()
+{
+    /**
+     * Devices with many tiles are compressed and decompressed by
+     * worker threads, check that the result is still pixel-perfect
+     */
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect rc(-100, -100, 1500, 1200);
+    QImage image(rc.size(), QImage::Format_ARGB32);
+
+    for (int y = 0; y < image.height(); y++) {
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); x++) {
+            line[x] = qRgba(x % 256, y % 256, (x * y) % 256, (x + y) % 256);
+        }
+    }
+
+    dev->convertFromQImage(image, 0, rc.x(), rc.y());
+
+    KoStore * writeStore =
+        KoStore::createStore(QString(FILES_OUTPUT_DIR) + '/' + "store_many_tiles_out.kra", KoStore::Write);
+    KisFakePaintDeviceWriter fakeWriter(writeStore);
+    writeStore->open("built image/layers/layer0");
+    QVERIFY(dev->write(fakeWriter));
+    writeStore->close();
+    delete writeStore;
+
+    KisPaintDeviceSP dev2 = new KisPaintDevice(cs);
+    KoStore * readStore =
+        KoStore::createStore(QString(FILES_OUTPUT_DIR) + '/' + "store_many_tiles_out.kra", KoStore::Read);
+    readStore->open("built image/layers/layer0");
+    QVERIFY(dev2->read(readStore->device()));
+    readStore->close();
+    delete readStore;
+
+    QCOMPARE(dev2->exactBounds(), dev->exactBounds());
+
+    QPoint pt;
+    if (!TestUtil::comparePaintDevices(pt, dev, dev2)) {
+        QFAIL(QString("Loading a saved image is not pixel perfect, first different pixel: %1,%2 ").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
 void KisPaintDeviceTest::testGeometry()
 {
     const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -17,6 +17,7 @@ private Q_SLOTS:
 
     void testCreation();
     void testStore();
+    void testStoreManyTiles();
     void testGeometry();
     void testClear();
     void testCrop();
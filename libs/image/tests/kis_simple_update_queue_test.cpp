@@ -234,6 +234,57 @@ void KisSimpleUpdateQueueTest::testMixingTypes()
     QCOMPARE(walkersList[3]->type(), KisBaseRectsWalker::FULL_REFRESH_NO_FILTHY);
 }
 
+void KisSimpleUpdateQueueTest::testTileDeduplication()
+{
+    QRect imageRect(0,0,1024,1024);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+
+    image->barrierLock();
+    image->addNode(paintLayer);
+    image->unlock();
+
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+
+    queue.addUpdateJob(paintLayer, QRect(0,0,256,256), imageRect, 0);
+
+    // all the tiles are already dirty, the request is dropped
+    queue.addUpdateJob(paintLayer, QRect(64,64,64,64), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 1);
+    QVERIFY(checkWalker(walkersList[0], QRect(0,0,256,256)));
+
+    // only the tiles that are not dirty yet are requested
+    queue.addUpdateJob(paintLayer, QRect(200,0,100,64), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 2);
+    QVERIFY(checkWalker(walkersList[0], QRect(0,0,256,256)));
+    QVERIFY(checkWalker(walkersList[1], QRect(256,0,44,64)));
+
+    // the tiles of a different update type are not shared
+    queue.addFullRefreshJob(paintLayer, QRect(64,64,64,64), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 3);
+    QVERIFY(checkWalker(walkersList[2], QRect(64,64,64,64)));
+
+    KisTestableUpdaterContext context(1);
+    queue.processQueue(context);
+
+    QVector<KisUpdateJobItem*> jobs = context.getJobs();
+    QVERIFY(checkWalker(jobs[0]->walker(), QRect(0,0,256,256)));
+    QCOMPARE(walkersList.size(), 2);
+
+    // the tiles of the started walker are not dirty anymore
+    queue.addUpdateJob(paintLayer, QRect(64,64,64,64), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 3);
+    QVERIFY(checkWalker(walkersList[2], QRect(64,64,64,64)));
+}
+
 void KisSimpleUpdateQueueTest::testSpontaneousJobsCompression()
 {
     KisTestableSimpleUpdateQueue queue;
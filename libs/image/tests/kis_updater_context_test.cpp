@@ -10,6 +10,9 @@
 #include "kistest.h"
 
 #include <QAtomicInt>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
 
@@ -17,6 +20,7 @@
 
 #include "kis_merge_walker.h"
 #include "kis_updater_context.h"
+#include "kis_spontaneous_job.h"
 #include "kis_image.h"
 
 #include "scheduler_utils.h"
@@ -235,5 +239,150 @@ void KisUpdaterContextTest::stressTestExclusiveJobs()
              << "/" << NUM_CHECKS * NUM_JOBS;
 }
 
+#define NUM_SUBTASKS 16
+#define SUBTASK_DELAY 10 // ms
+
+struct SpontaneousSubtasksState
+{
+    SpontaneousSubtasksState()
+        : runCount(NUM_SUBTASKS)
+    {
+    }
+
+    QVector<QAtomicInt> runCount;
+    QAtomicInt numStarted;
+    QAtomicInt numFinished;
+    QAtomicInt jobFinished;
+    QAtomicInt allFinishedOnReturn;
+    QAtomicInt exclusiveJobRan;
+    QAtomicInt exclusiveJobSawUnfinished;
+
+    QMutex threadsLock;
+    QSet<Qt::HANDLE> threads;
+};
+
+class SubtasksSpontaneousJob : public KisSpontaneousJob
+{
+public:
+    SubtasksSpontaneousJob(SpontaneousSubtasksState *state)
+        : m_state(state)
+    {
+    }
+
+    bool overrides(const KisSpontaneousJob *otherJob) override {
+        Q_UNUSED(otherJob);
+        return false;
+    }
+
+    int levelOfDetail() const override {
+        return 0;
+    }
+
+    void run() override {
+        SpontaneousSubtasksState *state = m_state;
+        QVector<std::function<void()>> subtasks;
+
+        for (int i = 0; i < NUM_SUBTASKS; i++) {
+            subtasks << [state, i] () {
+                state->numStarted.ref();
+                state->runCount[i].ref();
+
+                {
+                    QMutexLocker l(&state->threadsLock);
+                    state->threads.insert(QThread::currentThreadId());
+                }
+
+                QTest::qSleep(SUBTASK_DELAY);
+                state->numFinished.ref();
+            };
+        }
+
+        runSubtasks(subtasks);
+
+        if (state->numFinished == NUM_SUBTASKS) {
+            state->allFinishedOnReturn.ref();
+        }
+        state->jobFinished.ref();
+    }
+
+    QString debugName() const override {
+        return "SubtasksSpontaneousJob";
+    }
+
+private:
+    SpontaneousSubtasksState *m_state;
+};
+
+class SubtasksCheckerStrategy : public KisStrokeJobStrategy
+{
+public:
+    SubtasksCheckerStrategy(SpontaneousSubtasksState *state)
+        : m_state(state)
+    {
+    }
+
+    void run(KisStrokeJobData *data) override {
+        Q_UNUSED(data);
+
+        m_state->exclusiveJobRan.ref();
+
+        if (!m_state->jobFinished || m_state->numFinished != NUM_SUBTASKS) {
+            m_state->exclusiveJobSawUnfinished.ref();
+        }
+    }
+
+    QString debugId() const override {
+        return "SubtasksCheckerStrategy";
+    }
+
+private:
+    SpontaneousSubtasksState *m_state;
+};
+
+void KisUpdaterContextTest::testSpontaneousSubtasks()
+{
+    // the testing mode disables stealing, so use the real threads
+    KisUpdaterContext context(4);
+    SpontaneousSubtasksState state;
+
+    context.lock();
+    context.addSpontaneousJob(new SubtasksSpontaneousJob(&state));
+    context.unlock();
+
+    // the subtasks are started only after all of them are published
+    while (!state.numStarted) {
+        QTest::qSleep(1);
+    }
+
+    context.lock();
+
+    const bool firstStolen = context.stealSpontaneousSubtask();
+    const bool secondStolen = context.stealSpontaneousSubtask();
+    const bool hasThreadForExclusiveJob = context.hasSpareThread();
+
+    KisStrokeJobData *data =
+        new KisStrokeJobData(KisStrokeJobData::SEQUENTIAL,
+                             KisStrokeJobData::EXCLUSIVE);
+
+    context.addStrokeJob(new KisStrokeJob(new SubtasksCheckerStrategy(&state), data, 0, true));
+    context.unlock();
+
+    context.waitForDone();
+
+    QVERIFY(firstStolen);
+    QVERIFY(secondStolen);
+    QVERIFY(hasThreadForExclusiveJob);
+
+    for (int i = 0; i < NUM_SUBTASKS; i++) {
+        QCOMPARE(int(state.runCount[i]), 1);
+    }
+
+    QVERIFY(state.allFinishedOnReturn);
+    QVERIFY(state.threads.size() > 1);
+
+    QCOMPARE(int(state.exclusiveJobRan), 1);
+    QVERIFY(!state.exclusiveJobSawUnfinished);
+}
+
 KISTEST_MAIN(KisUpdaterContextTest)
 
@@ -6,6 +6,8 @@
 
 #include "kis_hline_iterator.h"
 
+#include <QVarLengthArray>
+
 
 KisHLineIterator2::KisHLineIterator2(KisDataManager *dataManager, qint32 x, qint32 y, qint32 w, qint32 offsetX, qint32 offsetY, bool writable, KisIteratorCompleteListener *completionListener)
     : KisBaseIterator(dataManager, writable, completionListener),
@@ -46,9 +48,7 @@ KisHLineIterator2::KisHLineIterator2(KisDataManager *dataManager, qint32 x, qint
     m_tileWidth = m_pixelSize * KisTileData::HEIGHT;
 
     // let's preallocate first row
-    for (quint32 i = 0; i < m_tilesCacheSize; i++){
-        fetchTileDataForCache(m_tilesCache[i], m_leftCol + i, m_row);
-    }
+    fetchTilesDataForCache();
     m_index = 0;
     switchToTile(m_leftInLeftmostTile);
 }
@@ -188,15 +188,25 @@ void KisHLineIterator2::switchToTile(qint32 xInTile)
 }
 
 
-void KisHLineIterator2::fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint32 row)
+void KisHLineIterator2::fetchTilesDataForCache()
 {
-    m_dataManager->getTilesPair(col, row, m_writable, &kti.tile, &kti.oldtile);
+    QVarLengthArray<KisTileSP, 32> tiles(int(m_tilesCacheSize));
+    QVarLengthArray<KisTileSP, 32> oldTiles(int(m_tilesCacheSize));
+
+    m_dataManager->getTilesPairs(m_leftCol, m_row, m_rightCol, m_row, m_writable,
+                                 tiles.data(), oldTiles.data());
 
-    lockTile(kti.tile);
-    kti.data = kti.tile->data();
+    for (quint32 i = 0; i < m_tilesCacheSize; i++) {
+        KisTileInfo &kti = m_tilesCache[i];
 
-    lockOldTile(kti.oldtile);
-    kti.oldData = kti.oldtile->data();
+        kti.tile = tiles[i];
+        lockTile(kti.tile);
+        kti.data = kti.tile->data();
+
+        kti.oldtile = oldTiles[i];
+        lockOldTile(kti.oldtile);
+        kti.oldData = kti.oldtile->data();
+    }
 }
 
 void KisHLineIterator2::preallocateTiles()
@@ -204,8 +214,8 @@ void KisHLineIterator2::preallocateTiles()
     for (quint32 i = 0; i < m_tilesCacheSize; ++i){
         unlockTile(m_tilesCache[i].tile);
         unlockOldTile(m_tilesCache[i].oldtile);
-        fetchTileDataForCache(m_tilesCache[i], m_leftCol + i, m_row);
     }
+    fetchTilesDataForCache();
 }
 
 qint32 KisHLineIterator2::x() const
@@ -71,7 +71,7 @@ private:
 private:
 
     void switchToTile(qint32 xInTile);
-    void fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint32 row);
+    void fetchTilesDataForCache();
     void preallocateTiles();
 };
 #endif
@@ -4,7 +4,10 @@
  *  SPDX-License-Identifier: GPL-2.0-or-later
  */
 
+#include <algorithm>
+
 #include <QtGlobal>
+#include <QVarLengthArray>
 #include "kis_memento_manager.h"
 #include "kis_memento.h"
 
@@ -226,6 +229,33 @@ KisTileSP KisMementoManager::getCommittedTile(qint32 col, qint32 row, bool &exis
     return mi->tile(0);
 }
 
+void KisMementoManager::getCommittedTiles(qint32 firstCol, qint32 firstRow,
+                                          qint32 lastCol, qint32 lastRow,
+                                          KisTileSP *tiles)
+{
+    const int numTiles = (lastCol - firstCol + 1) * (lastRow - firstRow + 1);
+
+    if(!namedTransactionInProgress()) {
+        std::fill(tiles, tiles + numTiles, KisTileSP());
+        return;
+    }
+
+    QVarLengthArray<KisMementoItemSP, 32> items(numTiles);
+    m_headsHashTable.getExistingTiles(firstCol, firstRow, lastCol, lastRow, items.data());
+
+    int i = 0;
+    for (qint32 row = firstRow; row <= lastRow; row++) {
+        for (qint32 col = firstCol; col <= lastCol; col++, i++) {
+            if (items[i]) {
+                tiles[i] = items[i]->tile(0);
+            } else {
+                bool unused;
+                tiles[i] = getCommittedTile(col, row, unused);
+            }
+        }
+    }
+}
+
 KisMementoSP KisMementoManager::getMemento()
 {
     /**
@@ -92,6 +92,16 @@ public:
      */
     KisTileSP getCommittedTile(qint32 col, qint32 row, bool &existingTile);
 
+    /**
+     * A batched version of getCommittedTile() for the area [firstCol,
+     * lastCol] x [firstRow, lastRow]. The tiles are written into \p tiles
+     * row by row. If no named transaction is in progress, all the
+     * returned tiles are null.
+     */
+    void getCommittedTiles(qint32 firstCol, qint32 firstRow,
+                           qint32 lastCol, qint32 lastRow,
+                           KisTileSP *tiles);
+
     KisMementoSP getMemento();
 
     bool hasCurrentMemento() {
@@ -10,11 +10,8 @@
 #include <kis_debug.h>
 
 
-const quint32 KisRandomAccessor2::CACHESIZE = 4; // Define the number of tiles we keep in cache
-
 KisRandomAccessor2::KisRandomAccessor2(KisTiledDataManager *ktm, qint32 offsetX, qint32 offsetY, bool writable, KisIteratorCompleteListener *completeListener) :
         m_ktm(ktm),
-        m_tilesCache(new KisTileInfo*[CACHESIZE]),
         m_tilesCacheSize(0),
         m_pixelSize(m_ktm->pixelSize()),
         m_data(0),
@@ -34,9 +31,7 @@ KisRandomAccessor2::~KisRandomAccessor2()
     for (uint i = 0; i < m_tilesCacheSize; i++) {
         unlockTile(m_tilesCache[i]->tile);
         unlockOldTile(m_tilesCache[i]->oldtile);
-        delete m_tilesCache[i];
     }
-    delete [] m_tilesCache;
 
     if (m_writable && m_completeListener) {
         m_completeListener->notifyWritableIteratorCompleted();
@@ -68,16 +63,18 @@ void KisRandomAccessor2::moveTo(qint32 x, qint32 y)
         }
     }
     // The tile wasn't in cache
-    if (m_tilesCacheSize == KisRandomAccessor2::CACHESIZE) { // Remove last element of cache
-        unlockTile(m_tilesCache[CACHESIZE-1]->tile);
-        unlockOldTile(m_tilesCache[CACHESIZE-1]->oldtile);
-        delete m_tilesCache[CACHESIZE-1];
+    KisTileInfo* kti = 0;
+    if (m_tilesCacheSize == KisRandomAccessor2::CACHESIZE) { // Reuse last element of cache
+        kti = m_tilesCache[CACHESIZE-1];
+        unlockTile(kti->tile);
+        unlockOldTile(kti->oldtile);
     } else {
+        kti = &m_tilesStorage[m_tilesCacheSize];
         m_tilesCacheSize++;
     }
     quint32 col = xToCol(x);
     quint32 row = yToRow(y);
-    KisTileInfo* kti = fetchTileData(col, row);
+    fetchTileData(kti, col, row);
     quint32 offset = x - kti->area_x1 + (y - kti->area_y1) * KisTileData::WIDTH;
     offset *= m_pixelSize;
     m_data = kti->data + offset;
@@ -106,10 +103,8 @@ const quint8* KisRandomAccessor2::rawDataConst() const
     return m_data;
 }
 
-KisRandomAccessor2::KisTileInfo* KisRandomAccessor2::fetchTileData(qint32 col, qint32 row)
+void KisRandomAccessor2::fetchTileData(KisTileInfo *kti, qint32 col, qint32 row)
 {
-    KisTileInfo* kti = new KisTileInfo;
-
     m_ktm->getTilesPair(col, row, m_writable, &kti->tile, &kti->oldtile);
 
     lockTile(kti->tile);
@@ -122,8 +117,6 @@ KisRandomAccessor2::KisTileInfo* KisRandomAccessor2::fetchTileData(qint32 col, q
     kti->area_y1 = row * KisTileData::WIDTH;
     kti->area_x2 = kti->area_x1 + KisTileData::HEIGHT - 1;
     kti->area_y2 = kti->area_y1 + KisTileData::WIDTH - 1;
-
-    return kti;
 }
 
 qint32 KisRandomAccessor2::numContiguousColumns(qint32 x) const
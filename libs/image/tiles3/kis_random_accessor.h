@@ -65,7 +65,7 @@ private:
         return m_ktm ? m_ktm->yToRow(y) : 0;
     }
 
-    KisTileInfo* fetchTileData(qint32 col, qint32 row);
+    void fetchTileData(KisTileInfo *kti, qint32 col, qint32 row);
 
 public:
     /// Move to a given x,y position, fetch tiles and data
@@ -80,8 +80,16 @@ public:
     qint32 y() const override;
 
 private:
+    static const quint32 CACHESIZE = 4; // Define the number of tiles we keep in cache
+
     KisTiledDataManager *m_ktm;
-    KisTileInfo** m_tilesCache;
+
+    /**
+     * The cache entries are allocated once together with the accessor,
+     * m_tilesCache keeps them ordered from the most recently used one
+     */
+    KisTileInfo m_tilesStorage[CACHESIZE];
+    KisTileInfo* m_tilesCache[CACHESIZE];
     quint32 m_tilesCacheSize;
     qint32 m_pixelSize;
     quint8* m_data;
@@ -90,7 +98,6 @@ private:
     int m_lastX, m_lastY;
     qint32 m_offsetX, m_offsetY;
     KisIteratorCompleteListener *m_completeListener;
-    static const quint32 CACHESIZE; // Define the number of tiles we keep in cache
 
 };
 
@@ -137,6 +137,23 @@ void KisTile::notifyAttachedToDataManager(KisMementoManager *mm)
 #endif
 }
 
+void KisTile::applySwapHint(int pinEpoch, bool prefetch)
+{
+    /**
+     * Holding the COW mutex guarantees the tile data will not
+     * be released while we are referencing it
+     */
+    QMutexLocker locker(&m_COWMutex);
+
+    if (pinEpoch) {
+        m_tileData->setPinEpoch(pinEpoch);
+    }
+
+    if (prefetch) {
+        m_tileData->m_store->prefetchTileData(m_tileData);
+    }
+}
+
 //#define DEBUG_TILE_LOCKING
 //#define DEBUG_TILE_COWING
 
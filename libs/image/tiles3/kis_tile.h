@@ -119,6 +119,16 @@ public:
         return m_tileData;
     }
 
+    /**
+     * Passes the swap hint to the current tile data of the tile.
+     * If \p pinEpoch is non-zero, the tile data is pinned in memory
+     * for this epoch. If \p prefetch is true and the data is swapped
+     * out, it is queued for loading in the background.
+     *
+     * Unlike lockForRead(), never blocks on the swap file.
+     */
+    void applySwapHint(int pinEpoch, bool prefetch);
+
 private:
     void init(qint32 col, qint32 row,
               KisTileData *defaultTileData, KisMementoManager* mm);
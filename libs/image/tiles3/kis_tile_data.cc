@@ -54,6 +54,8 @@ KisTileData::KisTileData(qint32 pixelSize, const quint8 *defPixel, KisTileDataSt
     : m_state(NORMAL),
       m_mementoFlag(0),
       m_age(0),
+      m_accessFrequency(0),
+      m_pinEpoch(0),
       m_usersCount(0),
       m_refCount(0),
       m_pixelSize(pixelSize),
@@ -83,6 +85,8 @@ KisTileData::KisTileData(const KisTileData& rhs, bool checkFreeMemory)
     : m_state(NORMAL),
       m_mementoFlag(0),
       m_age(0),
+      m_accessFrequency(0),
+      m_pinEpoch(0),
       m_usersCount(0),
       m_refCount(0),
       m_pixelSize(rhs.m_pixelSize),
@@ -112,9 +112,23 @@ inline int KisTileData::age() const {
 }
 inline void KisTileData::resetAge() {
     m_age = 0;
+    if (m_accessFrequency < MAX_ACCESS_FREQUENCY) {
+        m_accessFrequency++;
+    }
 }
 inline void KisTileData::markOld() {
     m_age++;
+    m_accessFrequency >>= 1;
+}
+inline int KisTileData::accessFrequency() const {
+    return m_accessFrequency;
+}
+
+inline int KisTileData::pinEpoch() const {
+    return m_pinEpoch.loadAcquire();
+}
+inline void KisTileData::setPinEpoch(int epoch) {
+    m_pinEpoch.storeRelease(epoch);
 }
 
 inline qint32 KisTileData::numUsers() const {
@@ -160,11 +160,25 @@ public:
     inline void setMementoed(bool value);
 
     /**
-     * Controlling methods for setting 'age' marks
+     * Controlling methods for setting 'age' marks. Every access
+     * resets the age and bumps the (saturating) access frequency
+     * counter, every swapper pass that skips the tile data ages it
+     * and halves the counter.
      */
     inline int age() const;
     inline void resetAge();
     inline void markOld();
+    inline int accessFrequency() const;
+
+    /**
+     * The swap hint epoch the tile data has been pinned with.
+     * The tile data is considered pinned by the swapper only
+     * while the epoch is one of the active epochs of the store.
+     *
+     * \see KisTileDataStore::beginSwapHint()
+     */
+    inline int pinEpoch() const;
+    inline void setPinEpoch(int epoch);
 
     /**
      * Returns number of tiles (or memento items),
@@ -270,6 +284,19 @@ private:
     //FIXME: make memory aligned
     int m_age;
 
+    /**
+     * Roughly counts how often the tile data has been accessed
+     * recently. Used by the swapper to keep the working set in
+     * memory.
+     */
+    int m_accessFrequency;
+
+    /**
+     * The swap hint epoch this tile data has been pinned with,
+     * 0 means "never pinned"
+     */
+    QAtomicInt m_pinEpoch;
+
 
     /**
      * The primitive for controlling swapping of the tile.
@@ -310,6 +337,11 @@ private:
 public:
     static const qint32 WIDTH;
     static const qint32 HEIGHT;
+
+    /**
+     * The access frequency counter saturates at this value
+     */
+    static const int MAX_ACCESS_FREQUENCY = 15;
 };
 
 #endif /* KIS_TILE_DATA_INTERFACE_H_ */
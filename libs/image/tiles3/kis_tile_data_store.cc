@@ -22,6 +22,8 @@ Q_GLOBAL_STATIC(KisTileDataStore, s_instance)
 
 #ifdef DEBUG_PRECLONE
 #include <stdio.h>
+#include <algorithm>
+#include <iterator>
 #define DEBUG_PRECLONE_ACTION(action, oldTD, newTD) \
     printf("!!! %s:\t\t\t  0x%X -> 0x%X    \t\t!!!\n",  \
            action, (quintptr)oldTD, (quintptr) newTD)
@@ -61,7 +63,8 @@ KisTileDataStore::KisTileDataStore()
       m_numTiles(0),
       m_memoryMetric(0),
       m_counter(1),
-      m_clockIndex(1)
+      m_clockIndex(1),
+      m_swapHintEpoch(1)
 {
     m_pooler.start();
     m_swapper.start();
@@ -279,6 +282,67 @@ bool KisTileDataStore::trySwapTileData(KisTileData *td)
     return result;
 }
 
+void KisTileDataStore::swapOutLoadedTileData(const QVector<KisTileData*> &tileData)
+{
+    if (!m_swapper.isAboveHardLimit()) return;
+
+    QWriteLocker locker(&m_iteratorLock);
+
+    Q_FOREACH (KisTileData *td, tileData) {
+        trySwapTileData(td);
+    }
+}
+
+int KisTileDataStore::beginSwapHint(const void *client)
+{
+    /**
+     * Zero epoch is reserved for "never pinned" tile data,
+     * skip it on overflow.
+     */
+    int epoch = 0;
+    while (!epoch) {
+        epoch = m_swapHintEpoch.fetchAndAddOrdered(1) + 1;
+    }
+
+    QMutexLocker locker(&m_swapHintLock);
+    m_swapHintClientEpochs[client] = epoch;
+
+    return epoch;
+}
+
+void KisTileDataStore::endSwapHint(const void *client)
+{
+    QMutexLocker locker(&m_swapHintLock);
+    m_swapHintClientEpochs.remove(client);
+}
+
+QVector<int> KisTileDataStore::activeSwapHintEpochs() const
+{
+    QMutexLocker locker(&m_swapHintLock);
+
+    QVector<int> epochs;
+    epochs.reserve(m_swapHintClientEpochs.size());
+    std::copy(m_swapHintClientEpochs.begin(), m_swapHintClientEpochs.end(),
+              std::back_inserter(epochs));
+    return epochs;
+}
+
+bool KisTileDataStore::isSwapHintEpochActive(int epoch) const
+{
+    if (!epoch) return false;
+
+    QMutexLocker locker(&m_swapHintLock);
+    return std::find(m_swapHintClientEpochs.begin(),
+                     m_swapHintClientEpochs.end(),
+                     epoch) != m_swapHintClientEpochs.end();
+}
+
+void KisTileDataStore::prefetchTileData(KisTileData *td)
+{
+    if (td->data()) return;
+    m_swapper.prefetch(td);
+}
+
 KisTileDataStoreIterator* KisTileDataStore::beginIteration()
 {
     m_iteratorLock.lockForWrite();
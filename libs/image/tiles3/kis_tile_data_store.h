@@ -11,6 +11,9 @@
 #include "kritaimage_export.h"
 
 #include <QReadWriteLock>
+#include <QMutex>
+#include <QHash>
+#include <QVector>
 #include "kis_tile_data_interface.h"
 
 #include "kis_tile_data_pooler.h"
@@ -107,6 +110,47 @@ public:
      */
     bool trySwapTileData(KisTileData *td);
 
+    /**
+     * Used by the loading code. If the store is above the hard
+     * memory limit, the freshly loaded tile data are written into
+     * the swap file right away, without waiting for the swapper to
+     * wake up. Otherwise does nothing. The tile data should not be
+     * locked by the caller.
+     */
+    void swapOutLoadedTileData(const QVector<KisTileData*> &tileData);
+
+    /**
+     * Starts a new swap hint epoch for \p client (usually a canvas).
+     * All the tile data pinned with the previous epoch of the same
+     * client are unpinned automatically, the epochs of the other
+     * clients stay active. The returned value should be passed to
+     * KisTiledDataManager::applySwapHint() for every device
+     * the user is looking at.
+     */
+    int beginSwapHint(const void *client);
+
+    /**
+     * Unpins all the tile data pinned by \p client. Should be
+     * called when the client is destroyed.
+     */
+    void endSwapHint(const void *client);
+
+    /**
+     * The current swap hint epochs of all the clients. The tile
+     * data pinned with these epochs are visible on canvas and
+     * should be swapped out the last.
+     */
+    QVector<int> activeSwapHintEpochs() const;
+
+    bool isSwapHintEpochActive(int epoch) const;
+
+    /**
+     * Asks the swapper to load the tile data back into memory
+     * in the background. Does nothing if the data is present
+     * in memory already.
+     */
+    void prefetchTileData(KisTileData *td);
+
 
     /**
      * WARN: The following three method are only for usage
@@ -167,6 +211,9 @@ private:
     QAtomicInt m_memoryMetric;
     QAtomicInt m_counter;
     QAtomicInt m_clockIndex;
+    QAtomicInt m_swapHintEpoch;
+    mutable QMutex m_swapHintLock;
+    QHash<const void*, int> m_swapHintClientEpochs;
     ConcurrentMap<int, KisTileData*> m_tileDataMap;
     QReadWriteLock m_iteratorLock;
 };
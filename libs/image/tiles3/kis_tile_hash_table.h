@@ -49,6 +49,16 @@ public:
      */
     TileTypeSP getExistingTile(qint32 col, qint32 row);
 
+    /**
+     * Fetches all the existing tiles in the area [firstCol, lastCol] x
+     * [firstRow, lastRow] into \p tiles (row by row). Missing tiles are
+     * returned as null pointers. All the lookups are done under a
+     * single read lock of the table.
+     */
+    void getExistingTiles(qint32 firstCol, qint32 firstRow,
+                          qint32 lastCol, qint32 lastRow,
+                          TileTypeSP *tiles);
+
     /**
      * Returns a tile in position (col,row). If no tile exists,
      * creates a new one, attaches it to the list and returns.
@@ -61,6 +61,17 @@ public:
      */
     TileTypeSP getExistingTile(qint32 col, qint32 row);
 
+    /**
+     * Fetches all the existing tiles in the area [firstCol, lastCol] x
+     * [firstRow, lastRow] into \p tiles (row by row). Missing tiles are
+     * returned as null pointers. All the lookups share one raw-pointer
+     * access section and one garbage collection pass, so the iterators
+     * don't synchronize on the GC for every tile they cross.
+     */
+    void getExistingTiles(qint32 firstCol, qint32 firstRow,
+                          qint32 lastCol, qint32 lastRow,
+                          TileTypeSP *tiles);
+
     /**
      * Returns a tile in position (col,row). If no tile exists,
      * creates a new one, attaches it to the list and returns.
@@ -110,6 +121,20 @@ public:
     friend class KisTileHashTableIteratorTraits2<T>;
 
 private:
+    /**
+     * Keeps raw pointers of the map alive while the locker exists.
+     * The scope must not take any other locks and must not call
+     * GC's update(), which may wait for all the raw pointer users
+     * to leave.
+     */
+    struct RawPointerAccessLocker {
+        RawPointerAccessLocker(QSBR &gc) : m_gc(gc) { m_gc.lockRawPointerAccess(); }
+        ~RawPointerAccessLocker() { m_gc.unlockRawPointerAccess(); }
+
+    private:
+        QSBR &m_gc;
+    };
+
     struct MemoryReclaimer {
         MemoryReclaimer(TileType *data) : d(data) {}
 
@@ -320,6 +345,26 @@ typename KisTileHashTableTraits2<T>::TileTypeSP KisTileHashTableTraits2<T>::getE
     return tile;
 }
 
+template <class T>
+void KisTileHashTableTraits2<T>::getExistingTiles(qint32 firstCol, qint32 firstRow,
+                                                  qint32 lastCol, qint32 lastRow,
+                                                  TileTypeSP *tiles)
+{
+    {
+        RawPointerAccessLocker locker(m_map.getGC());
+
+        for (qint32 row = firstRow; row <= lastRow; row++) {
+            for (qint32 col = firstCol; col <= lastCol; col++) {
+                const quint32 idx = calculateHashSafe(col, row);
+                *tiles++ = idx ? TileTypeSP(m_map.get(idx)) : TileTypeSP();
+            }
+        }
+    }
+
+    // garbage collection must **not** be run with locks held
+    m_map.getGC().update();
+}
+
 template <class T>
 typename KisTileHashTableTraits2<T>::TileTypeSP KisTileHashTableTraits2<T>::getTileLazy(qint32 col, qint32 row, bool &newTile)
 {
@@ -214,6 +214,20 @@ KisTileHashTableTraits<T>::getExistingTile(qint32 col, qint32 row)
     return getTile(col, row, idx);
 }
 
+template<class T>
+void KisTileHashTableTraits<T>::getExistingTiles(qint32 firstCol, qint32 firstRow,
+                                                 qint32 lastCol, qint32 lastRow,
+                                                 TileTypeSP *tiles)
+{
+    QReadLocker locker(&m_lock);
+
+    for (qint32 row = firstRow; row <= lastRow; row++) {
+        for (qint32 col = firstCol; col <= lastCol; col++) {
+            *tiles++ = getTile(col, row, calculateHash(col, row));
+        }
+    }
+}
+
 template<class T>
 typename KisTileHashTableTraits<T>::TileTypeSP
 KisTileHashTableTraits<T>::getTileLazy(qint32 col, qint32 row,
@@ -8,6 +8,7 @@
 
 #include <QRect>
 #include <QVector>
+#include <QtConcurrent>
 
 #include "kis_tile.h"
 #include "kis_tiled_data_manager.h"
@@ -16,12 +17,71 @@
 #include "kis_memento_manager.h"
 #include "swap/kis_legacy_tile_compressor.h"
 #include "swap/kis_tile_compressor_factory.h"
+#include "swap/kis_tile_compressor_2.h"
 
 #include "kis_paint_device_writer.h"
 
 #include "kis_global.h"
+#include "kis_image_config.h"
 
 
+namespace {
+
+/**
+ * The number of tiles compressed or decompressed by a single worker
+ * job. Small enough to keep all the cores busy on mid-sized layers,
+ * big enough to amortize the cost of the compressor's work buffers.
+ */
+const int tilesPerIOBatch = 64;
+
+/**
+ * Devices with fewer tiles are written and read sequentially, the
+ * threading overhead is not worth it for them.
+ */
+const int minTilesForParallelIO = 2 * tilesPerIOBatch;
+
+class KisByteArrayPaintDeviceWriter : public KisPaintDeviceWriter
+{
+public:
+    KisByteArrayPaintDeviceWriter(QByteArray *buffer)
+        : m_buffer(buffer)
+    {
+    }
+
+    bool write(const QByteArray &data) override {
+        m_buffer->append(data);
+        return true;
+    }
+
+    bool write(const char* data, qint64 length) override {
+        m_buffer->append(data, length);
+        return true;
+    }
+
+private:
+    QByteArray *m_buffer;
+};
+
+struct TilesWriteBatch {
+    QVector<KisTileSP> tiles;
+    QByteArray output;
+    bool success = true;
+};
+
+struct TilesReadBatch {
+    QVector<KisTileSP> tiles;
+    QVector<QByteArray> records;
+    QVector<QString> compressionNames;
+    bool success = true;
+};
+
+int numIOBatchesInFlight()
+{
+    return 2 * qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+}
+
+}
+
 /* The data area is divided into tiles each say 64x64 pixels (defined at compiletime)
  * The tiles are laid out in a matrix that can have negative indexes.
  * The matrix grows automatically if needed (a call for writeacces to a tile
@@ -103,21 +163,35 @@ bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
 
     bool retval = true;
 
+    const qint32 numTiles = m_hashTable->numTiles();
+
     if(CURRENT_VERSION == LEGACY_VERSION) {
         char str[80];
-        sprintf(str, "%d\n", m_hashTable->numTiles());
+        sprintf(str, "%d\n", numTiles);
         retval = store.write(str, strlen(str));
     }
     else {
-        retval = writeTilesHeader(store, m_hashTable->numTiles());
+        retval = writeTilesHeader(store, numTiles);
+    }
+
+    if (!retval) {
+        return retval;
     }
 
+    KisImageConfig config(true);
+    const QString compressionName = config.documentTileCompression();
+    const KisTileCompressor2::Predictor predictor =
+        KisTileCompressor2::Predictor(config.documentTilePredictor());
+
+    if (CURRENT_VERSION != LEGACY_VERSION && numTiles >= minTilesForParallelIO) {
+        return writeTilesParallel(store, compressionName, predictor);
+    }
 
     KisTileHashTableConstIterator iter(m_hashTable);
     KisTileSP tile;
 
     KisAbstractTileCompressorSP compressor =
-        KisTileCompressorFactory::create(CURRENT_VERSION);
+        KisTileCompressorFactory::create(CURRENT_VERSION, compressionName, predictor);
 
     while ((tile = iter.tile())) {
         retval = compressor->writeTile(tile, store);
@@ -130,6 +204,73 @@ bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
 
     return retval;
 }
+
+bool KisTiledDataManager::writeTilesParallel(KisPaintDeviceWriter &store,
+                                             const QString &compressionName,
+                                             int predictor)
+{
+    /**
+     * The tiles are compressed by the worker threads in batches, but
+     * the compressed records are passed to the store strictly in the
+     * order of the hash table iteration, so the written stream is
+     * byte-to-byte identical to the one created by the sequential
+     * path. Only a limited window of batches is kept in memory at a
+     * time.
+     */
+
+    QVector<KisTileSP> tiles;
+    tiles.reserve(m_hashTable->numTiles());
+
+    {
+        KisTileHashTableConstIterator iter(m_hashTable);
+        KisTileSP tile;
+
+        while ((tile = iter.tile())) {
+            tiles.append(tile);
+            iter.next();
+        }
+    }
+
+    auto compressBatch = [compressionName, predictor] (TilesWriteBatch &batch) {
+        KisTileCompressor2 compressor(compressionName, KisTileCompressor2::Predictor(predictor));
+        KisByteArrayPaintDeviceWriter writer(&batch.output);
+
+        Q_FOREACH (KisTileSP tile, batch.tiles) {
+            if (!compressor.writeTile(tile, writer)) {
+                batch.success = false;
+                break;
+            }
+        }
+    };
+
+    const int maxBatchesInFlight = numIOBatchesInFlight();
+    QVector<TilesWriteBatch> batches;
+    int tileIndex = 0;
+
+    while (tileIndex < tiles.size()) {
+        batches.clear();
+
+        while (tileIndex < tiles.size() && batches.size() < maxBatchesInFlight) {
+            TilesWriteBatch batch;
+            const int batchSize = qMin(tilesPerIOBatch, tiles.size() - tileIndex);
+            batch.tiles = tiles.mid(tileIndex, batchSize);
+            tileIndex += batchSize;
+            batches.append(batch);
+        }
+
+        QtConcurrent::blockingMap(batches, compressBatch);
+
+        for (auto it = batches.begin(); it != batches.end(); ++it) {
+            if (!it->success || !store.write(it->output)) {
+                warnFile << "Failed to write tile";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 bool KisTiledDataManager::read(QIODevice *stream)
 {
     clear();
@@ -164,13 +305,18 @@ bool KisTiledDataManager::read(QIODevice *stream)
         numTiles = line.toUInt();
     }
 
-    KisAbstractTileCompressorSP compressor =
-        KisTileCompressorFactory::create(tilesVersion);
-
     bool readSuccess = true;
-    for (quint32 i = 0; i < numTiles; i++) {
-        if (!compressor->readTile(stream, this)) {
-            readSuccess = false;
+
+    if (tilesVersion == CURRENT_VERSION && numTiles >= quint32(minTilesForParallelIO)) {
+        readSuccess = readTilesParallel(stream, numTiles);
+    } else {
+        KisAbstractTileCompressorSP compressor =
+            KisTileCompressorFactory::create(tilesVersion);
+
+        for (quint32 i = 0; i < numTiles; i++) {
+            if (!compressor->readTile(stream, this)) {
+                readSuccess = false;
+            }
         }
     }
 
@@ -178,6 +324,87 @@ bool KisTiledDataManager::read(QIODevice *stream)
     return readSuccess;
 }
 
+bool KisTiledDataManager::readTilesParallel(QIODevice *stream, quint32 numTiles)
+{
+    /**
+     * The stream itself can be read only sequentially, so the records
+     * are fetched on the calling thread and only decompression is
+     * passed to the workers. The tiles are locked for writing right
+     * when they are created, which keeps them resident until the
+     * batch is decompressed.
+     */
+
+    KisTileCompressor2 recordReader;
+
+    auto decompressBatch = [] (TilesReadBatch &batch) {
+        KisTileCompressor2 compressor;
+
+        for (int i = 0; i < batch.tiles.size(); i++) {
+            KisTileSP tile = batch.tiles[i];
+
+            if (!compressor.decompressTileRecord(tile, batch.records[i],
+                                                 batch.compressionNames[i])) {
+                batch.success = false;
+            }
+            tile->unlockForWrite();
+        }
+    };
+
+    const int maxBatchesInFlight = numIOBatchesInFlight();
+    QVector<TilesReadBatch> batches;
+    bool readSuccess = true;
+    quint32 tilesLeft = numTiles;
+
+    while (tilesLeft > 0) {
+        batches.clear();
+
+        while (tilesLeft > 0 && batches.size() < maxBatchesInFlight) {
+            TilesReadBatch batch;
+            const int batchSize = int(qMin(quint32(tilesPerIOBatch), tilesLeft));
+
+            for (int i = 0; i < batchSize; i++) {
+                KisTileSP tile;
+                QByteArray record;
+                QString compressionName;
+
+                if (recordReader.readTileRecord(stream, this, tile, record, compressionName)) {
+                    tile->lockForWrite();
+                    batch.tiles.append(tile);
+                    batch.records.append(record);
+                    batch.compressionNames.append(compressionName);
+                } else {
+                    readSuccess = false;
+                }
+            }
+
+            tilesLeft -= batchSize;
+            batches.append(batch);
+        }
+
+        QtConcurrent::blockingMap(batches, decompressBatch);
+
+        /**
+         * The document may be bigger than the memory limit. The swapper
+         * thread would not catch up with the loading, so the decoded
+         * tiles are sent to the swap file right here, while they are
+         * still fresh and unlocked.
+         */
+        QVector<KisTileData*> loadedTileData;
+
+        for (auto it = batches.constBegin(); it != batches.constEnd(); ++it) {
+            readSuccess &= it->success;
+
+            Q_FOREACH (KisTileSP tile, it->tiles) {
+                loadedTileData.append(tile->tileData());
+            }
+        }
+
+        KisTileDataStore::instance()->swapOutLoadedTileData(loadedTileData);
+    }
+
+    return readSuccess;
+}
+
 bool KisTiledDataManager::writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles)
 {
     QString buffer;
@@ -260,6 +487,34 @@ wrongString:
     return false;
 }
 
+void KisTiledDataManager::getTilesPairs(qint32 firstCol, qint32 firstRow,
+                                        qint32 lastCol, qint32 lastRow,
+                                        bool writable, KisTileSP *tiles, KisTileSP *oldTiles)
+{
+    m_hashTable->getExistingTiles(firstCol, firstRow, lastCol, lastRow, tiles);
+
+    const int numTiles = (lastCol - firstCol + 1) * (lastRow - firstRow + 1);
+
+    int i = 0;
+    for (qint32 row = firstRow; row <= lastRow; row++) {
+        for (qint32 col = firstCol; col <= lastCol; col++, i++) {
+            if (!tiles[i]) {
+                // slow path: the tile should be created or
+                // substituted with the default one
+                tiles[i] = getTile(col, row, writable);
+            }
+        }
+    }
+
+    m_mementoManager->getCommittedTiles(firstCol, firstRow, lastCol, lastRow, oldTiles);
+
+    for (i = 0; i < numTiles; i++) {
+        if (!oldTiles[i]) {
+            oldTiles[i] = tiles[i];
+        }
+    }
+}
+
 void KisTiledDataManager::purge(const QRect& area)
 {
     QList<KisTileSP> tilesToDelete;
@@ -780,3 +1035,54 @@ void KisTiledDataManager::releaseInternalPools()
 {
     KisTileData::releaseInternalPools();
 }
+
+int KisTiledDataManager::beginSwapHint(const void *client)
+{
+    return KisTileDataStore::instance()->beginSwapHint(client);
+}
+
+void KisTiledDataManager::endSwapHint(const void *client)
+{
+    KisTileDataStore::instance()->endSwapHint(client);
+}
+
+void KisTiledDataManager::applySwapHint(int pinEpoch, const QRect &pinnedRect, const QRect &prefetchRect)
+{
+    QReadLocker locker(&m_lock);
+
+    const QRect extent = m_extentManager.extent();
+    const QRect pinned = pinnedRect & extent;
+    const QRect hinted = (pinnedRect | prefetchRect) & extent;
+
+    if (hinted.isEmpty()) return;
+
+    const qint32 firstColumn = xToCol(hinted.left());
+    const qint32 lastColumn = xToCol(hinted.right());
+    const qint32 firstRow = yToRow(hinted.top());
+    const qint32 lastRow = yToRow(hinted.bottom());
+
+    const QRect pinnedTiles = pinned.isEmpty() ? QRect() :
+        QRect(QPoint(xToCol(pinned.left()), yToRow(pinned.top())),
+              QPoint(xToCol(pinned.right()), yToRow(pinned.bottom())));
+
+    QVector<KisTileSP> tiles((lastColumn - firstColumn + 1) * (lastRow - firstRow + 1));
+    m_hashTable->getExistingTiles(firstColumn, firstRow, lastColumn, lastRow, tiles.data());
+
+    /**
+     * Visible tiles go first, so that they were the first
+     * in the prefetch queue as well
+     */
+    for (int pass = 0; pass < 2; pass++) {
+        const bool pinPass = !pass;
+
+        int i = 0;
+        for (qint32 row = firstRow; row <= lastRow; row++) {
+            for (qint32 column = firstColumn; column <= lastColumn; column++, i++) {
+                if (!tiles[i]) continue;
+                if (pinnedTiles.contains(column, row) != pinPass) continue;
+
+                tiles[i]->applySwapHint(pinPass ? pinEpoch : 0, true);
+            }
+        }
+    }
+}
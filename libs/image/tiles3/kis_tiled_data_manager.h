@@ -9,6 +9,7 @@
 
 #include <QtGlobal>
 #include <QVector>
+#include <QSize>
 #include <KisRegion.h>
 
 #include <kis_shared.h>
@@ -102,6 +103,16 @@ public:
         }
     }
 
+    /**
+     * A batched version of getTilesPair() that fetches all the tiles of
+     * the area [firstCol, lastCol] x [firstRow, lastRow] row by row. The
+     * existing tiles are looked up in one go, so the iterators pay for
+     * the hash table synchronization once per a sweep, not once per tile.
+     */
+    void getTilesPairs(qint32 firstCol, qint32 firstRow,
+                       qint32 lastCol, qint32 lastRow,
+                       bool writable, KisTileSP *tiles, KisTileSP *oldTiles);
+
     inline KisTileSP getTile(qint32 col, qint32 row, bool writable) {
         if (writable) {
             bool newTile;
@@ -192,6 +203,27 @@ public:
 
     static void releaseInternalPools();
 
+    /**
+     * Starts a new swap hint epoch of \p client, all the tiles pinned
+     * earlier by the same client become unpinned. The returned epoch
+     * should be passed to applySwapHint() of every device visible on
+     * the client's canvas.
+     */
+    static int beginSwapHint(const void *client);
+
+    /**
+     * Unpins all the tiles pinned by \p client
+     */
+    static void endSwapHint(const void *client);
+
+    /**
+     * Tells the swapper which part of the device the user is looking
+     * at. The tiles intersecting \p pinnedRect are kept in memory as
+     * long as possible, the swapped out tiles intersecting \p pinnedRect
+     * or \p prefetchRect are loaded back in the background.
+     */
+    void applySwapHint(int pinEpoch, const QRect &pinnedRect, const QRect &prefetchRect);
+
 protected:
     /**
      * Reads and writes the tiles
@@ -331,6 +363,15 @@ public:
      */
     qint32 rowStride(qint32 x, qint32 y) const;
 
+    /**
+     * Get the size of the tiles the data is stored in. The tiles are
+     * aligned to the origin, so pixel (x, y) belongs to the tile
+     * (floor(x / width), floor(y / height)).
+     */
+    inline QSize tileSize() const {
+        return QSize(KisTileData::WIDTH, KisTileData::HEIGHT);
+    }
+
 private:
     KisTileHashTable *m_hashTable;
     KisMementoManager *m_mementoManager;
@@ -360,6 +401,11 @@ private:
     bool writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles);
     bool processTilesHeader(QIODevice *stream, quint32 &numTiles);
 
+    bool writeTilesParallel(KisPaintDeviceWriter &store,
+                            const QString &compressionName,
+                            int predictor);
+    bool readTilesParallel(QIODevice *stream, quint32 numTiles);
+
     inline qint32 divideRoundDown(qint32 x, const qint32 y) const
     {
         /**
@@ -9,6 +9,8 @@
 
 #include <iostream>
 
+#include <QVarLengthArray>
+
 KisVLineIterator2::KisVLineIterator2(KisDataManager *dataManager, qint32 x, qint32 y, qint32 h, qint32 offsetX, qint32 offsetY, bool writable, KisIteratorCompleteListener *completeListener)
     : KisBaseIterator(dataManager, writable, completeListener),
       m_offsetX(offsetX),
@@ -51,9 +53,7 @@ KisVLineIterator2::KisVLineIterator2(KisDataManager *dataManager, qint32 x, qint
     m_tileSize = m_lineStride * KisTileData::HEIGHT;
 
     // let's preallocate first row
-    for (int i = 0; i < m_tilesCacheSize; i++){
-        fetchTileDataForCache(m_tilesCache[i], m_column, m_topRow + i);
-    }
+    fetchTilesDataForCache();
     m_index = 0;
     switchToTile(m_topInTopmostTile);
 }
@@ -191,15 +191,25 @@ void KisVLineIterator2::switchToTile(qint32 yInTile)
 }
 
 
-void KisVLineIterator2::fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint32 row)
+void KisVLineIterator2::fetchTilesDataForCache()
 {
-    m_dataManager->getTilesPair(col, row, m_writable, &kti.tile, &kti.oldtile);
+    QVarLengthArray<KisTileSP, 32> tiles(m_tilesCacheSize);
+    QVarLengthArray<KisTileSP, 32> oldTiles(m_tilesCacheSize);
+
+    m_dataManager->getTilesPairs(m_column, m_topRow, m_column, m_bottomRow, m_writable,
+                                 tiles.data(), oldTiles.data());
 
-    lockTile(kti.tile);
-    kti.data = kti.tile->data();
+    for (int i = 0; i < m_tilesCacheSize; i++) {
+        KisTileInfo &kti = m_tilesCache[i];
+
+        kti.tile = tiles[i];
+        lockTile(kti.tile);
+        kti.data = kti.tile->data();
 
-    lockOldTile(kti.oldtile);
-    kti.oldData = kti.oldtile->data();
+        kti.oldtile = oldTiles[i];
+        lockOldTile(kti.oldtile);
+        kti.oldData = kti.oldtile->data();
+    }
 }
 
 void KisVLineIterator2::preallocateTiles()
@@ -207,8 +217,8 @@ void KisVLineIterator2::preallocateTiles()
     for (int i = 0; i < m_tilesCacheSize; ++i){
         unlockTile(m_tilesCache[i].tile);
         unlockOldTile(m_tilesCache[i].oldtile);
-        fetchTileDataForCache(m_tilesCache[i], m_column, m_topRow + i );
     }
+    fetchTilesDataForCache();
 }
 
 qint32 KisVLineIterator2::x() const
@@ -64,3 +64,101 @@ void KisAbstractCompression::delinearizeColors(quint8 *input, quint8 *output,
         startByte++;
     }
 }
+
+void KisAbstractCompression::applyHorizontalPredictor(quint8 *data, qint32 dataSize,
+                                                      qint32 width, qint32 height)
+{
+    const qint32 numRows = dataSize / width;
+    Q_ASSERT(numRows * width == dataSize);
+    Q_UNUSED(height);
+
+    for (qint32 row = 0; row < numRows; row++) {
+        quint8 *rowData = data + row * width;
+
+        // go backwards so that the left neighbour is still unchanged
+        for (qint32 x = width - 1; x > 0; x--) {
+            rowData[x] -= rowData[x - 1];
+        }
+    }
+}
+
+void KisAbstractCompression::revertHorizontalPredictor(quint8 *data, qint32 dataSize,
+                                                       qint32 width, qint32 height)
+{
+    const qint32 numRows = dataSize / width;
+    Q_ASSERT(numRows * width == dataSize);
+    Q_UNUSED(height);
+
+    for (qint32 row = 0; row < numRows; row++) {
+        quint8 *rowData = data + row * width;
+
+        for (qint32 x = 1; x < width; x++) {
+            rowData[x] += rowData[x - 1];
+        }
+    }
+}
+
+namespace {
+
+inline quint8 paethPredictor(quint8 a, quint8 b, quint8 c)
+{
+    const int p = int(a) + int(b) - int(c);
+    const int pa = qAbs(p - int(a));
+    const int pb = qAbs(p - int(b));
+    const int pc = qAbs(p - int(c));
+
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+}
+
+void KisAbstractCompression::applyPaethPredictor(quint8 *data, qint32 dataSize,
+                                                 qint32 width, qint32 height)
+{
+    const qint32 planeSize = width * height;
+    const qint32 numPlanes = dataSize / planeSize;
+    Q_ASSERT(numPlanes * planeSize == dataSize);
+
+    for (qint32 plane = 0; plane < numPlanes; plane++) {
+        quint8 *planeData = data + plane * planeSize;
+
+        // go backwards so that all the neighbours are still unchanged
+        for (qint32 y = height - 1; y >= 0; y--) {
+            quint8 *row = planeData + y * width;
+            const quint8 *prevRow = y > 0 ? row - width : 0;
+
+            for (qint32 x = width - 1; x >= 0; x--) {
+                const quint8 a = x > 0 ? row[x - 1] : 0;
+                const quint8 b = prevRow ? prevRow[x] : 0;
+                const quint8 c = prevRow && x > 0 ? prevRow[x - 1] : 0;
+
+                row[x] -= paethPredictor(a, b, c);
+            }
+        }
+    }
+}
+
+void KisAbstractCompression::revertPaethPredictor(quint8 *data, qint32 dataSize,
+                                                  qint32 width, qint32 height)
+{
+    const qint32 planeSize = width * height;
+    const qint32 numPlanes = dataSize / planeSize;
+    Q_ASSERT(numPlanes * planeSize == dataSize);
+
+    for (qint32 plane = 0; plane < numPlanes; plane++) {
+        quint8 *planeData = data + plane * planeSize;
+
+        for (qint32 y = 0; y < height; y++) {
+            quint8 *row = planeData + y * width;
+            const quint8 *prevRow = y > 0 ? row - width : 0;
+
+            for (qint32 x = 0; x < width; x++) {
+                const quint8 a = x > 0 ? row[x - 1] : 0;
+                const quint8 b = prevRow ? prevRow[x] : 0;
+                const quint8 c = prevRow && x > 0 ? prevRow[x - 1] : 0;
+
+                row[x] += paethPredictor(a, b, c);
+            }
+        }
+    }
+}
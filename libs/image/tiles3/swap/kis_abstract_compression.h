@@ -9,6 +9,7 @@
 
 #include "kritaimage_export.h"
 #include <QtGlobal>
+#include <QString>
 
 /**
  * Base class for compression operations
@@ -47,6 +48,15 @@ public:
      */
     virtual qint32 decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) = 0;
 
+    /**
+     * Returns the name of the algorithm. The name is stored in the
+     * tile headers of .kra files, so it should never be changed for
+     * an existing algorithm and must not be longer than 5 characters.
+     *
+     * \see KisCompressionRegistry
+     */
+    virtual QString name() const = 0;
+
     /**
      * Returns minimal allowed size of output buffer for compression
      */
@@ -76,6 +86,39 @@ public:
      */
     static void delinearizeColors(quint8 *input, quint8 *output,
                                   qint32 dataSize, qint32 pixelSize);
+
+    /**
+     * Predictors for the linearized data. The data is treated as a
+     * sequence of byte planes of \p width x \p height bytes each
+     * and every byte is replaced (in-place) with the difference
+     * between it and its prediction from the already-coded
+     * neighbours of the same plane. Smooth areas become runs of
+     * small repeated values, which LZ-style algorithms compress
+     * much better.
+     *
+     * Since linearizeColors() already splits every pixel into its
+     * bytes, the planes of 16-bit and floating point channels keep
+     * the high-order bytes (sign, exponent, high mantissa) apart
+     * from the noisy low-order ones, the same way the floating point
+     * predictor of TIFF does it.
+     */
+
+    /**
+     * Predicts every byte by its left neighbour
+     */
+    static void applyHorizontalPredictor(quint8 *data, qint32 dataSize,
+                                         qint32 width, qint32 height);
+    static void revertHorizontalPredictor(quint8 *data, qint32 dataSize,
+                                          qint32 width, qint32 height);
+
+    /**
+     * Predicts every byte by the Paeth predictor (as in PNG) built
+     * from its left, upper and upper-left neighbours
+     */
+    static void applyPaethPredictor(quint8 *data, qint32 dataSize,
+                                    qint32 width, qint32 height);
+    static void revertPaethPredictor(quint8 *data, qint32 dataSize,
+                                     qint32 width, qint32 height);
 };
 
 #endif /* __KIS_ABSTRACT_COMPRESSION_H */
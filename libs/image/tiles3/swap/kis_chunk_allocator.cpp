@@ -18,10 +18,11 @@
 #define WRAP_PREVIOUS_CHUNK_DATA(iter) (KisChunk((iter)-1))
 
 
-KisChunkAllocator::KisChunkAllocator(quint64 slabSize, quint64 storeSize)
+KisChunkAllocator::KisChunkAllocator(quint64 slabSize, quint64 storeSize, quint64 alignmentBoundary)
 {
     m_storeMaxSize = storeSize;
     m_storeSlabSize = slabSize;
+    m_alignmentBoundary = alignmentBoundary;
 
     m_iterator = m_list.begin();
     m_storeSize = m_storeSlabSize;
@@ -93,7 +94,23 @@ bool KisChunkAllocator::tryInsertChunk(KisChunkDataList &list,
         shift = 1;
     }
 
-    if(GAP_SIZE(lowBound, highBound) >= size) {
+    const quint64 begin = lowBound + shift;
+
+    if (m_alignmentBoundary &&
+        size <= m_alignmentBoundary &&
+        begin / m_alignmentBoundary != (begin + size - 1) / m_alignmentBoundary) {
+
+        /**
+         * The chunk would cross the boundary, so move it to the
+         * beginning of the next aligned block. The skipped bytes are
+         * not lost, smaller chunks can still be placed there later.
+         */
+        const quint64 alignedBegin = (begin / m_alignmentBoundary + 1) * m_alignmentBoundary;
+        lowBound = alignedBegin - 1;
+        shift = 1;
+    }
+
+    if(highBound > lowBound && GAP_SIZE(lowBound, highBound) >= size) {
         list.insert(iterator, KisChunkData(lowBound + shift, size));
         result = true;
     }
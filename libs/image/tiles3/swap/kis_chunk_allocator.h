@@ -116,8 +116,16 @@ private:
 class KRITAIMAGE_EXPORT KisChunkAllocator
 {
 public:
+    /**
+     * \param alignmentBoundary if non-zero, no chunk will cross a
+     * multiple of this value. It lets KisMemoryWindow map the swap
+     * file in fixed aligned windows (preferably a multiple of the
+     * huge page size), so that every chunk is guaranteed to fit into
+     * a single window.
+     */
     KisChunkAllocator(quint64 slabSize = DEFAULT_SLAB_SIZE,
-                      quint64 storeSize = DEFAULT_STORE_SIZE);
+                      quint64 storeSize = DEFAULT_STORE_SIZE,
+                      quint64 alignmentBoundary = 0);
     ~KisChunkAllocator();
 
     inline quint64 numChunks() const {
@@ -139,6 +147,7 @@ private:
 private:
     quint64 m_storeMaxSize;
     quint64 m_storeSlabSize;
+    quint64 m_alignmentBoundary;
 
 
     KisChunkDataList m_list;
@@ -0,0 +1,40 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_compression_registry.h"
+
+#include "kis_lzf_compression.h"
+#include "kis_lz4_compression.h"
+#include "kis_zlib_compression.h"
+
+
+QString KisCompressionRegistry::defaultCompression()
+{
+    return "LZF";
+}
+
+QStringList KisCompressionRegistry::compressionNames()
+{
+    return {"LZF", "LZ4", "ZLIB"};
+}
+
+bool KisCompressionRegistry::hasCompression(const QString &name)
+{
+    return compressionNames().contains(name);
+}
+
+KisAbstractCompression* KisCompressionRegistry::create(const QString &name)
+{
+    if (name == "LZF") {
+        return new KisLzfCompression();
+    } else if (name == "LZ4") {
+        return new KisLz4Compression();
+    } else if (name == "ZLIB") {
+        return new KisZlibCompression();
+    }
+
+    return 0;
+}
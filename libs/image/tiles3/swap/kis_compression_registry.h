@@ -0,0 +1,47 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_COMPRESSION_REGISTRY_H
+#define __KIS_COMPRESSION_REGISTRY_H
+
+#include "kritaimage_export.h"
+#include <QStringList>
+
+class KisAbstractCompression;
+
+/**
+ * Creates compression algorithms by the name they put into the tile
+ * headers. Every algorithm ever written into a .kra file must stay
+ * registered here, otherwise the files will not load anymore.
+ */
+class KRITAIMAGE_EXPORT KisCompressionRegistry
+{
+public:
+    /**
+     * The algorithm used when nothing else is requested. It is the
+     * only one supported by older versions of Krita.
+     */
+    static QString defaultCompression();
+
+    /**
+     * Returns the names of all the available algorithms
+     */
+    static QStringList compressionNames();
+
+    static bool hasCompression(const QString &name);
+
+    /**
+     * Creates a new instance of the algorithm \p name. The caller
+     * takes ownership of the object. Returns null if the algorithm
+     * is not known.
+     */
+    static KisAbstractCompression* create(const QString &name);
+
+private:
+    KisCompressionRegistry();
+};
+
+#endif /* __KIS_COMPRESSION_REGISTRY_H */
@@ -0,0 +1,235 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_lz4_compression.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+#define HASH_LOG  12
+#define HASH_SIZE (1 << HASH_LOG)
+
+#define MIN_MATCH      4
+#define LAST_LITERALS  5
+#define MF_LIMIT      12
+#define MAX_DISTANCE  65535
+#define RUN_MASK      15
+
+
+namespace {
+
+inline quint32 readU32(const quint8 *ptr)
+{
+    quint32 value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+inline quint32 hashSequence(quint32 sequence)
+{
+    return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+inline quint8* writeLengthTail(quint8 *op, qint32 length)
+{
+    for (; length >= 255; length -= 255) {
+        *op++ = 255;
+    }
+    *op++ = length;
+    return op;
+}
+
+inline bool readLengthTail(const quint8 *&ip, const quint8 *ipLimit, quint32 &length)
+{
+    quint32 value;
+    do {
+        if (ip >= ipLimit) return false;
+        value = *ip++;
+        length += value;
+    } while (value == 255);
+
+    return true;
+}
+
+}
+
+int lz4_compress(const quint8* input, int length, quint8* output)
+{
+    const quint8* ip = input;
+    const quint8* anchor = input;
+    const quint8* const ipEnd = input + length;
+    /* too short inputs are stored as a single literal run */
+    const bool canMatch = length > MF_LIMIT;
+    const quint8* const mfLimit = canMatch ? ipEnd - MF_LIMIT : input;
+    const quint8* const matchLimit = canMatch ? ipEnd - LAST_LITERALS : input;
+    quint8* op = output;
+
+    qint32 htab[HASH_SIZE];
+    std::fill(htab, htab + HASH_SIZE, -1);
+
+    while (ip < mfLimit) {
+        const quint32 sequence = readU32(ip);
+        const quint32 hash = hashSequence(sequence);
+        const qint32 refPos = htab[hash];
+        htab[hash] = ip - input;
+
+        if (refPos < 0 ||
+            ip - (input + refPos) > MAX_DISTANCE ||
+            readU32(input + refPos) != sequence) {
+
+            ip++;
+            continue;
+        }
+
+        const quint8* ref = input + refPos;
+
+        /* extend the match backwards, eating the pending literals */
+        while (ip > anchor && ref > input && ip[-1] == ref[-1]) {
+            ip--;
+            ref--;
+        }
+
+        /* ... and forwards */
+        const quint8* matchEnd = ip + MIN_MATCH;
+        const quint8* refEnd = ref + MIN_MATCH;
+        while (matchEnd < matchLimit && *matchEnd == *refEnd) {
+            matchEnd++;
+            refEnd++;
+        }
+
+        const qint32 literalLength = ip - anchor;
+        const qint32 matchLength = matchEnd - ip - MIN_MATCH;
+        const qint32 distance = ip - ref;
+
+        quint8* token = op++;
+        *token = qMin(literalLength, RUN_MASK) << 4;
+        if (literalLength >= RUN_MASK) {
+            op = writeLengthTail(op, literalLength - RUN_MASK);
+        }
+
+        memcpy(op, anchor, literalLength);
+        op += literalLength;
+
+        *op++ = distance & 0xff;
+        *op++ = distance >> 8;
+
+        *token |= qMin(matchLength, RUN_MASK);
+        if (matchLength >= RUN_MASK) {
+            op = writeLengthTail(op, matchLength - RUN_MASK);
+        }
+
+        ip = matchEnd;
+        anchor = ip;
+    }
+
+    /* left-over as literal copy */
+    const qint32 literalLength = ipEnd - anchor;
+
+    *op++ = qMin(literalLength, RUN_MASK) << 4;
+    if (literalLength >= RUN_MASK) {
+        op = writeLengthTail(op, literalLength - RUN_MASK);
+    }
+
+    memcpy(op, anchor, literalLength);
+    op += literalLength;
+
+    return op - output;
+}
+
+int lz4_decompress(const quint8* input, int length, quint8* output, int maxout)
+{
+    const quint8* ip = input;
+    const quint8* const ipEnd = input + length;
+    quint8* op = output;
+    quint8* const opEnd = output + maxout;
+
+    while (ip < ipEnd) {
+        const quint32 token = *ip++;
+
+        quint32 literalLength = token >> 4;
+        if (literalLength == RUN_MASK &&
+            !readLengthTail(ip, ipEnd, literalLength)) {
+
+            return 0;
+        }
+
+        if (literalLength > quint32(ipEnd - ip) ||
+            literalLength > quint32(opEnd - op)) {
+
+            return 0;
+        }
+
+        memcpy(op, ip, literalLength);
+        op += literalLength;
+        ip += literalLength;
+
+        /* the last sequence has no match part */
+        if (ip >= ipEnd) break;
+
+        if (ipEnd - ip < 2) return 0;
+
+        const quint32 distance = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        if (distance == 0 || distance > quint32(op - output)) return 0;
+
+        quint32 matchLength = token & RUN_MASK;
+        if (matchLength == RUN_MASK &&
+            !readLengthTail(ip, ipEnd, matchLength)) {
+
+            return 0;
+        }
+        matchLength += MIN_MATCH;
+
+        if (matchLength > quint32(opEnd - op)) return 0;
+
+        const quint8* ref = op - distance;
+
+        if (distance >= matchLength) {
+            memcpy(op, ref, matchLength);
+            op += matchLength;
+        } else {
+            /* overlapping copy, used for runs of repeated pixels */
+            for (; matchLength; --matchLength) {
+                *op++ = *ref++;
+            }
+        }
+    }
+
+    return op - output;
+}
+
+
+KisLz4Compression::KisLz4Compression()
+{
+}
+
+KisLz4Compression::~KisLz4Compression()
+{
+}
+
+qint32 KisLz4Compression::compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    Q_UNUSED(outputLength);
+    return lz4_compress(input, inputLength, output);
+}
+
+qint32 KisLz4Compression::decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    return lz4_decompress(input, inputLength, output, outputLength);
+}
+
+QString KisLz4Compression::name() const
+{
+    return "LZ4";
+}
+
+qint32 KisLz4Compression::outputBufferSize(qint32 dataSize)
+{
+    // The worst case of the LZ4 block format
+    return dataSize + dataSize / 255 + 16;
+}
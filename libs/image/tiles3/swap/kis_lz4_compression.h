@@ -0,0 +1,33 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_LZ4_COMPRESSION_H
+#define __KIS_LZ4_COMPRESSION_H
+
+#include "kis_abstract_compression.h"
+
+/**
+ * A self-contained implementation of the LZ4 block format. It
+ * compresses slightly worse than LZF, but decompression is much
+ * cheaper, since matches and literals are copied in whole runs
+ * instead of byte-by-byte. That makes it the preferred codec for
+ * the swap file, where tiles are swapped in much more often than
+ * they are swapped out.
+ */
+class KRITAIMAGE_EXPORT KisLz4Compression : public KisAbstractCompression
+{
+public:
+    KisLz4Compression();
+    ~KisLz4Compression() override;
+
+    qint32 compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+    qint32 decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+
+    QString name() const override;
+    qint32 outputBufferSize(qint32 dataSize) override;
+};
+
+#endif /* __KIS_LZ4_COMPRESSION_H */
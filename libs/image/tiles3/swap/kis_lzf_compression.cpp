@@ -260,6 +260,11 @@ qint32 KisLzfCompression::decompress(const quint8* input, qint32 inputLength, qu
     return lzff_decompress(input, inputLength, output, outputLength);
 }
 
+QString KisLzfCompression::name() const
+{
+    return "LZF";
+}
+
 qint32 KisLzfCompression::outputBufferSize(qint32 dataSize)
 {
     // WARNING: Copy-pasted from LZO samples, do not know how to prove it
@@ -18,6 +18,7 @@ public:
     qint32 compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
     qint32 decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
 
+    QString name() const override;
     qint32 outputBufferSize(qint32 dataSize) override;
 
     //void adjustForDataSize(qint32 dataSize);
@@ -9,11 +9,16 @@
 
 #include <QDir>
 
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #define SWP_PREFIX "KRITA_SWAP_FILE_XXXXXX"
 
-KisMemoryWindow::KisMemoryWindow(const QString &swapDir, quint64 writeWindowSize)
-    : m_readWindowEx(writeWindowSize / 4),
-      m_writeWindowEx(writeWindowSize)
+KisMemoryWindow::KisMemoryWindow(const QString &swapDir, quint64 writeWindowSize, int maxMappedWindows)
+    : m_windowSize(writeWindowSize),
+      m_maxMappedWindows(qMax(2, maxMappedWindows))
 {
     m_valid = true;
 
@@ -45,94 +50,139 @@ KisMemoryWindow::KisMemoryWindow(const QString &swapDir, quint64 writeWindowSize
 
 KisMemoryWindow::~KisMemoryWindow()
 {
+    unmapAll();
+}
+
+int KisMemoryWindow::numMappedWindows() const
+{
+    return m_windows.size();
 }
 
 quint8* KisMemoryWindow::getReadChunkPtr(const KisChunkData &readChunk)
 {
-    if (!adjustWindow(readChunk, &m_readWindowEx, &m_writeWindowEx)) {
+    MappingWindow *window = findWindow(readChunk);
+    if (!window) {
         return nullptr;
     }
 
-    return m_readWindowEx.calculatePointer(readChunk);
+    adviseReadAhead(*window, readChunk);
+
+    return window->calculatePointer(readChunk);
 }
 
 quint8* KisMemoryWindow::getWriteChunkPtr(const KisChunkData &writeChunk)
 {
-    if (!adjustWindow(writeChunk, &m_writeWindowEx, &m_readWindowEx)) {
+    MappingWindow *window = findWindow(writeChunk);
+    if (!window) {
         return nullptr;
     }
 
-    return m_writeWindowEx.calculatePointer(writeChunk);
+    return window->calculatePointer(writeChunk);
 }
 
-bool KisMemoryWindow::adjustWindow(const KisChunkData &requestedChunk,
-                                   MappingWindow *adjustingWindow,
-                                   MappingWindow *otherWindow)
+KisMemoryWindow::MappingWindow* KisMemoryWindow::findWindow(const KisChunkData &requestedChunk)
 {
-    if(!(adjustingWindow->window) ||
-       !(requestedChunk.m_begin >= adjustingWindow->chunk.m_begin &&
-         requestedChunk.m_end <= adjustingWindow->chunk.m_end))
-    {
-        m_file.unmap(adjustingWindow->window);
-
-        quint64 windowSize = adjustingWindow->defaultSize;
-        if(requestedChunk.size() > windowSize) {
-            warnKrita <<
-                "KisMemoryWindow: the requested chunk is too "
-                "big to fit into the mapping! "
-                "Adjusting mapping to avoid SIGSEGV...";
-
-            windowSize = requestedChunk.size();
+    for (auto it = m_windows.begin(); it != m_windows.end(); ++it) {
+        if (it->contains(requestedChunk)) {
+            if (it != m_windows.begin()) {
+                m_windows.prepend(*it);
+                m_windows.erase(it);
+            }
+            return &m_windows.first();
         }
+    }
 
-        adjustingWindow->chunk.setChunk(requestedChunk.m_begin, windowSize);
+    /**
+     * Try to map the aligned region the chunk belongs to, so that
+     * the neighbouring chunks could reuse the mapping
+     */
+    const quint64 regionBegin = requestedChunk.m_begin - requestedChunk.m_begin % m_windowSize;
+    KisChunkData region(regionBegin, m_windowSize);
 
-        if(adjustingWindow->chunk.m_end >= (quint64)m_file.size()) {
-            // Align by 32 bytes
-            quint64 newSize = (adjustingWindow->chunk.m_end + 1 + 32) & (~31ULL);
+    if (!(requestedChunk.m_end <= region.m_end)) {
+        warnKrita <<
+            "KisMemoryWindow: the requested chunk crosses the "
+            "window boundary! Mapping it separately to avoid SIGSEGV...";
 
-#ifdef Q_OS_WIN32
-            /**
-             * Workaround for Qt's "feature"
-             *
-             * On windows QFSEnginePrivate caches the value of
-             * mapHandle which is limited to the size of the file at
-             * the moment of its (handle's) creation. That is we will
-             * not be able to use it after resizing the file.  The
-             * only way to free the handle is to release all the
-             * mappings we have. Sad but true.
-             */
-            if (otherWindow->chunk.size()) {
-                m_file.unmap(otherWindow->window);
-            }
-#else
-            Q_UNUSED(otherWindow);
+        region = requestedChunk;
+    }
+
+    while (m_windows.size() >= m_maxMappedWindows) {
+        m_file.unmap(m_windows.last().window);
+        m_windows.removeLast();
+    }
+
+    if (!ensureFileSize(region.m_end + 1)) {
+        return nullptr;
+    }
+
+#ifdef Q_OS_UNIX
+    // A workaround for https://bugreports.qt-project.org/browse/QTBUG-6330
+    m_file.exists();
 #endif
 
-            if (!m_file.resize(newSize)) {
-                return false;
-            }
+    quint8 *ptr = m_file.map(region.m_begin, region.size());
+    if (!ptr) {
+        return nullptr;
+    }
+
+    m_windows.prepend(MappingWindow(region, ptr));
+    return &m_windows.first();
+}
+
+bool KisMemoryWindow::ensureFileSize(quint64 size)
+{
+    if (size <= (quint64)m_file.size()) {
+        return true;
+    }
+
+    // Align by 32 bytes
+    quint64 newSize = (size + 32) & (~31ULL);
 
 #ifdef Q_OS_WIN32
-            if (otherWindow->chunk.size()) {
-                otherWindow->window = m_file.map(otherWindow->chunk.m_begin,
-                                                 otherWindow->chunk.size());
-            }
+    /**
+     * Workaround for Qt's "feature"
+     *
+     * On windows QFSEnginePrivate caches the value of
+     * mapHandle which is limited to the size of the file at
+     * the moment of its (handle's) creation. That is we will
+     * not be able to use it after resizing the file.  The
+     * only way to free the handle is to release all the
+     * mappings we have. Sad but true.
+     */
+    unmapAll();
 #endif
-        }
 
+    return m_file.resize(newSize);
+}
+
+void KisMemoryWindow::unmapAll()
+{
+    Q_FOREACH (const MappingWindow &window, m_windows) {
+        m_file.unmap(window.window);
+    }
+    m_windows.clear();
+}
+
+void KisMemoryWindow::adviseReadAhead(const MappingWindow &window, const KisChunkData &readChunk)
+{
 #ifdef Q_OS_UNIX
-        // A workaround for https://bugreports.qt-project.org/browse/QTBUG-6330
-        m_file.exists();
-#endif
+    /**
+     * Tiles that were swapped out together are usually stored next
+     * to each other and are swapped in together as well, so ask the
+     * kernel to start fetching the following part of the window
+     */
+    static const quintptr pageSize = sysconf(_SC_PAGESIZE);
 
-        adjustingWindow->window = m_file.map(adjustingWindow->chunk.m_begin,
-                                             adjustingWindow->chunk.size());
+    const quint64 readAheadEnd = qMin(readChunk.m_end + DEFAULT_READAHEAD_SIZE, window.chunk.m_end);
+    if (readAheadEnd <= readChunk.m_end) return;
 
-        if (!adjustingWindow->window) {
-            return false;
-        }
-    }
+    const quintptr start = quintptr(window.calculatePointer(readChunk)) & ~(pageSize - 1);
+    const quintptr end = quintptr(window.window + readAheadEnd - window.chunk.m_begin);
 
-	return true;
+    posix_madvise(reinterpret_cast<void*>(start), end - start, POSIX_MADV_WILLNEED);
+#else
+    Q_UNUSED(window);
+    Q_UNUSED(readChunk);
+#endif
 }
@@ -8,20 +8,41 @@
 #define __KIS_MEMORY_WINDOW_H
 
 #include <QTemporaryFile>
+#include <QLinkedList>
 
 #include "kis_chunk_allocator.h"
 
 
 #define DEFAULT_WINDOW_SIZE (16*MiB)
+#define DEFAULT_MAPPED_WINDOWS 8
+#define DEFAULT_READAHEAD_SIZE (256 * 1024)
 
+/**
+ * Maps the swap file into memory in a set of windows.
+ *
+ * The file is split into regions of windowSize bytes aligned to
+ * the window size. Up to \p maxMappedWindows regions are kept
+ * mapped at the same time and are recycled in LRU order, so that
+ * reading and writing different parts of the swap file doesn't
+ * cause a remap on every access. The chunk allocator is expected to
+ * avoid chunks crossing the region boundaries (see
+ * KisChunkAllocator's alignment boundary); a chunk that still does
+ * so gets a separate mapping of its own.
+ *
+ * The pointer returned by getReadChunkPtr()/getWriteChunkPtr() is
+ * valid only till the next call to any of them.
+ */
 class KRITAIMAGE_EXPORT KisMemoryWindow
 {
 public:
     /**
      * @param swapDir If the dir doesn't exist, it'll be created, if it's empty QDir::tempPath will be used.
-     * @param writeWindowSize write window size.
+     * @param writeWindowSize the size of a single mapped window.
+     * @param maxMappedWindows the maximum number of windows mapped at the same time.
      */
-    KisMemoryWindow(const QString &swapDir, quint64 writeWindowSize = DEFAULT_WINDOW_SIZE);
+    KisMemoryWindow(const QString &swapDir,
+                    quint64 writeWindowSize = DEFAULT_WINDOW_SIZE,
+                    int maxMappedWindows = DEFAULT_MAPPED_WINDOWS);
     ~KisMemoryWindow();
 
     inline quint8* getReadChunkPtr(KisChunk readChunk) {
@@ -35,37 +56,51 @@ public:
     quint8* getReadChunkPtr(const KisChunkData &readChunk);
     quint8* getWriteChunkPtr(const KisChunkData &writeChunk);
 
+    /**
+     * The number of the windows that are currently mapped.
+     * Used for testing only.
+     */
+    int numMappedWindows() const;
+
 private:
     struct MappingWindow {
-        MappingWindow(quint64 _defaultSize)
-            : chunk(0,0),
-              window(0),
-              defaultSize(_defaultSize)
+        MappingWindow(const KisChunkData &_chunk, quint8 *_window)
+            : chunk(_chunk),
+              window(_window)
         {
         }
 
+        bool contains(const KisChunkData &other) const {
+            return other.m_begin >= chunk.m_begin && other.m_end <= chunk.m_end;
+        }
+
         quint8* calculatePointer(const KisChunkData &other) const {
             return window + other.m_begin - chunk.m_begin;
         }
 
         KisChunkData chunk;
         quint8 *window;
-        const quint64 defaultSize;
     };
 
+    typedef QLinkedList<MappingWindow> MappingWindowList;
 
 private:
-    bool adjustWindow(const KisChunkData &requestedChunk,
-                      MappingWindow *adjustingWindow,
-                      MappingWindow *otherWindow);
+    MappingWindow* findWindow(const KisChunkData &requestedChunk);
+    bool ensureFileSize(quint64 size);
+    void unmapAll();
+    void adviseReadAhead(const MappingWindow &window, const KisChunkData &readChunk);
 
 private:
     QTemporaryFile m_file;
 
     bool m_valid;
-    MappingWindow m_readWindowEx;
-    MappingWindow m_writeWindowEx;
+    const quint64 m_windowSize;
+    const int m_maxMappedWindows;
+
+    /**
+     * The most recently used window is kept at the front
+     */
+    MappingWindowList m_windows;
 };
 
 #endif /* __KIS_MEMORY_WINDOW_H */
-
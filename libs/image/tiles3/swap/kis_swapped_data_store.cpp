@@ -21,11 +21,16 @@ KisSwappedDataStore::KisSwappedDataStore()
     const quint64 swapSlabSize = config.swapSlabSize() * MiB;
     const quint64 swapWindowSize = config.swapWindowSize() * MiB;
 
-    m_allocator = new KisChunkAllocator(swapSlabSize, maxSwapSize);
-    m_swapSpace = new KisMemoryWindow(config.swapDir(), swapWindowSize);
+    /**
+     * The chunks never cross the window boundaries, so every tile
+     * can be accessed through one of the aligned mapped windows
+     */
+    m_allocator = new KisChunkAllocator(swapSlabSize, maxSwapSize, swapWindowSize);
+    m_swapSpace = new KisMemoryWindow(config.swapDir(), swapWindowSize, config.swapMappedWindows());
 
     // FIXME: use a factory after the patch is committed
-    m_compressor = new KisTileCompressor2();
+    m_compressor = new KisTileCompressor2(config.swapCompression(),
+                                          KisTileCompressor2::Predictor(config.swapTilePredictor()));
 }
 
 KisSwappedDataStore::~KisSwappedDataStore()
@@ -5,24 +5,39 @@
  */
 
 #include "kis_tile_compressor_2.h"
-#include "kis_lzf_compression.h"
+#include "kis_compression_registry.h"
+#include "kis_abstract_compression.h"
 #include <QIODevice>
 #include "kis_paint_device_writer.h"
+#include "kis_assert.h"
 #define TILE_DATA_SIZE(pixelSize) ((pixelSize) * KisTileData::WIDTH * KisTileData::HEIGHT)
 
-const QString KisTileCompressor2::m_compressionName = "LZF";
 
-
-KisTileCompressor2::KisTileCompressor2()
+KisTileCompressor2::KisTileCompressor2(const QString &compressionName, Predictor predictor)
+    : m_predictor(predictor)
 {
-    m_compression = new KisLzfCompression();
+    m_compression = KisCompressionRegistry::create(compressionName);
+
+    if (!m_compression) {
+        if (!compressionName.isEmpty()) {
+            warnTiles << "Unknown tile compression" << compressionName
+                      << "falling back to" << KisCompressionRegistry::defaultCompression();
+        }
+        m_compression = KisCompressionRegistry::create(KisCompressionRegistry::defaultCompression());
+    }
 }
 
 KisTileCompressor2::~KisTileCompressor2()
 {
+    qDeleteAll(m_decompressors);
     delete m_compression;
 }
 
+QString KisTileCompressor2::compressionName() const
+{
+    return m_compression->name();
+}
+
 bool KisTileCompressor2::writeTile(KisTileSP tile, KisPaintDeviceWriter &store)
 {
     const qint32 tileDataSize = TILE_DATA_SIZE(tile->pixelSize());
@@ -49,9 +64,25 @@ bool KisTileCompressor2::writeTile(KisTileSP tile, KisPaintDeviceWriter &store)
 }
 
 bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
+{
+    KisTileSP tile;
+    QString compressionName;
+
+    if (!readTileRecord(stream, dm, tile, m_streamingBuffer, compressionName)) {
+        return false;
+    }
+
+    tile->lockForWrite();
+    bool res = decompressTileRecord(tile, m_streamingBuffer, compressionName);
+    tile->unlockForWrite();
+    return res;
+}
+
+bool KisTileCompressor2::readTileRecord(QIODevice *stream, KisTiledDataManager *dm,
+                                        KisTileSP &tile, QByteArray &buffer,
+                                        QString &compressionName)
 {
     const qint32 tileDataSize = TILE_DATA_SIZE(pixelSize(dm));
-    prepareStreamingBuffer(tileDataSize);
 
     QByteArray header = stream->readLine(maxHeaderLength());
 
@@ -59,27 +90,66 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
     if (headerItems.size() == 4) {
         qint32 x = headerItems.takeFirst().toInt();
         qint32 y = headerItems.takeFirst().toInt();
-        QString compressionName = headerItems.takeFirst();
+        compressionName = headerItems.takeFirst();
         qint32 dataSize = headerItems.takeFirst().toInt();
 
         Q_ASSERT(headerItems.isEmpty());
-        Q_ASSERT(compressionName == m_compressionName);
+
+        if (!KisCompressionRegistry::hasCompression(compressionName)) {
+            warnFile << "Unknown tile compression:" << compressionName;
+            return false;
+        }
+
+        if (dataSize <= 0 || dataSize > tileDataSize + 1) {
+            warnFile << "Invalid size of the tile data:" << dataSize;
+            return false;
+        }
 
         qint32 row = yToRow(dm, y);
         qint32 col = xToCol(dm, x);
 
-        KisTileSP tile = dm->getTile(col, row, true);
-
-        stream->read(m_streamingBuffer.data(), dataSize);
+        tile = dm->getTile(col, row, true);
 
-        tile->lockForWrite();
-        bool res = decompressTileData((quint8*)m_streamingBuffer.data(), dataSize, tile->tileData());
-        tile->unlockForWrite();
-        return res;
+        buffer.resize(dataSize);
+        return stream->read(buffer.data(), dataSize) == dataSize;
     }
     return false;
 }
 
+bool KisTileCompressor2::decompressTileRecord(KisTileSP tile, QByteArray &buffer,
+                                              const QString &compressionName)
+{
+    const qint32 tileDataSize = TILE_DATA_SIZE(tile->pixelSize());
+
+    if (buffer[0] == RAW_DATA_FLAG && buffer.size() != tileDataSize + 1) {
+        warnFile << "Raw tile data has unexpected size:" << buffer.size();
+        return false;
+    }
+
+    KisAbstractCompression *compression = compressionForName(compressionName);
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(compression, false);
+
+    return decompressTileDataImpl(compression, (quint8*)buffer.data(),
+                                  buffer.size(), tile->tileData());
+}
+
+KisAbstractCompression* KisTileCompressor2::compressionForName(const QString &name)
+{
+    if (name == m_compression->name()) {
+        return m_compression;
+    }
+
+    KisAbstractCompression *compression = m_decompressors.value(name, 0);
+    if (!compression) {
+        compression = KisCompressionRegistry::create(name);
+        if (compression) {
+            m_decompressors.insert(name, compression);
+        }
+    }
+
+    return compression;
+}
+
 void KisTileCompressor2::prepareStreamingBuffer(qint32 tileDataSize)
 {
     /**
@@ -119,11 +189,23 @@ void KisTileCompressor2::compressTileData(KisTileData *tileData,
     KisAbstractCompression::linearizeColors(tileData->data(), (quint8*)m_linearizationBuffer.data(),
                                             tileDataSize, pixelSize);
 
+    qint8 compressedFlag = COMPRESSED_DATA_FLAG;
+
+    if (m_predictor == HorizontalPredictor) {
+        KisAbstractCompression::applyHorizontalPredictor((quint8*)m_linearizationBuffer.data(), tileDataSize,
+                                                         KisTileData::WIDTH, KisTileData::HEIGHT);
+        compressedFlag = COMPRESSED_HORIZONTAL_DELTA_FLAG;
+    } else if (m_predictor == PaethPredictor) {
+        KisAbstractCompression::applyPaethPredictor((quint8*)m_linearizationBuffer.data(), tileDataSize,
+                                                    KisTileData::WIDTH, KisTileData::HEIGHT);
+        compressedFlag = COMPRESSED_PAETH_DELTA_FLAG;
+    }
+
     compressedBytes = m_compression->compress((quint8*)m_linearizationBuffer.data(), tileDataSize,
                                               (quint8*)m_compressionBuffer.data(), m_compressionBuffer.size());
 
-    if(compressedBytes < tileDataSize) {
-        buffer[0] = COMPRESSED_DATA_FLAG;
+    if(compressedBytes > 0 && compressedBytes < tileDataSize) {
+        buffer[0] = compressedFlag;
         memcpy(buffer + 1, m_compressionBuffer.data(), compressedBytes);
         bytesWritten = compressedBytes + 1;
     }
@@ -137,17 +219,38 @@ void KisTileCompressor2::compressTileData(KisTileData *tileData,
 bool KisTileCompressor2::decompressTileData(quint8 *buffer,
                                             qint32 bufferSize,
                                             KisTileData *tileData)
+{
+    return decompressTileDataImpl(m_compression, buffer, bufferSize, tileData);
+}
+
+bool KisTileCompressor2::decompressTileDataImpl(KisAbstractCompression *compression,
+                                                quint8 *buffer,
+                                                qint32 bufferSize,
+                                                KisTileData *tileData)
 {
     const qint32 pixelSize = tileData->pixelSize();
     const qint32 tileDataSize = TILE_DATA_SIZE(pixelSize);
 
-    if(buffer[0] == COMPRESSED_DATA_FLAG) {
+    const qint8 flag = buffer[0];
+
+    if(flag == COMPRESSED_DATA_FLAG ||
+       flag == COMPRESSED_HORIZONTAL_DELTA_FLAG ||
+       flag == COMPRESSED_PAETH_DELTA_FLAG) {
+
         prepareWorkBuffers(tileDataSize);
 
         qint32 bytesWritten;
-        bytesWritten = m_compression->decompress(buffer + 1, bufferSize - 1,
+        bytesWritten = compression->decompress(buffer + 1, bufferSize - 1,
                                                  (quint8*)m_linearizationBuffer.data(), tileDataSize);
         if (bytesWritten == tileDataSize) {
+            if (flag == COMPRESSED_HORIZONTAL_DELTA_FLAG) {
+                KisAbstractCompression::revertHorizontalPredictor((quint8*)m_linearizationBuffer.data(), tileDataSize,
+                                                                  KisTileData::WIDTH, KisTileData::HEIGHT);
+            } else if (flag == COMPRESSED_PAETH_DELTA_FLAG) {
+                KisAbstractCompression::revertPaethPredictor((quint8*)m_linearizationBuffer.data(), tileDataSize,
+                                                             KisTileData::WIDTH, KisTileData::HEIGHT);
+            }
+
             KisAbstractCompression::delinearizeColors((quint8*)m_linearizationBuffer.data(),
                                                       tileData->data(),
                                                       tileDataSize, pixelSize);
@@ -155,10 +258,12 @@ bool KisTileCompressor2::decompressTileData(quint8 *buffer,
         }
         return false;
     }
-    else {
+    else if (flag == RAW_DATA_FLAG) {
         memcpy(tileData->data(), buffer + 1, tileDataSize);
         return true;
     }
+
+    warnTiles << "Unknown tile data flag:" << flag;
     return false;
 
 }
@@ -184,5 +289,5 @@ inline QString KisTileCompressor2::getHeader(KisTileSP tile,
     qint32 width, height;
     tile->extent().getRect(&x, &y, &width, &height);
 
-    return QString("%1,%2,%3,%4\n").arg(x).arg(y).arg(m_compressionName).arg(compressedSize);
+    return QString("%1,%2,%3,%4\n").arg(x).arg(y).arg(m_compression->name()).arg(compressedSize);
 }
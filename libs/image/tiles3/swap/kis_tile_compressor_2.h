@@ -8,18 +8,66 @@
 #define __KIS_TILE_COMPRESSOR_2_H
 
 #include "kis_abstract_tile_compressor.h"
+#include <QHash>
 
 class KisAbstractCompression;
 
 class KRITAIMAGE_EXPORT KisTileCompressor2 : public KisAbstractTileCompressor
 {
 public:
-    KisTileCompressor2();
+    /**
+     * The prediction filter applied to the linearized tile data
+     * before compression, see KisAbstractCompression. The filter
+     * used for every tile is stored in its data flag, so the reader
+     * doesn't need to know which one the writer used.
+     *
+     * NOTE: tiles written with a predictor cannot be read by the
+     *       versions of Krita that didn't know about them
+     */
+    enum Predictor {
+        NoPredictor = 0,
+        HorizontalPredictor,
+        PaethPredictor
+    };
+
+    /**
+     * Creates a compressor that writes tiles using the algorithm
+     * \p compressionName (see KisCompressionRegistry). When reading,
+     * the algorithm stored in the header of every tile is used,
+     * so the files written with any registered algorithm can be
+     * loaded.
+     */
+    KisTileCompressor2(const QString &compressionName = QString(),
+                       Predictor predictor = NoPredictor);
     ~KisTileCompressor2() override;
 
+    QString compressionName() const;
+
     bool writeTile(KisTileSP tile, KisPaintDeviceWriter &store) override;
     bool readTile(QIODevice *io, KisTiledDataManager *dm) override;
 
+    /**
+     * Reads the header and the compressed payload of the next tile
+     * in \p stream, but does not decompress it. The tile the record
+     * belongs to is fetched (or created) in \p dm and returned in
+     * \p tile, the payload is stored in \p buffer.
+     *
+     * Together with decompressTileRecord() it splits readTile() into
+     * a sequential I/O part and a CPU-bound part that can be run in
+     * a worker thread. The algorithm the payload was compressed with
+     * is returned in \p compressionName.
+     */
+    bool readTileRecord(QIODevice *stream, KisTiledDataManager *dm,
+                        KisTileSP &tile, QByteArray &buffer,
+                        QString &compressionName);
+
+    /**
+     * Decompresses a payload read by readTileRecord() into the tile
+     * data of \p tile. The tile must already be locked for writing
+     * by the caller.
+     */
+    bool decompressTileRecord(KisTileSP tile, QByteArray &buffer,
+                              const QString &compressionName);
 
     void compressTileData(KisTileData *tileData,quint8 *buffer,
                           qint32 bufferSize, qint32 &bytesWritten) override;
@@ -34,19 +82,27 @@ private:
 
     QString getHeader(KisTileSP tile, qint32 compressedSize);
 
+    KisAbstractCompression* compressionForName(const QString &name);
+    bool decompressTileDataImpl(KisAbstractCompression *compression,
+                                quint8 *buffer, qint32 bufferSize,
+                                KisTileData *tileData);
+
     void prepareWorkBuffers(qint32 tileDataSize);
     void prepareStreamingBuffer(qint32 tileDataSize);
 
 private:
     static const qint8 RAW_DATA_FLAG = 0;
     static const qint8 COMPRESSED_DATA_FLAG = 1;
+    static const qint8 COMPRESSED_HORIZONTAL_DELTA_FLAG = 2;
+    static const qint8 COMPRESSED_PAETH_DELTA_FLAG = 3;
 
 private:
     QByteArray m_linearizationBuffer;
     QByteArray m_compressionBuffer;
     QByteArray m_streamingBuffer;
     KisAbstractCompression *m_compression;
-    static const QString m_compressionName;
+    QHash<QString, KisAbstractCompression*> m_decompressors;
+    Predictor m_predictor;
 };
 
 #endif /* __KIS_TILE_COMPRESSOR_2_H */
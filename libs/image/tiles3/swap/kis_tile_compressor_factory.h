@@ -13,13 +13,22 @@
 class KRITAIMAGE_EXPORT KisTileCompressorFactory
 {
 public:
-    static KisAbstractTileCompressorSP create(qint32 version) {
+    /**
+     * Creates a compressor for the tiles of \p version. The
+     * \p compressionName and \p predictor are used for writing by
+     * the compressors that support them.
+     */
+    static KisAbstractTileCompressorSP create(qint32 version,
+                                              const QString &compressionName = QString(),
+                                              KisTileCompressor2::Predictor predictor = KisTileCompressor2::NoPredictor) {
         switch(version) {
         case 1:
+            Q_UNUSED(compressionName);
+            Q_UNUSED(predictor);
             return KisAbstractTileCompressorSP(new KisLegacyTileCompressor());
             break;
         case 2:
-            return KisAbstractTileCompressorSP(new KisTileCompressor2());
+            return KisAbstractTileCompressorSP(new KisTileCompressor2(compressionName, predictor));
             break;
         default:
             qFatal("Unknown version of the tiles");
@@ -5,6 +5,9 @@
  */
 
 #include <QSemaphore>
+#include <QVector>
+#include <algorithm>
+#include <utility>
 
 #include "tiles3/swap/kis_tile_data_swapper.h"
 #include "tiles3/swap/kis_tile_data_swapper_p.h"
@@ -40,6 +43,9 @@ public:
     KisTileDataStore *store;
     KisStoreLimits limits;
     QMutex cycleLock;
+
+    QMutex prefetchLock;
+    QVector<KisTileData*> prefetchQueue;
 };
 
 KisTileDataSwapper::KisTileDataSwapper(KisTileDataStore *store)
@@ -79,12 +85,55 @@ void KisTileDataSwapper::run()
     while (1) {
         waitForWork();
 
-        if (m_d->shouldExitFlag)
+        if (m_d->shouldExitFlag) {
+            processPrefetchQueue();
             return;
+        }
 
         QThread::msleep(DELAY);
 
         doJob();
+        processPrefetchQueue();
+    }
+}
+
+void KisTileDataSwapper::prefetch(KisTileData *td)
+{
+    td->ref();
+
+    QMutexLocker locker(&m_d->prefetchLock);
+    const bool needsKick = m_d->prefetchQueue.isEmpty();
+    m_d->prefetchQueue.append(td);
+
+    if (needsKick) {
+        kick();
+    }
+}
+
+void KisTileDataSwapper::processPrefetchQueue()
+{
+    QVector<KisTileData*> queue;
+
+    {
+        QMutexLocker locker(&m_d->prefetchLock);
+        std::swap(queue, m_d->prefetchQueue);
+    }
+
+    Q_FOREACH (KisTileData *td, queue) {
+        /**
+         * Don't fight with the swapping pass: when we are close to the
+         * hard limit, loading more tiles would only push out the ones
+         * the user is painting on right now.
+         */
+        if (!m_d->shouldExitFlag &&
+            !td->data() &&
+            m_d->store->memoryMetric() + td->pixelSize() < m_d->limits.hardLimit()) {
+
+            m_d->store->ensureTileDataLoaded(td);
+            td->unblockSwapping();
+        }
+
+        td->deref();
     }
 }
 
@@ -95,6 +144,11 @@ void KisTileDataSwapper::checkFreeMemory()
         doJob();
 }
 
+bool KisTileDataSwapper::isAboveHardLimit()
+{
+    return m_d->store->memoryMetric() > m_d->limits.hardLimit();
+}
+
 void KisTileDataSwapper::doJob()
 {
     /**
@@ -151,7 +205,7 @@ public:
     }
 
     static inline bool swapOutFirst(KisTileData *td) {
-        return td->age() > 0;
+        return td->age() > 0 && !td->accessFrequency();
     }
 };
 
@@ -175,7 +229,9 @@ public:
     }
 
     static inline bool swapOutFirst(KisTileData *td) {
-        return td->age() > 0;
+        // History goes first, then the tiles nobody touched for a while
+        return td->historical() ||
+            (td->age() > 0 && !td->accessFrequency());
     }
 };
 
@@ -184,11 +240,14 @@ template<class strategy>
 qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
 {
     qint64 freedMetric = 0;
-    QList<KisTileData*> additionalCandidates;
+    QVector<std::pair<int, KisTileData*>> additionalCandidates;
+    QVector<KisTileData*> pinnedCandidates;
 
     typename strategy::iterator *iter =
         strategy::beginIteration(m_d->store);
 
+    const QVector<int> pinEpochs = m_d->store->activeSwapHintEpochs();
+
     KisTileData *item = 0;
 
     while (iter->hasNext()) {
@@ -198,6 +257,19 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
 
         if (!strategy::isInteresting(item)) continue;
 
+        /**
+         * The tiles visible on canvas are swapped out only
+         * when there is no other way to free memory. Pure
+         * history tiles are never pinned, even if they
+         * used to be visible.
+         */
+        if (item->pinEpoch() && !item->historical() &&
+            pinEpochs.contains(item->pinEpoch())) {
+
+            pinnedCandidates.append(item);
+            continue;
+        }
+
         if (strategy::swapOutFirst(item)) {
             if (iter->trySwapOut(item)) {
                 freedMetric += item->pixelSize();
@@ -205,14 +277,40 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
         }
         else {
             item->markOld();
-            additionalCandidates.append(item);
+
+            /**
+             * The access frequency is changed by the painting threads
+             * concurrently, so it is sampled only once. Otherwise the
+             * comparator would be inconsistent during sorting.
+             */
+            additionalCandidates.append(std::make_pair(item->accessFrequency(), item));
         }
 
     }
 
-    Q_FOREACH (item, additionalCandidates) {
+    /**
+     * The least frequently used tiles go first
+     */
+    std::stable_sort(additionalCandidates.begin(), additionalCandidates.end(),
+                     [] (const std::pair<int, KisTileData*> &lhs,
+                         const std::pair<int, KisTileData*> &rhs) {
+                         return lhs.first < rhs.first;
+                     });
+
+    for (auto it = additionalCandidates.begin(); it != additionalCandidates.end(); ++it) {
         if (freedMetric >= needToFreeMetric) break;
 
+        item = it->second;
+
+        if (iter->trySwapOut(item)) {
+            freedMetric += item->pixelSize();
+        }
+    }
+
+    Q_FOREACH (item, pinnedCandidates) {
+        if (freedMetric >= needToFreeMetric ||
+            m_d->store->memoryMetric() <= m_d->limits.emergencyThreshold()) break;
+
         if (iter->trySwapOut(item)) {
             freedMetric += item->pixelSize();
         }
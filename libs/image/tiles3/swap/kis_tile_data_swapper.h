@@ -28,6 +28,20 @@ public:
     void terminateSwapper();
     void checkFreeMemory();
 
+    /**
+     * Returns true if the store uses more memory than the swapper
+     * tries to keep the working tiles within. The loading code uses
+     * that to stream freshly decoded tiles right into the swap file.
+     */
+    bool isAboveHardLimit();
+
+    /**
+     * Queues the tile data for loading from the swap file in the
+     * background. The swapper keeps a reference to \p td until
+     * the request is processed.
+     */
+    void prefetch(KisTileData *td);
+
     void testingRereadConfig();
 
 private:
@@ -35,6 +49,7 @@ private:
     void run() override;
 
     void doJob();
+    void processPrefetchQueue();
     template<class strategy> qint64 pass(qint64 needToFreeMetric);
 
 private:
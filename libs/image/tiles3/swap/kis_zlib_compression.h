@@ -0,0 +1,30 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_ZLIB_COMPRESSION_H
+#define __KIS_ZLIB_COMPRESSION_H
+
+#include "kis_abstract_compression.h"
+
+/**
+ * Deflate compression through zlib. It is several times slower than
+ * LZF, but gives noticeably smaller output, which is what we want
+ * for the documents written to disk, e.g. autosaves.
+ */
+class KRITAIMAGE_EXPORT KisZlibCompression : public KisAbstractCompression
+{
+public:
+    KisZlibCompression();
+    ~KisZlibCompression() override;
+
+    qint32 compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+    qint32 decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+
+    QString name() const override;
+    qint32 outputBufferSize(qint32 dataSize) override;
+};
+
+#endif /* __KIS_ZLIB_COMPRESSION_H */
@@ -30,6 +30,33 @@ void KisChunkAllocatorTest::testOperations()
     QVERIFY(qFuzzyCompare(allocator.debugFragmentation(), 1./6));
 }
 
+void KisChunkAllocatorTest::testAlignmentBoundary()
+{
+    const quint64 boundary = 100;
+    KisChunkAllocator allocator(1000, 10000, boundary);
+
+    QList<KisChunk> chunks;
+
+    for (int i = 0; i < 50; i++) {
+        chunks << allocator.getChunk(15 + i % 30);
+    }
+
+    // free every third chunk and fill the holes again
+    for (int i = chunks.size() - 1; i >= 0; i -= 3) {
+        allocator.freeChunk(chunks.takeAt(i));
+    }
+
+    for (int i = 0; i < 20; i++) {
+        chunks << allocator.getChunk(10 + i % 40);
+    }
+
+    Q_FOREACH (KisChunk chunk, chunks) {
+        QCOMPARE(chunk.begin() / boundary, chunk.end() / boundary);
+    }
+
+    allocator.sanityCheck();
+}
+
 
 #define NUM_TRANSACTIONS 30
 #define NUM_CHUNKS_ALLOC 15000
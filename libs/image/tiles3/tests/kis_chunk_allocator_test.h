@@ -19,6 +19,7 @@ qreal measureFragmentation(qint32 transactions, qint32 chunksAlloc,
 
 private Q_SLOTS:
     void testOperations();
+    void testAlignmentBoundary();
     void testFragmentation();
 };
 
@@ -11,6 +11,8 @@
 
 #include "../../../sdk/tests/testutil.h"
 #include "tiles3/swap/kis_lzf_compression.h"
+#include "tiles3/swap/kis_lz4_compression.h"
+#include "tiles3/swap/kis_zlib_compression.h"
 #include <kis_debug.h>
 
 #define TEST_FILE "tile.png"
@@ -209,6 +211,65 @@ void KisCompressionTests::testLzfOverflow()
     delete compression;
 }
 
+void KisCompressionTests::testLz4RoundTrip()
+{
+    KisAbstractCompression *compression = new KisLz4Compression();
+
+    roundTrip(compression);
+    roundTripTwoPass(compression);
+
+    delete compression;
+}
+
+void KisCompressionTests::testLz4Overflow()
+{
+    KisAbstractCompression *compression = new KisLz4Compression();
+    testOverflow(compression);
+    delete compression;
+}
+
+void KisCompressionTests::testZlibRoundTrip()
+{
+    KisAbstractCompression *compression = new KisZlibCompression();
+
+    roundTrip(compression);
+    roundTripTwoPass(compression);
+
+    delete compression;
+}
+
+void KisCompressionTests::testZlibOverflow()
+{
+    KisAbstractCompression *compression = new KisZlibCompression();
+    testOverflow(compression);
+    delete compression;
+}
+
+void KisCompressionTests::testPredictorsRoundTrip()
+{
+    QImage referenceImage(QString(FILES_DATA_DIR) + QDir::separator() + TEST_FILE);
+    referenceImage = referenceImage.convertToFormat(QImage::Format_ARGB32);
+
+    const qint32 width = referenceImage.width();
+    const qint32 height = referenceImage.height();
+    const qint32 srcSize = width * height * 4;
+
+    QImage image(referenceImage);
+    QVector<quint8> linearized(srcSize);
+
+    KisAbstractCompression::linearizeColors(image.bits(), linearized.data(), srcSize, 4);
+
+    KisAbstractCompression::applyHorizontalPredictor(linearized.data(), srcSize, width, height);
+    KisAbstractCompression::revertHorizontalPredictor(linearized.data(), srcSize, width, height);
+
+    KisAbstractCompression::applyPaethPredictor(linearized.data(), srcSize, width, height);
+    KisAbstractCompression::revertPaethPredictor(linearized.data(), srcSize, width, height);
+
+    KisAbstractCompression::delinearizeColors(linearized.data(), image.bits(), srcSize, 4);
+
+    QVERIFY(referenceImage == image);
+}
+
 void KisCompressionTests::benchmarkMemCpy()
 {
     QImage image(QString(FILES_DATA_DIR) + QDir::separator() + TEST_FILE);
@@ -250,5 +311,33 @@ void KisCompressionTests::benchmarkDecompressionLzfTwoPass()
     delete compression;
 }
 
+void KisCompressionTests::benchmarkCompressionLz4TwoPass()
+{
+    KisAbstractCompression *compression = new KisLz4Compression();
+    benchmarkCompressionTwoPass(compression);
+    delete compression;
+}
+
+void KisCompressionTests::benchmarkDecompressionLz4TwoPass()
+{
+    KisAbstractCompression *compression = new KisLz4Compression();
+    benchmarkDecompressionTwoPass(compression);
+    delete compression;
+}
+
+void KisCompressionTests::benchmarkCompressionZlibTwoPass()
+{
+    KisAbstractCompression *compression = new KisZlibCompression();
+    benchmarkCompressionTwoPass(compression);
+    delete compression;
+}
+
+void KisCompressionTests::benchmarkDecompressionZlibTwoPass()
+{
+    KisAbstractCompression *compression = new KisZlibCompression();
+    benchmarkDecompressionTwoPass(compression);
+    delete compression;
+}
+
 SIMPLE_TEST_MAIN(KisCompressionTests)
 
@@ -30,12 +30,26 @@ private Q_SLOTS:
     void testLzfRoundTrip();
     void testLzfOverflow();
 
+    void testLz4RoundTrip();
+    void testLz4Overflow();
+
+    void testZlibRoundTrip();
+    void testZlibOverflow();
+
+    void testPredictorsRoundTrip();
+
     void benchmarkMemCpy();
 
     void benchmarkCompressionLzf();
     void benchmarkCompressionLzfTwoPass();
     void benchmarkDecompressionLzf();
     void benchmarkDecompressionLzfTwoPass();
+
+    void benchmarkCompressionLz4TwoPass();
+    void benchmarkDecompressionLz4TwoPass();
+
+    void benchmarkCompressionZlibTwoPass();
+    void benchmarkDecompressionZlibTwoPass();
 };
 
 #endif /* KIS_COMPRESSION_TESTS_H */
@@ -9,11 +9,14 @@
 #include <simpletest.h>
 
 #include <QThreadPool>
+#include <QBuffer>
 
 #include "kis_image_config.h"
 #include "tiles_test_utils.h"
 #include "tiles3/kis_tiled_data_manager.h"
 #include "tiles3/kis_tile_data_store.h"
+#include "kis_datamanager.h"
+#include "kis_paint_device_writer.h"
 #include <kis_debug.h>
 #include "config-limit-long-tests.h"
 
@@ -206,4 +209,96 @@ void KisLowMemoryTests::hangingTilesTest()
     dstTile = 0;
 }
 
+class BufferPaintDeviceWriter : public KisPaintDeviceWriter
+{
+public:
+    BufferPaintDeviceWriter(QIODevice *device) : m_device(device) {}
+
+    bool write(const QByteArray &data) override {
+        return m_device->write(data) == data.size();
+    }
+
+    bool write(const char* data, qint64 length) override {
+        return m_device->write(data, length) == length;
+    }
+
+private:
+    QIODevice *m_device;
+};
+
+#define COLUMN2COLOR(col) (col % 255 + 1)
+
+void KisLowMemoryTests::streamingReadTest()
+{
+    // 8 times more than the memory limit
+    const int NUM_TILES = 2048;
+
+    quint8 defaultPixel = 0;
+    QByteArray data;
+
+    {
+        KisDataManager srcDM(1, &defaultPixel);
+
+        for (int i = 0; i < NUM_TILES; i++) {
+            KisTileSP tile = srcDM.getTile(i, 0, true);
+            tile->lockForWrite();
+            memset(tile->data(), COLUMN2COLOR(i), TILESIZE);
+            tile->unlockForWrite();
+        }
+
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        BufferPaintDeviceWriter writer(&buffer);
+        QVERIFY(srcDM.write(writer));
+    }
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+
+    KisDataManager dstDM(1, &defaultPixel);
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+
+    /**
+     * The loader swaps the tiles out after every round of batches, so
+     * limit the number of the batches in flight to make the bound below
+     * independent from the number of cores
+     */
+    const int oldMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(2);
+
+    const bool readResult = dstDM.read(&buffer);
+    QThreadPool::globalInstance()->setMaxThreadCount(oldMaxThreadCount);
+    QVERIFY(readResult);
+
+    /**
+     * The tiles are loaded in memory until the hard limit is reached,
+     * then every round of batches (2 threads * 2 batches * 64 tiles
+     * of one byte per pixel) is streamed into the swap file
+     */
+    const qint64 hardLimit = MiB_TO_METRIC(KisImageConfig(true).tilesHardLimit());
+    const qint64 roundOfBatches = 4 * 64;
+    const qint64 memoryBound = hardLimit + roundOfBatches;
+
+    QVERIFY(memoryBound < NUM_TILES);
+    QVERIFY2(store->memoryMetric() <= memoryBound,
+             QString("memory metric %1, bound %2").arg(store->memoryMetric()).arg(memoryBound).toLatin1());
+
+    // the tiles have actually been swapped out, not just never loaded
+    int numSwappedTiles = 0;
+    for (int i = 0; i < NUM_TILES; i++) {
+        if (!dstDM.getTile(i, 0, false)->tileData()->data()) {
+            numSwappedTiles++;
+        }
+    }
+    QVERIFY(numSwappedTiles >= NUM_TILES - memoryBound);
+
+    for (int i = 0; i < NUM_TILES; i++) {
+        KisTileSP tile = dstDM.getTile(i, 0, false);
+        tile->lockForRead();
+        QVERIFY(memoryIsFilled(COLUMN2COLOR(i), tile->data(), TILESIZE));
+        tile->unlockForRead();
+    }
+}
+
 SIMPLE_TEST_MAIN(KisLowMemoryTests)
@@ -42,6 +42,39 @@ void KisMemoryWindowTest::testWindow()
     QVERIFY(!memcmp(ptr, oddBuf, chunkLength));
 }
 
+void KisMemoryWindowTest::testMultipleWindows()
+{
+    QTemporaryDir swapDir;
+    KisMemoryWindow memory(swapDir.path(), 1024, 3);
+
+    const quint8 chunkLength = 10;
+    quint8 *ptr;
+
+    for (int i = 0; i < 5; i++) {
+        ptr = memory.getWriteChunkPtr(KisChunkData(i * 1024 + 100, chunkLength));
+        memset(ptr, 0x10 + i, chunkLength);
+        QVERIFY(memory.numMappedWindows() <= 3);
+    }
+
+    // the chunk crossing the window boundary gets a mapping of its own
+    ptr = memory.getWriteChunkPtr(KisChunkData(5 * 1024 - 5, chunkLength));
+    memset(ptr, 0xee, chunkLength);
+    QCOMPARE(memory.numMappedWindows(), 3);
+
+    for (int i = 4; i >= 0; i--) {
+        quint8 expected[chunkLength];
+        memset(expected, 0x10 + i, chunkLength);
+
+        ptr = memory.getReadChunkPtr(KisChunkData(i * 1024 + 100, chunkLength));
+        QVERIFY(!memcmp(ptr, expected, chunkLength));
+    }
+
+    quint8 expected[chunkLength];
+    memset(expected, 0xee, chunkLength);
+    ptr = memory.getReadChunkPtr(KisChunkData(5 * 1024 - 5, chunkLength));
+    QVERIFY(!memcmp(ptr, expected, chunkLength));
+}
+
 void KisMemoryWindowTest::testTopReports()
 {
 
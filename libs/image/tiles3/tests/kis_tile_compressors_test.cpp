@@ -10,6 +10,7 @@
 #include "tiles3/kis_tiled_data_manager.h"
 #include "tiles3/swap/kis_legacy_tile_compressor.h"
 #include "tiles3/swap/kis_tile_compressor_2.h"
+#include "tiles3/swap/kis_compression_registry.h"
 
 #include "tiles_test_utils.h"
 
@@ -167,6 +168,66 @@ void KisTileCompressorsTest::testLowLevelRoundTripIncompressible2()
     delete compressor;
 }
 
+void KisTileCompressorsTest::testRoundTrip2Codecs_data()
+{
+    QTest::addColumn<QString>("compressionName");
+    QTest::addColumn<int>("predictor");
+
+    Q_FOREACH (const QString &name, KisCompressionRegistry::compressionNames()) {
+        QTest::newRow((name + "-none").toLatin1()) << name << int(KisTileCompressor2::NoPredictor);
+        QTest::newRow((name + "-horizontal").toLatin1()) << name << int(KisTileCompressor2::HorizontalPredictor);
+        QTest::newRow((name + "-paeth").toLatin1()) << name << int(KisTileCompressor2::PaethPredictor);
+    }
+}
+
+void KisTileCompressorsTest::testRoundTrip2Codecs()
+{
+    QFETCH(QString, compressionName);
+    QFETCH(int, predictor);
+
+    KisTileCompressor2 *compressor =
+        new KisTileCompressor2(compressionName, KisTileCompressor2::Predictor(predictor));
+    QCOMPARE(compressor->compressionName(), compressionName);
+
+    doRoundTrip(compressor);
+    doLowLevelRoundTrip(compressor);
+    doLowLevelRoundTripIncompressible(compressor);
+    delete compressor;
+}
+
+void KisTileCompressorsTest::testReadWithDifferentCodec()
+{
+    /**
+     * The codec is stored in the tile header, so a compressor
+     * configured for one algorithm should still be able to read
+     * tiles written with any other one
+     */
+
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    dm.clear(64, 64, 64, 64, &oddPixel1);
+
+    KisTileSP tile11 = dm.getTile(1, 1, false);
+
+    KoStoreFake fakeStore;
+    KisFakePaintDeviceWriter writer(&fakeStore);
+
+    KisTileCompressor2 zlibCompressor("ZLIB");
+    QVERIFY(zlibCompressor.writeTile(tile11, writer));
+    tile11 = 0;
+
+    fakeStore.startReading();
+    dm.clear();
+
+    KisTileCompressor2 lzfCompressor("LZF");
+    QVERIFY(lzfCompressor.readTile(fakeStore.device(), &dm));
+
+    tile11 = dm.getTile(1, 1, false);
+    QVERIFY(memoryIsFilled(oddPixel1, tile11->data(), TILESIZE));
+}
+
 
 SIMPLE_TEST_MAIN(KisTileCompressorsTest)
 
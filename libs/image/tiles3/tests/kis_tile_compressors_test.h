@@ -26,6 +26,10 @@ private Q_SLOTS:
     void testRoundTrip2();
     void testLowLevelRoundTrip2();
     void testLowLevelRoundTripIncompressible2();
+
+    void testRoundTrip2Codecs_data();
+    void testRoundTrip2Codecs();
+    void testReadWithDifferentCodec();
 };
 
 #endif /* KIS_TILE_COMPRESSORS_TEST_H */
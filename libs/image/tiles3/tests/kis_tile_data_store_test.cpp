@@ -176,5 +176,67 @@ void KisTileDataStoreTest::testSwapping()
     }
 }
 
+void KisTileDataStoreTest::testSwapHint()
+{
+    KisImageConfig config(false);
+    config.setMemoryHardLimitPercent(config.memoryHardLimitPercent(true));
+    config.setMemorySoftLimitPercent(config.memorySoftLimitPercent(true));
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    store->debugClear();
+    store->testingRereadConfig();
+
+    const qint32 pixelSize = 1;
+    quint8 defaultPixel = 128;
+    KisTiledDataManager dm(pixelSize, &defaultPixel);
+
+    for(qint32 col = 0; col < 8; col++) {
+        KisTileSP tile = dm.getTile(col, 0, true);
+        tile->lockForWrite();
+        memset(tile->data(), COLUMN2COLOR(col), TILESIZE);
+        tile->unlockForWrite();
+    }
+
+    store->debugSwapAll();
+    QCOMPARE(store->numTilesInMemory(), 0);
+
+    const int clientA = 0;
+    const int clientB = 1;
+
+    const int pinEpoch = KisTiledDataManager::beginSwapHint(&clientA);
+    dm.applySwapHint(pinEpoch, QRect(0, 0, 128, 64), QRect(0, 0, 256, 64));
+
+    QCOMPARE(dm.getTile(0, 0, false)->tileData()->pinEpoch(), pinEpoch);
+    QCOMPARE(dm.getTile(1, 0, false)->tileData()->pinEpoch(), pinEpoch);
+    QVERIFY(dm.getTile(2, 0, false)->tileData()->pinEpoch() != pinEpoch);
+
+    // the swapper loads the hinted tiles in the background
+    QTRY_COMPARE_WITH_TIMEOUT(store->numTilesInMemory(), 4, 5000);
+
+    for(qint32 col = 0; col < 8; col++) {
+        KisTileSP tile = dm.getTile(col, 0, false);
+        tile->lockForRead();
+        QVERIFY(memoryIsFilled(COLUMN2COLOR(col), tile->data(), TILESIZE));
+        tile->unlockForRead();
+    }
+
+    // the hints of another canvas don't unpin the tiles of the first one
+    const int otherPinEpoch = KisTiledDataManager::beginSwapHint(&clientB);
+    dm.applySwapHint(otherPinEpoch, QRect(384, 0, 64, 64), QRect());
+
+    QVERIFY(store->isSwapHintEpochActive(dm.getTile(0, 0, false)->tileData()->pinEpoch()));
+    QVERIFY(store->isSwapHintEpochActive(dm.getTile(6, 0, false)->tileData()->pinEpoch()));
+
+    // a new epoch of the same canvas unpins its old tiles
+    KisTiledDataManager::beginSwapHint(&clientA);
+    QVERIFY(!store->isSwapHintEpochActive(dm.getTile(0, 0, false)->tileData()->pinEpoch()));
+    QVERIFY(store->isSwapHintEpochActive(dm.getTile(6, 0, false)->tileData()->pinEpoch()));
+
+    KisTiledDataManager::endSwapHint(&clientA);
+    KisTiledDataManager::endSwapHint(&clientB);
+    QVERIFY(!store->isSwapHintEpochActive(dm.getTile(6, 0, false)->tileData()->pinEpoch()));
+    QVERIFY(store->activeSwapHintEpochs().isEmpty());
+}
+
 SIMPLE_TEST_MAIN(KisTileDataStoreTest)
 
@@ -18,6 +18,7 @@ private Q_SLOTS:
     void testClockIterator();
     void testLeaks();
     void testSwapping();
+    void testSwapHint();
 };
 
 #endif /* KIS_TILE_DATA_STORE_TEST_H */
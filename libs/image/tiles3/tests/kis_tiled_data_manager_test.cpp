@@ -102,6 +102,47 @@ void KisTiledDataManagerTest::testUndoingNewTiles()
     QCOMPARE(srcDM.extent(), nullRect);
 }
 
+void KisTiledDataManagerTest::testTilesPairs()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager srcDM(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+
+    srcDM.clear(QRect(0,0,128,64), &oddPixel1);
+
+    KisMementoSP memento = srcDM.getMemento();
+    srcDM.clear(QRect(0,0,64,64), &oddPixel2);
+
+    KisTileSP tiles[3];
+    KisTileSP oldTiles[3];
+
+    srcDM.getTilesPairs(0, 0, 2, 0, true, tiles, oldTiles);
+
+    for (int i = 0; i < 3; i++) {
+        KisTileSP tile;
+        KisTileSP oldTile;
+        srcDM.getTilesPair(i, 0, true, &tile, &oldTile);
+
+        // the missing tile (2,0) has been created by the batch
+        QCOMPARE(tiles[i], tile);
+        QCOMPARE(oldTiles[i]->tileData(), oldTile->tileData());
+    }
+
+    QCOMPARE(srcDM.extent(), QRect(0,0,192,64));
+
+    oldTiles[0]->lockForRead();
+    QCOMPARE(*oldTiles[0]->data(), oddPixel1);
+    oldTiles[0]->unlockForRead();
+
+    tiles[0]->lockForRead();
+    QCOMPARE(*tiles[0]->data(), oddPixel2);
+    tiles[0]->unlockForRead();
+
+    srcDM.commit();
+}
+
 void KisTiledDataManagerTest::testPurgedAndEmptyTransactions()
 {
     quint8 defaultPixel = 0;
@@ -40,6 +40,7 @@ private Q_SLOTS:
     void testTransactions();
     void testPurgeHistory();
     void testUndoSetDefaultPixel();
+    void testTilesPairs();
 
     void benchmarkReadOnlyTileLazy();
     void benchmarkSharedPointers();
@@ -54,6 +54,13 @@ struct OptimizedOpsSelector
     static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
         return new KoCompositeOpCopy2<Traits>(cs);
     }
+
+    static KoCompositeOp* createGenericOp(const KoColorSpace *cs, const QString &id, const QString &category) {
+        Q_UNUSED(cs);
+        Q_UNUSED(id);
+        Q_UNUSED(category);
+        return nullptr;
+    }
 };
 
 template<>
@@ -71,6 +78,9 @@ struct OptimizedOpsSelector<KoBgrU8Traits>
     static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createCopyOp32(cs);
     }
+    static KoCompositeOp* createGenericOp(const KoColorSpace *cs, const QString &id, const QString &category) {
+        return KoOptimizedCompositeOpFactory::createGenericOp32(cs, id, category);
+    }
 };
 
 template<>
@@ -87,6 +97,9 @@ struct OptimizedOpsSelector<KoLabU8Traits>
     static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createCopyOp32(cs);
     }
+    static KoCompositeOp* createGenericOp(const KoColorSpace *cs, const QString &id, const QString &category) {
+        return KoOptimizedCompositeOpFactory::createGenericOp32(cs, id, category);
+    }
 };
 
 template<>
@@ -104,6 +117,9 @@ struct OptimizedOpsSelector<KoRgbF32Traits>
     static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createCopyOp128(cs);
     }
+    static KoCompositeOp* createGenericOp(const KoColorSpace *cs, const QString &id, const QString &category) {
+        return KoOptimizedCompositeOpFactory::createGenericOp128(cs, id, category);
+    }
 };
 
 template<>
@@ -121,6 +137,9 @@ struct OptimizedOpsSelector<KoBgrU16Traits>
     static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createCopyOpU64(cs);
     }
+    static KoCompositeOp* createGenericOp(const KoColorSpace *cs, const QString &id, const QString &category) {
+        return KoOptimizedCompositeOpFactory::createGenericOpU64(cs, id, category);
+    }
 };
 
 
@@ -140,7 +159,11 @@ struct AddGeneralOps<Traits, true>
                 cs->addCompositeOp(new KoCompositeOpGenericSC<Traits, func, KoAdditiveBlendingPolicy<Traits>>(cs, id, category));
             }
         } else {
-            cs->addCompositeOp(new KoCompositeOpGenericSC<Traits, func, KoAdditiveBlendingPolicy<Traits>>(cs, id, category));
+            KoCompositeOp *op = OptimizedOpsSelector<Traits>::createGenericOp(cs, id, category);
+            if (!op) {
+                op = new KoCompositeOpGenericSC<Traits, func, KoAdditiveBlendingPolicy<Traits>>(cs, id, category);
+            }
+            cs->addCompositeOp(op);
         }
      }
 
@@ -78,3 +78,18 @@ KoCompositeOp* KoOptimizedCompositeOpFactory::createCopyOpU64(const KoColorSpace
 {
     return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopyU64> >(cs);
 }
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createGenericOp32(const KoColorSpace *cs, const QString &id, const QString &category)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpGeneric32> >(cs, id, category);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createGenericOpU64(const KoColorSpace *cs, const QString &id, const QString &category)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpGenericU64> >(cs, id, category);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createGenericOp128(const KoColorSpace *cs, const QString &id, const QString &category)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpGeneric128> >(cs, id, category);
+}
@@ -11,6 +11,7 @@
 
 class KoCompositeOp;
 class KoColorSpace;
+class QString;
 
 /**
  * The creation of the optimized composite ops is moved into a separate
@@ -39,6 +40,16 @@ public:
     static KoCompositeOp* createCopyOp32(const KoColorSpace *cs);
     static KoCompositeOp* createAlphaDarkenOpHardU64(const KoColorSpace *cs);
     static KoCompositeOp* createAlphaDarkenOpCreamyU64(const KoColorSpace *cs);
+
+    /**
+     * Create a vectorized version of the separable blend mode \p id
+     * (multiply, screen, overlay and so on). Returns nullptr if there is no
+     * optimized implementation for the mode or for the current CPU, in which
+     * case the caller should use KoCompositeOpGenericSC.
+     */
+    static KoCompositeOp* createGenericOp32(const KoColorSpace *cs, const QString &id, const QString &category);
+    static KoCompositeOp* createGenericOpU64(const KoColorSpace *cs, const QString &id, const QString &category);
+    static KoCompositeOp* createGenericOp128(const KoColorSpace *cs, const QString &id, const QString &category);
 };
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORY_H */
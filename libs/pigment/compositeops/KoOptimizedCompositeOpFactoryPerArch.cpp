@@ -13,6 +13,7 @@
 #include "KoOptimizedCompositeOpOver32.h"
 #include "KoOptimizedCompositeOpOver128.h"
 #include "KoOptimizedCompositeOpCopy128.h"
+#include "KoOptimizedCompositeOpGeneric.h"
 
 #include <KoCompositeOpRegistry.h>
 
@@ -124,4 +125,31 @@ KoCompositeOp *KoOptimizedCompositeOpFactoryPerArch<
     return new KoOptimizedCompositeOpAlphaDarkenCreamyU64<xsimd::current_arch>(param);
 }
 
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpGeneric32>::create<
+    xsimd::current_arch>(const KoColorSpace *param, const QString &id, const QString &category)
+{
+    return KoOptimizedCompositeOpGeneric32<xsimd::current_arch>::create(param, id, category);
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpGenericU64>::create<
+    xsimd::current_arch>(const KoColorSpace *param, const QString &id, const QString &category)
+{
+    return KoOptimizedCompositeOpGenericU64<xsimd::current_arch>::create(param, id, category);
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpGeneric128>::create<
+    xsimd::current_arch>(const KoColorSpace *param, const QString &id, const QString &category)
+{
+    return KoOptimizedCompositeOpGeneric128<xsimd::current_arch>::create(param, id, category);
+}
+
 #endif // XSIMD_UNIVERSAL_BUILD_PASS
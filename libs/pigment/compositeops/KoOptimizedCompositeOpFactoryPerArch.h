@@ -12,6 +12,7 @@
 
 class KoCompositeOp;
 class KoColorSpace;
+class QString;
 
 template<typename _impl>
 class KoOptimizedCompositeOpAlphaDarkenCreamy32;
@@ -49,10 +50,22 @@ class KoOptimizedCompositeOpCopyU64;
 template<typename _impl>
 class KoOptimizedCompositeOpCopy32;
 
+template<typename _impl>
+struct KoOptimizedCompositeOpGeneric32;
+
+template<typename _impl>
+struct KoOptimizedCompositeOpGenericU64;
+
+template<typename _impl>
+struct KoOptimizedCompositeOpGeneric128;
+
 template<template<typename I> class CompositeOp>
 struct KoOptimizedCompositeOpFactoryPerArch {
     template<typename _impl>
     static KoCompositeOp *create(const KoColorSpace *);
+
+    template<typename _impl>
+    static KoCompositeOp *create(const KoColorSpace *, const QString &id, const QString &category);
 };
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORYPERARCH_H */
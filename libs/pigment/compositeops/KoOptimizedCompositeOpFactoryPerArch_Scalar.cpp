@@ -121,3 +121,43 @@ KoCompositeOp *KoOptimizedCompositeOpFactoryPerArch<
     return new KoCompositeOpAlphaDarken<KoBgrU16Traits, KoAlphaDarkenParamsWrapperCreamy>(param);
 }
 
+
+/**
+ * There is no point in having a scalar copy of the generic ops, the
+ * callers fall back to KoCompositeOpGenericSC when nullptr is returned
+ */
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpGeneric32>::create<
+    xsimd::generic>(const KoColorSpace *param, const QString &id, const QString &category)
+{
+    Q_UNUSED(param);
+    Q_UNUSED(id);
+    Q_UNUSED(category);
+    return nullptr;
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpGenericU64>::create<
+    xsimd::generic>(const KoColorSpace *param, const QString &id, const QString &category)
+{
+    Q_UNUSED(param);
+    Q_UNUSED(id);
+    Q_UNUSED(category);
+    return nullptr;
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpGeneric128>::create<
+    xsimd::generic>(const KoColorSpace *param, const QString &id, const QString &category)
+{
+    Q_UNUSED(param);
+    Q_UNUSED(id);
+    Q_UNUSED(category);
+    return nullptr;
+}
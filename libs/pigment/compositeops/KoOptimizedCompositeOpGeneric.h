@@ -0,0 +1,652 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPGENERIC_H
+#define KOOPTIMIZEDCOMPOSITEOPGENERIC_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "KoColorSpaceBlendingPolicy.h"
+#include "KoColorSpaceTraits.h"
+#include "KoCompositeOpGeneric.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+
+/**
+ * Helpers that let the blend functions below be written once and
+ * instantiated both for xsimd batches (vector path) and for plain
+ * floats (the unaligned head/tail pixels of each row).
+ */
+namespace KoOptimizedBlendMath
+{
+template<typename T, typename M>
+ALWAYS_INLINE T select(const M &cond, const T &a, const T &b)
+{
+    return xsimd::select(cond, a, b);
+}
+
+ALWAYS_INLINE float select(bool cond, float a, float b)
+{
+    return cond ? a : b;
+}
+
+template<typename T>
+ALWAYS_INLINE T min(const T &a, const T &b)
+{
+    return xsimd::min(a, b);
+}
+
+ALWAYS_INLINE float min(float a, float b)
+{
+    return std::min(a, b);
+}
+
+template<typename T>
+ALWAYS_INLINE T max(const T &a, const T &b)
+{
+    return xsimd::max(a, b);
+}
+
+ALWAYS_INLINE float max(float a, float b)
+{
+    return std::max(a, b);
+}
+
+template<typename T>
+ALWAYS_INLINE T sqrt(const T &a)
+{
+    return xsimd::sqrt(a);
+}
+
+ALWAYS_INLINE float sqrt(float a)
+{
+    return std::sqrt(a);
+}
+
+template<typename T>
+ALWAYS_INLINE auto isfinite(const T &a)
+{
+    return xsimd::isfinite(a);
+}
+
+ALWAYS_INLINE bool isfinite(float a)
+{
+    return std::isfinite(a);
+}
+
+/**
+ * Integer channels are clamped into the unit range by the
+ * generic functions, floating point ones are allowed to
+ * leave it (HDR)
+ */
+template<typename channels_type, typename T>
+ALWAYS_INLINE T clampResult(const T &a)
+{
+    if constexpr (std::numeric_limits<channels_type>::is_integer) {
+        return min(max(a, T(0.0f)), T(1.0f));
+    } else {
+        return a;
+    }
+}
+
+/**
+ * The value the generic functions return when a division overflows
+ */
+template<typename channels_type>
+ALWAYS_INLINE float maxValue()
+{
+    if constexpr (std::numeric_limits<channels_type>::is_integer) {
+        return 1.0f;
+    } else {
+        return std::numeric_limits<float>::max();
+    }
+}
+
+template<typename channels_type, typename T>
+ALWAYS_INLINE T colorDodge(const T &src, const T &dst)
+{
+    const T zeroValue(0.0f);
+    const T unitValue(1.0f);
+    const T maxValue(KoOptimizedBlendMath::maxValue<channels_type>());
+
+    T result = clampResult<channels_type>(dst / (unitValue - src));
+    result = select(src == unitValue, select(dst == zeroValue, zeroValue, maxValue), result);
+
+    if constexpr (!std::numeric_limits<channels_type>::is_integer) {
+        result = select(isfinite(result), result, maxValue);
+    }
+
+    return result;
+}
+
+template<typename channels_type, typename T>
+ALWAYS_INLINE T colorBurn(const T &src, const T &dst)
+{
+    const T zeroValue(0.0f);
+    const T unitValue(1.0f);
+    const T maxValue(KoOptimizedBlendMath::maxValue<channels_type>());
+
+    T result = clampResult<channels_type>((unitValue - dst) / src);
+    result = select(src == zeroValue, select(dst == unitValue, zeroValue, maxValue), result);
+
+    if constexpr (!std::numeric_limits<channels_type>::is_integer) {
+        result = select(isfinite(result), result, maxValue);
+    }
+
+    return unitValue - result;
+}
+} // namespace KoOptimizedBlendMath
+
+/**
+ * Vectorizable counterparts of the separable blend functions from
+ * KoCompositeOpFunctions.h. Every function operates on channel values
+ * normalized into 0...1 range and mirrors the corresponding cfXXX()
+ * function, whose pointer is kept in genericFunc and is used for the
+ * cases the optimized op does not handle.
+ */
+template<typename channels_type>
+struct KoOptimizedBlendMultiply {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfMultiply<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return src * dst;
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendScreen {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfScreen<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return src + dst - src * dst;
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendHardLight {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfHardLight<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        const T src2 = src + src;
+        const T screen = (src2 - T(1.0f)) + dst - (src2 - T(1.0f)) * dst;
+        return KoOptimizedBlendMath::select(src > T(0.5f), screen, src2 * dst);
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendOverlay {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfOverlay<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendHardLight<channels_type>::blend(dst, src);
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendSoftLight {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfSoftLight<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        const T unitValue(1.0f);
+        const T src2 = src + src;
+
+        const T light = dst + (src2 - unitValue) * (KoOptimizedBlendMath::sqrt(dst) - dst);
+        const T dark = dst - (unitValue - src2) * dst * (unitValue - dst);
+
+        return KoOptimizedBlendMath::clampResult<channels_type>(
+            KoOptimizedBlendMath::select(src > T(0.5f), light, dark));
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendColorDodge {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfColorDodge<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendMath::colorDodge<channels_type>(src, dst);
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendColorBurn {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfColorBurn<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendMath::colorBurn<channels_type>(src, dst);
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendHardMix {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfHardMix<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendMath::select(dst > T(0.5f),
+                                            KoOptimizedBlendMath::colorDodge<channels_type>(src, dst),
+                                            KoOptimizedBlendMath::colorBurn<channels_type>(src, dst));
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendDarkenOnly {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfDarkenOnly<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendMath::min(src, dst);
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendLightenOnly {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfLightenOnly<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendMath::max(src, dst);
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendAddition {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfAddition<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendMath::clampResult<channels_type>(src + dst);
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendSubtract {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfSubtract<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendMath::clampResult<channels_type>(dst - src);
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendDifference {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfDifference<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendMath::max(src, dst) - KoOptimizedBlendMath::min(src, dst);
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendLinearBurn {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfLinearBurn<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return KoOptimizedBlendMath::clampResult<channels_type>(src + dst - T(1.0f));
+    }
+};
+
+template<typename channels_type>
+struct KoOptimizedBlendExclusion {
+    static constexpr channels_type (*genericFunc)(channels_type, channels_type) = &cfExclusion<channels_type>;
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        const T x = src * dst;
+        return KoOptimizedBlendMath::clampResult<channels_type>(dst + src - (x + x));
+    }
+};
+
+/**
+ * A compositor for KoStreamedMath::genericComposite() that implements
+ * the formula of KoCompositeOpGenericSC for C1_C2_C3_A pixels with all
+ * the color channels enabled. When \p alphaLocked is set, the alpha
+ * channel of the destination is preserved, otherwise it is united with
+ * the source one.
+ */
+template<typename channels_type, class BlendFunction, bool alphaLocked>
+struct GenericSCCompositor128 {
+    struct ParamsWrapper {
+        ParamsWrapper(const KoCompositeOp::ParameterInfo &params)
+        {
+            Q_UNUSED(params);
+        }
+    };
+
+    template<typename T>
+    static ALWAYS_INLINE T normalize(const T &value)
+    {
+        if constexpr (std::numeric_limits<channels_type>::is_integer) {
+            return value * T(1.0f / float(KoColorSpaceMathsTraits<channels_type>::unitValue));
+        } else {
+            return value;
+        }
+    }
+
+    template<typename T>
+    static ALWAYS_INLINE T denormalize(const T &value)
+    {
+        if constexpr (std::numeric_limits<channels_type>::is_integer) {
+            return value * T(float(KoColorSpaceMathsTraits<channels_type>::unitValue));
+        } else {
+            return value;
+        }
+    }
+
+    // \see docs in AlphaDarkenCompositor32
+    template<bool haveMask, bool src_aligned, typename _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const ParamsWrapper &oparams)
+    {
+        using float_v = typename KoStreamedMath<_impl>::float_v;
+        using float_m = typename float_v::batch_bool_type;
+
+        Q_UNUSED(oparams);
+
+        float_v src_alpha;
+        float_v dst_alpha;
+
+        float_v src_c1;
+        float_v src_c2;
+        float_v src_c3;
+
+        PixelWrapper<channels_type, _impl> dataWrapper;
+        dataWrapper.read(src, src_c1, src_c2, src_c3, src_alpha);
+
+        src_alpha *= float_v(opacity);
+
+        if (haveMask) {
+            const float_v uint8MaxRec1(1.0f / 255.0f);
+            src_alpha *= KoStreamedMath<_impl>::fetch_mask_8(mask) * uint8MaxRec1;
+        }
+
+        const float_v zeroValue(0.0f);
+        const float_v oneValue(1.0f);
+
+        // The generic op leaves the destination untouched for transparent
+        // source pixels, except for clearing the empty pixels when the
+        // alpha is locked, which we still have to do below
+        if (!alphaLocked && xsimd::all(src_alpha == zeroValue)) {
+            return;
+        }
+
+        float_v dst_c1;
+        float_v dst_c2;
+        float_v dst_c3;
+
+        dataWrapper.read(dst, dst_c1, dst_c2, dst_c3, dst_alpha);
+
+        src_c1 = normalize(src_c1);
+        src_c2 = normalize(src_c2);
+        src_c3 = normalize(src_c3);
+
+        dst_c1 = normalize(dst_c1);
+        dst_c2 = normalize(dst_c2);
+        dst_c3 = normalize(dst_c3);
+
+        const float_v blend_c1 = BlendFunction::blend(src_c1, dst_c1);
+        const float_v blend_c2 = BlendFunction::blend(src_c2, dst_c2);
+        const float_v blend_c3 = BlendFunction::blend(src_c3, dst_c3);
+
+        if (alphaLocked) {
+            const float_m empty_dst_pixels_mask = dst_alpha == zeroValue;
+
+            dst_c1 = xsimd::select(empty_dst_pixels_mask, zeroValue, src_alpha * (blend_c1 - dst_c1) + dst_c1);
+            dst_c2 = xsimd::select(empty_dst_pixels_mask, zeroValue, src_alpha * (blend_c2 - dst_c2) + dst_c2);
+            dst_c3 = xsimd::select(empty_dst_pixels_mask, zeroValue, src_alpha * (blend_c3 - dst_c3) + dst_c3);
+
+            dataWrapper.write(dst, denormalize(dst_c1), denormalize(dst_c2), denormalize(dst_c3), dst_alpha);
+        } else {
+            const float_v new_alpha = src_alpha + dst_alpha - src_alpha * dst_alpha;
+
+            /**
+             * The value of new_alpha can have *some* zero values,
+             * which will result in NaN values while division, so
+             * we keep the destination as it is for them.
+             */
+            const float_m empty_pixels_mask = new_alpha == zeroValue;
+
+            const float_v dst_only = dst_alpha * (oneValue - src_alpha);
+            const float_v src_only = src_alpha * (oneValue - dst_alpha);
+            const float_v both = src_alpha * dst_alpha;
+
+            dst_c1 = xsimd::select(empty_pixels_mask, dst_c1,
+                                   (dst_only * dst_c1 + src_only * src_c1 + both * blend_c1) / new_alpha);
+            dst_c2 = xsimd::select(empty_pixels_mask, dst_c2,
+                                   (dst_only * dst_c2 + src_only * src_c2 + both * blend_c2) / new_alpha);
+            dst_c3 = xsimd::select(empty_pixels_mask, dst_c3,
+                                   (dst_only * dst_c3 + src_only * src_c3 + both * blend_c3) / new_alpha);
+
+            dataWrapper.write(dst, denormalize(dst_c1), denormalize(dst_c2), denormalize(dst_c3), new_alpha);
+        }
+    }
+
+    template<bool haveMask, typename _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *src,
+                                                      quint8 *dst,
+                                                      const quint8 *mask,
+                                                      float opacity,
+                                                      const ParamsWrapper &oparams)
+    {
+        using Wrapper = PixelWrapper<channels_type, _impl>;
+        const qint32 alpha_pos = 3;
+
+        Q_UNUSED(oparams);
+
+        const auto *s = reinterpret_cast<const channels_type*>(src);
+        auto *d = reinterpret_cast<channels_type*>(dst);
+
+        float srcAlpha = s[alpha_pos];
+        Wrapper::normalizeAlpha(srcAlpha);
+        srcAlpha *= opacity;
+
+        if (haveMask) {
+            const float uint8Rec1 = 1.0f / 255.0f;
+            srcAlpha *= float(*mask) * uint8Rec1;
+        }
+
+        float dstAlpha = d[alpha_pos];
+        Wrapper::normalizeAlpha(dstAlpha);
+
+        if (alphaLocked) {
+            if (dstAlpha == 0.0f) {
+                KoStreamedMathFunctions::clearPixel<4 * sizeof(channels_type)>(dst);
+                return;
+            }
+
+            if (srcAlpha == 0.0f) {
+                return;
+            }
+
+            for (int i = 0; i < 3; i++) {
+                const float srcValue = normalize(float(s[i]));
+                const float dstValue = normalize(float(d[i]));
+                const float result = srcAlpha * (BlendFunction::blend(srcValue, dstValue) - dstValue) + dstValue;
+                d[i] = Wrapper::roundFloatToUint(denormalize(result));
+            }
+        } else {
+            if (srcAlpha == 0.0f) {
+                return;
+            }
+
+            const float newAlpha = srcAlpha + dstAlpha - srcAlpha * dstAlpha;
+
+            if (newAlpha != 0.0f) {
+                const float dstOnly = dstAlpha * (1.0f - srcAlpha);
+                const float srcOnly = srcAlpha * (1.0f - dstAlpha);
+                const float both = srcAlpha * dstAlpha;
+
+                for (int i = 0; i < 3; i++) {
+                    const float srcValue = normalize(float(s[i]));
+                    const float dstValue = normalize(float(d[i]));
+                    const float result =
+                        (dstOnly * dstValue + srcOnly * srcValue + both * BlendFunction::blend(srcValue, dstValue)) / newAlpha;
+                    d[i] = Wrapper::roundFloatToUint(denormalize(result));
+                }
+            }
+
+            float newAlphaDenorm = newAlpha;
+            Wrapper::denormalizeAlpha(newAlphaDenorm);
+            d[alpha_pos] = Wrapper::roundFloatToUint(newAlphaDenorm);
+        }
+    }
+};
+
+/**
+ * An optimized version of KoCompositeOpGenericSC for 4-channel colorspaces
+ * with alpha channel placed at the last position: C1_C2_C3_A. The case when
+ * all the color channels are enabled is vectorized, everything else falls
+ * back to the generic implementation.
+ */
+template<typename _impl, class Traits, class BlendFunction>
+class KoOptimizedCompositeOpGenericSC
+    : public KoCompositeOpGenericSC<Traits, BlendFunction::genericFunc, KoAdditiveBlendingPolicy<Traits>>
+{
+    using base_class = KoCompositeOpGenericSC<Traits, BlendFunction::genericFunc, KoAdditiveBlendingPolicy<Traits>>;
+    using channels_type = typename Traits::channels_type;
+
+    static_assert(Traits::channels_nb == 4 && Traits::alpha_pos == 3,
+                  "the optimized generic ops support C1_C2_C3_A pixels only");
+
+public:
+    KoOptimizedCompositeOpGenericSC(const KoColorSpace *cs, const QString &id, const QString &category)
+        : base_class(cs, id, category)
+    {
+    }
+
+    using base_class::composite;
+
+    void composite(const KoCompositeOp::ParameterInfo &params) const override
+    {
+        const QBitArray &flags = params.channelFlags;
+
+        const bool allColorChannelsFlag =
+            flags.isEmpty() || (flags.at(0) && flags.at(1) && flags.at(2));
+        const bool alphaLocked = !flags.isEmpty() && !flags.at(3);
+
+        if (!allColorChannelsFlag) {
+            base_class::composite(params);
+        } else if (params.maskRowStart) {
+            if (alphaLocked) {
+                composite<true, true>(params);
+            } else {
+                composite<true, false>(params);
+            }
+        } else {
+            if (alphaLocked) {
+                composite<false, true>(params);
+            } else {
+                composite<false, false>(params);
+            }
+        }
+    }
+
+    template<bool haveMask, bool alphaLocked>
+    inline void composite(const KoCompositeOp::ParameterInfo &params) const
+    {
+        KoStreamedMath<_impl>::template genericComposite<
+            haveMask,
+            false,
+            GenericSCCompositor128<channels_type, BlendFunction, alphaLocked>,
+            Traits::pixelSize>(params);
+    }
+};
+
+/**
+ * Creates an optimized version of the separable blend mode \p id, or
+ * returns nullptr if there is no vectorized implementation for it.
+ */
+template<typename _impl, class Traits>
+KoCompositeOp *createOptimizedGenericSCOp(const KoColorSpace *cs, const QString &id, const QString &category)
+{
+    using channels_type = typename Traits::channels_type;
+
+    if (id == COMPOSITE_MULT) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendMultiply<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_SCREEN) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendScreen<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_OVERLAY) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendOverlay<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_HARD_LIGHT) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendHardLight<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_SOFT_LIGHT_PHOTOSHOP) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendSoftLight<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_DODGE) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendColorDodge<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_BURN) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendColorBurn<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_HARD_MIX) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendHardMix<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_DARKEN) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendDarkenOnly<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_LIGHTEN) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendLightenOnly<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_ADD || id == COMPOSITE_LINEAR_DODGE) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendAddition<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_SUBTRACT) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendSubtract<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_DIFF) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendDifference<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_LINEAR_BURN) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendLinearBurn<channels_type>>(cs, id, category);
+    } else if (id == COMPOSITE_EXCLUSION) {
+        return new KoOptimizedCompositeOpGenericSC<_impl, Traits, KoOptimizedBlendExclusion<channels_type>>(cs, id, category);
+    }
+
+    return nullptr;
+}
+
+template<typename _impl>
+struct KoOptimizedCompositeOpGeneric32 {
+    static KoCompositeOp *create(const KoColorSpace *cs, const QString &id, const QString &category)
+    {
+        return createOptimizedGenericSCOp<_impl, KoBgrU8Traits>(cs, id, category);
+    }
+};
+
+template<typename _impl>
+struct KoOptimizedCompositeOpGenericU64 {
+    static KoCompositeOp *create(const KoColorSpace *cs, const QString &id, const QString &category)
+    {
+        return createOptimizedGenericSCOp<_impl, KoBgrU16Traits>(cs, id, category);
+    }
+};
+
+template<typename _impl>
+struct KoOptimizedCompositeOpGeneric128 {
+    static KoCompositeOp *create(const KoColorSpace *cs, const QString &id, const QString &category)
+    {
+        return createOptimizedGenericSCOp<_impl, KoRgbF32Traits>(cs, id, category);
+    }
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPGENERIC_H
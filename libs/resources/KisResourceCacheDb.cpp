@@ -9,6 +9,7 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QDirIterator>
+#include <QFileInfo>
 #include <QStringList>
 #include <QElapsedTimer>
 #include <QDataStream>
@@ -25,6 +26,7 @@
 
 #include "KisResourceLocator.h"
 #include "KisResourceLoaderRegistry.h"
+#include "KoMD5Generator.h"
 
 #include "ResourceDebug.h"
 #include <kis_assert.h>
@@ -60,6 +62,9 @@ QString changeToEmptyIfNull(QString s)
     return s.isNull() ? QString("") : s;
 }
 
+// the table_name of the storage manifests in the metadata table
+const QString storageManifestTable {"storage_manifest"};
+
 bool updateSchemaVersion()
 {
     QFile f(":/fill_version_information.sql");
@@ -1596,6 +1601,24 @@ bool KisResourceCacheDb::deleteStorage(QString location)
         }
     }
 
+    {
+        QSqlQuery q;
+        if (!q.prepare("DELETE FROM metadata\n"
+                       "WHERE table_name = :table\n"
+                       "AND   foreign_id = (SELECT storages.id\n"
+                       "                    FROM   storages\n"
+                       "                    WHERE  storages.location = :location);")) {
+            qWarning() << "Could not prepare delete storage manifest query" << q.lastError();
+            return false;
+        }
+        q.bindValue(":table", storageManifestTable);
+        q.bindValue(":location", changeToEmptyIfNull(location));
+        if (!q.exec()) {
+            qWarning() << "Could not execute delete storage manifest query" << q.lastError();
+            return false;
+        }
+    }
+
     {
         QSqlQuery q;
         if (!q.prepare("DELETE FROM storages\n"
@@ -1650,56 +1673,417 @@ QDebug operator<<(QDebug dbg, const ResourceVersion &ver)
 
     return dbg.space();
 }
-}
 
-bool KisResourceCacheDb::synchronizeStorage(KisResourceStorageSP storage)
+/// A stored manifest is only valid for the Krita version, schema and resource types it was made with
+QString storageManifestEnvironment()
 {
-    QElapsedTimer t;
-    t.start();
-
-    QSqlDatabase::database().transaction();
+    QStringList resourceTypes = KisResourceLoaderRegistry::instance()->resourceTypes();
+    resourceTypes.sort();
 
-    if (!s_valid) {
-        qWarning() << "KisResourceCacheDb::addResource: The database is not valid";
-        return false;
-    }
+    return QString("%1;%2;%3")
+            .arg(KritaVersionWrapper::versionString())
+            .arg(KisResourceCacheDb::databaseVersion)
+            .arg(resourceTypes.join(','));
+}
 
-    bool success = true;
+/// Returns the id of the storage in the database, or -1 if it is not there
+int storageIdForLocation(const QString &location, bool *ok)
+{
+    *ok = false;
 
-    // Find the storage in the database
     QSqlQuery q;
     if (!q.prepare("SELECT id\n"
-                   ",      timestamp\n"
-                   ",      pre_installed\n"
                    "FROM   storages\n"
                    "WHERE  location = :location\n")) {
-        qWarning() << "Could not prepare storage timestamp statement" << q.lastError();
+        qWarning() << "Could not prepare storage id statement" << q.lastError();
+        return -1;
     }
 
-    q.bindValue(":location", changeToEmptyIfNull(KisResourceLocator::instance()->makeStorageLocationRelative(storage->location())));
+    q.bindValue(":location", changeToEmptyIfNull(KisResourceLocator::instance()->makeStorageLocationRelative(location)));
     if (!q.exec()) {
-        qWarning() << "Could not execute storage timestamp statement" << q.boundValues() << q.lastError();
+        qWarning() << "Could not execute storage id statement" << q.boundValues() << q.lastError();
+        return -1;
     }
 
-    if (!q.first()) {
+    *ok = true;
+    return q.first() ? q.value(0).toInt() : -1;
+}
+
+/// Adds the path, modification time and size of every file below the folder to the listing
+void addFolderToListing(const QString &folder, QStringList &listing, qint64 &mtime, qint64 &size)
+{
+    QDirIterator it(folder, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+
+        listing << QString("%1 %2 %3").arg(it.filePath()).arg(modified).arg(info.size());
+        mtime = qMax(mtime, modified);
+        size += info.size();
+    }
+}
+}
+
+bool KisResourceCacheDb::setStorageManifest(int storageId, const StorageManifest &manifest)
+{
+    QSqlQuery q;
+    if (!q.prepare("DELETE FROM metadata\n"
+                   "WHERE  foreign_id = :id\n"
+                   "AND    table_name = :table\n")) {
+        qWarning() << "Could not prepare delete storage manifest query" << q.lastError();
+        return false;
+    }
+
+    q.bindValue(":id", storageId);
+    q.bindValue(":table", storageManifestTable);
+
+    if (!q.exec()) {
+        qWarning() << "Could not execute delete storage manifest query" << q.lastError();
+        return false;
+    }
+
+    QMap<QString, QVariant> map;
+    map["mtime"] = qlonglong(manifest.mtime);
+    map["size"] = qlonglong(manifest.size);
+    map["content_hash"] = manifest.contentHash;
+    map["environment"] = manifest.environment;
+
+    return addMetaDataForId(map, storageId, storageManifestTable);
+}
+
+KisResourceCacheDb::StorageScan KisResourceCacheDb::prepareStorageScan(KisResourceStorageSP storage)
+{
+    StorageScan scan;
+    scan.storage = storage;
+    scan.manifest.environment = storageManifestEnvironment();
+
+    Q_FOREACH(const QString &resourceType, KisResourceLoaderRegistry::instance()->resourceTypes()) {
+        scan.resources.insert(resourceType, QVector<QVector<StorageScan::Entry>>());
+    }
+
+    if (!s_valid) {
+        qWarning() << "KisResourceCacheDb::prepareStorageScan: The database is not valid";
+        scan.error = true;
+        return scan;
+    }
+
+    // Find the storage in the database
+    {
+        bool ok = false;
+        scan.storageId = storageIdForLocation(storage->location(), &ok);
+
+        if (!ok) {
+            scan.error = true;
+            return scan;
+        }
+
+        if (scan.storageId < 0) {
+            // This is a new storage, synchronizeStorage() will add it
+            return scan;
+        }
+
+        storage->setStorageId(scan.storageId);
+    }
+
+    const QMap<QString, QVariant> manifest = metaDataForId(scan.storageId, storageManifestTable);
+    scan.storedManifest.mtime = manifest.value("mtime").toLongLong();
+    scan.storedManifest.size = manifest.value("size").toLongLong();
+    scan.storedManifest.contentHash = manifest.value("content_hash").toString();
+    scan.storedManifest.environment = manifest.value("environment").toString();
+
+    // Let the worker know which versions are already in the database, so
+    // that it only hashes the new ones
+    {
+        QSqlQuery q;
+        q.setForwardOnly(true);
+        if (!q.prepare("SELECT resource_types.name\n"
+                       ",      versioned_resources.filename\n"
+                       "FROM   versioned_resources\n"
+                       ",      resources\n"
+                       ",      resource_types\n"
+                       "WHERE  resources.resource_type_id = resource_types.id\n"
+                       "AND    resources.id = versioned_resources.resource_id\n"
+                       "AND    versioned_resources.storage_id = :storage_id")) {
+            qWarning() << "Could not prepare known resources query" << q.lastError();
+            scan.error = true;
+            return scan;
+        }
+
+        q.bindValue(":storage_id", scan.storageId);
+
+        if (!q.exec()) {
+            qWarning() << "Could not execute known resources query" << q.boundValues() << q.lastError();
+            scan.error = true;
+            return scan;
+        }
+
+        while (q.next()) {
+            scan.knownUrls.insert(q.value(0).toString() + "/" + q.value(1).toString());
+        }
+    }
+
+    return scan;
+}
+
+void KisResourceCacheDb::scanStorage(StorageScan &scan)
+{
+    QElapsedTimer t;
+    t.start();
+
+    KisResourceStorageSP storage = scan.storage;
+
+    if (scan.error) {
+        scan.scanTime = t.elapsed();
+        return;
+    }
+
+    StorageManifest &manifest = scan.manifest;
+
+    switch (storage->type()) {
+    case KisResourceStorage::StorageType::Folder: {
+        // Only look at the resource folders: the database and the usage log
+        // may live in the same folder and change on every start
+        QStringList listing;
+        for (auto it = scan.resources.constBegin(); it != scan.resources.constEnd(); ++it) {
+            addFolderToListing(storage->location() + "/" + it.key(), listing, manifest.mtime, manifest.size);
+        }
+        listing.sort();
+        manifest.contentHash = KoMD5Generator::generateHash(listing.join('\n').toUtf8());
+        break;
+    }
+    case KisResourceStorage::StorageType::Bundle:
+    case KisResourceStorage::StorageType::AdobeBrushLibrary:
+    case KisResourceStorage::StorageType::AdobeStyleLibrary: {
+        const QFileInfo info(storage->location());
+        manifest.mtime = info.lastModified().toMSecsSinceEpoch();
+        manifest.size = info.size();
+
+        // The resources of a bundle that were modified by the user are saved next to it
+        QStringList listing;
+        if (storage->type() == KisResourceStorage::StorageType::Bundle) {
+            addFolderToListing(storage->location() + "_modified", listing, manifest.mtime, manifest.size);
+            listing.sort();
+        }
+
+        if (manifest.mtime == scan.storedManifest.mtime
+                && manifest.size == scan.storedManifest.size
+                && manifest.environment == scan.storedManifest.environment) {
+            // Hashing a large bundle is exactly what we want to avoid on every start
+            manifest.contentHash = scan.storedManifest.contentHash;
+        }
+        else {
+            manifest.contentHash = KoMD5Generator::generateHash(KoMD5Generator::generateHash(storage->location()).toLatin1()
+                                                                + listing.join('\n').toUtf8());
+        }
+        break;
+    }
+    default:
+        // Memory storages don't survive a restart, so they are always synchronized
+        break;
+    }
+
+    if (scan.storageId < 0) {
+        // A new storage is added as a whole, there is nothing to compare
+        scan.scanTime = t.elapsed();
+        return;
+    }
+
+    scan.unchanged = manifest.isValid()
+            && manifest.contentHash == scan.storedManifest.contentHash
+            && manifest.environment == scan.storedManifest.environment;
+
+    if (!scan.unchanged
+            && (storage->type() == KisResourceStorage::StorageType::Folder
+                || storage->type() == KisResourceStorage::StorageType::Bundle)) {
+
+        listStorageResources(scan, true);
+    }
+
+    scan.scanTime = t.elapsed();
+}
+
+void KisResourceCacheDb::listStorageResources(StorageScan &scan, bool hashNewVersions)
+{
+    KisResourceStorageSP storage = scan.storage;
+
+    /// We compare resource versions one-by-one because the storage may have multiple
+    /// versions of them, so collect all of them here
+
+    for (auto it = scan.resources.begin(); it != scan.resources.end(); ++it) {
+        QSharedPointer<KisResourceStorage::ResourceIterator> iter = storage->resources(it.key());
+        while (iter->hasNext()) {
+            iter->next();
+
+            QVector<StorageScan::Entry> versions;
+
+            QSharedPointer<KisResourceStorage::ResourceIterator> verIt = iter->versions();
+            while (verIt->hasNext()) {
+                verIt->next();
+
+                StorageScan::Entry entry;
+                entry.url = verIt->url();
+                entry.version = verIt->guessedVersion();
+
+                // we use lower precision than the normal QDateTime
+                entry.timestamp = QDateTime::fromSecsSinceEpoch(verIt->lastModified().toSecsSinceEpoch());
+
+                if (hashNewVersions && !scan.knownUrls.contains(QDir::fromNativeSeparators(entry.url))) {
+                    scan.md5Sums.insert(entry.url, storage->resourceMd5(entry.url));
+                }
+
+                versions.append(entry);
+            }
+
+            it.value().append(versions);
+        }
+    }
+
+    scan.listed = true;
+}
+
+bool KisResourceCacheDb::synchronizeStorage(const StorageScan &scan)
+{
+    if (!s_valid) {
+        qWarning() << "KisResourceCacheDb::synchronizeStorage: The database is not valid";
+        return false;
+    }
+
+    KisResourceStorageSP storage = scan.storage;
+
+    if (scan.error) {
+        qWarning() << "Could not read storage" << storage->location() << "from the database, skipping its synchronization";
+        return false;
+    }
+
+    if (scan.storageId < 0) {
         // This is a new storage, the user must have dropped it in the path before restarting Krita, so add it.
         debugResource << "Adding storage to the database:" << storage;
         if (!addStorage(storage, false)) {
             qWarning() << "Could not add new storage" << storage->name() << "to the database";
-            success = false;
+            return true;
         }
+
+        // Save the manifest, so that the storage is not scanned again on the next start
+        if (scan.manifest.isValid()) {
+            bool ok = false;
+            const int storageId = storageIdForLocation(storage->location(), &ok);
+
+            if (ok && storageId >= 0) {
+                storage->setStorageId(storageId);
+                setStorageManifest(storageId, scan.manifest);
+            }
+        }
+
         return true;
     }
 
-    storage->setStorageId(q.value("id").toInt());
+    if (scan.unchanged) {
+        // The contents are the same, but e.g. the bundle may have been touched
+        if (!(scan.manifest == scan.storedManifest)) {
+            setStorageManifest(scan.storageId, scan.manifest);
+        }
+        return true;
+    }
 
-    /// We compare resource versions one-by-one because the storage may have multiple
-    /// versions of them
+    if (!scan.listed) {
+        // The storages that are not listed by scanStorage() are listed here,
+        // in the thread that owns them
+        StorageScan listedScan = scan;
+        listStorageResources(listedScan, false);
+        return synchronizeStorage(listedScan);
+    }
 
-    Q_FOREACH(const QString &resourceType, KisResourceLoaderRegistry::instance()->resourceTypes()) {
+    QElapsedTimer t;
+    t.start();
+
+    QSqlDatabase::database().transaction();
+
+    /// Fetch the ids and versions of all the resources of the storage at once,
+    /// instead of querying them version by version
+
+    QHash<QString, int> resourceIds;
+    QHash<QString, int> versionedResourceIds;
+    QHash<QString, QVector<ResourceVersion>> versionsInDatabase;
+
+    {
+        QSqlQuery q;
+        q.setForwardOnly(true);
+        if (!q.prepare("SELECT resource_types.name\n"
+                       ",      resources.filename\n"
+                       ",      resources.id\n"
+                       "FROM   resources\n"
+                       ",      resource_types\n"
+                       "WHERE  resources.resource_type_id = resource_types.id\n"
+                       "AND    resources.storage_id = :storage_id")) {
+            qWarning() << "Could not prepare resources for storage query" << q.lastError();
+            QSqlDatabase::database().rollback();
+            return false;
+        }
+
+        q.bindValue(":storage_id", scan.storageId);
+
+        if (!q.exec()) {
+            qWarning() << "Could not exec resources for storage query" << q.boundValues() << q.lastError();
+            QSqlDatabase::database().rollback();
+            return false;
+        }
+
+        while (q.next()) {
+            resourceIds.insert(q.value(0).toString() + "/" + q.value(1).toString(), q.value(2).toInt());
+        }
+    }
+
+    {
+        QSqlQuery q;
+        q.setForwardOnly(true);
+        if (!q.prepare("SELECT resource_types.name\n"
+                       ",      versioned_resources.resource_id\n"
+                       ",      versioned_resources.filename\n"
+                       ",      versioned_resources.version\n"
+                       ",      versioned_resources.timestamp\n"
+                       "FROM   versioned_resources\n"
+                       ",      resource_types\n"
+                       ",      resources\n"
+                       "WHERE  resources.resource_type_id = resource_types.id\n"
+                       "AND    resources.id = versioned_resources.resource_id\n"
+                       "AND    versioned_resources.storage_id == :storage_id")) {
+            qWarning() << "Could not prepare versioned resources for storage query" << q.lastError();
+            QSqlDatabase::database().rollback();
+            return false;
+        }
+
+        q.bindValue(":storage_id", scan.storageId);
+
+        if (!q.exec()) {
+            qWarning() << "Could not exec versioned resources for storage query" << q.boundValues() << q.lastError();
+            QSqlDatabase::database().rollback();
+            return false;
+        }
 
-        /// Firstly, fetch information about the existing resources
-        /// in the storage
+        while (q.next()) {
+            const QString resourceType = q.value(0).toString();
+
+            ResourceVersion item;
+            item.url = resourceType + "/" + q.value(2).toString();
+            item.version = q.value(3).toInt();
+            item.timestamp = QDateTime::fromSecsSinceEpoch(q.value(4).toInt());
+            item.resourceId = q.value(1).toInt();
+
+            versionedResourceIds.insert(item.url, item.resourceId);
+            versionsInDatabase[resourceType].append(item);
+        }
+    }
+
+    auto md5ForUrl = [&scan, storage] (const QString &url) {
+        auto it = scan.md5Sums.constFind(url);
+        return it != scan.md5Sums.constEnd() ? *it : storage->resourceMd5(url);
+    };
+
+    for (auto typeIt = scan.resources.constBegin(); typeIt != scan.resources.constEnd(); ++typeIt) {
+        const QString &resourceType = typeIt.key();
+
+        /// Firstly, assign the database ids to the resources found in the storage
 
         QVector<ResourceVersion> resourcesInStorage;
 
@@ -1709,37 +2093,29 @@ bool KisResourceCacheDb::synchronizeStorage(KisResourceStorageSP storage)
 
         int nextInexistentResourceId = std::numeric_limits<int>::min();
 
-        QSharedPointer<KisResourceStorage::ResourceIterator> iter = storage->resources(resourceType);
-        while (iter->hasNext()) {
-            iter->next();
+        Q_FOREACH(const QVector<StorageScan::Entry> &versions, typeIt.value()) {
 
             const int firstResourceVersionPosition = resourcesInStorage.size();
 
             int detectedResourceId = nextInexistentResourceId;
-            QSharedPointer<KisResourceStorage::ResourceIterator> verIt =
-                    iter->versions();
 
-            while (verIt->hasNext()) {
-                verIt->next();
+            Q_FOREACH(const StorageScan::Entry &entry, versions) {
 
-                // verIt->url() contains paths like "brushes/ink.png" or "brushes/subfolder/splash.png".
+                // entry.url contains paths like "brushes/ink.png" or "brushes/subfolder/splash.png".
                 // we need to cut off the first part and get "ink.png" in the first case,
                 // but "subfolder/splash.png" in the second case in order for subfolders to work
-                // so it cannot just use QFileInfo(verIt->url()).fileName() here.
-                QString path = QDir::fromNativeSeparators(verIt->url()); // make sure it uses Unix separators
+                // so it cannot just use QFileInfo(entry.url).fileName() here.
+                QString path = QDir::fromNativeSeparators(entry.url); // make sure it uses Unix separators
                 int folderEndIdx = path.indexOf("/");
-                QString properFilenameWithSubfolders = path.right(path.length() - folderEndIdx - 1);
-                int id = resourceIdForResource(properFilenameWithSubfolders,
-                                               verIt->type(),
-                                               KisResourceLocator::instance()->makeStorageLocationRelative(storage->location()));
-
-                ResourceVersion item;
-                item.url = verIt->url();
-                item.version = verIt->guessedVersion();
+                const QString key = resourceType + "/" + path.right(path.length() - folderEndIdx - 1);
 
-                // we use lower precision than the normal QDateTime
-                item.timestamp = QDateTime::fromSecsSinceEpoch(verIt->lastModified().toSecsSinceEpoch());
+                // same lookup order as resourceIdForResource()
+                const int id = resourceIds.value(key, versionedResourceIds.value(key, -1));
 
+                ResourceVersion item;
+                item.url = entry.url;
+                item.version = entry.version;
+                item.timestamp = entry.timestamp;
                 item.resourceId = id;
 
                 if (detectedResourceId < 0 && id >= 0) {
@@ -1762,44 +2138,9 @@ bool KisResourceCacheDb::synchronizeStorage(KisResourceStorageSP storage)
             nextInexistentResourceId++;
         }
 
+        /// Secondly, take the resources present in the database
 
-        /// Secondly, fetch the resources present in the database
-
-        QVector<ResourceVersion> resourcesInDatabase;
-
-        QSqlQuery q;
-        q.setForwardOnly(true);
-        if (!q.prepare("SELECT versioned_resources.resource_id, versioned_resources.filename, versioned_resources.version, versioned_resources.timestamp\n"
-                       "FROM   versioned_resources\n"
-                       ",      resource_types\n"
-                       ",      resources\n"
-                       "WHERE  resources.resource_type_id = resource_types.id\n"
-                       "AND    resources.id = versioned_resources.resource_id\n"
-                       "AND    resource_types.name = :resource_type\n"
-                       "AND    versioned_resources.storage_id == :storage_id")) {
-            qWarning() << "Could not prepare resource by type query" << q.lastError();
-            success = false;
-            continue;
-        }
-
-        q.bindValue(":resource_type", resourceType);
-        q.bindValue(":storage_id", int(storage->storageId()));
-
-        if (!q.exec()) {
-            qWarning() << "Could not exec resource by type query" << q.boundValues() << q.lastError();
-            success = false;
-            continue;
-        }
-
-        while (q.next()) {
-            ResourceVersion item;
-            item.url = resourceType + "/" + q.value(1).toString();
-            item.version = q.value(2).toInt();
-            item.timestamp = QDateTime::fromSecsSinceEpoch(q.value(3).toInt());
-            item.resourceId = q.value(0).toInt();
-
-            resourcesInDatabase.append(item);
-        }
+        QVector<ResourceVersion> resourcesInDatabase = versionsInDatabase.value(resourceType);
 
         QSet<int> resourceIdForUpdate;
 
@@ -1828,7 +2169,7 @@ bool KisResourceCacheDb::synchronizeStorage(KisResourceStorageSP storage)
             }
 
             res->setVersion(itA->version);
-            res->setMD5Sum(storage->resourceMd5(itA->url));
+            res->setMD5Sum(md5ForUrl(itA->url));
             if (!res->valid()) {
                 KisUsageLogger::log("Could not retrieve md5 for resource " + itA->url);
                 ++itA;
@@ -1853,7 +2194,7 @@ bool KisResourceCacheDb::synchronizeStorage(KisResourceStorageSP storage)
             for (auto it = std::next(itA); it != nextResource; ++it) {
                 KoResourceSP res = storage->resource(it->url);
                 res->setVersion(it->version);
-                res->setMD5Sum(storage->resourceMd5(it->url));
+                res->setMD5Sum(md5ForUrl(it->url));
                 if (!res->valid()) {
                     continue;
                 }
@@ -1885,7 +2226,7 @@ bool KisResourceCacheDb::synchronizeStorage(KisResourceStorageSP storage)
                 KoResourceSP res = storage->resource(itA->url);
                 if (res) {
                     res->setVersion(itA->version);
-                    res->setMD5Sum(storage->resourceMd5(itA->url));
+                    res->setMD5Sum(md5ForUrl(itA->url));
 
                     const bool result = addResourceVersionImpl(itA->resourceId, itA->timestamp, storage, res);
                     KIS_SAFE_ASSERT_RECOVER_NOOP(result);
@@ -1920,10 +2261,22 @@ bool KisResourceCacheDb::synchronizeStorage(KisResourceStorageSP storage)
         }
     }
 
+    if (scan.manifest.isValid()) {
+        // Written in the same transaction, so that an interrupted synchronization is redone on the next start
+        setStorageManifest(scan.storageId, scan.manifest);
+    }
+
     QSqlDatabase::database().commit();
     debugResource << "Synchronizing the storages took" << t.elapsed() << "milliseconds for" << storage->location();
 
-    return success;
+    return true;
+}
+
+bool KisResourceCacheDb::synchronizeStorage(KisResourceStorageSP storage)
+{
+    StorageScan scan = prepareStorageScan(storage);
+    scanStorage(scan);
+    return synchronizeStorage(scan);
 }
 
 void KisResourceCacheDb::deleteTemporaryResources()
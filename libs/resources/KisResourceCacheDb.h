@@ -8,6 +8,11 @@
 #define KISRESOURCECACHEDB_H
 
 #include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QVector>
 
 #include <kritaresources_export.h>
 
@@ -122,6 +127,76 @@ private:
     /// Actually delete the storage and all its resources from the database (i.e., nothing is set to inactive, it's deleted)
     ///  location - relative
     static bool deleteStorage(QString location);
+
+    /**
+     * @brief The StorageManifest struct is a fingerprint of the contents of a
+     * storage. It is saved in the metadata table after every synchronization,
+     * so that storages that haven't changed since then can be skipped.
+     */
+    struct StorageManifest {
+        qint64 mtime {0}; ///< the latest modification time of the files of the storage, in msecs
+        qint64 size {0}; ///< the total size of the files of the storage
+        QString contentHash; ///< md5 of the storage file, or of the file listing of a folder storage
+        QString environment; ///< the Krita version and resource types the storage was synchronized with
+
+        bool isValid() const {
+            return !contentHash.isEmpty();
+        }
+
+        bool operator==(const StorageManifest &rhs) const {
+            return mtime == rhs.mtime
+                    && size == rhs.size
+                    && contentHash == rhs.contentHash
+                    && environment == rhs.environment;
+        }
+    };
+
+    /**
+     * @brief The StorageScan struct carries a storage through the three
+     * phases of the synchronization: prepareStorageScan() reads what the
+     * database knows about the storage, scanStorage() walks and hashes the
+     * storage and synchronizeStorage() writes the differences to the database.
+     */
+    struct StorageScan {
+        struct Entry {
+            QString url;
+            int version {-1};
+            QDateTime timestamp;
+        };
+
+        KisResourceStorageSP storage;
+        int storageId {-1}; ///< -1 if the storage is not in the database yet
+        bool error {false}; ///< the database could not be read, so the storage must not be synchronized
+        StorageManifest storedManifest;
+        QSet<QString> knownUrls; ///< the urls of the versions the database has for this storage
+
+        StorageManifest manifest;
+        bool unchanged {false};
+        bool listed {false}; ///< false if the resources are left to be listed by synchronizeStorage()
+        QMap<QString, QVector<QVector<Entry>>> resources; ///< the versions of every resource found in the storage, by resource type
+        QHash<QString, QString> md5Sums; ///< the md5 sums of the versions that are not in the database
+        qint64 scanTime {0};
+    };
+
+    /// Replaces the stored manifest of the storage; doesn't start a transaction of its own
+    static bool setStorageManifest(int storageId, const StorageManifest &manifest);
+
+    /// Reads the stored manifest and the known resources of the storage; must be called from the thread that owns the database connection
+    static StorageScan prepareStorageScan(KisResourceStorageSP storage);
+
+    /**
+     * Fingerprints the storage and, if it has changed, lists and hashes its
+     * resources; doesn't touch the database, so it can run in a worker thread.
+     * Only folders and bundles are listed here: the other storages parse the
+     * whole file to list their resources, which is left to synchronizeStorage().
+     */
+    static void scanStorage(StorageScan &scan);
+
+    /// Collects the versions of all the resources of the storage and, if \p hashNewVersions is true, the md5 sums of the versions the database doesn't know yet
+    static void listStorageResources(StorageScan &scan, bool hashNewVersions);
+
+    /// Writes the differences found by scanStorage() to the database in a single transaction
+    static bool synchronizeStorage(const StorageScan &scan);
     static bool synchronizeStorage(KisResourceStorageSP storage);
 
     /**
@@ -18,6 +18,7 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QBuffer>
+#include <QtConcurrent>
 
 #include <kconfig.h>
 #include <kconfiggroup.h>
@@ -1161,12 +1162,51 @@ bool KisResourceLocator::synchronizeDb()
 
 
     findStorages();
+
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    // The database connection belongs to this thread, so only walking and
+    // hashing the storages happens in the worker threads
+    QVector<KisResourceCacheDb::StorageScan> scans;
     Q_FOREACH(const KisResourceStorageSP storage, d->storages) {
-        if (!KisResourceCacheDb::synchronizeStorage(storage)) {
-            d->errorMessages.append(i18n("Could not synchronize %1 with the database", storage->location()));
+        scans << KisResourceCacheDb::prepareStorageScan(storage);
+    }
+
+    QtConcurrent::blockingMap(scans, [] (KisResourceCacheDb::StorageScan &scan) {
+        KisResourceCacheDb::scanStorage(scan);
+    });
+
+    int skippedStorages = 0;
+
+    Q_FOREACH(const KisResourceCacheDb::StorageScan &scan, scans) {
+        QElapsedTimer t;
+        t.start();
+
+        if (!KisResourceCacheDb::synchronizeStorage(scan)) {
+            d->errorMessages.append(i18n("Could not synchronize %1 with the database", scan.storage->location()));
+        }
+
+        if (scan.unchanged) {
+            skippedStorages++;
+            KisUsageLogger::log(QString("Storage %1 is unchanged, skipped synchronization (scanning took %2 ms)")
+                                .arg(scan.storage->location())
+                                .arg(scan.scanTime));
+        }
+        else {
+            KisUsageLogger::log(QString("Synchronized storage %1 in %2 ms (scanning took %3 ms, updating the database %4 ms)")
+                                .arg(scan.storage->location())
+                                .arg(scan.scanTime + t.elapsed())
+                                .arg(scan.scanTime)
+                                .arg(t.elapsed()));
         }
     }
 
+    KisUsageLogger::log(QString("Synchronized %1 storages (%2 unchanged) in %3 ms")
+                        .arg(scans.size())
+                        .arg(skippedStorages)
+                        .arg(totalTimer.elapsed()));
+
     Q_FOREACH(const KisResourceStorageSP storage, d->storages) {
         if (!KisResourceCacheDb::addStorageTags(storage)) {
             d->errorMessages.append(i18n("Could not synchronize %1 with the database", storage->location()));
@@ -9,6 +9,7 @@
 #include <simpletest.h>
 #include <QVersionNumber>
 #include <QDirIterator>
+#include <QTemporaryDir>
 #include <QSqlError>
 #include <QSqlQuery>
 
@@ -113,6 +114,100 @@ void TestResourceLocator::testLocatorSynchronization()
     }
 }
 
+void TestResourceLocator::testStorageManifest()
+{
+    KisResourceStorageSP storage;
+    Q_FOREACH(KisResourceStorageSP s, m_locator->storages()) {
+        if (s->type() == KisResourceStorage::StorageType::Folder) {
+            storage = s;
+        }
+    }
+    QVERIFY(storage);
+
+    // The manifest was saved by the synchronization in testLocatorSynchronization
+    {
+        KisResourceCacheDb::StorageScan scan = KisResourceCacheDb::prepareStorageScan(storage);
+        QVERIFY(scan.storageId >= 0);
+        QVERIFY(scan.storedManifest.isValid());
+
+        KisResourceCacheDb::scanStorage(scan);
+        QVERIFY(scan.unchanged);
+        QVERIFY(scan.md5Sums.isEmpty());
+    }
+
+    // Any new file makes the storage synchronize again
+    QFile f(storage->location() + "/" + ResourceType::PaintOpPresets + "/manifest_test.txt");
+    QVERIFY(f.open(QFile::WriteOnly));
+    f.write("test");
+    f.close();
+
+    {
+        KisResourceCacheDb::StorageScan scan = KisResourceCacheDb::prepareStorageScan(storage);
+        KisResourceCacheDb::scanStorage(scan);
+        QVERIFY(!scan.unchanged);
+        QVERIFY(KisResourceCacheDb::synchronizeStorage(scan));
+    }
+
+    {
+        KisResourceCacheDb::StorageScan scan = KisResourceCacheDb::prepareStorageScan(storage);
+        KisResourceCacheDb::scanStorage(scan);
+        QVERIFY(scan.unchanged);
+    }
+
+    QVERIFY(f.remove());
+    QVERIFY(m_locator->synchronizeDb());
+}
+
+void TestResourceLocator::testNewStorageManifest()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString bundlePath = dir.path() + "/manifest_test.bundle";
+    QVERIFY(QFile::copy(m_srcLocation + "/bundles/test1.bundle", bundlePath));
+
+    KisResourceStorageSP storage = QSharedPointer<KisResourceStorage>::create(bundlePath);
+    QVERIFY(storage->valid());
+
+    {
+        KisResourceCacheDb::StorageScan scan = KisResourceCacheDb::prepareStorageScan(storage);
+        QVERIFY(!scan.error);
+        QCOMPARE(scan.storageId, -1);
+
+        KisResourceCacheDb::scanStorage(scan);
+        QVERIFY(scan.manifest.isValid());
+        QVERIFY(KisResourceCacheDb::synchronizeStorage(scan));
+    }
+
+    // The storage added by the synchronization has its manifest saved
+    {
+        KisResourceCacheDb::StorageScan scan = KisResourceCacheDb::prepareStorageScan(storage);
+        QVERIFY(scan.storageId >= 0);
+        QVERIFY(scan.storedManifest.isValid());
+
+        KisResourceCacheDb::scanStorage(scan);
+        QVERIFY(scan.unchanged);
+    }
+
+    QVERIFY(KisResourceCacheDb::deleteStorage(storage));
+}
+
+void TestResourceLocator::testMemoryStorageListedOnSynchronization()
+{
+    KisResourceStorageSP storage = m_locator->storageByLocation("memory");
+    QVERIFY(storage);
+
+    KisResourceCacheDb::StorageScan scan = KisResourceCacheDb::prepareStorageScan(storage);
+    KisResourceCacheDb::scanStorage(scan);
+
+    // Only folders and bundles are listed by the worker threads
+    QVERIFY(!scan.unchanged);
+    QVERIFY(!scan.listed);
+    QVERIFY(scan.md5Sums.isEmpty());
+
+    QVERIFY(KisResourceCacheDb::synchronizeStorage(scan));
+}
+
 void TestResourceLocator::testResourceLocationBase()
 {
     QCOMPARE(m_locator->resourceLocationBase(), m_dstLocation);
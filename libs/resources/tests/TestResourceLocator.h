@@ -20,6 +20,9 @@ private Q_SLOTS:
     void testLocatorInitialization();
     void testStorageInitialization();
     void testLocatorSynchronization();
+    void testStorageManifest();
+    void testNewStorageManifest();
+    void testMemoryStorageListedOnSynchronization();
 
     void testResourceLocationBase();
     void testResource();
@@ -89,6 +89,8 @@
 
 #include "kis_wrapped_rect.h"
 #include "kis_algebra_2d.h"
+#include "kis_paint_device.h"
+#include "kis_datamanager.h"
 #include "kis_image_signal_router.h"
 
 #include "KisSnapPixelStrategy.h"
@@ -324,6 +326,7 @@ void KisCanvas2::initializeFpsDecoration()
 
 KisCanvas2::~KisCanvas2()
 {
+    KisTiledDataManager::endSwapHint(this);
     delete m_d;
 }
 
@@ -1109,6 +1112,35 @@ void KisCanvas2::slotUpdateRegionOfInterest()
     if (m_d->regionOfInterest != oldRegionOfInterest) {
         emit sigRegionOfInterestChanged(m_d->regionOfInterest);
     }
+
+    /**
+     * Tell the tile swapper what the user is looking at: the visible
+     * tiles of the projection and of the active layer are kept in
+     * memory, and the ones within the region of interest are loaded
+     * back from the swap file in the background.
+     */
+    KisImageSP image = this->image();
+    if (image && m_d->view) {
+        const QRect visibleRect =
+            m_d->coordinatesConverter->widgetRectInImagePixels().toAlignedRect() & imageRect;
+        const int pinEpoch = KisTiledDataManager::beginSwapHint(this);
+
+        auto hintDevice = [&] (KisPaintDeviceSP device) {
+            const QPoint offset(device->x(), device->y());
+            device->dataManager()->applySwapHint(pinEpoch,
+                                                 visibleRect.translated(-offset),
+                                                 m_d->regionOfInterest.translated(-offset));
+        };
+
+        KisPaintDeviceSP projection = image->projection();
+        hintDevice(projection);
+
+        KisNodeSP node = m_d->view->currentNode();
+        KisPaintDeviceSP device = node ? node->paintDevice() : KisPaintDeviceSP();
+        if (device && device != projection) {
+            hintDevice(device);
+        }
+    }
 }
 
 void KisCanvas2::slotReferenceImagesChanged()
@@ -10,6 +10,7 @@
 #include <QMutexLocker>
 
 #include <KoShapeManager.h>
+#include <KoShapeRasterCache.h>
 #include <KoSelectedShapesProxySimple.h>
 #include <KoViewConverter.h>
 #include <KoColorSpace.h>
@@ -23,6 +24,7 @@
 #include <KoSelection.h>
 #include <KoUnit.h>
 #include "kis_image_view_converter.h"
+#include "kis_image_config.h"
 
 #include <kis_debug.h>
 
@@ -36,6 +38,22 @@
 #include "kis_default_bounds.h"
 #include "kis_do_something_command.h"
 
+namespace {
+
+/**
+ * The budget of the raster cache is shared by all the shape layers, a zero
+ * budget disables the cache and frees the images that are already cached
+ */
+void setupRasterCache(KoShapeManager *shapeManager)
+{
+    KisImageConfig cfg(true);
+    const qint64 limit = qMax(0, cfg.shapeRasterCacheLimit());
+
+    KoShapeRasterCache::instance()->setMemoryLimit(limit * 1024 * 1024);
+    shapeManager->setRasterCacheEnabled(limit > 0);
+}
+
+}
 
 KisShapeLayerCanvasBase::KisShapeLayerCanvasBase(KisShapeLayer *parent)
     : KoCanvasBase(0)
@@ -44,6 +62,7 @@ KisShapeLayerCanvasBase::KisShapeLayerCanvasBase(KisShapeLayer *parent)
     , m_viewConverter()
 {
     m_shapeManager->selection()->setActiveLayer(parent);
+    setupRasterCache(m_shapeManager.data());
 }
 
 KisShapeLayerCanvasBase::KisShapeLayerCanvasBase(const KisShapeLayerCanvasBase &rhs, KisShapeLayer *parent)
@@ -54,6 +73,7 @@ KisShapeLayerCanvasBase::KisShapeLayerCanvasBase(const KisShapeLayerCanvasBase &
 {
     m_viewConverter.setImage(nullptr);
     m_shapeManager->selection()->setActiveLayer(parent);
+    setupRasterCache(m_shapeManager.data());
 }
 
 void KisShapeLayerCanvasBase::setImage(KisImageWSP image)
@@ -219,7 +239,7 @@ public:
     }
 
     void run() override {
-        m_canvas->repaint();
+        m_canvas->repaint(this);
     }
 
     int levelOfDetail() const override {
@@ -399,7 +419,7 @@ void KisShapeLayerCanvas::slotImageSizeChanged()
     m_cachedImageRect = m_image->bounds();
 }
 
-void KisShapeLayerCanvas::repaint()
+void KisShapeLayerCanvas::repaint(KisSpontaneousJob *job)
 {
 
     KoShapeManager::PaintJobsOrder paintJobsOrder;
@@ -418,77 +438,89 @@ void KisShapeLayerCanvas::repaint()
     const qint32 MASK_IMAGE_WIDTH = 256;
     const qint32 MASK_IMAGE_HEIGHT = 256;
 
-    QImage image(MASK_IMAGE_WIDTH, MASK_IMAGE_HEIGHT, QImage::Format_ARGB32);
-    QPainter tempPainter(&image);
-
-    if(m_parentLayer->antialiased()) {
-        tempPainter.setRenderHint(QPainter::Antialiasing);
-        tempPainter.setRenderHint(QPainter::TextAntialiasing);
-    }
-
-    quint8 * dstData = new quint8[MASK_IMAGE_WIDTH * MASK_IMAGE_HEIGHT * m_projection->pixelSize()];
-
     QRect repaintRect = paintJobsOrder.uncroppedViewUpdateRect;
     m_projection->clear(repaintRect);
 
-    Q_FOREACH (const KoShapeManager::PaintJob &job, paintJobsOrder.jobs) {
-        if (job.isEmpty()) {
-            m_projection->clear(job.viewUpdateRect);
+    QVector<const KoShapeManager::PaintJob*> renderJobs;
+
+    for (const KoShapeManager::PaintJob &paintJob : std::as_const(paintJobsOrder.jobs)) {
+        if (paintJob.isEmpty()) {
+            m_projection->clear(paintJob.viewUpdateRect);
             continue;
         }
 
-        KIS_SAFE_ASSERT_RECOVER(job.viewUpdateRect.width() <= MASK_IMAGE_WIDTH &&
-                                job.viewUpdateRect.height() <= MASK_IMAGE_HEIGHT) {
+        KIS_SAFE_ASSERT_RECOVER(paintJob.viewUpdateRect.width() <= MASK_IMAGE_WIDTH &&
+                                paintJob.viewUpdateRect.height() <= MASK_IMAGE_HEIGHT) {
             continue;
         }
 
-        image.fill(0);
+        renderJobs << &paintJob;
+        repaintRect |= paintJob.viewUpdateRect;
+    }
 
-        tempPainter.setTransform(QTransform());
-        tempPainter.setClipRect(QRect(0,0,job.viewUpdateRect.width(), job.viewUpdateRect.height()));
-        tempPainter.setTransform(viewConverter()->documentToView() *
-                                 QTransform::fromTranslate(-job.viewUpdateRect.x(), -job.viewUpdateRect.y()));
+    /**
+     * The paint jobs are rendered in batches, which the idle threads of
+     * the update scheduler may steal from us. Every batch has its own
+     * QImage/QPainter pair. The jobs are distributed over the batches
+     * in round-robin manner, so that the dense areas of the layer are
+     * shared between the threads.
+     *
+     * The shapes of the jobs are shallow copies made in the GUI thread
+     * (see a comment in slotStartAsyncRepaint()), and paintJob() only
+     * reads them, so the jobs can be rendered concurrently.
+     */
+    const int numBatches = qMin(renderJobs.size(), 2 * job->subtasksConcurrency());
+    const QTransform documentToView = viewConverter()->documentToView();
+    const bool antialiased = m_parentLayer->antialiased();
+    const KoColorSpace *dstColorSpace = m_projection->colorSpace();
+
+    QVector<std::function<void()>> subtasks;
+
+    for (int batch = 0; batch < numBatches; batch++) {
+        subtasks << [this, batch, numBatches, &renderJobs, documentToView, antialiased, dstColorSpace] () {
+            QVector<quint8> imageData(MASK_IMAGE_WIDTH * MASK_IMAGE_HEIGHT * 4);
+            QVector<quint8> dstData(MASK_IMAGE_WIDTH * MASK_IMAGE_HEIGHT * dstColorSpace->pixelSize());
+
+            for (int i = batch; i < renderJobs.size(); i += numBatches) {
+                const KoShapeManager::PaintJob &paintJob = *renderJobs[i];
+                const QRect &rc = paintJob.viewUpdateRect;
 
-        m_shapeManager->paintJob(tempPainter, job);
+                /**
+                 * The image is packed tightly, so that the whole tile could
+                 * be converted and written into the projection at once
+                 */
+                QImage image(imageData.data(), rc.width(), rc.height(),
+                             4 * rc.width(), QImage::Format_ARGB32);
+                image.fill(0);
 
-        if (image.size() != job.viewUpdateRect.size()) {
-            const quint8 *imagePtr = image.constBits();
-            const int imageRowStride = 4 * image.width();
+                {
+                    QPainter tempPainter(&image);
 
-            for (int y = 0; y < job.viewUpdateRect.height(); y++) {
+                    if (antialiased) {
+                        tempPainter.setRenderHint(QPainter::Antialiasing);
+                        tempPainter.setRenderHint(QPainter::TextAntialiasing);
+                    }
+
+                    tempPainter.setClipRect(QRect(QPoint(), rc.size()));
+                    tempPainter.setTransform(documentToView *
+                                             QTransform::fromTranslate(-rc.x(), -rc.y()));
+
+                    m_shapeManager->paintJob(tempPainter, paintJob);
+                }
 
                 KoColorSpaceRegistry::instance()->rgb8()
-                        ->convertPixelsTo(imagePtr, dstData, m_projection->colorSpace(),
-                                          job.viewUpdateRect.width(),
+                        ->convertPixelsTo(image.constBits(), dstData.data(), dstColorSpace,
+                                          rc.width() * rc.height(),
                                           KoColorConversionTransformation::internalRenderingIntent(),
                                           KoColorConversionTransformation::internalConversionFlags());
 
-                m_projection->writeBytes(dstData,
-                                         job.viewUpdateRect.x(),
-                                         job.viewUpdateRect.y() + y,
-                                         job.viewUpdateRect.width(),
-                                         1);
-
-                imagePtr += imageRowStride;
+                m_projection->writeBytes(dstData.constData(), rc);
             }
-        } else {
-            KoColorSpaceRegistry::instance()->rgb8()
-                    ->convertPixelsTo(image.constBits(), dstData, m_projection->colorSpace(),
-                                      MASK_IMAGE_WIDTH * MASK_IMAGE_HEIGHT,
-                                      KoColorConversionTransformation::internalRenderingIntent(),
-                                      KoColorConversionTransformation::internalConversionFlags());
-
-            m_projection->writeBytes(dstData,
-                                     job.viewUpdateRect.x(),
-                                     job.viewUpdateRect.y(),
-                                     MASK_IMAGE_WIDTH,
-                                     MASK_IMAGE_HEIGHT);
-
-        }
-        repaintRect |= job.viewUpdateRect;
+        };
     }
 
-    delete[] dstData;
+    job->runSubtasks(subtasks);
+
     m_projection->purgeDefaultPixels();
     m_parentLayer->setDirty(repaintRect);
 
@@ -20,6 +20,8 @@
 #include "kis_default_bounds_base.h"
 #include "KoColorConversionTransformation.h"
 
+class KisSpontaneousJob;
+
 class KoColorProfile;
 class KoShapeManager;
 class KoToolProxy;
@@ -106,11 +108,12 @@ public:
 
 private Q_SLOTS:
     friend class KisRepaintShapeLayerLayerJob;
-    void repaint();
     void slotStartAsyncRepaint();
     void slotImageSizeChanged();
 
 private:
+    void repaint(KisSpontaneousJob *job);
+
     KisPaintDeviceSP m_projection;
     KisShapeLayer *m_parentLayer {0};
 
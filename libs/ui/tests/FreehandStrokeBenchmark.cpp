@@ -254,4 +254,14 @@ void FreehandStrokeBenchmark::testColorsmudgeLightness_smear_new_nsa_ptoverwrite
     benchmarkBrushUnthreaded("testing_200px_colorsmudge_lightness_smearing_new_nsa_ptoverwrite.kpp");
 }
 
+void FreehandStrokeBenchmark::testColorsmudgeDefaultTip_smear_new_sa_threaded()
+{
+    benchmarkBrush("testing_200px_colorsmudge_default_smearing_new_sa.kpp");
+}
+
+void FreehandStrokeBenchmark::testColorsmudgeLightness_smear_new_nsa_ptoverlay_threaded()
+{
+    benchmarkBrush("testing_200px_colorsmudge_lightness_smearing_new_nsa_ptoverlay.kpp");
+}
+
 KISTEST_MAIN(FreehandStrokeBenchmark)
@@ -43,6 +43,9 @@ private Q_SLOTS:
     void testColorsmudgeLightness_smear_new_nsa_nopt();
     void testColorsmudgeLightness_smear_new_nsa_ptoverlay();
     void testColorsmudgeLightness_smear_new_nsa_ptoverwrite();
+
+    void testColorsmudgeDefaultTip_smear_new_sa_threaded();
+    void testColorsmudgeLightness_smear_new_nsa_ptoverlay_threaded();
 };
 
 #endif // FREEHANDSTROKEBENCHMARK_H
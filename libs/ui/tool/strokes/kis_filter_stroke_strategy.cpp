@@ -19,6 +19,7 @@
 #include "kis_image_config.h"
 #include "kis_image_animation_interface.h"
 #include "kis_painter.h"
+#include "kis_convolution_painter.h"
 #include "KisAnimAutoKey.h"
 #include <commands_new/KisDisableDirtyRequestsCommand.h>
 
@@ -361,11 +362,14 @@ void KisFilterStrokeStrategy::cancelStrokeCallback()
     }
 
     addMutatedJobs(jobs);
+
+    KisConvolutionPainter::releaseCachedKernels();
 }
 
 void KisFilterStrokeStrategy::finishStrokeCallback()
 {
     KisStrokeStrategyUndoCommandBased::finishStrokeCallback();
+    KisConvolutionPainter::releaseCachedKernels();
 }
 
 KisStrokeStrategy* KisFilterStrokeStrategy::createLodClone(int levelOfDetail)
@@ -48,6 +48,7 @@ KisFilterConfigurationSP KisGaussianBlurFilter::defaultConfiguration(KisResource
     config->setProperty("horizRadius", 5);
     config->setProperty("vertRadius", 5);
     config->setProperty("lockAspect", true);
+    config->setProperty("algorithm", int(KisGaussianKernel::Auto));
 
     return config;
 }
@@ -75,9 +76,17 @@ void KisGaussianBlurFilter::processImpl(KisPaintDeviceSP device,
         channelFlags = QBitArray(device->colorSpace()->channelCount(), true);
     }
 
+    /**
+     * The configurations saved before the "algorithm" key was introduced
+     * should keep rendering with the precise kernel
+     */
+    const KisGaussianKernel::BlurAlgorithm algorithm =
+        KisGaussianKernel::BlurAlgorithm(config->getInt("algorithm", KisGaussianKernel::Convolution));
+
     KisGaussianKernel::applyGaussian(device, rect,
                                      horizontalRadius, verticalRadius,
-                                     channelFlags, progressUpdater);
+                                     channelFlags, progressUpdater,
+                                     false, BORDER_REPEAT, algorithm);
 }
 
 QRect KisGaussianBlurFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
@@ -92,6 +101,18 @@ QRect KisGaussianBlurFilter::neededRect(const QRect & rect, const KisFilterConfi
     const int halfWidth = _config->getProperty("horizRadius", value) ? KisGaussianKernel::kernelSizeFromRadius(t.scale(value.toFloat())) / 2 : 5;
     const int halfHeight = _config->getProperty("vertRadius", value) ? KisGaussianKernel::kernelSizeFromRadius(t.scale(value.toFloat())) / 2 : 5;
 
+    const KisGaussianKernel::BlurAlgorithm algorithm =
+        KisGaussianKernel::BlurAlgorithm(_config->getInt("algorithm", KisGaussianKernel::Convolution));
+
+    /**
+     * The recursive filter reads exactly one kernel radius around the rect
+     */
+    if (KisGaussianKernel::usesRecursiveGaussian(algorithm,
+                                                 t.scale(_config->getDouble("horizRadius", 5)),
+                                                 t.scale(_config->getDouble("vertRadius", 5)))) {
+        return rect.adjusted(-halfWidth, -halfHeight, halfWidth, halfHeight);
+    }
+
     return rect.adjusted(-halfWidth * 2, -halfHeight * 2, halfWidth * 2, halfHeight * 2);
 }
 
@@ -9,6 +9,7 @@
 
 #include "kis_lens_blur_filter.h"
 #include "kis_wdg_lens_blur.h"
+#include "kis_lens_blur_kernels.h"
 
 #include <KoCompositeOp.h>
 
@@ -25,8 +26,6 @@
 #include "kis_lod_transform.h"
 
 
-#include <QPainter>
-
 #include <math.h>
 
 
@@ -61,6 +60,7 @@ KisFilterConfigurationSP KisLensBlurFilter::defaultConfiguration(KisResourcesInt
     config->setProperty("irisShape", "Pentagon (5)");
     config->setProperty("irisRadius", 5);
     config->setProperty("irisRotation", 0);
+    config->setProperty("quality", int(Balanced));
 
     QSize halfSize = getKernelHalfSize(config, 0);
     config->setProperty("halfWidth", halfSize.width());
@@ -83,34 +83,12 @@ QPolygonF KisLensBlurFilter::getIrisPolygon(const KisFilterConfigurationSP confi
     config->getProperty("irisRotation", value);
     uint irisRotation = value.toUInt();
 
-    if (irisRadius < 1)
-        return QPolygon();
-
-    QPolygonF irisShapePoly;
-
-    int sides = 1;
-    qreal angle = 0;
-
-    if (irisShape == "Triangle") sides = 3;
-    else if (irisShape == "Quadrilateral (4)") sides = 4;
-    else if (irisShape == "Pentagon (5)") sides = 5;
-    else if (irisShape == "Hexagon (6)") sides = 6;
-    else if (irisShape == "Heptagon (7)") sides = 7;
-    else if (irisShape == "Octagon (8)") sides = 8;
-    else return QPolygonF();
-
-    for (int i = 0; i < sides; ++i) {
-        irisShapePoly << QPointF(0.5 * cos(angle), 0.5 * sin(angle));
-        angle += 2 * M_PI / sides;
-    }
-
-    QTransform transform;
-    transform.rotate(irisRotation);
-    transform.scale(irisRadius * 2, irisRadius * 2);
-
-    QPolygonF transformedIris = transform.map(irisShapePoly);
+    return KisLensBlurKernels::irisPolygon(irisShape, irisRadius, irisRotation);
+}
 
-    return transformedIris;
+KisConvolutionKernelSP KisLensBlurFilter::createComplexGaussianKernel(int radius, Quality quality)
+{
+    return KisLensBlurKernels::createComplexGaussianKernel(radius, quality == Balanced ? 3 : 2);
 }
 
 void KisLensBlurFilter::processImpl(KisPaintDeviceSP device,
@@ -130,40 +108,36 @@ void KisLensBlurFilter::processImpl(KisPaintDeviceSP device,
     }
 
     const int lod = device->defaultBounds()->currentLevelOfDetail();
-    QPolygonF transformedIris = getIrisPolygon(config, lod);
-    if (transformedIris.isEmpty()) return;
-
-    QRectF boundingRect = transformedIris.boundingRect();
 
-    int kernelWidth = boundingRect.toAlignedRect().width();
-    int kernelHeight = boundingRect.toAlignedRect().height();
+    const Quality quality = Quality(config->getInt("quality", Balanced));
 
-    QImage kernelRepresentation(kernelWidth, kernelHeight, QImage::Format_RGB32);
-    kernelRepresentation.fill(0);
+    if (config->getString("irisShape") == "Circle" && quality != Precise) {
+        KisLodTransformScalar t(lod);
+        const int radius = t.scale(config->getInt("irisRadius", 5));
+        if (radius < 1) return;
 
-    QPainter imagePainter(&kernelRepresentation);
-    imagePainter.setRenderHint(QPainter::Antialiasing);
-    imagePainter.setBrush(QColor::fromRgb(255, 255, 255));
+        KisConvolutionPainter painter(device, KisConvolutionPainter::SPATIAL);
+        painter.setChannelFlags(channelFlags);
+        painter.setProgress(progressUpdater);
 
-    QTransform offsetTransform;
-    offsetTransform.translate(-boundingRect.x(), -boundingRect.y());
-    imagePainter.setTransform(offsetTransform);
-    imagePainter.drawPolygon(transformedIris, Qt::WindingFill);
-
-    // construct kernel from image
-    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> irisKernel(kernelHeight, kernelWidth);
-    for (int j = 0; j < kernelHeight; ++j) {
-        for (int i = 0; i < kernelWidth; ++i) {
-            irisKernel(j, i) = qRed(kernelRepresentation.pixel(i, j));
-        }
+        KisConvolutionKernelSP kernel = createComplexGaussianKernel(radius, quality);
+        painter.applyMatrix(kernel, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
+        return;
     }
 
-    // apply convolution
+    QPolygonF transformedIris = getIrisPolygon(config, lod);
+    if (transformedIris.isEmpty()) return;
+
+    /**
+     * Arbitrary iris shapes are not separable, so the kernel is applied
+     * via FFT when it is available, the spectrum of the kernel is reused
+     * for all the patches of the image
+     */
     KisConvolutionPainter painter(device);
     painter.setChannelFlags(channelFlags);
     painter.setProgress(progressUpdater);
 
-    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(irisKernel, 0, irisKernel.sum());
+    KisConvolutionKernelSP kernel = KisLensBlurKernels::createIrisKernel(transformedIris);
     painter.applyMatrix(kernel, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
 }
 
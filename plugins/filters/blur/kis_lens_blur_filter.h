@@ -11,12 +11,26 @@
 #define KIS_LENS_BLUR_FILTER_H
 
 #include "filter/kis_filter.h"
+#include "kis_convolution_kernel.h"
 #include "ui_wdg_lens_blur.h"
 
 #include <Eigen/Core>
 
 class KisLensBlurFilter : public KisFilter
 {
+public:
+    /**
+     * Quality presets for the circular iris. Fast and Balanced approximate
+     * the disk with a sum of two or three complex Gaussian components,
+     * each of which is separable. Precise convolves with the rasterized
+     * disk, as it is done for the polygonal irises.
+     */
+    enum Quality {
+        Fast = 0,
+        Balanced,
+        Precise
+    };
+
 public:
     KisLensBlurFilter();
 public:
@@ -42,6 +56,7 @@ public:
 
 private:
     static QPolygonF getIrisPolygon(const KisFilterConfigurationSP config, int lod);
+    static KisConvolutionKernelSP createComplexGaussianKernel(int radius, Quality quality);
 };
 
 #endif
@@ -0,0 +1,164 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_lens_blur_kernels.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QTransform>
+
+#include <math.h>
+#include <numeric>
+
+#include <Eigen/Core>
+
+
+namespace {
+
+/**
+ * Complex Gaussian components fitted to a disk of radius 1 by Olli
+ * Niemitalo. Each component is exp(-a * x^2) * (cos(b * x^2) + i * sin(b * x^2))
+ * applied along both axes, the real and the imaginary parts of the 2D
+ * result are weighted with A and B respectively.
+ */
+struct ComplexGaussianComponent {
+    qreal a;
+    qreal b;
+    qreal A;
+    qreal B;
+};
+
+const ComplexGaussianComponent twoComponents[] = {
+    {0.886528, 5.268909, 0.411259, -0.548794},
+    {1.960518, 1.558213, 0.513282, 4.561110}
+};
+
+const ComplexGaussianComponent threeComponents[] = {
+    {2.176490, 5.043495, 1.621035, -2.105439},
+    {1.019306, 9.027613, -0.280860, -0.162882},
+    {2.815110, 1.597273, -0.366471, 10.300301}
+};
+
+/**
+ * The fitted components spread a bit wider than their nominal radius:
+ * the sampled kernel is closest to the sharp disc when the argument of
+ * the components reaches 1.1 at the edge of the disc
+ */
+const qreal componentScale = 1.1;
+
+}
+
+QPolygonF KisLensBlurKernels::irisPolygon(const QString &shape, qreal radius, qreal rotation)
+{
+    if (radius < 1)
+        return QPolygonF();
+
+    QPolygonF irisShapePoly;
+
+    int sides = 1;
+    qreal angle = 0;
+
+    if (shape == "Circle") sides = 64;
+    else if (shape == "Triangle") sides = 3;
+    else if (shape == "Quadrilateral (4)") sides = 4;
+    else if (shape == "Pentagon (5)") sides = 5;
+    else if (shape == "Hexagon (6)") sides = 6;
+    else if (shape == "Heptagon (7)") sides = 7;
+    else if (shape == "Octagon (8)") sides = 8;
+    else return QPolygonF();
+
+    for (int i = 0; i < sides; ++i) {
+        irisShapePoly << QPointF(0.5 * cos(angle), 0.5 * sin(angle));
+        angle += 2 * M_PI / sides;
+    }
+
+    QTransform transform;
+    transform.rotate(rotation);
+    transform.scale(radius * 2, radius * 2);
+
+    return transform.map(irisShapePoly);
+}
+
+KisConvolutionKernelSP KisLensBlurKernels::createIrisKernel(const QPolygonF &iris)
+{
+    QRectF boundingRect = iris.boundingRect();
+
+    int kernelWidth = boundingRect.toAlignedRect().width();
+    int kernelHeight = boundingRect.toAlignedRect().height();
+
+    QImage kernelRepresentation(kernelWidth, kernelHeight, QImage::Format_RGB32);
+    kernelRepresentation.fill(0);
+
+    QPainter imagePainter(&kernelRepresentation);
+    imagePainter.setRenderHint(QPainter::Antialiasing);
+    imagePainter.setBrush(QColor::fromRgb(255, 255, 255));
+
+    QTransform offsetTransform;
+    offsetTransform.translate(-boundingRect.x(), -boundingRect.y());
+    imagePainter.setTransform(offsetTransform);
+    imagePainter.drawPolygon(iris, Qt::WindingFill);
+    imagePainter.end();
+
+    // construct kernel from image
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> irisKernel(kernelHeight, kernelWidth);
+    for (int j = 0; j < kernelHeight; ++j) {
+        for (int i = 0; i < kernelWidth; ++i) {
+            irisKernel(j, i) = qRed(kernelRepresentation.pixel(i, j));
+        }
+    }
+
+    return KisConvolutionKernel::fromMatrix(irisKernel, 0, irisKernel.sum());
+}
+
+KisConvolutionKernelSP KisLensBlurKernels::createComplexGaussianKernel(int radius, int numComponents)
+{
+    const ComplexGaussianComponent *components = numComponents == 3 ? threeComponents : twoComponents;
+    numComponents = numComponents == 3 ? 3 : 2;
+
+    const int kernelSize = 2 * radius + 1;
+
+    QVector<KisConvolutionKernel::SeparableTerm> terms;
+    qreal kernelSum = 0.0;
+
+    /**
+     * The 2D kernel of a component is (re + i * im) x (re + i * im), so
+     * A * Re + B * Im of it is a sum of two real separable terms:
+     * (A * re + B * im) x re + (B * re - A * im) x im
+     */
+    for (int i = 0; i < numComponents; ++i) {
+        const ComplexGaussianComponent &c = components[i];
+
+        KisConvolutionKernel::SeparableTerm realTerm;
+        KisConvolutionKernel::SeparableTerm imaginaryTerm;
+        realTerm.column.resize(kernelSize);
+        realTerm.row.resize(kernelSize);
+        imaginaryTerm.column.resize(kernelSize);
+        imaginaryTerm.row.resize(kernelSize);
+
+        for (int j = 0; j < kernelSize; ++j) {
+            const qreal x = componentScale * qreal(j - radius) / radius;
+            const qreal x2 = x * x;
+            const qreal magnitude = std::exp(-c.a * x2);
+            const qreal re = magnitude * std::cos(c.b * x2);
+            const qreal im = magnitude * std::sin(c.b * x2);
+
+            realTerm.row[j] = re;
+            realTerm.column[j] = c.A * re + c.B * im;
+            imaginaryTerm.row[j] = im;
+            imaginaryTerm.column[j] = c.B * re - c.A * im;
+        }
+
+        kernelSum +=
+            std::accumulate(realTerm.column.begin(), realTerm.column.end(), 0.0) *
+            std::accumulate(realTerm.row.begin(), realTerm.row.end(), 0.0) +
+            std::accumulate(imaginaryTerm.column.begin(), imaginaryTerm.column.end(), 0.0) *
+            std::accumulate(imaginaryTerm.row.begin(), imaginaryTerm.row.end(), 0.0);
+
+        terms << realTerm << imaginaryTerm;
+    }
+
+    return KisConvolutionKernel::fromSeparableTerms(terms, 0, kernelSum);
+}
@@ -0,0 +1,42 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_LENS_BLUR_KERNELS_H
+#define KIS_LENS_BLUR_KERNELS_H
+
+#include <QPolygonF>
+#include <QString>
+
+#include "kis_convolution_kernel.h"
+
+/**
+ * The kernels of the lens blur filter, kept apart from the filter
+ * itself so that they can be compared with each other in the tests.
+ */
+namespace KisLensBlurKernels
+{
+
+/**
+ * \return the polygon of the iris of the given \p shape, e.g. "Circle"
+ * or "Hexagon (6)", centered at the origin. The circle is approximated
+ * with 64 sides. Returns an empty polygon for unknown shapes.
+ */
+QPolygonF irisPolygon(const QString &shape, qreal radius, qreal rotation);
+
+/**
+ * Rasterizes \p iris into a dense kernel, this kernel is not separable
+ */
+KisConvolutionKernelSP createIrisKernel(const QPolygonF &iris);
+
+/**
+ * Approximates a disc of \p radius with a sum of \p numComponents (two or
+ * three) complex Gaussians, each of which gives two separable terms
+ */
+KisConvolutionKernelSP createComplexGaussianKernel(int radius, int numComponents);
+
+}
+
+#endif // KIS_LENS_BLUR_KERNELS_H
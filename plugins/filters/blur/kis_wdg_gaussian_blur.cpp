@@ -17,6 +17,7 @@
 #include <kis_paint_device.h>
 #include <kis_processing_information.h>
 #include <KisGlobalResourcesInterface.h>
+#include <kis_gaussian_kernel.h>
 
 #include "ui_wdg_gaussian_blur.h"
 
@@ -44,6 +45,14 @@ KisWdgGaussianBlur::KisWdgGaussianBlur(bool usedForMasks, QWidget * parent) : Ki
     m_widget->verticalRadius->setSuffix(i18n(" px"));
     connect(m_widget->verticalRadius, SIGNAL(valueChanged(qreal)), this, SLOT(verticalRadiusChanged(qreal)));
 
+    m_widget->cmbAlgorithm->addItem(i18nc("Gaussian blur algorithm", "Automatic"), int(KisGaussianKernel::Auto));
+    m_widget->cmbAlgorithm->addItem(i18nc("Gaussian blur algorithm", "Precise"), int(KisGaussianKernel::Convolution));
+    m_widget->cmbAlgorithm->addItem(i18nc("Gaussian blur algorithm", "Fast"), int(KisGaussianKernel::Recursive));
+    m_widget->cmbAlgorithm->setToolTip(i18n("Precise algorithm is slow for large radii, fast algorithm "
+                                            "approximates the blur at a constant speed. Automatic mode "
+                                            "uses the fast algorithm for radii larger than 100 px."));
+    connect(m_widget->cmbAlgorithm, SIGNAL(currentIndexChanged(int)), SIGNAL(sigConfigurationItemChanged()));
+
     connect(m_widget->aspectButton, SIGNAL(keepAspectRatioChanged(bool)), this, SLOT(aspectLockChanged(bool)));
     connect(m_widget->horizontalRadius, SIGNAL(valueChanged(qreal)), SIGNAL(sigConfigurationItemChanged()));
     connect(m_widget->verticalRadius, SIGNAL(valueChanged(qreal)), SIGNAL(sigConfigurationItemChanged()));
@@ -60,6 +69,7 @@ KisPropertiesConfigurationSP KisWdgGaussianBlur::configuration() const
     config->setProperty("horizRadius", m_widget->horizontalRadius->value());
     config->setProperty("vertRadius", m_widget->verticalRadius->value());
     config->setProperty("lockAspect", m_widget->aspectButton->keepAspectRatio());
+    config->setProperty("algorithm", m_widget->cmbAlgorithm->currentData().toInt());
     return config;
 }
 
@@ -75,6 +85,9 @@ void KisWdgGaussianBlur::setConfiguration(const KisPropertiesConfigurationSP con
     if (config->getProperty("lockAspect", value)) {
         m_widget->aspectButton->setKeepAspectRatio(value.toBool());
     }
+
+    const int algorithm = config->getInt("algorithm", KisGaussianKernel::Convolution);
+    m_widget->cmbAlgorithm->setCurrentIndex(qMax(0, m_widget->cmbAlgorithm->findData(algorithm)));
 }
 
 void KisWdgGaussianBlur::horizontalRadiusChanged(qreal v)
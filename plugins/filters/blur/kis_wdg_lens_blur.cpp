@@ -36,10 +36,20 @@ KisWdgLensBlur::KisWdgLensBlur(QWidget * parent) : KisConfigWidget(parent)
     m_shapeTranslations[i18n("Hexagon (6)")] = "Hexagon (6)";
     m_shapeTranslations[i18n("Heptagon (7)")] = "Heptagon (7)";
     m_shapeTranslations[i18n("Octagon (8)")] = "Octagon (8)";
+    m_shapeTranslations[i18n("Circle")] = "Circle";
+
+    m_widget->cmbQuality->addItem(i18nc("Lens blur quality", "Fast"), int(KisLensBlurFilter::Fast));
+    m_widget->cmbQuality->addItem(i18nc("Lens blur quality", "Balanced"), int(KisLensBlurFilter::Balanced));
+    m_widget->cmbQuality->addItem(i18nc("Lens blur quality", "Precise"), int(KisLensBlurFilter::Precise));
+    m_widget->cmbQuality->setCurrentIndex(1);
+    m_widget->cmbQuality->setToolTip(i18n("Fast and balanced quality approximate the circular iris, "
+                                          "which is much faster for large radii. "
+                                          "Polygonal irises are always precise."));
 
     connect(m_widget->irisShapeCombo, SIGNAL(currentIndexChanged(int)), SIGNAL(sigConfigurationItemChanged()));
     connect(m_widget->irisRadiusSlider, SIGNAL(valueChanged(int)), SIGNAL(sigConfigurationItemChanged()));
     connect(m_widget->irisRotationSelector, SIGNAL(angleChanged(qreal)), SIGNAL(sigConfigurationItemChanged()));
+    connect(m_widget->cmbQuality, SIGNAL(currentIndexChanged(int)), SIGNAL(sigConfigurationItemChanged()));
 }
 
 KisWdgLensBlur::~KisWdgLensBlur()
@@ -53,6 +63,7 @@ KisPropertiesConfigurationSP KisWdgLensBlur::configuration() const
     config->setProperty("irisShape", m_shapeTranslations[m_widget->irisShapeCombo->currentText()]);
     config->setProperty("irisRadius", m_widget->irisRadiusSlider->value());
     config->setProperty("irisRotation", static_cast<int>(m_widget->irisRotationSelector->angle()));
+    config->setProperty("quality", m_widget->cmbQuality->currentData().toInt());
 
     QSize halfSize = KisLensBlurFilter::getKernelHalfSize(config, 0);
     config->setProperty("halfWidth", halfSize.width());
@@ -77,5 +88,8 @@ void KisWdgLensBlur::setConfiguration(const KisPropertiesConfigurationSP config)
     if (config->getProperty("irisRotation", value)) {
         m_widget->irisRotationSelector->setAngle(static_cast<qreal>(value.toInt()));
     }
+
+    const int quality = config->getInt("quality", KisLensBlurFilter::Balanced);
+    m_widget->cmbQuality->setCurrentIndex(qMax(0, m_widget->cmbQuality->findData(quality)));
 }
 
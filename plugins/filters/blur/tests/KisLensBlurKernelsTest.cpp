@@ -0,0 +1,90 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisLensBlurKernelsTest.h"
+
+#include "kistest.h"
+
+#include "../kis_lens_blur_kernels.h"
+
+namespace {
+
+/**
+ * The L1 distance between the normalized \p kernel and a sharp disc
+ * of \p radius centered at \p center (in the coordinates of the kernel
+ * cells), the disc covers the cells whose centers are inside it
+ */
+qreal distanceToDisc(KisConvolutionKernelSP kernel, const QPointF &center, qreal radius)
+{
+    const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> &data = *kernel->data();
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> disc =
+        Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>::Zero(data.rows(), data.cols());
+
+    for (int r = 0; r < disc.rows(); r++) {
+        for (int c = 0; c < disc.cols(); c++) {
+            const qreal dx = c - center.x();
+            const qreal dy = r - center.y();
+            disc(r, c) = dx * dx + dy * dy <= radius * radius ? 1.0 : 0.0;
+        }
+    }
+
+    return (data / kernel->factor() - disc / disc.sum()).cwiseAbs().sum();
+}
+
+}
+
+void KisLensBlurKernelsTest::testCircleKernelMatchesDisc_data()
+{
+    QTest::addColumn<int>("numComponents");
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<qreal>("tolerance");
+
+    // numComponents == 0 stands for the rasterized iris of the Precise quality
+    QTest::addRow("fast-10") << 2 << 10 << 0.2;
+    QTest::addRow("fast-30") << 2 << 30 << 0.2;
+    QTest::addRow("balanced-10") << 3 << 10 << 0.15;
+    QTest::addRow("balanced-30") << 3 << 30 << 0.15;
+    QTest::addRow("precise-10") << 0 << 10 << 0.1;
+    QTest::addRow("precise-30") << 0 << 30 << 0.1;
+}
+
+void KisLensBlurKernelsTest::testCircleKernelMatchesDisc()
+{
+    QFETCH(int, numComponents);
+    QFETCH(int, radius);
+    QFETCH(qreal, tolerance);
+
+    KisConvolutionKernelSP kernel;
+    QPointF center;
+
+    if (numComponents) {
+        kernel = KisLensBlurKernels::createComplexGaussianKernel(radius, numComponents);
+        QVERIFY(kernel);
+
+        QCOMPARE(kernel->width(), quint32(2 * radius + 1));
+        QCOMPARE(kernel->height(), quint32(2 * radius + 1));
+        QCOMPARE(kernel->separableTerms().size(), 2 * numComponents);
+
+        center = QPointF(radius, radius);
+    } else {
+        const QPolygonF iris = KisLensBlurKernels::irisPolygon("Circle", radius, 0);
+        QVERIFY(!iris.isEmpty());
+
+        kernel = KisLensBlurKernels::createIrisKernel(iris);
+        QVERIFY(kernel);
+        QVERIFY(kernel->separableTerms().isEmpty());
+
+        // the iris is rasterized with its bounding rect moved to the origin
+        center = -iris.boundingRect().topLeft() - QPointF(0.5, 0.5);
+    }
+
+    const qreal distance = distanceToDisc(kernel, center, radius);
+    QVERIFY2(distance < tolerance,
+             QString("L1 distance to the disc is %1, tolerance %2").arg(distance).arg(tolerance).toLatin1());
+}
+
+KISTEST_MAIN(KisLensBlurKernelsTest)
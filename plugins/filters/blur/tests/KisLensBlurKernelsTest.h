@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_LENS_BLUR_KERNELS_TEST_H
+#define KIS_LENS_BLUR_KERNELS_TEST_H
+
+#include <simpletest.h>
+
+class KisLensBlurKernelsTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testCircleKernelMatchesDisc_data();
+    void testCircleKernelMatchesDisc();
+};
+
+#endif // KIS_LENS_BLUR_KERNELS_TEST_H
@@ -15,6 +15,7 @@
 
 #include <stdlib.h>
 #include <vector>
+#include <algorithm>
 
 #include <QPoint>
 #include <QSpinBox>
@@ -28,7 +29,7 @@
 
 #include <KisDocument.h>
 #include <kis_image.h>
-#include <KisSequentialIteratorProgress.h>
+#include <kis_iterator_ng.h>
 #include <kis_layer.h>
 #include <filter/kis_filter_registry.h>
 #include <kis_global.h>
@@ -44,7 +45,7 @@
 KisOilPaintFilter::KisOilPaintFilter() : KisFilter(id(), FiltersCategoryArtisticId, i18n("&Oilpaint..."))
 {
     setSupportsPainting(true);
-    setSupportsThreading(false);
+    setSupportsThreading(true);
     setSupportsAdjustmentLayers(true);
 }
 
@@ -63,126 +64,289 @@ void KisOilPaintFilter::processImpl(KisPaintDeviceSP device,
     OilPaint(device, device, applyRect, brushSize, smooth, progressUpdater);
 }
 
+namespace {
+
+/**
+ * Histogram of the window pixels over the intensity bins. Every bin
+ * keeps the number of pixels that fall into it and the sum of their
+ * normalized channel values, so that the average color of the most
+ * frequent bin can be fetched without rescanning the window.
+ */
+class OilPaintHistogram
+{
+public:
+    OilPaintHistogram(int numBins, int numChannels)
+        : m_numBins(numBins),
+          m_numChannels(numChannels),
+          m_counts(numBins, 0),
+          m_sums(numBins * numChannels, 0.0)
+    {
+    }
+
+    void clear() {
+        m_counts.fill(0);
+        m_sums.fill(0.0);
+    }
+
+    inline void addSample(int bin, const float *channels, int sign) {
+        if (bin < 0) return;
+
+        m_counts[bin] += sign;
+
+        double *sums = m_sums.data() + bin * m_numChannels;
+        for (int i = 0; i < m_numChannels; i++) {
+            sums[i] += sign * channels[i];
+        }
+    }
+
+    inline void addHistogram(const OilPaintHistogram &rhs, int sign) {
+        for (int i = 0; i < m_numBins; i++) {
+            m_counts[i] += sign * rhs.m_counts[i];
+        }
+
+        const int numSums = m_sums.size();
+        for (int i = 0; i < numSums; i++) {
+            m_sums[i] += sign * rhs.m_sums[i];
+        }
+    }
+
+    /**
+     * Writes the average color of the most frequent bin into \p channels.
+     * When several bins have the same count, the one with the lowest
+     * intensity wins. Returns the number of pixels in that bin.
+     */
+    int mostFrequentColor(QVector<float> &channels) const {
+        int bin = 0;
+        int maxInstance = 0;
+
+        for (int i = 0; i < m_numBins; i++) {
+            if (m_counts[i] > maxInstance) {
+                bin = i;
+                maxInstance = m_counts[i];
+            }
+        }
+
+        if (maxInstance > 0) {
+            const double *sums = m_sums.constData() + bin * m_numChannels;
+            for (int i = 0; i < m_numChannels; i++) {
+                channels[i] = sums[i] / maxInstance;
+            }
+        }
+
+        return maxInstance;
+    }
+
+private:
+    int m_numBins;
+    int m_numChannels;
+    QVector<int> m_counts;
+    QVector<double> m_sums;
+};
+
+/**
+ * A row of the source area converted into the form used by the
+ * histograms: the intensity bin of every pixel (-1 for fully transparent
+ * pixels, they don't provide any information), the normalized channel
+ * values and the opacity.
+ */
+struct OilPaintRow
+{
+    QVector<int> bins;
+    QVector<float> channels;
+    QVector<qreal> opacity;
+};
+
+}
+
 // This method have been ported from Pieter Z. Voloshyn algorithm code.
 
 /* Function to apply the OilPaint effect.
  *
- * data             => The image data in RGBA mode.
- * w                => Width of image.
- * h                => Height of image.
  * BrushSize        => Brush size.
  * Smoothness       => Smooth value.
  *
- * Theory           => Using MostFrequentColor function we take the main color in
- *                     a matrix and simply write at the original position.
+ * Theory           => Using the most frequent color of a matrix around each
+ *                     pixel and simply write at the original position.
+ *
+ * The most frequent color is taken from a histogram over the intensity of
+ * the pixels in the matrix. Instead of rescanning the whole matrix for every
+ * pixel, the histogram is slid along the row (Huang): the pixels of the
+ * column that leaves the matrix are removed from it and the pixels of the
+ * column that enters it are added. When the matrix is taller than the
+ * number of intensity bins, it is cheaper to keep a histogram for every
+ * column, slide those down the rows and add/remove whole columns to the
+ * matrix histogram (Perreault), which makes the cost independent of the
+ * brush size.
+ *
+ * The source is read through oldRawData(), the rows of the matrix are
+ * always fetched before the corresponding destination rows are written,
+ * so the filter can be applied in-place and to several patches of the
+ * same device concurrently.
  */
 
 void KisOilPaintFilter::OilPaint(const KisPaintDeviceSP src, KisPaintDeviceSP dst, const QRect &applyRect,
                                  int BrushSize, int Smoothness, KoUpdater* progressUpdater) const
 {
-    KisSequentialConstIteratorProgress it(src, applyRect, progressUpdater);
-    KisSequentialIterator dstIt(dst, applyRect);
+    if (applyRect.isEmpty()) return;
 
-    while (it.nextPixel() && dstIt.nextPixel()) {
-        MostFrequentColor(src, dstIt.rawData(), applyRect, it.x(), it.y(), BrushSize, Smoothness);
+    const KoColorSpace* cs = src->colorSpace();
+    const int numChannels = cs->channelCount();
+    const int pixelSize = cs->pixelSize();
+    const int numBins = Smoothness + 1;
+    const double Scale = Smoothness / 255.0;
+
+    const int radius = BrushSize;
+    const int kernelSize = 2 * radius + 1;
+    const int width = applyRect.width();
+    const int height = applyRect.height();
+    const int srcWidth = width + 2 * radius;
+    const int srcHeight = height + 2 * radius;
+
+    const bool useColumnHistograms = kernelSize > numBins;
+
+    // the rows of the matrix plus the one that has just left it
+    const int numRows = kernelSize + 1;
+    QVector<OilPaintRow> rows(numRows);
+    for (OilPaintRow &row : rows) {
+        row.bins.resize(srcWidth);
+        row.channels.resize(srcWidth * numChannels);
+        row.opacity.resize(srcWidth);
     }
-}
 
-// This method has been ported from Pieter Z. Voloshyn's algorithm code in Digikam.
+    auto rowForIndex = [&rows, numRows] (int index) -> OilPaintRow& {
+        return rows[index % numRows];
+    };
 
-/* Function to determine the most frequent color in a matrix
- *
- * Bits             => Bits array
- * Width            => Image width
- * Height           => Image height
- * X                => Position horizontal
- * Y                => Position vertical
- * Radius           => Is the radius of the matrix to be analyzed
- * Intensity        => Intensity to calculate
- *
- * Theory           => This function creates a matrix with the analyzed pixel in
- *                     the center of this matrix and find the most frequent color
- */
+    QVector<float> channel(numChannels);
+    KisHLineConstIteratorSP srcIt = src->createHLineConstIteratorNG(applyRect.x() - radius,
+                                                                    applyRect.y() - radius,
+                                                                    srcWidth);
 
-void KisOilPaintFilter::MostFrequentColor(KisPaintDeviceSP src, quint8* dst, const QRect& /*bounds*/, int X, int Y, int Radius, int Intensity) const
-{
-    uint I;
+    auto loadRow = [&] (int index) {
+        OilPaintRow &row = rowForIndex(index);
 
-    double Scale = Intensity / 255.0;
+        for (int x = 0; x < srcWidth; x++) {
+            const quint8 *data = srcIt->oldRawData();
 
-    // Alloc some arrays to be used
-    uchar *IntensityCount = new uchar[(Intensity + 1)];
+            row.opacity[x] = cs->opacityF(data);
 
-    const KoColorSpace* cs = src->colorSpace();
+            if (cs->opacityU8(data) == 0) {
+                row.bins[x] = -1;
+            } else {
+                cs->normalisedChannelsValue(data, channel);
+                std::copy(channel.constBegin(), channel.constEnd(),
+                          row.channels.begin() + x * numChannels);
 
-    QVector<float> channel(cs->channelCount());
-    QVector<float>* AverageChannels = new QVector<float>[(Intensity + 1)];
+                row.bins[x] = (uint)(cs->intensity8(data) * Scale);
+            }
 
-    // Erase the array
-    memset(IntensityCount, 0, (Intensity + 1) * sizeof(uchar));
+            srcIt->nextPixel();
+        }
 
-    int startx = X - Radius;
-    int starty = Y - Radius;
-    int width = (2 * Radius) + 1;
-    int height = (2 * Radius) + 1;
+        srcIt->nextRow();
+    };
 
-    qreal middlePointAlpha = 1;
-    {
-        // if the current pixel is transparent, the result must be transparent, too.
-        KisSequentialConstIterator middlePointIt(src, QRect(X, Y, 1, 1));
-        middlePointIt.nextPixel();
-        middlePointAlpha = cs->opacityF(middlePointIt.oldRawData());
-    }
+    auto addSample = [numChannels] (OilPaintHistogram &histogram, const OilPaintRow &row, int x, int sign) {
+        histogram.addSample(row.bins[x], row.channels.constData() + x * numChannels, sign);
+    };
 
+    std::vector<OilPaintHistogram> columns;
+    if (useColumnHistograms) {
+        columns.resize(srcWidth, OilPaintHistogram(numBins, numChannels));
+    }
 
-    KisSequentialConstIterator srcIt(src, QRect(startx, starty, width, height));
-    while (middlePointAlpha > 0 && srcIt.nextPixel()) {
+    OilPaintHistogram kernel(numBins, numChannels);
 
-        cs->normalisedChannelsValue(srcIt.oldRawData(), channel);
+    for (int i = 0; i < kernelSize; i++) {
+        loadRow(i);
+    }
 
-        if (cs->opacityU8(srcIt.oldRawData()) == 0) {
-            // if the pixel is transparent, it's not going to provide any useful information
-            continue;
+    if (useColumnHistograms) {
+        for (int i = 0; i < kernelSize; i++) {
+            const OilPaintRow &row = rowForIndex(i);
+            for (int x = 0; x < srcWidth; x++) {
+                addSample(columns[x], row, x, 1);
+            }
         }
+    }
 
-        I = (uint)(cs->intensity8(srcIt.oldRawData()) * Scale);
+    KisHLineIteratorSP dstIt = dst->createHLineIteratorNG(applyRect.x(), applyRect.y(), width);
 
-        IntensityCount[I]++;
+    if (progressUpdater) {
+        progressUpdater->setRange(0, height);
+    }
 
-        if (IntensityCount[I] == 1) {
-            AverageChannels[I] = channel;
-        } else {
-            for (int i = 0; i < channel.size(); i++) {
-                AverageChannels[I][i] += channel[i];
+    for (int y = 0; y < height; y++) {
+        if (y > 0) {
+            loadRow(y + kernelSize - 1);
+
+            if (useColumnHistograms) {
+                const OilPaintRow &leavingRow = rowForIndex(y - 1);
+                const OilPaintRow &enteringRow = rowForIndex(y + kernelSize - 1);
+
+                for (int x = 0; x < srcWidth; x++) {
+                    addSample(columns[x], leavingRow, x, -1);
+                    addSample(columns[x], enteringRow, x, 1);
+                }
             }
         }
-    }
 
-    I = 0;
-    int MaxInstance = 0;
+        kernel.clear();
 
-    for (int i = 0 ; i <= Intensity ; ++i) {
-        if (IntensityCount[i] > MaxInstance) {
-            I = i;
-            MaxInstance = IntensityCount[i];
+        if (useColumnHistograms) {
+            for (int x = 0; x < kernelSize; x++) {
+                kernel.addHistogram(columns[x], 1);
+            }
+        } else {
+            for (int i = 0; i < kernelSize; i++) {
+                const OilPaintRow &row = rowForIndex(y + i);
+                for (int x = 0; x < kernelSize; x++) {
+                    addSample(kernel, row, x, 1);
+                }
+            }
         }
-    }
 
-    if (MaxInstance != 0) {
-        channel = AverageChannels[I];
-        for (int i = 0; i < channel.size(); i++) {
-            channel[i] /= MaxInstance;
+        const OilPaintRow &middleRow = rowForIndex(y + radius);
+
+        for (int x = 0; x < width; x++) {
+            if (x > 0) {
+                const int leavingColumn = x - 1;
+                const int enteringColumn = x + kernelSize - 1;
+
+                if (useColumnHistograms) {
+                    kernel.addHistogram(columns[leavingColumn], -1);
+                    kernel.addHistogram(columns[enteringColumn], 1);
+                } else {
+                    for (int i = 0; i < kernelSize; i++) {
+                        const OilPaintRow &row = rowForIndex(y + i);
+                        addSample(kernel, row, leavingColumn, -1);
+                        addSample(kernel, row, enteringColumn, 1);
+                    }
+                }
+            }
+
+            quint8 *dstData = dstIt->rawData();
+
+            // if the current pixel is transparent, the result must be transparent, too.
+            const qreal middlePointAlpha = middleRow.opacity[x + radius];
+            const int maxInstance = middlePointAlpha > 0 ? kernel.mostFrequentColor(channel) : 0;
+
+            if (maxInstance != 0) {
+                cs->fromNormalisedChannelsValue(dstData, channel);
+            } else {
+                memset(dstData, 0, pixelSize);
+            }
+            cs->setOpacity(dstData, OPACITY_OPAQUE_U8, middlePointAlpha);
+
+            dstIt->nextPixel();
         }
-        cs->fromNormalisedChannelsValue(dst, channel);
-        cs->setOpacity(dst, OPACITY_OPAQUE_U8, middlePointAlpha);
-    } else {
-        memset(dst, 0, cs->pixelSize());
-        cs->setOpacity(dst, OPACITY_OPAQUE_U8, middlePointAlpha);
-    }
 
+        dstIt->nextRow();
 
-    delete [] IntensityCount;        // free all the arrays
-    delete [] AverageChannels;
+        if (progressUpdater) {
+            progressUpdater->setValue(y + 1);
+        }
+    }
 }
 
 QRect KisOilPaintFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int /*lod*/) const
@@ -202,7 +366,7 @@ QRect KisOilPaintFilter::changedRect(const QRect & rect, const KisFilterConfigur
 KisConfigWidget * KisOilPaintFilter::createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP, bool) const
 {
     vKisIntegerWidgetParam param;
-    param.push_back(KisIntegerWidgetParam(1, 5, 1, i18n("Brush size"), "brushSize"));
+    param.push_back(KisIntegerWidgetParam(1, 25, 1, i18n("Brush size"), "brushSize"));
     param.push_back(KisIntegerWidgetParam(10, 255, 30, i18nc("smooth out the painting strokes the filter creates", "Smooth"), "smooth"));
     KisMultiIntegerFilterWidget * w = new KisMultiIntegerFilterWidget(id().id(),  parent,  id().id(),  param);
     w->setConfiguration(defaultConfiguration(KisGlobalResourcesInterface::instance()));
@@ -6,7 +6,22 @@
 
 #include "KisColorSmudgeStrategy.h"
 
+#include "kis_fixed_paint_device.h"
+
 KisColorSmudgeStrategy::KisColorSmudgeStrategy()
         : m_memoryAllocator(new KisOptimizedByteArray::PooledMemoryAllocator())
 {
 }
+
+void KisColorSmudgeStrategy::Dab::detachFromDabCache()
+{
+    if (maskDabIsCached) {
+        maskDab = new KisFixedPaintDevice(*maskDab);
+        maskDabIsCached = false;
+    }
+
+    if (origDabIsCached) {
+        origDab = new KisFixedPaintDevice(*origDab);
+        origDabIsCached = false;
+    }
+}
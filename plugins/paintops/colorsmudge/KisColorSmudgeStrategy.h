@@ -12,6 +12,30 @@
 
 class KisColorSmudgeStrategy
 {
+public:
+    /**
+     * The mask of a single dab, generated by updateMask() and consumed
+     * by paintDab(). The strategy itself keeps no per-dab state, so the
+     * mask of the next dab may be generated while the previous one is
+     * still being blended into the layer.
+     */
+    struct Dab
+    {
+        KisFixedPaintDeviceSP maskDab;
+        KisFixedPaintDeviceSP origDab;
+        bool shouldPreserveDab = true;
+
+        bool maskDabIsCached = false;
+        bool origDabIsCached = false;
+
+        /**
+         * KisDabCache reuses the device it returns for every fetched dab.
+         * Make a deep copy of such devices, so that the dab stays valid
+         * after the next call to updateMask().
+         */
+        void detachFromDabCache();
+    };
+
 public:
     KisColorSmudgeStrategy();
 
@@ -19,14 +43,16 @@ public:
 
     virtual void initializePainting() = 0;
 
-    virtual void updateMask(KisDabCache *dabCache,
+    virtual void updateMask(Dab *dab,
+                            KisDabCache *dabCache,
                             const KisPaintInformation& info,
                             const KisDabShape &shape,
                             const QPointF &cursorPoint,
                             QRect *dstDabRect,
                             qreal lightnessStrength) = 0;
 
-    virtual QVector<QRect> paintDab(const QRect &srcRect, const QRect &dstRect,
+    virtual QVector<QRect> paintDab(const Dab &dab,
+                                    const QRect &srcRect, const QRect &dstRect,
                                     const KoColor &currentPaintColor,
                                     qreal opacity,
                                     qreal colorRateValue,
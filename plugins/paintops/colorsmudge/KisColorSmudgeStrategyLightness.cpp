@@ -20,8 +20,6 @@
 KisColorSmudgeStrategyLightness::KisColorSmudgeStrategyLightness(KisPainter *painter, bool smearAlpha,
                                                                  bool useDullingMode, KisPaintThicknessOptionData::ThicknessMode thicknessMode)
         : KisColorSmudgeStrategyBase(useDullingMode)
-        , m_maskDab(new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8()))
-        , m_origDab(new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->rgb8()))
         , m_smearAlpha(smearAlpha)
         , m_initializationPainter(painter)
         , m_thicknessMode(thicknessMode)
@@ -87,29 +85,31 @@ KisColorSmudgeStrategyBase::DabColoringStrategy &KisColorSmudgeStrategyLightness
     return m_coloringStrategy;
 }
 
-void KisColorSmudgeStrategyLightness::updateMask(KisDabCache *dabCache, const KisPaintInformation &info,
+void KisColorSmudgeStrategyLightness::updateMask(Dab *dab, KisDabCache *dabCache, const KisPaintInformation &info,
                                                  const KisDabShape &shape, const QPointF &cursorPoint,
                                                  QRect *dstDabRect, qreal paintThickness)
 {
-    m_origDab = dabCache->fetchNormalizedImageDab(m_origDab->colorSpace(),
-                                                  cursorPoint,
-                                                  shape,
-                                                  info,
-                                                  1.0,
-                                                  dstDabRect);
+    dab->origDab = dabCache->fetchNormalizedImageDab(KoColorSpaceRegistry::instance()->rgb8(),
+                                                     cursorPoint,
+                                                     shape,
+                                                     info,
+                                                     1.0,
+                                                     dstDabRect);
+    dab->origDabIsCached = true;
 
-    m_shouldPreserveOriginalDab = !dabCache->needSeparateOriginal();
+    dab->shouldPreserveDab = !dabCache->needSeparateOriginal();
 
-    const int numPixels = m_origDab->bounds().width() * m_origDab->bounds().height();
+    const int numPixels = dab->origDab->bounds().width() * dab->origDab->bounds().height();
 
     if (paintThickness < 1.0) {
-        if (m_shouldPreserveOriginalDab) {
-            m_shouldPreserveOriginalDab = false;
-            m_origDab = new KisFixedPaintDevice(*m_origDab);
+        if (dab->shouldPreserveDab) {
+            dab->shouldPreserveDab = false;
+            dab->origDab = new KisFixedPaintDevice(*dab->origDab);
+            dab->origDabIsCached = false;
         }
 
         const int denormedPaintThickness = qRound(paintThickness * 255.0);
-        KoBgrU8Traits::Pixel *pixelPtr = reinterpret_cast<KoBgrU8Traits::Pixel *>(m_origDab->data());
+        KoBgrU8Traits::Pixel *pixelPtr = reinterpret_cast<KoBgrU8Traits::Pixel *>(dab->origDab->data());
         for (int i = 0; i < numPixels; i++) {
             int gray = pixelPtr->red - 127;
 
@@ -129,13 +129,18 @@ void KisColorSmudgeStrategyLightness::updateMask(KisDabCache *dabCache, const Ki
         }
     }
 
-    m_maskDab->setRect(m_origDab->bounds());
-    m_maskDab->lazyGrowBufferWithoutInitialization();
-    m_origDab->colorSpace()->copyOpacityU8(m_origDab->data(), m_maskDab->data(), numPixels);
+    if (!dab->maskDab) {
+        dab->maskDab = new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+    }
+
+    dab->maskDab->setRect(dab->origDab->bounds());
+    dab->maskDab->lazyGrowBufferWithoutInitialization();
+    dab->origDab->colorSpace()->copyOpacityU8(dab->origDab->data(), dab->maskDab->data(), numPixels);
 }
 
 QVector<QRect>
-KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor,
+KisColorSmudgeStrategyLightness::paintDab(const Dab &dab,
+                                          const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor,
                                           qreal opacity, qreal colorRateValue, qreal smudgeRateValue,
                                           qreal maxPossibleSmudgeRateValue, qreal paintThicknessValue,
                                           qreal smudgeRadiusValue)
@@ -152,7 +157,7 @@ KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dst
 
     blendBrush({ &m_finalPainter },
         m_sourceWrapperDevice,
-        m_maskDab, m_shouldPreserveOriginalDab,
+        dab.maskDab, dab.shouldPreserveDab,
         srcRect, dstRect,
         currentPaintColor,
         opacity,
@@ -168,8 +173,8 @@ KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dst
         1.0 : KisAlgebra2D::lerp(overlaySmearRate, 1.0, paintThicknessValue);
     const quint8 brushHeightmapOpacity = qRound(opacity * overlayAdjustment * 255.0);
     m_heightmapPainter.setOpacity(brushHeightmapOpacity);
-    m_heightmapPainter.bltFixed(dstRect.topLeft(), m_origDab, m_origDab->bounds());
-    m_heightmapPainter.renderMirrorMaskSafe(dstRect, m_origDab, m_shouldPreserveOriginalDab);
+    m_heightmapPainter.bltFixed(dstRect.topLeft(), dab.origDab, dab.origDab->bounds());
+    m_heightmapPainter.renderMirrorMaskSafe(dstRect, dab.origDab, dab.shouldPreserveDab);
 
 
     KisFixedPaintDeviceSP tempColorDevice =
@@ -24,18 +24,18 @@ public:
 
     DabColoringStrategy &coloringStrategy() override;
 
-    void updateMask(KisDabCache *dabCache,
+    void updateMask(Dab *dab,
+                    KisDabCache *dabCache,
                     const KisPaintInformation& info,
                     const KisDabShape &shape,
                     const QPointF &cursorPoint,
                     QRect *dstDabRect, qreal lightnessStrength) override;
 
-    QVector<QRect> paintDab(const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor, qreal opacity,
+    QVector<QRect> paintDab(const Dab &dab,
+                            const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor, qreal opacity,
                             qreal colorRateValue, qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
                             qreal lightnessStrengthValue, qreal smudgeRadiusValue) override;
 private:
-    KisFixedPaintDeviceSP m_maskDab;
-    KisFixedPaintDeviceSP m_origDab;
     KisPaintDeviceSP m_heightmapDevice;
     KisPaintDeviceSP m_colorOnlyDevice;
     KisPaintDeviceSP m_projectionDevice;
@@ -43,7 +43,6 @@ private:
     KisColorSmudgeSourceSP m_sourceWrapperDevice;
     KisPainter m_finalPainter;
     KisPainter m_heightmapPainter;
-    bool m_shouldPreserveOriginalDab {true};
     DabColoringStrategyMask m_coloringStrategy;
     bool m_smearAlpha {true};
     KisPainter *m_initializationPainter {nullptr};
@@ -20,20 +20,21 @@ KisColorSmudgeStrategyBase::DabColoringStrategy &KisColorSmudgeStrategyMask::col
     return m_coloringStrategy;
 }
 
-void KisColorSmudgeStrategyMask::updateMask(KisDabCache *dabCache, const KisPaintInformation &info, const KisDabShape &shape,
+void KisColorSmudgeStrategyMask::updateMask(Dab *dab, KisDabCache *dabCache, const KisPaintInformation &info, const KisDabShape &shape,
                                        const QPointF &cursorPoint, QRect *dstDabRect, qreal lightnessStrength)
 {
     static const KoColorSpace* cs = KoColorSpaceRegistry::instance()->alpha8();
     static KoColor color(Qt::black, cs);
 
-    m_maskDab = dabCache->fetchDab(cs,
-                                   color,
-                                   cursorPoint,
-                                   shape,
-                                   info,
-                                   1.0,
-                                   dstDabRect,
-                                   lightnessStrength);
+    dab->maskDab = dabCache->fetchDab(cs,
+                                      color,
+                                      cursorPoint,
+                                      shape,
+                                      info,
+                                      1.0,
+                                      dstDabRect,
+                                      lightnessStrength);
 
-    m_shouldPreserveMaskDab = !dabCache->needSeparateOriginal();
+    dab->maskDabIsCached = true;
+    dab->shouldPreserveDab = !dabCache->needSeparateOriginal();
 }
@@ -20,7 +20,8 @@ public:
 
     DabColoringStrategy &coloringStrategy() override;
 
-    void updateMask(KisDabCache *dabCache,
+    void updateMask(Dab *dab,
+                    KisDabCache *dabCache,
                     const KisPaintInformation& info,
                     const KisDabShape &shape,
                     const QPointF &cursorPoint,
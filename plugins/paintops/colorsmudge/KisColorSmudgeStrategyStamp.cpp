@@ -9,12 +9,13 @@
 #include "kis_fixed_paint_device.h"
 #include "kis_image.h"
 #include "KisOverlayPaintDeviceWrapper.h"
+#include <KoColorSpaceRegistry.h>
 
 
 KisColorSmudgeStrategyStamp::KisColorSmudgeStrategyStamp(KisPainter *painter, KisImageSP image, bool smearAlpha,
                                                          bool useDullingMode, bool useOverlayMode)
         : KisColorSmudgeStrategyWithOverlay(painter, image, smearAlpha, useDullingMode, useOverlayMode)
-        , m_origDab(new KisFixedPaintDevice(m_layerOverlayDevice->overlayColorSpace())) // TODO: check compositionSourceColorSpace!
+        , m_origDabColorSpace(m_layerOverlayDevice->overlayColorSpace()) // TODO: check compositionSourceColorSpace!
 {
 }
 
@@ -23,28 +24,47 @@ KisColorSmudgeStrategyBase::DabColoringStrategy &KisColorSmudgeStrategyStamp::co
     return m_coloringStrategy;
 }
 
-void KisColorSmudgeStrategyStamp::updateMask(KisDabCache *dabCache, const KisPaintInformation &info,
+void KisColorSmudgeStrategyStamp::updateMask(Dab *dab, KisDabCache *dabCache, const KisPaintInformation &info,
                                              const KisDabShape &shape, const QPointF &cursorPoint, QRect *dstDabRect, qreal lightnessStrength)
 {
 
-    static KoColor color(Qt::black, m_origDab->colorSpace());
+    static KoColor color(Qt::black, m_origDabColorSpace);
 
-    m_origDab = dabCache->fetchDab(m_origDab->colorSpace(),
-                                   color,
-                                   cursorPoint,
-                                   shape,
-                                   info,
-                                   1.0,
-                                   dstDabRect,
-                                   lightnessStrength);
+    dab->origDab = dabCache->fetchDab(m_origDabColorSpace,
+                                      color,
+                                      cursorPoint,
+                                      shape,
+                                      info,
+                                      1.0,
+                                      dstDabRect,
+                                      lightnessStrength);
+    dab->origDabIsCached = true;
 
-    m_coloringStrategy.setStampDab(m_origDab);
+    if (!dab->maskDab) {
+        dab->maskDab = new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+    }
 
-    const int numPixels = m_origDab->bounds().width() * m_origDab->bounds().height();
+    const int numPixels = dab->origDab->bounds().width() * dab->origDab->bounds().height();
 
-    m_maskDab->setRect(m_origDab->bounds());
-    m_maskDab->lazyGrowBufferWithoutInitialization();
-    m_origDab->colorSpace()->copyOpacityU8(m_origDab->data(), m_maskDab->data(), numPixels);
+    dab->maskDab->setRect(dab->origDab->bounds());
+    dab->maskDab->lazyGrowBufferWithoutInitialization();
+    dab->origDab->colorSpace()->copyOpacityU8(dab->origDab->data(), dab->maskDab->data(), numPixels);
 
-    m_shouldPreserveMaskDab = false;
+    dab->shouldPreserveDab = false;
+}
+
+QVector<QRect> KisColorSmudgeStrategyStamp::paintDab(const Dab &dab,
+                                                     const QRect &srcRect, const QRect &dstRect,
+                                                     const KoColor &currentPaintColor, qreal opacity,
+                                                     qreal colorRateValue, qreal smudgeRateValue,
+                                                     qreal maxPossibleSmudgeRateValue,
+                                                     qreal lightnessStrengthValue, qreal smudgeRadiusValue)
+{
+    m_coloringStrategy.setStampDab(dab.origDab);
+
+    return KisColorSmudgeStrategyWithOverlay::paintDab(dab, srcRect, dstRect,
+                                                       currentPaintColor, opacity,
+                                                       colorRateValue, smudgeRateValue,
+                                                       maxPossibleSmudgeRateValue,
+                                                       lightnessStrengthValue, smudgeRadiusValue);
 }
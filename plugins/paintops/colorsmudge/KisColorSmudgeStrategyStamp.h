@@ -19,15 +19,21 @@ struct KisColorSmudgeStrategyStamp : public KisColorSmudgeStrategyWithOverlay
 
     DabColoringStrategy &coloringStrategy() override;
 
-    void updateMask(KisDabCache *dabCache,
+    void updateMask(Dab *dab,
+                    KisDabCache *dabCache,
                     const KisPaintInformation& info,
                     const KisDabShape &shape,
                     const QPointF &cursorPoint,
                     QRect *dstDabRect,
                     qreal lightnessStrength) override;
 
+    QVector<QRect> paintDab(const Dab &dab,
+                            const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor, qreal opacity,
+                            qreal colorRateValue, qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
+                            qreal lightnessStrengthValue, qreal smudgeRadiusValue) override;
+
 private:
-    KisFixedPaintDeviceSP m_origDab;
+    const KoColorSpace *m_origDabColorSpace;
     DabColoringStrategyStamp m_coloringStrategy;
 };
 
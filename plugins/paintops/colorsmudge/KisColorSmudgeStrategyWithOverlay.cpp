@@ -19,7 +19,6 @@ KisColorSmudgeStrategyWithOverlay::KisColorSmudgeStrategyWithOverlay(KisPainter
                                                                      bool smearAlpha, bool useDullingMode,
                                                                      bool useOverlayMode)
         : KisColorSmudgeStrategyBase(useDullingMode)
-        , m_maskDab(new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8()))
         , m_smearAlpha(smearAlpha)
         , m_initializationPainter(painter)
 {
@@ -69,7 +68,8 @@ QVector<KisPainter *> KisColorSmudgeStrategyWithOverlay::finalPainters()
     return result;
 }
 
-QVector<QRect> KisColorSmudgeStrategyWithOverlay::paintDab(const QRect &srcRect, const QRect &dstRect,
+QVector<QRect> KisColorSmudgeStrategyWithOverlay::paintDab(const Dab &dab,
+                                                           const QRect &srcRect, const QRect &dstRect,
                                                            const KoColor &currentPaintColor, qreal opacity,
                                                            qreal colorRateValue, qreal smudgeRateValue,
                                                            qreal maxPossibleSmudgeRateValue,
@@ -95,7 +95,7 @@ QVector<QRect> KisColorSmudgeStrategyWithOverlay::paintDab(const QRect &srcRect,
 
     blendBrush(finalPainters(),
                m_sourceWrapperDevice,
-               m_maskDab, m_shouldPreserveMaskDab,
+               dab.maskDab, dab.shouldPreserveDab,
                srcRect, dstRect,
                currentPaintColor,
                opacity,
@@ -7,6 +7,8 @@
 #include "kis_colorsmudgeop.h"
 
 #include <QRect>
+#include <QElapsedTimer>
+#include <kis_pointer_utils.h>
 
 #include <KoColor.h>
 
@@ -18,6 +20,10 @@
 #include <kis_spacing_information.h>
 #include "kis_paintop_plugin_utils.h"
 
+#include <KisRunnableStrokeJobData.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <KisRunnableStrokeJobsInterface.h>
+
 #include "KisInterstrokeData.h"
 #include "KisInterstrokeDataFactory.h"
 
@@ -111,6 +117,35 @@ KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPaint
     }
 
     m_strategy->initializePainting();
+
+    if (m_smudgeRateOption.mode() == KisSmudgeLengthOptionData::SMEARING_MODE) {
+        /**
+        * Disable handling of the subpixel precision. In the smudge op we
+        * should read from the aligned areas of the image, so having
+        * additional internal offsets, created by the subpixel precision,
+        * will worsen the quality (at least because
+        * QRectF(dstDabRect).center() will not point to the real center
+        * of the brush anymore).
+        * Of course, this only really matters with smearing_mode (bug:327235),
+        * and you only notice the lack of subpixel precision in the dulling methods.
+        */
+        m_dabCache->disableSubpixelPrecision();
+    }
+
+    /**
+     * The masks can be generated ahead of time only when their generation
+     * doesn't depend on the order of the dabs. Pipe brushes change their
+     * state on every dab, and texturing/sharpness and a randomized mirror
+     * option consume values from the random source of the stroke inside
+     * the dab cache, so such presets are painted synchronously.
+     */
+    const enumBrushType brushType = m_brush->brushType();
+    m_useAsynchronousUpdates =
+        painter->runnableStrokeJobsInterface() &&
+        (brushType == MASK || brushType == IMAGE) &&
+        !m_dabCache->needSeparateOriginal() &&
+        !(m_mirrorOption.isChecked() && m_mirrorOption.isRandom());
+
     m_paintColor = painter->paintColor().convertedTo(m_strategy->preciseColorSpace());
 
     m_hsvOptions.append(KisHSVOption::createHueOption(settings.data()));
@@ -140,19 +175,6 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
     if (!painter()->device() || !brush || !brush->canPaintFor(info)) {
         return KisSpacingInformation(1.0);
     }
-    if (m_smudgeRateOption.mode() == KisSmudgeLengthOptionData::SMEARING_MODE) {
-        /**
-        * Disable handling of the subpixel precision. In the smudge op we
-        * should read from the aligned areas of the image, so having
-        * additional internal offsets, created by the subpixel precision,
-        * will worsen the quality (at least because
-        * QRectF(m_dstDabRect).center() will not point to the real center
-        * of the brush anymore).
-        * Of course, this only really matters with smearing_mode (bug:327235),
-        * and you only notice the lack of subpixel precision in the dulling methods.
-        */
-        m_dabCache->disableSubpixelPrecision();
-    }
 
     // get the scaling factor calculated by the size option
     qreal scale = m_sizeOption.apply(info);
@@ -177,11 +199,60 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
 
     KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_strategy, spacingInfo);
 
+    DabRequest request;
+    request.info = info;
+    request.shape = shape;
+    request.scatteredPos = scatteredPos;
+    request.smudgeRadiusPortion = smudgeRadiusPortion;
+    request.paintThickness = m_paintThicknessOption.apply(info);
+    request.isFirstDab = m_firstRun;
 
-    const qreal paintThickness = m_paintThicknessOption.apply(info);
-    m_strategy->updateMask(m_dabCache, info, shape, scatteredPos, &m_dstDabRect, paintThickness);
+    /**
+     * In the synchronous mode the mask is generated before the rest of
+     * the options are evaluated, just like it has always been done, so
+     * that the values are taken from the random source in the same order
+     */
+    if (!m_useAsynchronousUpdates) {
+        prepareDab(&request, &m_dabs[0]);
+    }
 
-    QPointF newCenterPos = QRectF(m_dstDabRect).center();
+    if (m_firstRun) {
+        m_firstRun = false;
+    } else {
+        request.colorRate = m_colorRateOption.isChecked() ? m_colorRateOption.computeSizeLikeValue(info) : 0.0;
+        request.smudgeRate = m_smudgeRateOption.isChecked() ? m_smudgeRateOption.computeSizeLikeValue(info) : 1.0;
+        request.maxSmudgeRate = m_smudgeRateOption.strengthValue();
+        request.opacity = m_opacityOption.apply(info);
+
+        KoColor paintColor = m_paintColor;
+
+        m_gradientOption.apply(paintColor, m_gradient, info);
+        if (m_hsvTransform) {
+            Q_FOREACH (KisHSVOption *option, m_hsvOptions) {
+                option->apply(m_hsvTransform, info);
+            }
+            m_hsvTransform->transform(paintColor.data(), paintColor.data(), 1);
+        }
+
+        request.paintColor = paintColor;
+    }
+
+    if (m_useAsynchronousUpdates) {
+        m_dabsQueue.append(request);
+    } else if (!request.isFirstDab) {
+        painter()->addDirtyRects(paintDab(request, m_dabs[0]));
+    }
+
+    return spacingInfo;
+}
+
+void KisColorSmudgeOp::prepareDab(DabRequest *request, KisColorSmudgeStrategy::Dab *dab)
+{
+    m_strategy->updateMask(dab, m_dabCache, request->info, request->shape,
+                           request->scatteredPos, &request->dstDabRect,
+                           request->paintThickness);
+
+    QPointF newCenterPos = QRectF(request->dstDabRect).center();
     /**
      * Save the center of the current dab to know where to read the
      * data during the next pass. We do not save scatteredPos here,
@@ -189,42 +260,98 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
      * brush (due to rounding effects), which will result in a
      * really weird quality.
      */
-    QRect srcDabRect = m_dstDabRect.translated((m_lastPaintPos - newCenterPos).toPoint());
+    request->srcDabRect = request->dstDabRect.translated((m_lastPaintPos - newCenterPos).toPoint());
 
     m_lastPaintPos = newCenterPos;
+}
 
-    if (m_firstRun) {
-        m_firstRun = false;
-        return spacingInfo;
+QVector<QRect> KisColorSmudgeOp::paintDab(const DabRequest &request, const KisColorSmudgeStrategy::Dab &dab)
+{
+    return m_strategy->paintDab(dab,
+                                request.srcDabRect, request.dstDabRect,
+                                request.paintColor,
+                                request.opacity, request.colorRate,
+                                request.smudgeRate,
+                                request.maxSmudgeRate,
+                                request.paintThickness,
+                                request.smudgeRadiusPortion);
+}
+
+struct KisColorSmudgeOp::UpdateSharedState
+{
+    QVector<DabRequest> dabsQueue;
+    QVector<QVector<QRect>> dirtyRects;
+    QElapsedTimer dabRenderingTimer;
+};
+
+std::pair<int, bool> KisColorSmudgeOp::doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    if (m_updateSharedState || m_dabsQueue.isEmpty()) {
+        return std::make_pair(m_currentUpdatePeriod, m_updateSharedState && !m_dabsQueue.isEmpty());
     }
 
-    const qreal colorRate = m_colorRateOption.isChecked() ? m_colorRateOption.computeSizeLikeValue(info) : 0.0;
-    const qreal smudgeRate = m_smudgeRateOption.isChecked() ? m_smudgeRateOption.computeSizeLikeValue(info) : 1.0;
-    const qreal maxSmudgeRate = m_smudgeRateOption.strengthValue();
-    const qreal fpOpacity = m_opacityOption.apply(info);
+    m_updateSharedState = toQShared(new UpdateSharedState());
+    UpdateSharedStateSP state = m_updateSharedState;
 
-    KoColor paintColor = m_paintColor;
+    state->dabsQueue.swap(m_dabsQueue);
+    state->dirtyRects.resize(state->dabsQueue.size());
+    state->dabRenderingTimer.start();
+
+    /**
+     * Smudging reads the pixels painted by the previous dab, so blending
+     * is strictly sequential. What we can do is to generate the mask of
+     * the next dab in parallel with blending of the current one:
+     *
+     * prepare(0) | paint(0), prepare(1) | paint(1), prepare(2) | ...
+     *
+     * The prepared dabs alternate between the two slots in m_dabs.
+     */
+    KritaUtils::addJobSequential(jobs,
+        [this, state] () {
+            prepareDab(&state->dabsQueue[0], &m_dabs[0]);
+            m_dabs[0].detachFromDabCache();
+        }
+    );
+
+    for (int i = 0; i < state->dabsQueue.size(); i++) {
+        if (!state->dabsQueue[i].isFirstDab) {
+            KritaUtils::addJobConcurrent(jobs,
+                [this, state, i] () {
+                    state->dirtyRects[i] = paintDab(state->dabsQueue[i], m_dabs[i % 2]);
+                }
+            );
+        }
 
-    m_gradientOption.apply(paintColor, m_gradient, info);
-    if (m_hsvTransform) {
-        Q_FOREACH (KisHSVOption *option, m_hsvOptions) {
-            option->apply(m_hsvTransform, info);
+        if (i + 1 < state->dabsQueue.size()) {
+            KritaUtils::addJobConcurrent(jobs,
+                [this, state, i] () {
+                    KisColorSmudgeStrategy::Dab *dab = &m_dabs[(i + 1) % 2];
+                    prepareDab(&state->dabsQueue[i + 1], dab);
+                    dab->detachFromDabCache();
+                }
+            );
         }
-        m_hsvTransform->transform(paintColor.data(), paintColor.data(), 1);
+
+        KritaUtils::addJobSequential(jobs, nullptr);
     }
 
-    const QVector<QRect> dirtyRects =
-            m_strategy->paintDab(srcDabRect, m_dstDabRect,
-                                 paintColor,
-                                 fpOpacity, colorRate,
-                                 smudgeRate,
-                                 maxSmudgeRate,
-                                 paintThickness,
-                                 smudgeRadiusPortion);
+    KritaUtils::addJobSequential(jobs,
+        [this, state] () {
+            Q_FOREACH (const QVector<QRect> &rects, state->dirtyRects) {
+                painter()->addDirtyRects(rects);
+            }
 
-    painter()->addDirtyRects(dirtyRects);
+            const int minUpdatePeriod = 10;
+            const int maxUpdatePeriod = 100;
 
-    return spacingInfo;
+            m_currentUpdatePeriod =
+                qBound(minUpdatePeriod, int(1.5 * state->dabRenderingTimer.elapsed()), maxUpdatePeriod);
+
+            m_updateSharedState.clear();
+        }
+    );
+
+    return std::make_pair(m_currentUpdatePeriod, false);
 }
 
 KisSpacingInformation KisColorSmudgeOp::updateSpacingImpl(const KisPaintInformation &info) const
@@ -8,9 +8,14 @@
 #define _KIS_COLORSMUDGEOP_H_
 
 #include <QRect>
+#include <QSharedPointer>
 
 #include "KoColorTransformation.h"
 #include <KoAbstractGradient.h>
+#include <KoColor.h>
+
+#include <brushengine/kis_paint_information.h>
+#include <kis_dab_shape.h>
 
 #include <kis_brush_based_paintop.h>
 #include <kis_types.h>
@@ -29,14 +34,15 @@
 #include <KisSmudgeRadiusOption.h>
 #include <KisSmudgeOverlayModeOptionData.h>
 
+#include "KisColorSmudgeStrategy.h"
+
 class QPointF;
 
 class KisBrushBasedPaintOpSettings;
 class KisPainter;
 class KoColorSpace;
 class KisInterstrokeDataFactory;
-
-class KisColorSmudgeStrategy;
+class KisRunnableStrokeJobData;
 
 class KisColorSmudgeOp: public KisBrushBasedPaintOp
 {
@@ -46,12 +52,46 @@ public:
 
     static KisInterstrokeDataFactory* createInterstrokeDataFactory(const KisPaintOpSettingsSP settings, KisResourcesInterfaceSP resourcesInterface);
 
+    std::pair<int, bool> doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs) override;
+
 protected:
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
 
     KisSpacingInformation updateSpacingImpl(const KisPaintInformation &info) const override;
     KisTimingInformation updateTimingImpl(const KisPaintInformation &info) const override;
 
+private:
+    /**
+     * All the values of the dynamic options are evaluated in paintAt(),
+     * in the same order as in the synchronous mode, so that the random
+     * sources of the stroke produced exactly the same sequence.
+     */
+    struct DabRequest
+    {
+        KisPaintInformation info;
+        KisDabShape shape;
+        QPointF scatteredPos;
+        bool isFirstDab = false;
+
+        qreal paintThickness = 1.0;
+        qreal smudgeRadiusPortion = 0.0;
+        qreal colorRate = 0.0;
+        qreal smudgeRate = 1.0;
+        qreal maxSmudgeRate = 1.0;
+        qreal opacity = 1.0;
+        KoColor paintColor;
+
+        // filled by prepareDab()
+        QRect srcDabRect;
+        QRect dstDabRect;
+    };
+
+    struct UpdateSharedState;
+    typedef QSharedPointer<UpdateSharedState> UpdateSharedStateSP;
+
+    void prepareDab(DabRequest *request, KisColorSmudgeStrategy::Dab *dab);
+    QVector<QRect> paintDab(const DabRequest &request, const KisColorSmudgeStrategy::Dab &dab);
+
 private:
     bool                      m_firstRun;
 
@@ -74,11 +114,23 @@ private:
     KisAirbrushOptionData m_airbrushData;
     KisSmudgeOverlayModeOptionData m_overlayModeData;
 
-    QRect                     m_dstDabRect;
     QPointF                   m_lastPaintPos;
 
     KoColorTransformation *m_hsvTransform {0};
     QScopedPointer<KisColorSmudgeStrategy> m_strategy;
+
+    /**
+     * In asynchronous mode paintAt() only evaluates the dynamic options
+     * and queues the dab. The masks are generated and blended by the
+     * jobs created in doAsynchronousUpdate(): the mask of the next dab
+     * is generated while the current one is being blended. Two dab
+     * slots are enough for that.
+     */
+    bool m_useAsynchronousUpdates {false};
+    QVector<DabRequest> m_dabsQueue;
+    KisColorSmudgeStrategy::Dab m_dabs[2];
+    UpdateSharedStateSP m_updateSharedState;
+    int m_currentUpdatePeriod {20};
 };
 
 #endif // _KIS_COLORSMUDGEOP_H_
@@ -17,6 +17,8 @@ public:
     KisColorSmudgeOpSettings(KisResourcesInterfaceSP resourcesInterface);
     ~KisColorSmudgeOpSettings() override;
 
+    bool needsAsynchronousUpdates() const override;
+
     QList<KisUniformPaintOpPropertySP> uniformProperties(KisPaintOpSettingsSP settings, QPointer<KisPaintOpPresetUpdateProxy> updateProxy) override;
 
 private:
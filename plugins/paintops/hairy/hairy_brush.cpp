@@ -13,17 +13,25 @@
 
 #include <QVariant>
 #include <QHash>
+#include <QMap>
 #include <QVector>
 
 #include <kis_types.h>
-#include <kis_random_accessor_ng.h>
 #include <kis_cross_device_color_sampler.h>
 #include <kis_fixed_paint_device.h>
+#include <kis_datamanager.h>
 
 
 #include <cmath>
 #include <ctime>
 
+namespace {
+inline int divideRoundDown(int x, int y)
+{
+    return x >= 0 ? x / y : -((-x + y - 1) / y);
+}
+}
+
 
 HairyBrush::HairyBrush()
 {
@@ -123,10 +131,11 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
     Bristle *bristle = 0;
     KoColor bristleColor(dab->colorSpace());
 
-    m_dabAccessor = dab->createRandomAccessorNG();
-
     m_dab = dab;
 
+    m_inkPositions.clear();
+    m_inkColors.clear();
+
     // initialization block
     if (firstStroke()) {
         initAndCache();
@@ -231,8 +240,10 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
         }
 
     }
+
+    renderInk();
+
     m_dab = nullptr;
-    m_dabAccessor = nullptr;
 }
 
 
@@ -296,6 +307,85 @@ void HairyBrush::opacityDepletion(Bristle* bristle, KoColor& bristleColor, qreal
 inline void HairyBrush::addBristleInk(Bristle *bristle,const QPointF &pos, const KoColor &color)
 {
     Q_UNUSED(bristle);
+
+    m_inkPositions.append(pos);
+    m_inkColors.append(reinterpret_cast<const char*>(color.data()), m_pixelSize);
+}
+
+void HairyBrush::renderInk()
+{
+    if (m_inkPositions.isEmpty()) return;
+
+    const KoColorSpace *cs = m_dab->colorSpace();
+
+    if (!m_inkBuffer || *m_inkBuffer->colorSpace() != *cs) {
+        m_inkBuffer = new KisFixedPaintDevice(cs);
+    }
+
+    const QSize tileSize = !m_inkTileSize.isEmpty() ?
+        m_inkTileSize : m_dab->dataManager()->tileSize();
+
+    struct TileInk {
+        QRect rect;
+        QVector<int> points;
+    };
+
+    /**
+     * The ink points are grouped by the tiles their pixels fall into,
+     * a particle on the border of the tiles goes into all of them. The
+     * points of every tile keep their original order, so every pixel
+     * gets exactly the same sequence of writes as before, while the
+     * buffer never grows bigger than a tile, however long the segment is.
+     */
+    QMap<QPair<int, int>, TileInk> tiles;
+
+    for (int i = 0; i < m_inkPositions.size(); i++) {
+        const QPointF &pos = m_inkPositions[i];
+
+        const QRect pointRect = m_properties->antialias ?
+            QRect(int(pos.x()), int(pos.y()), 2, 2) :
+            QRect(qRound(pos.x()), qRound(pos.y()), 1, 1);
+
+        const int firstRow = divideRoundDown(pointRect.top(), tileSize.height());
+        const int lastRow = divideRoundDown(pointRect.bottom(), tileSize.height());
+        const int firstCol = divideRoundDown(pointRect.left(), tileSize.width());
+        const int lastCol = divideRoundDown(pointRect.right(), tileSize.width());
+
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int col = firstCol; col <= lastCol; col++) {
+                const QRect tileRect(col * tileSize.width(), row * tileSize.height(),
+                                     tileSize.width(), tileSize.height());
+
+                TileInk &tile = tiles[qMakePair(row, col)];
+                tile.rect |= pointRect & tileRect;
+                tile.points.append(i);
+            }
+        }
+    }
+
+    const quint8 *colors = reinterpret_cast<const quint8*>(m_inkColors.constData());
+
+    // only the touched part of every tile is written back, so that
+    // the extent of the dab stays the same as with per-pixel access
+    for (auto it = tiles.constBegin(); it != tiles.constEnd(); ++it) {
+        m_inkRect = it->rect;
+
+        m_inkBuffer->setRect(m_inkRect);
+        m_inkBuffer->lazyGrowBufferWithoutInitialization();
+        m_dab->readBytes(m_inkBuffer->data(), m_inkRect);
+
+        Q_FOREACH (int index, it->points) {
+            plotInk(m_inkPositions[index], colors + index * m_pixelSize);
+        }
+
+        m_dab->writeBytes(m_inkBuffer->data(), m_inkRect);
+    }
+
+    m_inkRect = QRect();
+}
+
+inline void HairyBrush::plotInk(const QPointF &pos, const quint8 *color)
+{
     if (m_properties->antialias) {
         if (m_properties->useCompositing) {
             paintParticle(pos, color);
@@ -315,10 +405,12 @@ inline void HairyBrush::addBristleInk(Bristle *bristle,const QPointF &pos, const
     }
 }
 
-void HairyBrush::paintParticle(QPointF pos, const KoColor& color, qreal weight)
+void HairyBrush::paintParticle(QPointF pos, const quint8 *color, qreal weight)
 {
+    const KoColorSpace * cs = m_dab->colorSpace();
+
     // opacity top left, right, bottom left, right
-    quint8 opacity = color.opacityU8();
+    quint8 opacity = cs->opacityU8(color);
     opacity *= weight;
 
     int ipx = int (pos.x());
@@ -331,34 +423,40 @@ void HairyBrush::paintParticle(QPointF pos, const KoColor& color, qreal weight)
     quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity);
     quint8 bbr = qRound((fx)  * (fy)  * opacity);
 
-    const KoColorSpace * cs = m_dab->colorSpace();
+    quint8 *dst = inkPixel(ipx, ipy);
+    if (dst) {
+        btl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btl + cs->opacityU8(dst), OPACITY_OPAQUE_U8));
+        memcpy(dst, color, m_pixelSize);
+        cs->setOpacity(dst, btl, 1);
+    }
+
+    dst = inkPixel(ipx + 1, ipy);
+    if (dst) {
+        btr =  quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btr + cs->opacityU8(dst), OPACITY_OPAQUE_U8));
+        memcpy(dst, color, m_pixelSize);
+        cs->setOpacity(dst, btr, 1);
+    }
 
-    m_dabAccessor->moveTo(ipx  , ipy);
-    btl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btl, 1);
-
-    m_dabAccessor->moveTo(ipx + 1, ipy);
-    btr =  quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btr, 1);
-
-    m_dabAccessor->moveTo(ipx, ipy + 1);
-    bbl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbl, 1);
-
-    m_dabAccessor->moveTo(ipx + 1, ipy + 1);
-    bbr = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbr, 1);
+    dst = inkPixel(ipx, ipy + 1);
+    if (dst) {
+        bbl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbl + cs->opacityU8(dst), OPACITY_OPAQUE_U8));
+        memcpy(dst, color, m_pixelSize);
+        cs->setOpacity(dst, bbl, 1);
+    }
+
+    dst = inkPixel(ipx + 1, ipy + 1);
+    if (dst) {
+        bbr = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbr + cs->opacityU8(dst), OPACITY_OPAQUE_U8));
+        memcpy(dst, color, m_pixelSize);
+        cs->setOpacity(dst, bbr, 1);
+    }
 }
 
-void HairyBrush::paintParticle(QPointF pos, const KoColor& color)
+void HairyBrush::paintParticle(QPointF pos, const quint8 *color)
 {
     // opacity top left, right, bottom left, right
-    memcpy(m_color.data(), color.data(), m_pixelSize);
-    quint8 opacity = color.opacityU8();
+    memcpy(m_color.data(), color, m_pixelSize);
+    quint8 opacity = m_dab->colorSpace()->opacityU8(color);
 
     int ipx = int (pos.x());
     int ipy = int (pos.y());
@@ -371,30 +469,34 @@ void HairyBrush::paintParticle(QPointF pos, const KoColor& color)
     quint8 bbr = qRound((fx)  * (fy)  * opacity);
 
     m_color.setOpacity(btl);
-    plotPixel(ipx  , ipy, m_color);
+    plotPixel(ipx  , ipy, m_color.data());
 
     m_color.setOpacity(btr);
-    plotPixel(ipx + 1  , ipy, m_color);
+    plotPixel(ipx + 1  , ipy, m_color.data());
 
     m_color.setOpacity(bbl);
-    plotPixel(ipx  , ipy + 1, m_color);
+    plotPixel(ipx  , ipy + 1, m_color.data());
 
     m_color.setOpacity(bbr);
-    plotPixel(ipx + 1 , ipy + 1, m_color);
+    plotPixel(ipx + 1 , ipy + 1, m_color.data());
 }
 
 
-inline void HairyBrush::plotPixel(int wx, int wy, const KoColor &color)
+inline void HairyBrush::plotPixel(int wx, int wy, const quint8 *color)
 {
-    m_dabAccessor->moveTo(wx, wy);
-    m_compositeOp->composite(m_dabAccessor->rawData(), m_pixelSize, color.data() , m_pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_U8);
+    quint8 *dst = inkPixel(wx, wy);
+    if (!dst) return;
+
+    m_compositeOp->composite(dst, m_pixelSize, color, m_pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_U8);
 }
 
-inline void HairyBrush::darkenPixel(int wx, int wy, const KoColor &color)
+inline void HairyBrush::darkenPixel(int wx, int wy, const quint8 *color)
 {
-    m_dabAccessor->moveTo(wx, wy);
-    if (m_dab->colorSpace()->opacityU8(m_dabAccessor->rawData()) < color.opacityU8()) {
-        memcpy(m_dabAccessor->rawData(), color.data(), m_pixelSize);
+    quint8 *dst = inkPixel(wx, wy);
+    if (!dst) return;
+
+    if (m_dab->colorSpace()->opacityU8(dst) < m_dab->colorSpace()->opacityU8(color)) {
+        memcpy(dst, color, m_pixelSize);
     }
 }
 
@@ -10,6 +10,7 @@
 #include <QVector>
 #include <QList>
 #include <QTransform>
+#include <QByteArray>
 
 #include <KoColor.h>
 
@@ -17,8 +18,8 @@
 #include "bristle.h"
 
 #include <kis_paint_device.h>
+#include <kis_fixed_paint_device.h>
 #include <brushengine/kis_paint_information.h>
-#include <kis_random_accessor_ng.h>
 
 class KoCompositeOp;
 
@@ -74,16 +75,25 @@ public:
     void fromDabWithDensity(KisFixedPaintDeviceSP dab, qreal density);
 
 private:
-    /// paints single bristle
+    /// queue a single ink point of a bristle, it will be painted by renderInk()
     void addBristleInk(Bristle *bristle,const QPointF &pos, const KoColor &color);
+    /// paint all the queued ink points into the dab, tile by tile
+    void renderInk();
+    /// paint single ink point into m_inkBuffer, the pixels outside m_inkRect are skipped
+    void plotInk(const QPointF &pos, const quint8 *color);
     /// composite single pixel to dab
-    void plotPixel(int wx, int wy, const KoColor &color);
+    void plotPixel(int wx, int wy, const quint8 *color);
     /// check the opacity of dab pixel and if the opacity is less than color, it will copy color to dab
-    void darkenPixel(int wx, int wy, const KoColor &color);
+    void darkenPixel(int wx, int wy, const quint8 *color);
     /// paint wu particle by copying the color and setup just the opacity, weight is complementary to opacity of the color
-    void paintParticle(QPointF pos, const KoColor& color, qreal weight);
+    void paintParticle(QPointF pos, const quint8 *color, qreal weight);
     /// paint wu particle using composite operation
-    void paintParticle(QPointF pos, const KoColor& color);
+    void paintParticle(QPointF pos, const quint8 *color);
+    /// pointer to the pixel of m_inkBuffer, null if the pixel is outside m_inkRect
+    inline quint8* inkPixel(int wx, int wy) const {
+        if (!m_inkRect.contains(wx, wy)) return nullptr;
+        return m_inkBuffer->data() + ((wy - m_inkRect.y()) * m_inkRect.width() + wx - m_inkRect.x()) * m_pixelSize;
+    }
     /// similar to sample input color in spray
     void colorifyBristles(KisPaintDeviceSP source, QPointF point);
 
@@ -111,7 +121,23 @@ private:
     QHash<QString, QVariant> m_params;
     // temporary device
     KisPaintDeviceSP m_dab;
-    KisRandomAccessorSP m_dabAccessor;
+
+    /**
+     * The ink points of all the bristles are first collected in
+     * m_inkPositions/m_inkColors and then painted in the original order
+     * into a plain linear buffer, one tile of the dab at a time. Every
+     * tile is read and written once, which is much cheaper than moving
+     * a random accessor for every pixel of every bristle.
+     */
+    QVector<QPointF> m_inkPositions;
+    QByteArray m_inkColors;
+    QRect m_inkRect;
+    KisFixedPaintDeviceSP m_inkBuffer;
+
+    friend class HairyBrushTest;
+    /// the size of the tiles of the ink buffer, the tile size of the dab if empty
+    QSize m_inkTileSize;
+
     const KoCompositeOp * m_compositeOp {nullptr};
     quint32 m_pixelSize {0};
 
@@ -0,0 +1,128 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "HairyBrushTest.h"
+
+#include "kistest.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_fixed_paint_device.h>
+#include <brushengine/kis_paint_information.h>
+#include <brushengine/kis_random_source.h>
+
+#include "../hairy_brush.h"
+
+namespace {
+
+KisHairyProperties createProperties(bool antialias, bool useCompositing)
+{
+    KisHairyProperties properties;
+
+    properties.radius = 5;
+    properties.inkAmount = 1024;
+    properties.sigma = 1.0;
+    properties.inkDepletionCurve = QVector<qreal>(1024, 0.0);
+    properties.inkDepletionEnabled = false;
+    properties.isbrushDimension1D = false;
+    properties.useMousePressure = false;
+    properties.useSaturation = false;
+    properties.useOpacity = true;
+    properties.useWeights = false;
+
+    properties.useSoakInk = false;
+    properties.connectedPath = false;
+    properties.antialias = antialias;
+    properties.useCompositing = useCompositing;
+
+    properties.pressureWeight = 50;
+    properties.bristleLengthWeight = 50;
+    properties.bristleInkAmountWeight = 50;
+    properties.inkDepletionWeight = 50;
+
+    properties.shearFactor = 0.0;
+    properties.randomFactor = 2.0;
+    properties.scaleFactor = 2.0;
+    properties.threshold = 0.0;
+
+    return properties;
+}
+
+}
+
+void HairyBrushTest::testTiledInkMatchesPerPixelInk_data()
+{
+    QTest::addColumn<bool>("antialias");
+    QTest::addColumn<bool>("useCompositing");
+
+    QTest::addRow("aliased-darken") << false << false;
+    QTest::addRow("aliased-composite") << false << true;
+    QTest::addRow("antialiased-particle") << true << false;
+    QTest::addRow("antialiased-composite") << true << true;
+}
+
+void HairyBrushTest::testTiledInkMatchesPerPixelInk()
+{
+    QFETCH(bool, antialias);
+    QFETCH(bool, useCompositing);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    // the opacity of the brush tip becomes the length of the bristles
+    KisFixedPaintDeviceSP tip = new KisFixedPaintDevice(cs);
+    tip->setRect(QRect(0, 0, 11, 11));
+    tip->initialize();
+    tip->fill(QRect(0, 0, 11, 11), KoColor(QColor(255, 0, 0, 100), cs));
+    tip->fill(QRect(3, 3, 5, 5), KoColor(QColor(0, 0, 255, 255), cs));
+
+    KisHairyProperties properties = createProperties(antialias, useCompositing);
+
+    /**
+     * A 1x1 ink tile makes the brush read and write every pixel of the
+     * dab separately, in the order the bristles paint it, exactly as the
+     * random accessor used to do. The long diagonal segment crosses many
+     * tiles and its bounding box is mostly empty.
+     */
+    auto paintSegment = [&] (const QSize &inkTileSize) {
+        HairyBrush brush;
+        brush.setProperties(&properties);
+        brush.setInkColor(KoColor(Qt::black, cs));
+        brush.fromDabWithDensity(tip, 1.0);
+        brush.m_inkTileSize = inkTileSize;
+
+        KisPaintInformation pi1(QPointF(10.5, 20.3), 1.0);
+        KisPaintInformation pi2(QPointF(1500.2, 1100.7), 0.8);
+        pi2.setRandomSource(new KisRandomSource(42));
+
+        KisPaintDeviceSP dab = new KisPaintDevice(cs);
+        brush.paintLine(dab, nullptr, pi1, pi2, 1.0, 0.3);
+
+        return dab;
+    };
+
+    KisPaintDeviceSP tiled = paintSegment(QSize());
+    KisPaintDeviceSP perPixel = paintSegment(QSize(1, 1));
+
+    const QRect rc = perPixel->exactBounds();
+    QVERIFY(rc.width() > 1400);
+    QVERIFY(rc.height() > 1000);
+
+    QCOMPARE(tiled->extent(), perPixel->extent());
+    QCOMPARE(tiled->exactBounds(), rc);
+
+    QVector<quint8> tiledBytes(rc.width() * rc.height() * cs->pixelSize());
+    QVector<quint8> perPixelBytes(rc.width() * rc.height() * cs->pixelSize());
+
+    tiled->readBytes(tiledBytes.data(), rc);
+    perPixel->readBytes(perPixelBytes.data(), rc);
+
+    QVERIFY(tiledBytes == perPixelBytes);
+}
+
+KISTEST_MAIN(HairyBrushTest)
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef HAIRY_BRUSH_TEST_H
+#define HAIRY_BRUSH_TEST_H
+
+#include <simpletest.h>
+
+class HairyBrushTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testTiledInkMatchesPerPixelInk_data();
+    void testTiledInkMatchesPerPixelInk();
+};
+
+#endif // HAIRY_BRUSH_TEST_H
@@ -19,6 +19,7 @@
 #include <qmath.h>
 #include <KoCompositeOpRegistry.h>
 #include <KoMixColorsOp.h>
+#include <KisRectsGrid.h>
 
 using namespace std;
 
@@ -115,6 +116,40 @@ void KisMyPaintSurface::get_color(MyPaintSurface *self, float x, float y, float
 }
 
 
+void KisMyPaintSurface::beginDabsBatch()
+{
+    /**
+     * The batched dabs are copied back to the layer without the channel
+     * flags of the painter, so alpha and channel locks need the per-dab path
+     */
+    const QBitArray channelFlags = m_tempPainter->channelFlags();
+    const bool hasLockedChannels = !channelFlags.isEmpty() && channelFlags.count(true) != channelFlags.size();
+
+    m_batchDabs = !m_tempPainter->selection() && !m_tempPainter->hasMirroring() && !hasLockedChannels;
+}
+
+void KisMyPaintSurface::endDabsBatch()
+{
+    if (!m_pendingDabs.isEmpty()) {
+        if (m_surface->bitDepth == KoChannelInfo::UINT8) {
+            flushDabsImpl<quint8>();
+        }
+        else if (m_surface->bitDepth == KoChannelInfo::UINT16) {
+            flushDabsImpl<quint16>();
+        }
+#if defined HAVE_OPENEXR
+        else if (m_surface->bitDepth == KoChannelInfo::FLOAT16) {
+            flushDabsImpl<half>();
+        }
+#endif
+        else {
+            flushDabsImpl<float>();
+        }
+    }
+
+    m_batchDabs = false;
+}
+
 /*GIMP's draw_dab and get_color code*/
 template <typename channelType>
 int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float radius, float color_r, float color_g,
@@ -123,8 +158,108 @@ int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float
 
     Q_UNUSED(self);
     Q_UNUSED(lock_alpha);
+
+    const QPoint pt = QPoint(x - radius - 1, y - radius - 1);
+    const QSize sz = QSize(2 * (radius+1), 2 * (radius+1));
+
+    Dab dab;
+    dab.x = x;
+    dab.y = y;
+    dab.radius = radius;
+    dab.color_r = color_r;
+    dab.color_g = color_g;
+    dab.color_b = color_b;
+    dab.color_a = color_a;
+    dab.opaque = opaque;
+    dab.hardness = hardness;
+    dab.aspect_ratio = aspect_ratio;
+    dab.angle = angle;
+    dab.colorize = colorize;
+    dab.rect = QRect(pt, sz);
+
+    if (m_batchDabs) {
+        m_pendingDabs.append(dab);
+        return 1;
+    }
+
+    const QRect dabRectAligned = dab.rect;
+
+    m_precisePainterWrapper.readRects(m_tempPainter->calculateAllMirroredRects(dabRectAligned));
+    m_tempPainter->copyAreaOptimized(dabRectAligned.topLeft(), m_tempPainter->device(), m_dab, dabRectAligned);
+
+    m_maskDevice->setRect(dabRectAligned);
+    m_maskDevice->lazyGrowBufferWithoutInitialization();
+
+    blendDab<channelType>(dab, m_maskDevice->data());
+
+    m_tempPainter->bitBltWithFixedSelection(dabRectAligned.x(), dabRectAligned.y(), m_dab, m_maskDevice, dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.width(), dabRectAligned.height());
+    m_tempPainter->renderMirrorMask(dabRectAligned, m_dab, dabRectAligned.x(), dabRectAligned.y(), m_maskDevice);
+    const QVector<QRect> dirtyRects = m_tempPainter->takeDirtyRegion();
+    m_precisePainterWrapper.writeRects(dirtyRects);
+    painter()->addDirtyRects(dirtyRects);
+    return 1;
+}
+
+template <typename channelType>
+void KisMyPaintSurface::flushDabsImpl()
+{
+    /**
+     * Without selection and mirroring the blending mask is binary, so
+     * blending the dabs one after another right in m_dab and copying
+     * the result back gives exactly the same pixels as blending every
+     * dab separately. The layer is accessed once per tile instead of
+     * once per dab.
+     */
+    KisRectsGrid grid;
+    QVector<QRect> tileRects;
+    QVector<QRect> dirtyRects;
+
+    Q_FOREACH (const Dab &dab, m_pendingDabs) {
+        tileRects += grid.addRect(dab.rect);
+        dirtyRects << dab.rect;
+    }
+
+    m_precisePainterWrapper.readRects(tileRects);
+
+    KisPaintDeviceSP overlay = m_precisePainterWrapper.overlay();
+
+    Q_FOREACH (const QRect &rc, tileRects) {
+        KisPainter::copyAreaOptimized(rc.topLeft(), overlay, m_dab, rc);
+    }
+
+    Q_FOREACH (const Dab &dab, m_pendingDabs) {
+        blendDab<channelType>(dab, nullptr);
+    }
+
+    Q_FOREACH (const QRect &rc, tileRects) {
+        KisPainter::copyAreaOptimized(rc.topLeft(), m_dab, overlay, rc);
+    }
+
+    m_precisePainterWrapper.writeRects(tileRects);
+    painter()->addDirtyRects(dirtyRects);
+
+    m_pendingDabs.clear();
+}
+
+/**
+ * Blends \p dab into m_dab. The pixels with non-zero opacity are marked
+ * in \p maskPointer. When no mask is passed, only these pixels are
+ * written to m_dab.
+ */
+template <typename channelType>
+void KisMyPaintSurface::blendDab(const Dab &dab, quint8 *maskPointer)
+{
+    const float x = dab.x;
+    const float y = dab.y;
+    const float radius = dab.radius;
+    const float color_r = dab.color_r;
+    const float color_g = dab.color_g;
+    const float color_b = dab.color_b;
+    const float color_a = dab.color_a;
+    const float opaque = dab.opaque;
+
     const float one_over_radius2 = 1.0f / (radius * radius);
-    const double angle_rad = kisDegreesToRadians(angle);
+    const double angle_rad = kisDegreesToRadians(dab.angle);
     const float cs = cos(angle_rad);
     const float sn = sin(angle_rad);
     float normal_mode;
@@ -132,27 +267,22 @@ int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float
     float segment2_slope;
     float r_aa_start;
 
-    hardness = CLAMP (hardness, 0.0f, 1.0f);
+    const float hardness = CLAMP (dab.hardness, 0.0f, 1.0f);
     segment1_slope = -(1.0f / hardness - 1.0f);
     segment2_slope = -hardness / (1.0f - hardness);
-    aspect_ratio = max(1.0f, aspect_ratio);
+    const float aspect_ratio = max(1.0f, dab.aspect_ratio);
 
     r_aa_start = radius - 1.0f;
     r_aa_start = max(r_aa_start, 0.0f);
     r_aa_start = (r_aa_start * r_aa_start) / aspect_ratio;
 
-    normal_mode = opaque * (1.0f - colorize);
-    colorize = opaque * colorize;
+    normal_mode = opaque * (1.0f - dab.colorize);
+    const float colorize = opaque * dab.colorize;
 
-    const QPoint pt = QPoint(x - radius - 1, y - radius - 1);
-    const QSize sz = QSize(2 * (radius+1), 2 * (radius+1));
-
-    const QRect dabRectAligned = QRect(pt, sz);
+    const QRect dabRectAligned = dab.rect;
     const QPointF center = QPointF(x, y);
 
     KisAlgebra2D::OuterCircle outer(center, radius);
-    m_precisePainterWrapper.readRects(m_tempPainter->calculateAllMirroredRects(dabRectAligned));
-    m_tempPainter->copyAreaOptimized(dabRectAligned.topLeft(), m_tempPainter->device(), m_dab, dabRectAligned);
     KisSequentialIterator it(m_dab, dabRectAligned);
 
     quint8 maskUnitValue = KoColorSpaceMathsTraits<quint8>::unitValue; // because it's alpha8
@@ -161,45 +291,87 @@ int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float
     float minValue = KoColorSpaceMathsTraits<channelType>::min;
     bool eraser = painter()->compositeOpId() == COMPOSITE_ERASE;
 
+    /**
+     * The opacity of the dab is generated for the whole row before blending
+     * it. For the usual (non-tiny) dabs the loop is plain arithmetic without
+     * any calls or early exits, so the compiler can vectorize it. The pixels
+     * outside the dab's outer circle are marked with a negative value.
+     */
+    m_rowAlpha.resize(dabRectAligned.width());
+    float *rowAlpha = m_rowAlpha.data();
+    int rowAlphaY = dabRectAligned.y() - 1;
 
-    m_maskDevice->setRect(dabRectAligned);
-    m_maskDevice->lazyGrowBufferWithoutInitialization();
+    auto calculateRowAlpha = [&] (int yp) {
+        const int x0 = dabRectAligned.x();
+        const int width = dabRectAligned.width();
 
+        if (radius < 3.0) {
+            for (int i = 0; i < width; i++) {
+                const float rr = calculate_rr_antialiased (x0 + i, yp, x, y, aspect_ratio, sn, cs, one_over_radius2, r_aa_start);
+                rowAlpha[i] = calculate_alpha_for_rr (rr, hardness, segment1_slope, segment2_slope);
+            }
+        } else {
+            const float yy = (yp + 0.5f - y);
+
+            for (int i = 0; i < width; i++) {
+                const float xx = (x0 + i + 0.5f - x);
+                const float yyr = (yy*cs-xx*sn)*aspect_ratio;
+                const float xxr = yy*sn+xx*cs;
+                const float rr = (yyr*yyr + xxr*xxr) * one_over_radius2;
+
+                const float innerAlpha = 1.0f + rr * segment1_slope;
+                const float outerAlpha = rr * segment2_slope - segment2_slope;
+                rowAlpha[i] = rr > 1.0f ? 0.0f : (rr <= hardness ? innerAlpha : outerAlpha);
+            }
+        }
+
+        for (int i = 0; i < width; i++) {
+            if (outer.fadeSq(QPointF(x0 + i, yp)) > 1.0f) {
+                rowAlpha[i] = -1.0f;
+            }
+        }
+    };
 
     // Dmitry says that going with the pointer should be in the same order
     // as using the sequential iterator
-    quint8* maskPointer = m_maskDevice->data();
-
 
     while(it.nextPixel()) {
 
         // first initialize to 0;
-        *maskPointer = 0;
-
-        QPoint pt(it.x(), it.y());
+        if (maskPointer) {
+            *maskPointer = 0;
+        }
 
-        if(outer.fadeSq(pt) > 1.0f) {
-            maskPointer++;
-            continue;
+        if (it.y() != rowAlphaY) {
+            calculateRowAlpha(it.y());
+            rowAlphaY = it.y();
         }
 
-        float rr, base_alpha, alpha, dst_alpha, r, g, b, a;
+        const float pixelAlpha = rowAlpha[it.x() - dabRectAligned.x()];
 
-        if (radius < 3.0) {
-            rr = calculate_rr_antialiased (it.x(), it.y(), x, y, aspect_ratio, sn, cs, one_over_radius2, r_aa_start);
-        }
-        else {
-            rr = calculate_rr (it.x(), it.y(), x, y, aspect_ratio, sn, cs, one_over_radius2);
+        if (pixelAlpha < 0.0f) {
+            if (maskPointer) {
+                maskPointer++;
+            }
+            continue;
         }
 
-        base_alpha = calculate_alpha_for_rr (rr, hardness, segment1_slope, segment2_slope);
+        float base_alpha, alpha, dst_alpha, r, g, b, a;
+
+        base_alpha = pixelAlpha;
 
-        m_tempPainter->selection();
         alpha = base_alpha * normal_mode;
 
         // set alpha to mask
-        if (alpha > minValue) {
-            *maskPointer = (quint8)(maskUnitValue);
+        const bool isMasked = alpha > minValue;
+
+        if (maskPointer) {
+            if (isMasked) {
+                *maskPointer = (quint8)(maskUnitValue);
+            }
+            maskPointer++;
+        } else if (!isMasked) {
+            continue;
         }
 
         channelType* nativeArray = reinterpret_cast<channelType*>(it.rawData());
@@ -262,23 +434,19 @@ int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float
         nativeArray[1] = KoColorSpaceMaths<float, channelType>::scaleToA(g);
         nativeArray[2] = KoColorSpaceMaths<float, channelType>::scaleToA(r);
         nativeArray[3] = KoColorSpaceMaths<float, channelType>::scaleToA(a);
-
-        maskPointer++;
     }
-
-
-    m_tempPainter->bitBltWithFixedSelection(dabRectAligned.x(), dabRectAligned.y(), m_dab, m_maskDevice, dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.width(), dabRectAligned.height());
-    m_tempPainter->renderMirrorMask(dabRectAligned, m_dab, dabRectAligned.x(), dabRectAligned.y(), m_maskDevice);
-    const QVector<QRect> dirtyRects = m_tempPainter->takeDirtyRegion();
-    m_precisePainterWrapper.writeRects(dirtyRects);
-    painter()->addDirtyRects(dirtyRects);
-    return 1;
 }
 
 template <typename channelType>
 void KisMyPaintSurface::getColorImpl(MyPaintSurface *self, float x, float y, float radius,
                             float * color_r, float * color_g, float * color_b, float * color_a) {
     Q_UNUSED(self);
+
+    // the color should be sampled from the result of all the previous dabs
+    if (!m_pendingDabs.isEmpty()) {
+        flushDabsImpl<channelType>();
+    }
+
     if (radius < 1.0f)
         radius = 1.0f;
 
@@ -323,7 +491,8 @@ void KisMyPaintSurface::getColorImpl(MyPaintSurface *self, float x, float y, flo
     m_blendDevice->lazyGrowBufferWithoutInitialization();
 
 
-    qint16* weights = new qint16[size];
+    m_colorWeights.resize(size);
+    qint16* weights = m_colorWeights.data();
     quint32 num_colors = 0;
 
     activeDev->readBytes(m_blendDevice->data(), dabRectAligned);
@@ -369,8 +538,6 @@ void KisMyPaintSurface::getColorImpl(MyPaintSurface *self, float x, float y, flo
             *color_a = CLAMP(a, 0.0f, 1.0f);
         }
     }
-
-    delete [] weights;
 }
 
 KisPainter* KisMyPaintSurface::painter() {
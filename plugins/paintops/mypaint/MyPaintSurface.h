@@ -69,6 +69,19 @@ public:
                   float sn, float cs, float one_over_radius2);
 
 
+    /**
+     * Dabs drawn between beginDabsBatch() and endDabsBatch() are not
+     * blended immediately. They are collected and blended in one pass,
+     * reading and writing every affected tile of the layer only once.
+     * get_color() flushes the collected dabs before sampling.
+     *
+     * Batching is disabled when the painter has a selection, mirroring or
+     * locked channels, because in that case every dab depends on the masked
+     * result of the previous one.
+     */
+    void beginDabsBatch();
+    void endDabsBatch();
+
     KisPainter* painter();
     void paint(KoColor *color, KoColor* bgColor);
     qreal calculateOpacity(float angle, float hardness, float opaque, float x, float y,
@@ -76,6 +89,29 @@ public:
 
     MyPaintSurface* surface();
 
+private:
+    struct Dab {
+        float x;
+        float y;
+        float radius;
+        float color_r;
+        float color_g;
+        float color_b;
+        float color_a;
+        float opaque;
+        float hardness;
+        float aspect_ratio;
+        float angle;
+        float colorize;
+        QRect rect;
+    };
+
+    template <typename channelType>
+    void blendDab(const Dab &dab, quint8 *maskPointer);
+
+    template <typename channelType>
+    void flushDabsImpl();
+
 private:
     KisPainter *m_painter;
     KisPaintDeviceSP m_imageDevice;
@@ -88,6 +124,11 @@ private:
     KisFixedPaintDeviceSP m_blendDevice;
     KisFixedPaintDeviceSP m_maskDevice;
 
+    bool m_batchDabs {false};
+    QVector<Dab> m_pendingDabs;
+    QVector<qint16> m_colorWeights;
+    QVector<float> m_rowAlpha;
+
 };
 
 #endif // KIS_MYPAINT_SURFACE_H
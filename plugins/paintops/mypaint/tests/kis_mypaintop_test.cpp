@@ -79,6 +79,93 @@ void KisMyPaintOpTest::testGetColor() {
     QVERIFY(qFuzzyCompare((float)qRound(a), 1.0L));
 }
 
+void KisMyPaintOpTest::testDabsBatch() {
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    KisPaintDeviceSP batchDev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+
+    KisPainter refPainter(refDev);
+    KisPainter batchPainter(batchDev);
+
+    QScopedPointer<KisMyPaintSurface> refSurface(new KisMyPaintSurface(&refPainter, refDev));
+    QScopedPointer<KisMyPaintSurface> batchSurface(new KisMyPaintSurface(&batchPainter, batchDev));
+
+    auto drawDabs = [] (KisMyPaintSurface *surface) {
+        for (int i = 0; i < 40; i++) {
+            surface->draw_dab(surface->surface(), 50 + 7 * i, 100 + 3 * i, 20, 0, 0.5, 1, 0.5, 0.8, 1, 1.5, 30, 0, 0);
+        }
+    };
+
+    drawDabs(refSurface.data());
+
+    batchSurface->beginDabsBatch();
+    drawDabs(batchSurface.data());
+    batchSurface->endDabsBatch();
+
+    QCOMPARE(batchDev->exactBounds(), refDev->exactBounds());
+
+    const QRect rc = refDev->exactBounds();
+    QImage refImage = refDev->convertToQImage(0, rc.x(), rc.y(), rc.width(), rc.height());
+    QImage batchImage = batchDev->convertToQImage(0, rc.x(), rc.y(), rc.width(), rc.height());
+
+    QPoint errpoint;
+    if (!TestUtil::compareQImages(errpoint, refImage, batchImage)) {
+        QFAIL(QString("Batched dabs differ from the unbatched ones, first different pixel: %1,%2 \n").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
+void KisMyPaintOpTest::testDabsBatchAlphaLocked() {
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(cs);
+    KisPaintDeviceSP batchDev = new KisPaintDevice(cs);
+
+    const QRect filledRect(0, 0, 150, 400);
+    refDev->fill(filledRect, KoColor(Qt::white, cs));
+    batchDev->fill(filledRect, KoColor(Qt::white, cs));
+
+    // alpha lock
+    const QBitArray channelFlags = cs->channelFlags(true, false);
+
+    KisPainter refPainter(refDev);
+    refPainter.setChannelFlags(channelFlags);
+    KisPainter batchPainter(batchDev);
+    batchPainter.setChannelFlags(channelFlags);
+
+    QScopedPointer<KisMyPaintSurface> refSurface(new KisMyPaintSurface(&refPainter, refDev));
+    QScopedPointer<KisMyPaintSurface> batchSurface(new KisMyPaintSurface(&batchPainter, batchDev));
+
+    auto drawDabs = [] (KisMyPaintSurface *surface) {
+        for (int i = 0; i < 40; i++) {
+            surface->draw_dab(surface->surface(), 50 + 7 * i, 100 + 3 * i, 20, 0, 0.5, 1, 0.5, 0.8, 1, 1.5, 30, 0, 0);
+        }
+    };
+
+    drawDabs(refSurface.data());
+
+    batchSurface->beginDabsBatch();
+    drawDabs(batchSurface.data());
+    batchSurface->endDabsBatch();
+
+    // the dabs outside of the filled area must stay transparent
+    QCOMPARE(refDev->pixel(QPoint(260, 190)).opacityU8(), OPACITY_TRANSPARENT_U8);
+    QCOMPARE(batchDev->pixel(QPoint(260, 190)).opacityU8(), OPACITY_TRANSPARENT_U8);
+
+    const QRect rc = refDev->exactBounds() | batchDev->exactBounds();
+    QImage refImage = refDev->convertToQImage(0, rc.x(), rc.y(), rc.width(), rc.height());
+    QImage batchImage = batchDev->convertToQImage(0, rc.x(), rc.y(), rc.width(), rc.height());
+
+    QPoint errpoint;
+    if (!TestUtil::compareQImages(errpoint, refImage, batchImage)) {
+        QFAIL(QString("Batched dabs differ from the unbatched ones, first different pixel: %1,%2 \n").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+
+    // the filled area should be painted over with the locked alpha
+    QCOMPARE(batchDev->pixel(QPoint(60, 104)).opacityU8(), OPACITY_OPAQUE_U8);
+    QVERIFY(batchDev->pixel(QPoint(60, 104)) != KoColor(Qt::white, cs));
+}
+
 void KisMyPaintOpTest::testLoading() {
 
     QScopedPointer<KisMyPaintPaintOpPreset> brush (new KisMyPaintPaintOpPreset(QString(FILES_DATA_DIR) + QDir::separator() + "basic.myb"));
@@ -23,6 +23,8 @@ public:
 private Q_SLOTS:
     void testDab();
     void testGetColor();
+    void testDabsBatch();
+    void testDabsBatchAlphaLocked();
     void testLoading();
 };
 
@@ -0,0 +1,87 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSprayPixelBuffer.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include <kis_paint_device.h>
+#include <kis_datamanager.h>
+#include <kis_assert.h>
+#include <kis_random_accessor_ng.h>
+
+namespace {
+inline int divideRoundDown(int x, int y)
+{
+    return x >= 0 ? x / y : -((-x + y - 1) / y);
+}
+}
+
+KisSprayPixelBuffer::KisSprayPixelBuffer(int pixelSize)
+    : m_pixelSize(pixelSize)
+{
+}
+
+void KisSprayPixelBuffer::addPixel(int x, int y, const quint8 *color)
+{
+    m_positions.append(QPoint(x, y));
+
+    const int offset = m_colors.size();
+    m_colors.resize(offset + m_pixelSize);
+    memcpy(m_colors.data() + offset, color, m_pixelSize);
+}
+
+bool KisSprayPixelBuffer::isEmpty() const
+{
+    return m_positions.isEmpty();
+}
+
+int KisSprayPixelBuffer::pixelSize() const
+{
+    return m_pixelSize;
+}
+
+void KisSprayPixelBuffer::flush(KisPaintDeviceSP dev)
+{
+    if (m_positions.isEmpty()) return;
+
+    KIS_SAFE_ASSERT_RECOVER(dev->pixelSize() == quint32(m_pixelSize)) {
+        m_positions.clear();
+        m_colors.clear();
+        return;
+    }
+
+    const QSize tileSize = dev->dataManager()->tileSize();
+
+    auto tileKey = [tileSize] (const QPoint &pt) {
+        return qMakePair(divideRoundDown(pt.y(), tileSize.height()),
+                         divideRoundDown(pt.x(), tileSize.width()));
+    };
+
+    /**
+     * The sort is stable, so the overwrites of the same pixel still
+     * happen in the order they were added
+     */
+    m_order.resize(m_positions.size());
+    std::iota(m_order.begin(), m_order.end(), 0);
+    std::stable_sort(m_order.begin(), m_order.end(),
+                     [&] (int lhs, int rhs) {
+                         return tileKey(m_positions[lhs]) < tileKey(m_positions[rhs]);
+                     });
+
+    KisRandomAccessorSP accessor = dev->createRandomAccessorNG();
+    const quint8 *colors = m_colors.constData();
+
+    Q_FOREACH (int index, m_order) {
+        const QPoint &pt = m_positions[index];
+        accessor->moveTo(pt.x(), pt.y());
+        memcpy(accessor->rawData(), colors + index * m_pixelSize, m_pixelSize);
+    }
+
+    m_positions.clear();
+    m_colors.clear();
+}
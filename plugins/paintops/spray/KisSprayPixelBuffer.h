@@ -0,0 +1,48 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_SPRAY_PIXEL_BUFFER_H
+#define KIS_SPRAY_PIXEL_BUFFER_H
+
+#include <QPoint>
+#include <QVector>
+
+#include <kis_types.h>
+
+/**
+ * Pixel overwrites of the wu-particle and pixel shapes of the spray
+ * brush. The writes are queued while the particles are generated and
+ * applied to the dab in one go by flush().
+ *
+ * Particles come in random order, so writing them directly makes the
+ * accessor jump between tiles on almost every pixel. flush() groups
+ * the writes by tile instead, but the result is exactly the same as if
+ * the pixels were written one by one in the order they were added:
+ * when a pixel is added several times, the last color wins.
+ */
+class KisSprayPixelBuffer
+{
+public:
+    explicit KisSprayPixelBuffer(int pixelSize = 1);
+
+    void addPixel(int x, int y, const quint8 *color);
+
+    bool isEmpty() const;
+    int pixelSize() const;
+
+    /**
+     * Writes all the queued pixels into \p dev and clears the buffer
+     */
+    void flush(KisPaintDeviceSP dev);
+
+private:
+    int m_pixelSize;
+    QVector<QPoint> m_positions;
+    QVector<quint8> m_colors;
+    QVector<int> m_order;
+};
+
+#endif // KIS_SPRAY_PIXEL_BUFFER_H
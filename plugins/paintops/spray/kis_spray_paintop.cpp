@@ -10,6 +10,8 @@
 #include <cmath>
 
 #include <QRect>
+#include <QElapsedTimer>
+#include <kis_pointer_utils.h>
 #include <kis_global.h>
 #include <kis_paint_device.h>
 #include <kis_painter.h>
@@ -23,6 +25,10 @@
 #include <kis_paintop_plugin_utils.h>
 #include <KoResourceLoadResult.h>
 
+#include <KisRunnableStrokeJobData.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <KisRunnableStrokeJobsInterface.h>
+
 
 KisSprayPaintOp::KisSprayPaintOp(const KisPaintOpSettingsSP settings, KisPainter *painter, KisNodeSP node, KisImageSP image)
     : KisPaintOp(painter)
@@ -63,6 +69,12 @@ KisSprayPaintOp::KisSprayPaintOp(const KisPaintOpSettingsSP settings, KisPainter
 
     m_sprayBrush.setFixedDab(cachedDab());
 
+    m_useAsynchronousUpdates =
+        painter->runnableStrokeJobsInterface() &&
+        settings->needsAsynchronousUpdates() &&
+        m_isPresetValid &&
+        m_sprayBrush.canGenerateParticlesConcurrently();
+
     // spacing
     if ((m_sprayOpOption.data.diameter * 0.5) > 1) {
         m_ySpacing = m_xSpacing = m_sprayOpOption.data.diameter * 0.5 * m_sprayOpOption.data.spacing;
@@ -89,13 +101,6 @@ KisSpacingInformation KisSprayPaintOp::paintAt(const KisPaintInformation& info)
         return KisSpacingInformation(m_spacing);
     }
 
-    if (!m_dab) {
-        m_dab = source()->createCompositionSourceDevice();
-    }
-    else {
-        m_dab->clear();
-    }
-
     qreal rotation = m_rotationOption.apply(info);
     quint8 origOpacity = m_opacityOption.apply(painter(), info);
     // Spray Brush is capable of working with zero scale,
@@ -103,6 +108,28 @@ KisSpacingInformation KisSprayPaintOp::paintAt(const KisPaintInformation& info)
     const qreal scale = m_sizeOption.apply(info);
     const qreal lodScale = KisLodTransform::lodToScale(painter()->device());
 
+    if (m_useAsynchronousUpdates) {
+        DabRequest request;
+        request.pixelDab = m_sprayBrush.preparePixelDab(info,
+                                                        rotation,
+                                                        scale, lodScale,
+                                                        painter()->paintColor(),
+                                                        painter()->backgroundColor());
+        request.opacity = painter()->opacity();
+        painter()->setOpacity(origOpacity);
+
+        m_dabsQueue.append(request);
+
+        return computeSpacing(info, lodScale);
+    }
+
+    if (!m_dab) {
+        m_dab = source()->createCompositionSourceDevice();
+    }
+    else {
+        m_dab->clear();
+    }
+
 
     m_sprayBrush.paint(m_dab,
                        m_node->paintDevice(),
@@ -120,6 +147,79 @@ KisSpacingInformation KisSprayPaintOp::paintAt(const KisPaintInformation& info)
     return computeSpacing(info, lodScale);
 }
 
+void KisSprayPaintOp::paintDab(SprayBrush::PixelDab *pixelDab, quint8 opacity)
+{
+    if (!m_dab) {
+        m_dab = source()->createCompositionSourceDevice();
+    }
+    else {
+        m_dab->clear();
+    }
+
+    m_sprayBrush.flushPixelDab(pixelDab, m_dab);
+
+    const quint8 origOpacity = painter()->opacity();
+    painter()->setOpacity(opacity);
+
+    QRect rc = m_dab->extent();
+    painter()->bitBlt(rc.topLeft(), m_dab, rc);
+    painter()->renderMirrorMask(rc, m_dab);
+    painter()->setOpacity(origOpacity);
+}
+
+struct KisSprayPaintOp::UpdateSharedState
+{
+    QVector<DabRequest> dabsQueue;
+    QElapsedTimer dabRenderingTimer;
+};
+
+std::pair<int, bool> KisSprayPaintOp::doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    if (m_updateSharedState || m_dabsQueue.isEmpty()) {
+        return std::make_pair(m_currentUpdatePeriod, m_updateSharedState && !m_dabsQueue.isEmpty());
+    }
+
+    m_updateSharedState = toQShared(new UpdateSharedState());
+    UpdateSharedStateSP state = m_updateSharedState;
+
+    state->dabsQueue.swap(m_dabsQueue);
+    state->dabRenderingTimer.start();
+
+    /**
+     * Every block of particles has its own random source, so all the
+     * blocks of all the queued dabs are generated concurrently. The
+     * pixels overwrite each other, so writing and blending of the dabs
+     * is sequential.
+     */
+    for (int i = 0; i < state->dabsQueue.size(); i++) {
+        for (int block = 0; block < state->dabsQueue[i].pixelDab.blocks.size(); block++) {
+            KritaUtils::addJobConcurrent(jobs,
+                [this, state, i, block] () {
+                    m_sprayBrush.generatePixelBlock(&state->dabsQueue[i].pixelDab, block);
+                }
+            );
+        }
+    }
+
+    KritaUtils::addJobSequential(jobs,
+        [this, state] () {
+            for (auto it = state->dabsQueue.begin(); it != state->dabsQueue.end(); ++it) {
+                paintDab(&it->pixelDab, it->opacity);
+            }
+
+            const int minUpdatePeriod = 10;
+            const int maxUpdatePeriod = 100;
+
+            m_currentUpdatePeriod =
+                qBound(minUpdatePeriod, int(1.5 * state->dabRenderingTimer.elapsed()), maxUpdatePeriod);
+
+            m_updateSharedState.clear();
+        }
+    );
+
+    return std::make_pair(m_currentUpdatePeriod, false);
+}
+
 KisSpacingInformation KisSprayPaintOp::updateSpacingImpl(const KisPaintInformation &info) const
 {
     return computeSpacing(info, KisLodTransform::lodToScale(painter()->device()));
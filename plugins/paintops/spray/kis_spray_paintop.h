@@ -7,6 +7,8 @@
 #ifndef KIS_SPRAY_PAINTOP_H_
 #define KIS_SPRAY_PAINTOP_H_
 
+#include <QSharedPointer>
+
 #include <brushengine/kis_paintop.h>
 #include <kis_types.h>
 
@@ -34,6 +36,8 @@ public:
 
     static QList<KoResourceLoadResult> prepareLinkedResources(const KisPaintOpSettingsSP settings, KisResourcesInterfaceSP resourcesInterface);
 
+    std::pair<int, bool> doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs) override;
+
 protected:
 
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
@@ -45,6 +49,17 @@ protected:
 private:
     KisSpacingInformation computeSpacing(const KisPaintInformation &info, qreal lodScale) const;
 
+    struct DabRequest
+    {
+        SprayBrush::PixelDab pixelDab;
+        quint8 opacity = OPACITY_OPAQUE_U8;
+    };
+
+    struct UpdateSharedState;
+    typedef QSharedPointer<UpdateSharedState> UpdateSharedStateSP;
+
+    void paintDab(SprayBrush::PixelDab *pixelDab, quint8 opacity);
+
 private:
     KisSprayShapeOptionData m_shapeProperties;
     KisSprayOpOption m_sprayOpOption;
@@ -63,6 +78,18 @@ private:
     KisOpacityOption m_opacityOption;
     KisRateOption m_rateOption;
     KisNodeSP m_node;
+
+    /**
+     * With the wu-particle and pixel shapes paintAt() only takes the
+     * values of the dab from the random sources and queues it. The
+     * particles are generated concurrently by the jobs created in
+     * doAsynchronousUpdate(), then the dabs are written and blended
+     * in their order.
+     */
+    bool m_useAsynchronousUpdates {false};
+    QVector<DabRequest> m_dabsQueue;
+    UpdateSharedStateSP m_updateSharedState;
+    int m_currentUpdatePeriod {20};
 };
 
 #endif // KIS_SPRAY_PAINTOP_H_
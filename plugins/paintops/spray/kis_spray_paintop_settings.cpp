@@ -13,6 +13,7 @@
 #include "KisSprayShapeOptionData.h"
 #include <KisOptimizedBrushOutline.h>
 #include <KisSprayOpOptionData.h>
+#include "spray_brush.h"
 
 struct KisSprayPaintOpSettings::Private
 {
@@ -66,6 +67,17 @@ bool KisSprayPaintOpSettings::paintIncremental()
     return data.paintingMode == enumPaintingMode::BUILDUP;
 }
 
+bool KisSprayPaintOpSettings::needsAsynchronousUpdates() const
+{
+    KisSprayShapeOptionData shapeData;
+    shapeData.read(this);
+
+    KisColorOptionData colorData;
+    colorData.read(this);
+
+    return SprayBrush::canGenerateParticlesConcurrently(shapeData, colorData);
+}
+
 
 KisOptimizedBrushOutline KisSprayPaintOpSettings::brushOutline(const KisPaintInformation &info, const OutlineMode &mode, qreal alignForZoom)
 {
@@ -89,51 +89,56 @@ qreal SprayBrush::rotationAngle(KisRandomSourceSP randomSource)
     return rotation;
 }
 
-void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
-                       const KisPaintInformation& info,
-                       qreal rotation, qreal scale,
-                       qreal additionalScale,
-                       const KoColor &color, const KoColor &bgColor)
+template <typename Func>
+void SprayBrush::dispatchDistributions(Func func) const
 {
+    auto dispatchRadial = [&] (const auto &angularDistribution) {
+        if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Uniform) {
+            if (m_sprayOpOption->data.radialDistributionCenterBiased) {
+                func(angularDistribution, m_sprayOpOption->m_uniformDistribution);
+            } else {
+                func(angularDistribution, m_sprayOpOption->m_uniformDistributionPolarDistance);
+            }
+        } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Gaussian) {
+            if (m_sprayOpOption->data.radialDistributionCenterBiased) {
+                func(angularDistribution, m_sprayOpOption->m_normalDistribution);
+            } else {
+                func(angularDistribution, m_sprayOpOption->m_normalDistributionPolarDistance);
+            }
+        } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_ClusterBased) {
+            func(angularDistribution, m_sprayOpOption->m_clusterBasedDistributionPolarDistance);
+        } else {
+            func(angularDistribution, m_sprayOpOption->m_radialCurveBasedDistributionPolarDistance);
+        }
+    };
+
     if (m_sprayOpOption->data.angularDistributionType == KisSprayOpOptionData::ParticleDistribution_Uniform) {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, m_sprayOpOption->m_uniformDistribution);
+        dispatchRadial(m_sprayOpOption->m_uniformDistribution);
     } else {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, m_sprayOpOption->m_angularCurveBasedDistribution);
+        dispatchRadial(m_sprayOpOption->m_angularCurveBasedDistribution);
     }
 }
 
-template <typename AngularDistribution>
-void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
-                           const KisPaintInformation& info,
-                           qreal rotation, qreal scale,
-                           qreal additionalScale,
-                           const KoColor &color,
-                           const KoColor &bgColor,
-                           const AngularDistribution &angularDistribution)
+void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
+                       const KisPaintInformation& info,
+                       qreal rotation, qreal scale,
+                       qreal additionalScale,
+                       const KoColor &color, const KoColor &bgColor)
 {
-    if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Uniform) {
-        if (m_sprayOpOption->data.radialDistributionCenterBiased) {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                      angularDistribution, m_sprayOpOption->m_uniformDistribution);
-        } else {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                      angularDistribution, m_sprayOpOption->m_uniformDistributionPolarDistance);
-        }
-    } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Gaussian) {
-        if (m_sprayOpOption->data.radialDistributionCenterBiased) {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                      angularDistribution, m_sprayOpOption->m_normalDistribution);
-        } else {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                      angularDistribution, m_sprayOpOption->m_normalDistributionPolarDistance);
+    if (canGenerateParticlesConcurrently()) {
+        PixelDab pixelDab = preparePixelDab(info, rotation, scale, additionalScale, color, bgColor);
+        for (int i = 0; i < pixelDab.blocks.size(); i++) {
+            generatePixelBlock(&pixelDab, i);
         }
-    } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_ClusterBased) {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                  angularDistribution, m_sprayOpOption->m_clusterBasedDistributionPolarDistance);
-    } else {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                  angularDistribution, m_sprayOpOption->m_radialCurveBasedDistributionPolarDistance);
+        flushPixelDab(&pixelDab, dab);
+        return;
     }
+
+    dispatchDistributions(
+        [&] (const auto &angularDistribution, const auto &radialDistribution) {
+            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
+                      angularDistribution, radialDistribution);
+        });
 }
 
 template <typename AngularDistribution, typename RadialDistribution>
@@ -160,6 +165,7 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
         m_painter->setFillStyle(KisPainter::FillStyleForegroundColor);
         m_painter->setMaskImageSize(effectiveSize.width(), effectiveSize.height());
         m_dabPixelSize = dab->colorSpace()->pixelSize();
+        m_pixelBuffer = KisSprayPixelBuffer(m_dabPixelSize);
         if (m_colorProperties->useRandomHSV) {
             m_transfo = dab->colorSpace()->createColorTransformation("hsv_adjustment", QHash<QString, QVariant>());
         }
@@ -174,7 +180,6 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
 
     qreal x = info.pos().x();
     qreal y = info.pos().y();
-    KisRandomAccessorSP accessor = dab->createRandomAccessorNG();
 
     Q_ASSERT(color.colorSpace()->pixelSize() == dab->pixelSize());
     m_inkColor = color;
@@ -264,19 +269,7 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
 
             // mix the color with background color
             if (m_colorProperties->mixBgColor) {
-                KoMixColorsOp * mixOp = dab->colorSpace()->mixColorsOp();
-
-                const quint8 *colors[2];
-                colors[0] = m_inkColor.data();
-                colors[1] = bgColor.data();
-
-                qint16 colorWeights[2];
-                int MAX_16BIT = 255;
-                qreal blend = info.pressure();
-
-                colorWeights[0] = static_cast<quint16>(blend * MAX_16BIT);
-                colorWeights[1] = static_cast<quint16>((1.0 - blend) * MAX_16BIT);
-                mixOp->mixColors(colors, colorWeights, 2, m_inkColor.data());
+                mixWithBackground(&m_inkColor, bgColor, info.pressure());
             }
 
             if (m_colorProperties->useRandomHSV && m_transfo) {
@@ -326,15 +319,14 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
             }
             // wu-particle
             case 2: {
-                paintParticle(accessor, m_inkColor, nx + x, ny + y);
+                paintParticle(&m_pixelBuffer, m_inkColor, nx + x, ny + y);
                 break;
             }
             // pixel
             case 3: {
                 ix = qRound(nx + x);
                 iy = qRound(ny + y);
-                accessor->moveTo(ix, iy);
-                memcpy(accessor->rawData(), m_inkColor.data(), m_dabPixelSize);
+                m_pixelBuffer.addPixel(ix, iy, m_inkColor.data());
                 break;
             }
             case 4: {
@@ -410,13 +402,16 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
             m_inkColor=color;//reset color//
         }
     }
+
+    m_pixelBuffer.flush(dab);
+
     // recover from jittering of color,
     // m_inkColor.opacity is recovered with every paint
 }
 
 
 
-void SprayBrush::paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor &color, qreal rx, qreal ry)
+void SprayBrush::paintParticle(KisSprayPixelBuffer *pixels, const KoColor &color, qreal rx, qreal ry) const
 {
     // opacity top left, right, bottom left, right
     KoColor pcolor(color);
@@ -437,20 +432,173 @@ void SprayBrush::paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor
     // Maybe some kind of compositing using here would be cool
 
     pcolor.setOpacity(btl);
-    writeAccessor->moveTo(ipx  , ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
+    pixels->addPixel(ipx, ipy, pcolor.data());
 
     pcolor.setOpacity(btr);
-    writeAccessor->moveTo(ipx + 1, ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
+    pixels->addPixel(ipx + 1, ipy, pcolor.data());
 
     pcolor.setOpacity(bbl);
-    writeAccessor->moveTo(ipx, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
+    pixels->addPixel(ipx, ipy + 1, pcolor.data());
 
     pcolor.setOpacity(bbr);
-    writeAccessor->moveTo(ipx + 1, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
+    pixels->addPixel(ipx + 1, ipy + 1, pcolor.data());
+}
+
+void SprayBrush::mixWithBackground(KoColor *inkColor, const KoColor &bgColor, qreal pressure) const
+{
+    KoMixColorsOp * mixOp = inkColor->colorSpace()->mixColorsOp();
+
+    const quint8 *colors[2];
+    colors[0] = inkColor->data();
+    colors[1] = bgColor.data();
+
+    qint16 colorWeights[2];
+    int MAX_16BIT = 255;
+    qreal blend = pressure;
+
+    colorWeights[0] = static_cast<quint16>(blend * MAX_16BIT);
+    colorWeights[1] = static_cast<quint16>((1.0 - blend) * MAX_16BIT);
+    mixOp->mixColors(colors, colorWeights, 2, inkColor->data());
+}
+
+namespace {
+/**
+ * The number of particles generated from one random source. It must not
+ * depend on the number of threads, otherwise the strokes would differ
+ * between the machines.
+ */
+const quint32 particlesPerBlock = 4096;
+}
+
+bool SprayBrush::canGenerateParticlesConcurrently() const
+{
+    return canGenerateParticlesConcurrently(*m_shapeProperties, *m_colorProperties);
+}
+
+bool SprayBrush::canGenerateParticlesConcurrently(const KisSprayShapeOptionData &shapeProperties,
+                                                  const KisColorOptionData &colorProperties)
+{
+    return shapeProperties.enabled &&
+        (shapeProperties.shape == 2 || shapeProperties.shape == 3) &&
+        !colorProperties.sampleInputColor &&
+        !colorProperties.useRandomHSV &&
+        !colorProperties.fillBackground;
+}
+
+SprayBrush::PixelDab SprayBrush::preparePixelDab(const KisPaintInformation& info,
+                                                 qreal rotation, qreal scale,
+                                                 qreal additionalScale,
+                                                 const KoColor &color,
+                                                 const KoColor &bgColor) const
+{
+    KisRandomSourceSP randomSource = info.randomSource();
+
+    PixelDab dab;
+    dab.center = info.pos();
+    dab.pressure = info.pressure();
+    dab.color = color;
+    dab.bgColor = bgColor;
+
+    // apply size sensor
+    dab.radius = m_sprayOpOption->data.diameter/2 * scale * additionalScale;
+
+    // jitter movement
+    if (m_sprayOpOption->data.jitterMovement) {
+        dab.center.rx() += ((2 * dab.radius * randomSource->generateNormalized()) - dab.radius) * m_sprayOpOption->data.jitterAmount;
+        dab.center.ry() += ((2 * dab.radius * randomSource->generateNormalized()) - dab.radius) * m_sprayOpOption->data.jitterAmount;
+    }
+
+    if (m_sprayOpOption->data.useDensity) {
+        dab.particlesCount = (m_sprayOpOption->data.coverage * (M_PI * pow2(dab.radius)) / pow2(additionalScale));
+    }
+    else {
+        dab.particlesCount = m_sprayOpOption->data.particleCount;
+    }
+
+    dab.transform.rotateRadians(-rotation + deg2rad(m_sprayOpOption->data.brushRotation));
+    dab.transform.scale(m_sprayOpOption->data.scale, m_sprayOpOption->data.scale);
+
+    dab.inkColor = color;
+    if (!m_colorProperties->colorPerParticle) {
+        if (m_colorProperties->mixBgColor) {
+            mixWithBackground(&dab.inkColor, bgColor, dab.pressure);
+        }
+        if (m_colorProperties->useRandomOpacity) {
+            dab.inkColor.setOpacity(quint8(qRound(randomSource->generateNormalized() * OPACITY_OPAQUE_U8)));
+        }
+    }
+
+    const int numBlocks = (dab.particlesCount + particlesPerBlock - 1) / particlesPerBlock;
+    for (int i = 0; i < numBlocks; i++) {
+        dab.blockSeeds.append(int(randomSource->generate()));
+    }
+    dab.blocks.fill(KisSprayPixelBuffer(color.colorSpace()->pixelSize()), numBlocks);
+
+    return dab;
+}
+
+template <typename AngularDistribution, typename RadialDistribution>
+void SprayBrush::generatePixelBlockImpl(PixelDab *dab, int block,
+                                        const AngularDistribution &angularDistribution,
+                                        const RadialDistribution &radialDistribution) const
+{
+    if (!angularDistribution.isValid() || !radialDistribution.isValid()) {
+        return;
+    }
+
+    KisRandomSourceSP randomSource(new KisRandomSource(dab->blockSeeds[block]));
+    KisSprayPixelBuffer *pixels = &dab->blocks[block];
+
+    const quint32 firstParticle = block * particlesPerBlock;
+    const quint32 lastParticle = qMin(dab->particlesCount, firstParticle + particlesPerBlock);
+
+    KoColor inkColor = dab->inkColor;
+
+    for (quint32 i = firstParticle; i < lastParticle; i++) {
+        const qreal angle = angularDistribution(randomSource) * M_PI * 2;
+        const qreal length = radialDistribution(randomSource);
+
+        // generate polar coordinate
+        qreal nx = (dab->radius * cos(angle) * length);
+        qreal ny = (dab->radius * sin(angle) * length);
+
+        // compute the height of the ellipse
+        ny *= m_sprayOpOption->data.aspect;
+
+        dab->transform.map(nx, ny, &nx, &ny);
+
+        if (m_colorProperties->colorPerParticle) {
+            inkColor = dab->color;
+
+            if (m_colorProperties->mixBgColor) {
+                mixWithBackground(&inkColor, dab->bgColor, dab->pressure);
+            }
+            if (m_colorProperties->useRandomOpacity) {
+                inkColor.setOpacity(quint8(qRound(randomSource->generateNormalized() * OPACITY_OPAQUE_U8)));
+            }
+        }
+
+        if (m_shapeProperties->shape == 2) {
+            paintParticle(pixels, inkColor, nx + dab->center.x(), ny + dab->center.y());
+        } else {
+            pixels->addPixel(qRound(nx + dab->center.x()), qRound(ny + dab->center.y()), inkColor.data());
+        }
+    }
+}
+
+void SprayBrush::generatePixelBlock(PixelDab *dab, int block) const
+{
+    dispatchDistributions(
+        [&] (const auto &angularDistribution, const auto &radialDistribution) {
+            generatePixelBlockImpl(dab, block, angularDistribution, radialDistribution);
+        });
+}
+
+void SprayBrush::flushPixelDab(PixelDab *dab, KisPaintDeviceSP dev) const
+{
+    for (auto it = dab->blocks.begin(); it != dab->blocks.end(); ++it) {
+        it->flush(dev);
+    }
 }
 
 void SprayBrush::paintCircle(KisPainter* painter, qreal x, qreal y, qreal radius)
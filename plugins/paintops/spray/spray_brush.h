@@ -18,12 +18,15 @@
 #include "KisSprayOpOption.h"
 #include "KisSprayShapeDynamicsOptionData.h"
 #include "KisSprayShapeOptionData.h"
+#include "KisSprayPixelBuffer.h"
 
 
 
 
 
 #include <QImage>
+#include <QTransform>
+#include <QVector>
 #include <kis_brush.h>
 
 class KisPaintInformation;
@@ -51,6 +54,66 @@ public:
 
     void setFixedDab(KisFixedPaintDeviceSP dab);
 
+    /**
+     * A dab of the wu-particle or pixel shape. Its particles are split
+     * into blocks of a fixed size and every block is generated from its
+     * own random source, seeded from the random source of the stroke.
+     * The blocks can be generated concurrently, and the result does not
+     * depend on the number of threads.
+     */
+    struct PixelDab
+    {
+        QPointF center;
+        qreal radius {1.0};
+        quint32 particlesCount {0};
+        QTransform transform;
+        qreal pressure {1.0};
+
+        /// the ink color of the particles if it is not randomized per particle
+        KoColor inkColor;
+        KoColor color;
+        KoColor bgColor;
+
+        QVector<int> blockSeeds;
+        QVector<KisSprayPixelBuffer> blocks;
+    };
+
+    /**
+     * \return true if the dabs of the current preset can be painted with
+     * preparePixelDab(), generatePixelBlock() and flushPixelDab(). That is
+     * true for the wu-particle and pixel shapes, unless the particles need
+     * to sample the layer, use the shared HSV transformation or the painter.
+     */
+    bool canGenerateParticlesConcurrently() const;
+
+    /**
+     * The same check done on the options of a preset, used by the
+     * settings to request asynchronous updates from the stroke
+     */
+    static bool canGenerateParticlesConcurrently(const KisSprayShapeOptionData &shapeProperties,
+                                                 const KisColorOptionData &colorProperties);
+
+    /**
+     * Takes all the values of the dab from the random source of the stroke
+     */
+    PixelDab preparePixelDab(const KisPaintInformation& info,
+                             qreal rotation,
+                             qreal scale,
+                             qreal additionalScale,
+                             const KoColor &color,
+                             const KoColor &bgColor) const;
+
+    /**
+     * Generates the particles of block \p block of \p dab. Different
+     * blocks may be generated concurrently.
+     */
+    void generatePixelBlock(PixelDab *dab, int block) const;
+
+    /**
+     * Writes the particles of all the blocks into \p dev, in block order
+     */
+    void flushPixelDab(PixelDab *dab, KisPaintDeviceSP dev) const;
+
 private:
     int m_dabSeqNo {0};
     KoColor m_inkColor;
@@ -74,17 +137,14 @@ private:
     KisBrushSP m_brush;
     KisFixedPaintDeviceSP m_fixedDab;
 
+    /// pixel writes of the wu-particle and pixel shapes, deferred until all
+    /// the particles of the dab are generated and then applied tile by tile
+    KisSprayPixelBuffer m_pixelBuffer;
+
 private:
-    template <typename AngularDistribution>
-    void paintImpl(KisPaintDeviceSP dab,
-                   KisPaintDeviceSP source,
-                   const KisPaintInformation& info,
-                   qreal rotation,
-                   qreal scale,
-                   qreal additionalScale,
-                   const KoColor &color,
-                   const KoColor &bgColor,
-                   const AngularDistribution &angularDistribution);
+    /// calls \p func with the angular and radial distributions of the preset
+    template <typename Func>
+    void dispatchDistributions(Func func) const;
     template <typename AngularDistribution, typename RadialDistribution>
     void paintImpl(KisPaintDeviceSP dab,
                    KisPaintDeviceSP source,
@@ -96,10 +156,17 @@ private:
                    const KoColor &bgColor,
                    const AngularDistribution &angularDistribution,
                    const RadialDistribution &radialDistribution);
+    template <typename AngularDistribution, typename RadialDistribution>
+    void generatePixelBlockImpl(PixelDab *dab,
+                                int block,
+                                const AngularDistribution &angularDistribution,
+                                const RadialDistribution &radialDistribution) const;
     /// rotation in radians according the settings (gauss distribution, uniform distribution or fixed angle)
     qreal rotationAngle(KisRandomSourceSP randomSource);
+    /// mixes the ink color with the background color, weighted by the pressure
+    void mixWithBackground(KoColor *inkColor, const KoColor &bgColor, qreal pressure) const;
     /// Paints Wu Particle
-    void paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor &color, qreal rx, qreal ry);
+    void paintParticle(KisSprayPixelBuffer *pixels, const KoColor &color, qreal rx, qreal ry) const;
     void paintCircle(KisPainter * painter, qreal x, qreal y, qreal radius);
     void paintEllipse(KisPainter * painter, qreal x, qreal y, qreal a, qreal b, qreal angle);
     void paintRectangle(KisPainter * painter, qreal x, qreal y, qreal width, qreal height, qreal angle);
@@ -0,0 +1,86 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSprayOpTest.h"
+
+#include "kistest.h"
+
+#include <stroke_testing_utils.h>
+#include <strokes/freehand_stroke.h>
+#include <strokes/KisFreehandStrokeInfo.h>
+#include <KisAsynchronousStrokeUpdateHelper.h>
+#include <kis_resources_snapshot.h>
+#include <kis_image.h>
+#include <kis_paint_device.h>
+#include <brushengine/kis_paint_information.h>
+
+class SprayFreehandStrokeTester : public utils::StrokeTester
+{
+public:
+    SprayFreehandStrokeTester(const QString &presetFilename)
+        : StrokeTester("spray-freehand", QSize(500, 500), presetFilename)
+    {
+    }
+
+    QRect paintedRect() const {
+        return m_paintedRect;
+    }
+
+    bool presetNeedsAsynchronousUpdates() const {
+        return m_presetNeedsAsynchronousUpdates;
+    }
+
+protected:
+    using utils::StrokeTester::addPaintingJobs;
+
+    KisStrokeStrategy* createStroke(KisResourcesSnapshotSP resources,
+                                    KisImageWSP image) override {
+        Q_UNUSED(image);
+
+        m_presetNeedsAsynchronousUpdates =
+            resources->presetNeedsAsynchronousUpdates();
+
+        return new FreehandStrokeStrategy(resources, new KisFreehandStrokeInfo(),
+                                          kundo2_noi18n("Freehand Stroke"));
+    }
+
+    void addPaintingJobs(KisImageWSP image,
+                         KisResourcesSnapshotSP resources) override
+    {
+        Q_UNUSED(resources);
+
+        KisPaintInformation pi1(QPointF(100, 100));
+        KisPaintInformation pi2(QPointF(400, 400));
+
+        image->addJob(strokeId(), new FreehandStrokeStrategy::Data(0, pi1, pi2));
+        image->addJob(strokeId(), new KisAsynchronousStrokeUpdateHelper::UpdateData(true));
+    }
+
+    void beforeCheckingResult(KisImageWSP image, KisNodeSP activeNode) override {
+        Q_UNUSED(image);
+        m_paintedRect = activeNode->paintDevice()->exactBounds();
+    }
+
+private:
+    QRect m_paintedRect;
+    bool m_presetNeedsAsynchronousUpdates = false;
+};
+
+void KisSprayOpTest::testFreehandStrokePaintsPixels()
+{
+    /**
+     * The wu-particle preset takes the concurrent path of the paintop,
+     * which paints only from the asynchronous updates of the stroke
+     */
+    SprayFreehandStrokeTester tester("spray_wu_pixels1.kpp");
+    tester.testSimpleStrokeNoVerification();
+
+    QVERIFY(tester.presetNeedsAsynchronousUpdates());
+    QVERIFY(!tester.paintedRect().isEmpty());
+    QVERIFY(QRect(50, 50, 400, 400).contains(tester.paintedRect()));
+}
+
+KISTEST_MAIN(KisSprayOpTest)
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSPRAYOPTEST_H
+#define KISSPRAYOPTEST_H
+
+#include <QtTest>
+
+class KisSprayOpTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+
+    void testFreehandStrokePaintsPixels();
+};
+
+#endif // KISSPRAYOPTEST_H
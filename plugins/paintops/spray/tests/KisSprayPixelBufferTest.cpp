@@ -0,0 +1,78 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSprayPixelBufferTest.h"
+
+#include "kistest.h"
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+#include <kis_random_generator.h>
+
+#include "../KisSprayPixelBuffer.h"
+
+void KisSprayPixelBufferTest::testFlushMatchesPerPixelWrites_data()
+{
+    QTest::addColumn<QRect>("area");
+    QTest::addColumn<int>("numPixels");
+
+    QTest::addRow("single-tile") << QRect(3, 5, 50, 50) << 1000;
+    QTest::addRow("many-tiles") << QRect(-100, -70, 300, 260) << 20000;
+
+    // more writes than pixels, so that most of the pixels are overwritten
+    QTest::addRow("overwrites") << QRect(-10, -10, 20, 20) << 5000;
+}
+
+void KisSprayPixelBufferTest::testFlushMatchesPerPixelWrites()
+{
+    QFETCH(QRect, area);
+    QFETCH(int, numPixels);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const int pixelSize = cs->pixelSize();
+
+    KisPaintDeviceSP flushed = new KisPaintDevice(cs);
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+
+    KisSprayPixelBuffer buffer(pixelSize);
+    KisRandomAccessorSP accessor = reference->createRandomAccessorNG();
+
+    KisRandomGenerator random(42);
+    QVector<quint8> color(pixelSize);
+
+    for (int i = 0; i < numPixels; i++) {
+        const int x = area.x() + random.randomAt(i, 0) % area.width();
+        const int y = area.y() + random.randomAt(i, 1) % area.height();
+
+        for (int j = 0; j < pixelSize; j++) {
+            color[j] = random.randomAt(i, 2 + j) % 256;
+        }
+
+        buffer.addPixel(x, y, color.constData());
+
+        accessor->moveTo(x, y);
+        memcpy(accessor->rawData(), color.constData(), pixelSize);
+    }
+
+    buffer.flush(flushed);
+    QVERIFY(buffer.isEmpty());
+
+    QCOMPARE(flushed->exactBounds(), reference->exactBounds());
+
+    const QRect rc = reference->exactBounds();
+    QVector<quint8> flushedBytes(rc.width() * rc.height() * pixelSize);
+    QVector<quint8> referenceBytes(rc.width() * rc.height() * pixelSize);
+
+    flushed->readBytes(flushedBytes.data(), rc);
+    reference->readBytes(referenceBytes.data(), rc);
+
+    QVERIFY(flushedBytes == referenceBytes);
+}
+
+KISTEST_MAIN(KisSprayPixelBufferTest)
@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSPRAYPIXELBUFFERTEST_H
+#define KISSPRAYPIXELBUFFERTEST_H
+
+#include <QtTest>
+
+class KisSprayPixelBufferTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+
+    void testFlushMatchesPerPixelWrites_data();
+    void testFlushMatchesPerPixelWrites();
+};
+
+#endif // KISSPRAYPIXELBUFFERTEST_H